@@ -6,6 +6,9 @@
 #include "AudioTester.h"
 #include "HitSoundTest.h"
 #include "SkinLoadTest.h"
+#include "ReplayVerifyTest.h"
+#include "ReplayFramesTest.h"
+#include "StackingTest.h"
 #include "AsyncPoolTest.h"
 #include "NeomodEnvInterop.h"
 
@@ -20,6 +23,9 @@ static constexpr std::array sDescriptors{
     AppDescriptor{"HitSoundTest", [] -> App * { return new Mc::Tests::HitSoundTest(); }},
     AppDescriptor{"SkinLoadTest", [] -> App * { return new Mc::Tests::SkinLoadTest(); }},
     AppDescriptor{"AsyncPoolTest", [] -> App * { return new Mc::Tests::AsyncPoolTest(); }},
+    AppDescriptor{"ReplayVerifyTest", [] -> App * { return new Mc::Tests::ReplayVerifyTest(); }},
+    AppDescriptor{"ReplayFramesTest", [] -> App * { return new Mc::Tests::ReplayFramesTest(); }},
+    AppDescriptor{"StackingTest", [] -> App * { return new Mc::Tests::StackingTest(); }},
 };
 
 std::span<const AppDescriptor> getAllAppDescriptors() { return sDescriptors; }
@@ -137,7 +137,7 @@ void process_leaderboard_response(const MD5Hash beatmap_hash, std::string body_s
         scores.push_back(std::move(score));
     }
 
-    db->getOnlineScores()[beatmap_hash] = std::move(scores);
+    db->setOnlineScores(beatmap_hash, std::move(scores));
     ui->getSongBrowser()->onGotNewLeaderboard(beatmap_hash);
 }
 }  // namespace
@@ -198,7 +198,7 @@ void fetch_online_scores(const DatabaseBeatmap *beatmap) {
             process_leaderboard_response(map_md5, response.body);
         } else {
             debugLog("Leaderboard request failed: {}", response.error_msg);
-            db->getOnlineScores()[map_md5] = std::vector<FinishedScore>();
+            db->setOnlineScores(map_md5, {});
             ui->getSongBrowser()->onGotNewLeaderboard(map_md5);
         }
     });
@@ -201,7 +201,7 @@ void submit_score(FinishedScore score) {
             debugLog("Score submit result: {}", response.body);
 
             // Reset leaderboards so new score will appear
-            db->getOnlineScores().clear();
+            db->clearOnlineScores();
             ui->getSongBrowser()->onGotNewLeaderboard(beatmap_hash_str);
         } else {
             // TODO: handle failure
@@ -0,0 +1,116 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "BeatmapColumns.h"
+
+#include "DatabaseBeatmap.h"
+
+#include <algorithm>
+#include <cassert>
+
+void BeatmapColumns::addSet(BeatmapSet *set) {
+    const auto &diffs = set->getDifficulties();
+    const u32 first = static_cast<u32>(this->size());
+    const uSz new_size = first + 1 + diffs.size();
+
+    this->ar.resize(new_size);
+    this->cs.resize(new_size);
+    this->hp.resize(new_size);
+    this->od.resize(new_size);
+    this->bpm.resize(new_size);
+    this->length_ms.resize(new_size);
+    this->date_added.resize(new_size);
+    this->sr_arrays.resize(new_size);
+    this->stars_nomod.resize(new_size);
+    this->num_children.resize(new_size);
+
+    set->column_row = first;
+    this->fill(first, set);
+    this->num_children[first] = static_cast<u32>(diffs.size());
+
+    u32 row = first + 1;
+    for(const auto &diff : diffs) {
+        diff->column_row = row;
+        this->fill(row, diff.get());
+        this->num_children[row] = 0;
+        row++;
+    }
+
+    this->invalidateStars();
+}
+
+void BeatmapColumns::update(const DatabaseBeatmap *map) {
+    const u32 row = map->getColumnRow();
+    if(!this->contains(row)) return;
+
+    this->fill(row, map);
+    this->invalidateStars();
+}
+
+void BeatmapColumns::fill(u32 row, const DatabaseBeatmap *map) {
+    const bool is_set = !map->getDifficulties().empty();
+
+    this->ar[row] = map->getAR();
+    this->cs[row] = map->getCS();
+    this->hp[row] = map->getHP();
+    this->od[row] = map->getOD();
+    this->bpm[row] = map->getMostCommonBPM();
+    this->length_ms[row] = map->getLengthMS();
+    this->date_added[row] = map->last_modification_time;
+    this->sr_arrays[row] = is_set ? nullptr : map->star_ratings;
+    this->stars_nomod[row] = is_set ? 0.f : map->fStarsNomod;
+}
+
+void BeatmapColumns::clear() {
+    this->ar.clear();
+    this->cs.clear();
+    this->hp.clear();
+    this->od.clear();
+    this->bpm.clear();
+    this->length_ms.clear();
+    this->date_added.clear();
+    this->sr_arrays.clear();
+    this->stars_nomod.clear();
+    this->num_children.clear();
+    this->stars.clear();
+    this->invalidateStars();
+}
+
+void BeatmapColumns::reserve(uSz num_rows) {
+    this->ar.reserve(num_rows);
+    this->cs.reserve(num_rows);
+    this->hp.reserve(num_rows);
+    this->od.reserve(num_rows);
+    this->bpm.reserve(num_rows);
+    this->length_ms.reserve(num_rows);
+    this->date_added.reserve(num_rows);
+    this->sr_arrays.reserve(num_rows);
+    this->stars_nomod.reserve(num_rows);
+    this->num_children.reserve(num_rows);
+}
+
+const std::vector<f32> &BeatmapColumns::getStars(u8 idx) {
+    assert(idx < StarPrecalc::NUM_PRECALC_RATINGS);
+    if(idx == this->stars_idx && this->stars.size() == this->size()) return this->stars;
+
+    const uSz rows = this->size();
+    this->stars.resize(rows);
+
+    // difficulties: calculated rating if we have one, otherwise fall back to nomod stars
+    for(uSz row = 0; row < rows; row++) {
+        const StarPrecalc::SRArray *srs = this->sr_arrays[row];
+        const f32 calculated = srs ? (*srs)[idx] : 0.f;
+        this->stars[row] = calculated > 0.f ? calculated : this->stars_nomod[row];
+    }
+
+    // sets: highest rated difficulty
+    for(uSz row = 0; row < rows; row++) {
+        const u32 children = this->num_children[row];
+        if(children == 0) continue;
+
+        const auto first_child = this->stars.begin() + static_cast<std::ptrdiff_t>(row + 1);
+        this->stars[row] = std::max(0.f, *std::ranges::max_element(first_child, first_child + children));
+        row += children;
+    }
+
+    this->stars_idx = idx;
+    return this->stars;
+}
@@ -0,0 +1,69 @@
+#pragma once
+// Copyright (c) 2026, WH, All rights reserved.
+// columnar copy of the numeric beatmap attributes used for sorting and grouping
+
+#include "noinclude.h"
+#include "types.h"
+#include "DiffCalc/StarPrecalc.h"
+
+#include <limits>
+#include <vector>
+
+class DatabaseBeatmap;
+typedef DatabaseBeatmap BeatmapSet;
+
+// DatabaseBeatmaps are large and scattered all over the heap, so sorting thousands of them by a single float means
+// a cache miss per comparison. This keeps the values the song browser sorts and buckets by in one contiguous array
+// per attribute, indexed by a dense row id (DatabaseBeatmap::getColumnRow()).
+// Rows are assigned when Database registers a beatmapset; a set's difficulties always follow it directly.
+// Only accessed from the main thread once loading has finished (the loader fills it before that).
+class BeatmapColumns final {
+    NOCOPY_NOMOVE(BeatmapColumns)
+   public:
+    static constexpr u32 INVALID_ROW = std::numeric_limits<u32>::max();
+
+    BeatmapColumns() = default;
+    ~BeatmapColumns() = default;
+
+    // assigns rows to the set and all of its difficulties
+    void addSet(BeatmapSet *set);
+    // re-reads the attributes of an already added beatmap (e.g. after diffcalc updated it)
+    void update(const DatabaseBeatmap *map);
+    void clear();
+    void reserve(uSz num_rows);
+
+    // star ratings of every row for idx, computed the same way as DatabaseBeatmap::getStarRating()
+    // (sets get the maximum of their difficulties). cached until the next add/update/invalidateStars()
+    [[nodiscard]] const std::vector<f32> &getStars(u8 idx);
+    inline void invalidateStars() { this->stars_idx = 0xFF; }
+
+    [[nodiscard]] inline uSz size() const { return this->ar.size(); }
+    [[nodiscard]] inline bool contains(u32 row) const { return row < this->size(); }
+
+    [[nodiscard]] inline const std::vector<f32> &getAR() const { return this->ar; }
+    [[nodiscard]] inline const std::vector<f32> &getCS() const { return this->cs; }
+    [[nodiscard]] inline const std::vector<f32> &getHP() const { return this->hp; }
+    [[nodiscard]] inline const std::vector<f32> &getOD() const { return this->od; }
+    [[nodiscard]] inline const std::vector<i32> &getMostCommonBPM() const { return this->bpm; }
+    [[nodiscard]] inline const std::vector<u32> &getLengthMS() const { return this->length_ms; }
+    [[nodiscard]] inline const std::vector<i64> &getDateAdded() const { return this->date_added; }
+
+   private:
+    void fill(u32 row, const DatabaseBeatmap *map);
+
+    std::vector<f32> ar;
+    std::vector<f32> cs;
+    std::vector<f32> hp;
+    std::vector<f32> od;
+    std::vector<i32> bpm;
+    std::vector<u32> length_ms;
+    std::vector<i64> date_added;  // last_modification_time
+
+    // inputs for getStars()
+    std::vector<const StarPrecalc::SRArray *> sr_arrays;  // nullptr for sets and not yet calculated diffs
+    std::vector<f32> stars_nomod;
+    std::vector<u32> num_children;  // the children of a set are the rows right after it, 0 for diffs
+
+    std::vector<f32> stars;
+    u8 stars_idx{0xFF};
+};
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <chrono>
 #include <limits>
+#include <span>
 #include <utility>
 
 #include "Environment.h"
@@ -652,6 +653,14 @@ bool BeatmapInterface::start() {
 
     std::ranges::sort(this->hitobjectsSortedByEndTime, BeatmapInterface::sortHitObjectByEndTimeComp);
 
+    this->hitobjectsMaxEndTime.clear();
+    this->hitobjectsMaxEndTime.reserve(this->hitobjects.size());
+    for(i32 maxEndTime = std::numeric_limits<i32>::min(); const auto &unq : this->hitobjects) {
+        maxEndTime = std::max(maxEndTime, unq->getEndTime());
+        this->hitobjectsMaxEndTime.push_back(maxEndTime);
+    }
+    this->retiredHitObjects = {};
+
     // after the hitobjects have been loaded we can calculate the stacks
     this->calculateStacks();
     this->computeDrainRate();
@@ -1071,13 +1080,10 @@ void BeatmapInterface::seekMS(u32 ms) {
         debugLog("After seeking, we are now {:d}ms behind the player.", this->last_frame_ms - (i32)ms);
     }
 
-    if(this->is_watching) {
-        // When seeking backwards, restart simulation from beginning
-        if(std::cmp_less(ms, this->iCurMusicPos)) {
-            this->sim = std::make_unique<SimulatedBeatmapInterface>(this->beatmap, osu->getScore()->mods);
-            this->sim->spectated_replay = this->spectated_replay;
-            osu->getScore()->reset();
-        }
+    if(this->is_watching && this->sim) {
+        // Continue the simulation from the closest checkpoint before the new position
+        // (it simulates forward from the current state by itself, if that's closer)
+        this->sim->seek((i32)ms);
     }
 
     if(!this->is_watching && !BanchoState::spectating) {  // score submission already disabled when watching replay
@@ -1652,6 +1658,8 @@ void BeatmapInterface::unloadObjects() {
     this->hitobjects.clear();
     this->hitobjectsSortedByEndTime.clear();
     this->misaimObjects.clear();
+    this->hitobjectsMaxEndTime.clear();
+    this->retiredHitObjects = {};
     this->breaks.clear();
     this->clicks.clear();
     this->all_clicks.clear();
@@ -1663,9 +1671,42 @@ void BeatmapInterface::resetHitObjects(i32 curPos) {
         hitobject->update(curPos, engine->getFrameTime());
         hitobject->onReset(curPos);
     }
+    this->retiredHitObjects = {};
     ui->getHUD()->resetHitErrorBar();
 }
 
+void BeatmapInterface::updateRetiredHitObjects(i32 curPos, i32 pvs) {
+    auto &retired = this->retiredHitObjects;
+    const auto tally = [&retired](const HitObject *hobj, int delta) {
+        switch(hobj->getType()) {
+            case HitObjectType::CIRCLE:
+                retired.numCircles += delta;
+                break;
+            case HitObjectType::SLIDER:
+                retired.numSliders += delta;
+                break;
+            case HitObjectType::SPINNER:
+                retired.numSpinners += delta;
+                break;
+        }
+    };
+
+    // same condition as the "past objects" PVS check in update2(), but against the running max end time, so that the
+    // whole prefix stays valid as long as its last entry does.
+    // the pvs isn't constant (speed changes, mafham), so the prefix can also shrink again
+    const auto isPast = [&](uSz idx) { return curPos - pvs > this->hitobjectsMaxEndTime[idx]; };
+
+    while(retired.count > 0 && !isPast(retired.count - 1)) {
+        retired.count--;
+        tally(this->hitobjects[retired.count].get(), -1);
+    }
+    while(retired.count < this->hitobjects.size() && this->hitobjects[retired.count]->isFinished() &&
+          isPast(retired.count)) {
+        tally(this->hitobjects[retired.count].get(), 1);
+        retired.count++;
+    }
+}
+
 void BeatmapInterface::resetScore() {
     this->is_submittable = cvars().areAllCvarsSubmittable();
 
@@ -2878,7 +2919,40 @@ void BeatmapInterface::update2() {
 
         this->iCurrentHitObjectIndex = 0;  // reset below here, since it's needed for mafham pvs
 
-        for(int i = -1; const auto &hobjptr : this->hitobjects) {
+        // start after the retired prefix, and set everything up as if the loop below had just skipped over it
+        uSz firstActiveIndex = 0;
+        if(usePVS) {
+            this->updateRetiredHitObjects(this->iCurMusicPosWithOffsets, pvs);
+            firstActiveIndex = this->retiredHitObjects.count;
+        } else {
+            this->retiredHitObjects = {};
+        }
+
+        if(firstActiveIndex > 0) {
+            // retired objects are all in the past, so iNextHitObjectTime can't have been set by any of them
+            HitObject *lastRetired = this->hitobjects[firstActiveIndex - 1].get();
+            this->currentHitObject = lastRetired;
+            this->iPreviousHitObjectTime = lastRetired->getEndTime();
+            this->iCurrentHitObjectIndex = (int)firstActiveIndex - 1;
+
+            // ************ live pp block start ************ //
+            this->iCurrentNumCircles = this->retiredHitObjects.numCircles;
+            this->iCurrentNumSliders = this->retiredHitObjects.numSliders;
+            this->iCurrentNumSpinners = this->retiredHitObjects.numSpinners;
+            // ************ live pp block end ************** //
+
+            // this usually stops at the first one, since the followpoint fade time is shorter than the pvs
+            const i32 followPointFadeTime = (i32)cv::followpoints_prevfadetime.getFloat();
+            for(int i = (int)firstActiveIndex - 1; i >= 0; i--) {
+                if(this->iCurMusicPosWithOffsets > this->hitobjects[i]->getEndTime() + followPointFadeTime) {
+                    this->iPreviousFollowPointObjectIndex = i;
+                    break;
+                }
+            }
+        }
+
+        for(int i = (int)firstActiveIndex - 1;
+            const auto &hobjptr : std::span{this->hitobjects}.subspan(firstActiveIndex)) {
             ++i;
             HitObject *curHobj = hobjptr.get();
             // the order must be like this:
@@ -3113,9 +3187,8 @@ void BeatmapInterface::update2() {
             this->misaimObjects.clear();
             HitObject *lastUnfinishedHitObject = nullptr;
             const i32 hitWindow50 = (i32)this->getHitWindow50();
-            for(const auto &hitobject : this->hitobjects)  // this shouldn't hurt performance too much, since no
-                                                           // expensive operations are happening within the loop
-            {
+            // retired objects are all finished, so they can be skipped here too
+            for(const auto &hitobject : std::span{this->hitobjects}.subspan(firstActiveIndex)) {
                 if(!hitobject->isFinished()) {
                     if(this->iCurMusicPosWithOffsets >= hitobject->getClickTime())
                         lastUnfinishedHitObject = hitobject.get();
@@ -4191,12 +4264,6 @@ void BeatmapInterface::calculateStacks() {
 
     debugLog("Beatmap: Calculating stacks ...");
 
-    // reset
-    for(auto &hitobject : this->hitobjects) {
-        hitobject->setStack(0);
-    }
-
-    const f32 STACK_LENIENCE = 3.0f;
     const f32 STACK_OFFSET = 0.05f;
 
     const f32 approachTime =
@@ -4204,120 +4271,8 @@ void BeatmapInterface::calculateStacks() {
                                       GameRules::getMaxApproachTime());
     const f32 stackLeniency = this->beatmap->getStackLeniency();
 
-    if(this->beatmap->getVersion() > 5) {
-        // peppy's algorithm
-        // https://gist.github.com/peppy/1167470
-
-        for(int i = this->hitobjects.size() - 1; i >= 0; i--) {
-            int n = i;
-
-            HitObject *objectI = this->hitobjects[i].get();
-
-            bool isSpinner = objectI->getType() == HitObjectType::SPINNER;
-
-            if(objectI->getStack() != 0 || isSpinner) continue;
-
-            bool isHitCircle = objectI->getType() == HitObjectType::CIRCLE;
-            bool isSlider = objectI->getType() == HitObjectType::SLIDER;
-
-            if(isHitCircle) {
-                while(--n >= 0) {
-                    HitObject *objectN = this->hitobjects[n].get();
-
-                    bool isSpinnerN = objectN->getType() == HitObjectType::SPINNER;
-
-                    if(isSpinnerN) continue;
-
-                    if(objectI->getClickTime() - (approachTime * stackLeniency) > (objectN->getEndTime())) break;
-
-                    vec2 objectNEndPosition = objectN->getOriginalRawPosAt(objectN->getEndTime());
-                    if(objectN->getDuration() != 0 &&
-                       vec::length(objectNEndPosition - objectI->getOriginalRawPosAt(objectI->getClickTime())) <
-                           STACK_LENIENCE) {
-                        int offset = objectI->getStack() - objectN->getStack() + 1;
-                        for(int j = n + 1; j <= i; j++) {
-                            if(vec::length((objectNEndPosition - this->hitobjects[j]->getOriginalRawPosAt(
-                                                                     this->hitobjects[j]->getClickTime()))) <
-                               STACK_LENIENCE)
-                                this->hitobjects[j]->setStack(this->hitobjects[j]->getStack() - offset);
-                        }
-
-                        break;
-                    }
-
-                    if(vec::length((objectN->getOriginalRawPosAt(objectN->getClickTime()) -
-                                    objectI->getOriginalRawPosAt(objectI->getClickTime()))) < STACK_LENIENCE) {
-                        objectN->setStack(objectI->getStack() + 1);
-                        objectI = objectN;
-                    }
-                }
-            } else if(isSlider) {
-                while(--n >= 0) {
-                    HitObject *objectN = this->hitobjects[n].get();
-
-                    bool isSpinnerN = objectN->getType() == HitObjectType::SPINNER;
-
-                    if(isSpinnerN) continue;
-
-                    if(objectI->getClickTime() - (approachTime * stackLeniency) > objectN->getClickTime()) break;
-
-                    if(vec::length(
-                           ((objectN->getDuration() != 0 ? objectN->getOriginalRawPosAt(objectN->getEndTime())
-                                                         : objectN->getOriginalRawPosAt(objectN->getClickTime())) -
-                            objectI->getOriginalRawPosAt(objectI->getClickTime()))) < STACK_LENIENCE) {
-                        objectN->setStack(objectI->getStack() + 1);
-                        objectI = objectN;
-                    }
-                }
-            }
-        }
-    } else  // getSelectedDifficulty()->version < 6
-    {
-        // old stacking algorithm for old beatmaps
-        // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Beatmaps/BeatmapProcessor.cs
-
-        for(int i = 0; i < this->hitobjects.size(); i++) {
-            HitObject *currHitObject = this->hitobjects[i].get();
-            auto *sliderPointer = currHitObject && currHitObject->getType() == HitObjectType::SLIDER
-                                      ? static_cast<Slider *>(currHitObject)
-                                      : nullptr;
-
-            const bool isSlider = (sliderPointer != nullptr);
-
-            if(currHitObject->getStack() != 0 && !isSlider) continue;
-
-            i32 startTime = currHitObject->getEndTime();
-            int sliderStack = 0;
-
-            for(int j = i + 1; j < this->hitobjects.size(); j++) {
-                HitObject *objectJ = this->hitobjects[j].get();
-
-                if(objectJ->getClickTime() - (approachTime * stackLeniency) > startTime) break;
-
-                // "The start position of the hitobject, or the position at the end of the path if the hitobject is a
-                // slider"
-                vec2 position2 = isSlider ? sliderPointer->getOriginalRawPosAt(sliderPointer->getEndTime())
-                                          : currHitObject->getOriginalRawPosAt(currHitObject->getClickTime());
-
-                if(vec::length((objectJ->getOriginalRawPosAt(objectJ->getClickTime()) -
-                                currHitObject->getOriginalRawPosAt(currHitObject->getClickTime()))) < 3) {
-                    currHitObject->setStack(currHitObject->getStack() + 1);
-                    startTime = objectJ->getEndTime();
-                } else if(vec::length((objectJ->getOriginalRawPosAt(objectJ->getClickTime()) - position2)) < 3) {
-                    // "Case for sliders - bump notes down and right, rather than up and left."
-                    sliderStack++;
-                    objectJ->setStack(objectJ->getStack() - sliderStack);
-                    startTime = objectJ->getEndTime();
-                }
-            }
-        }
-    }
-
-    // update hitobject positions
-    f32 stackOffset = this->fRawHitcircleDiameter * STACK_OFFSET;
-    for(auto &hitobject : this->hitobjects) {
-        if(hitobject->getStack() != 0) hitobject->updateStackPosition(stackOffset);
-    }
+    HitObject::calculateStacks(this->hitobjects, this->beatmap->getVersion(), approachTime * stackLeniency,
+                               this->fRawHitcircleDiameter * STACK_OFFSET);
 }
 
 void BeatmapInterface::computeDrainRate() {
@@ -271,6 +271,7 @@ class BeatmapInterface final : public AbstractBeatmapInterface {
     void unloadObjects();
 
     void resetHitObjects(i32 curPos = 0);
+    void updateRetiredHitObjects(i32 curPos, i32 pvs);
 
     void playMissSound();
 
@@ -329,6 +330,17 @@ class BeatmapInterface final : public AbstractBeatmapInterface {
     std::vector<HitObject *> hitobjectsSortedByEndTime;  // for hitObject->draw/draw2()
     std::vector<HitObject *> nonSpinnerObjectsToDraw;    // for drawHitObjects, temp buffer
     std::vector<HitObject *> misaimObjects;
+    std::vector<i32> hitobjectsMaxEndTime;  // running max of getEndTime() over "hitobjects"
+
+    // the leading run of "hitobjects" which update2() would only skip as "past objects" (finished and out of the PVS),
+    // so the per-frame update doesn't have to walk over everything that was already played.
+    // objects only become unfinished again through resetHitObjects(), which clears this
+    struct {
+        uSz count{0};
+        int numCircles{0};
+        int numSliders{0};
+        int numSpinners{0};
+    } retiredHitObjects;
 
     // statistics
     int iNPS;
@@ -1,6 +1,7 @@
 // Copyright (c) 2024, kiwec, All rights reserved.
 #include "Collections.h"
 
+#include "AsyncPool.h"
 #include "ByteBufferedFile.h"
 #include "OsuConVars.h"
 #include "Database.h"
@@ -87,7 +88,8 @@ Collection& get_or_create_collection(std::string_view name) {
 
 // Should only be called from db loader thread!
 bool load_peppy(std::string_view peppy_collections_path) {
-    ByteBufferedFile::Reader peppy_collections(peppy_collections_path);
+    ByteBufferedFile::MappedReader mapped_collections(peppy_collections_path);
+    ByteBufferedFile::SpanReader peppy_collections(mapped_collections.data());
     if(peppy_collections.total_size == 0) return false;
     if(!cv::collections_legacy_enabled.getBool()) {
         db->bytes_processed += peppy_collections.total_size;
@@ -102,31 +104,62 @@ bool load_peppy(std::string_view peppy_collections_path) {
         return false;
     }
 
-    u32 total_maps = 0;
+    // find where each collection's hashes are first, decoding them is most of the work
+    struct PeppyCollection {
+        std::string name;
+        uSz offset;
+        u32 nb_maps;
+    };
+    std::vector<PeppyCollection> peppy_cols;
+
     u32 nb_collections = peppy_collections.read<u32>();
+    peppy_cols.reserve(nb_collections);
     for(u32 c = 0; c < nb_collections; c++) {
         auto name = peppy_collections.read_string();
         u32 nb_maps = peppy_collections.read<u32>();
-        total_maps += nb_maps;
+        const uSz offset = peppy_collections.total_pos;
+        for(u32 m = 0; m < nb_maps && peppy_collections.good(); m++) {
+            peppy_collections.skip_string();
+        }
+        if(!peppy_collections.good()) break;
 
-        auto& collection = get_or_create_collection(name);
-        collection.maps.reserve(nb_maps);
-        collection.peppy_maps.reserve(nb_maps);
+        peppy_cols.push_back({.name = std::move(name), .offset = offset, .nb_maps = nb_maps});
+    }
 
-        for(u32 m = 0; m < nb_maps; m++) {
+    std::vector<std::vector<MD5Hash>> col_hashes(peppy_cols.size());
+    Async::parallel_for(peppy_cols.size(), [&](uSz c) {
+        ByteBufferedFile::SpanReader hash_reader{mapped_collections.data()};
+        hash_reader.seek(peppy_cols[c].offset);
+
+        auto &hashes = col_hashes[c];
+        hashes.resize(peppy_cols[c].nb_maps);
+        for(auto &hash : hashes) {
             MD5String map_hash;
-            (void)peppy_collections.read_hash_chars(map_hash);  // TODO: validate
+            (void)hash_reader.read_hash_chars(map_hash);  // TODO: validate
+            hash = map_hash;
+        }
+    });
+
+    u32 total_maps = 0;
+    for(uSz c = 0; c < peppy_cols.size(); c++) {
+        const auto &hashes = col_hashes[c];
+        total_maps += hashes.size();
+
+        auto& collection = get_or_create_collection(peppy_cols[c].name);
+        collection.maps.reserve(collection.maps.size() + hashes.size());
+        collection.peppy_maps.reserve(collection.peppy_maps.size() + hashes.size());
 
+        for(const auto& map_hash : hashes) {
             collection.maps.insert(map_hash);
             collection.peppy_maps.insert(map_hash);
         }
 
-        u32 progress_bytes = db->bytes_processed + peppy_collections.total_pos;
+        u32 progress_bytes = db->bytes_processed + peppy_collections.total_size * (c + 1) / peppy_cols.size();
         f64 progress_float = (f64)progress_bytes / (f64)db->total_bytes;
         db->loading_progress = std::clamp(progress_float, 0.01, 0.99);
     }
 
-    debugLog("Loaded {:d} peppy collections ({:d} maps)", nb_collections, total_maps);
+    debugLog("Loaded {:d} peppy collections ({:d} maps)", peppy_cols.size(), total_maps);
     db->bytes_processed += peppy_collections.total_size;
     return true;
 }
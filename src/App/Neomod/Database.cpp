@@ -3,6 +3,7 @@
 
 #include "AsyncIOHandler.h"
 #include "Bancho.h"
+#include "BanchoPacket.h"
 #include "ContainerRanges.h"
 #include "Parsing.h"
 #include "SString.h"
@@ -35,8 +36,15 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 #include <utility>
 
+#ifdef MCENGINE_PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 std::unique_ptr<Database> db = nullptr;
 
 bool Database::sortScoreByScore(const FinishedScore &a, const FinishedScore &b) {
@@ -96,14 +104,41 @@ bool Database::sortScoreByPP(const FinishedScore &a, const FinishedScore &b) {
 
 f32 Database::get_star_rating(const MD5Hash &hash, ModFlags flags, f32 speed) const {
     if(uSz idx = StarPrecalc::index_of(flags, speed); idx != StarPrecalc::INVALID_MODCOMBO) {
-        Sync::shared_lock lk(this->star_ratings_mtx);
-        if(const auto &it = this->star_ratings.find(hash); it != this->star_ratings.end()) {
-            return (*it->second)[idx];
+        Sync::shared_lock lk(this->diff_hash_mtx);
+        if(const auto *slot = this->diff_hashes.find(hash); slot && slot->star_ratings) {
+            return (*slot->star_ratings)[idx];
         }
     }
     return 0.f;
 }
 
+const std::vector<FinishedScore> *Database::getScores(const MD5Hash &hash) const {
+    const auto *slot = this->diff_hashes.find(hash);
+    return slot ? slot->local_scores.get() : nullptr;
+}
+
+std::vector<FinishedScore> *Database::getScoresMutable(const MD5Hash &hash) {
+    auto *slot = this->diff_hashes.find(hash);
+    return slot ? slot->local_scores.get() : nullptr;
+}
+
+std::vector<FinishedScore> *Database::getOnlineScores(const MD5Hash &hash) {
+    auto *slot = this->diff_hashes.find(hash);
+    return slot ? slot->online_scores.get() : nullptr;
+}
+
+void Database::setOnlineScores(const MD5Hash &hash, std::vector<FinishedScore> scores) {
+    Sync::unique_lock lock(this->diff_hash_mtx);
+    this->diff_hashes[hash].online_scores = std::make_unique<std::vector<FinishedScore>>(std::move(scores));
+}
+
+void Database::clearOnlineScores() {
+    Sync::unique_lock lock(this->diff_hash_mtx);
+    for(auto &slot : this->diff_hashes) {
+        slot.online_scores.reset();
+    }
+}
+
 // static helper
 std::string Database::getDBPath(DatabaseType db_type) {
     static_assert(DatabaseType::LAST == DatabaseType::STABLE_MAPS, "add missing case to getDBPath");
@@ -251,10 +286,13 @@ void Database::startLoader() {
 
     this->loudness_to_calc.clear();
     {
-        Sync::unique_lock lock(this->beatmap_difficulties_mtx);
-        this->beatmap_difficulties.clear();
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        for(auto &slot : this->diff_hashes) {
+            slot.diff = nullptr;
+        }
     }
     this->beatmapsets.clear();
+    this->beatmap_columns.clear();
 
     // append, the copy will only be cleared if loading them succeeded
     Mc::append_range(this->extern_db_paths_to_import_async_copy, std::move(this->extern_db_paths_to_import));
@@ -278,7 +316,10 @@ void Database::startLoader() {
                 this->loadOldMcNeomodScores(this->database_files[MCNEOMOD_SCORES]);
                 if(tok.stop_requested()) goto done;
                 this->loadPeppyScores(this->database_files[STABLE_SCORES]);
+                // after every score source, so pp updates/deletions of imported scores find their target
+                const u32 nb_journaled = this->replayScoreJournal();
                 this->scores_loaded = true;
+                if(nb_journaled > 0) this->compactScores();
                 if(tok.stop_requested()) goto done;
                 this->loadMaps(this->database_files[NEOMOD_MAPS], this->database_files[STABLE_MAPS]);
                 if(tok.stop_requested()) goto done;
@@ -317,9 +358,25 @@ void Database::destroyLoader() {
     VolNormalization::abort();
 
     directoryWatcher->stop_watching(NEOMOD_MAPS_PATH "/");
+    if(!this->watched_songs_folder.empty()) {
+        directoryWatcher->stop_watching(this->watched_songs_folder);
+        for(const auto &folder : this->watched_new_song_folders) {
+            directoryWatcher->stop_watching(fmt::format("{}{}/", this->watched_songs_folder, folder));
+        }
+        this->watched_new_song_folders.clear();
+        this->watched_songs_folder.clear();
+    }
+    this->changed_song_folders.clear();
     this->db_load_handle.cancel();
     this->load_interrupted.store(true, std::memory_order_release);  // for subroutines (loadMaps, etc.)
     if(this->db_load_handle.valid()) this->db_load_handle.wait();
+
+    // raw load tasks bail out on load_interrupted, drop whatever batches they already queued for the main thread
+    for(auto &task : this->raw_load_tasks) {
+        if(task.valid()) task.wait();
+    }
+    this->raw_load_tasks.clear();
+    this->raw_load_generation++;
     logIf(cv::debug_db.getBool() || cv::debug_async_db.getBool(), "done");
 }
 
@@ -374,10 +431,13 @@ Database::~Database() {
     this->loudness_to_calc.clear();
 
     {
-        Sync::unique_lock lock(this->beatmap_difficulties_mtx);
-        this->beatmap_difficulties.clear();
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        for(auto &slot : this->diff_hashes) {
+            slot.diff = nullptr;
+        }
     }
     this->beatmapsets.clear();
+    this->beatmap_columns.clear();
 
     Collections::unload_all();
 }
@@ -389,67 +449,246 @@ void Database::update() {
         this->onDBLoadComplete();
     }
 
-    // loadRaw() logic
-    if(this->raw_load_scheduled) {
-        Timer t;
+    // loadRaw() logic, the folders themselves are loaded by the tasks started in startRawLoadTasks()
+    if(this->raw_load_scheduled && !this->isCancelled()) {
+        // update progress
+        this->loading_progress = (float)this->cur_raw_load_idx / (float)this->num_beatmaps_to_load;
+
+        // check if we are finished
+        if(this->cur_raw_load_idx >= this->num_beatmaps_to_load) {
+            this->raw_load_beatmap_folders.clear();
+            this->raw_load_tasks.clear();
+            this->raw_load_scheduled = false;
 
-        while(t.getElapsedTime() < 0.033f) {
-            if(this->isCancelled()) break;  // cancellation point
+            this->importTimer->update();
 
-            if(this->raw_load_beatmap_folders.size() > 0 &&
-               this->cur_raw_load_idx < this->raw_load_beatmap_folders.size()) {
-                std::string curBeatmap = this->raw_load_beatmap_folders[this->cur_raw_load_idx++];
-                this->raw_loaded_beatmap_folders.push_back(
-                    curBeatmap);  // for future incremental loads, so that we know what's been loaded already
+            debugLog("Refresh finished, added {} beatmaps in {:f} seconds.", this->beatmapsets.size(),
+                     this->importTimer->getElapsedTime());
 
-                std::string fullBeatmapPath = this->raw_load_osu_song_folder;
-                fullBeatmapPath.append(curBeatmap);
-                fullBeatmapPath.append("/");
+            Collections::load_all(this->database_files[DatabaseType::MCNEOMOD_COLLECTIONS],
+                                  this->database_files[DatabaseType::STABLE_COLLECTIONS]);
 
-                this->addBeatmapSet(fullBeatmapPath,           //
-                                    -1,                        // no set id override
-                                    !this->raw_load_is_neomod  // is_peppy
-                );
+            // clang-format off
+            for(auto &diff : this->beatmapsets
+                            // for all diffs within the set with fStarsNomod <= 0.f (peppy difficulties needing recalc)
+                            | std::views::transform([](const auto &set) -> auto & { return *set->difficulties; })
+                            | std::views::join
+                            | std::views::filter([](const auto &diff) { return diff->fStarsNomod <= 0.f; })) {
+                diff->fStarsNomod *= -1.f;
             }
+            // clang-format on
+            this->loading_progress = 1.0f;
+
+            // will find maps/scores needing recalc dynamically
+            BatchDiffCalc::start_calc();
+            VolNormalization::start_calc(this->loudness_to_calc);
+
+            // not recursive: that would need an inotify watch for every set folder on linux, which easily runs past
+            // fs.inotify.max_user_watches. new set folders get their own watch instead, see onSongsFolderChange
+            if(!this->raw_load_is_neomod && DirectoryWatcher::is_event_driven()) {
+                this->watched_songs_folder = this->raw_load_osu_song_folder;
+                directoryWatcher->watch_directory(this->watched_songs_folder, [](const FileChangeEvent &ev) {
+                    if(db) db->onSongsFolderChange(ev);
+                });
+            }
+        }
+    }
+
+    if(!this->changed_song_folders.empty()) {
+        this->importChangedSongFolders();
+    }
+}
+
+void Database::onSongsFolderChange(const FileChangeEvent &ev) {
+    // only new sets are imported, see importChangedSongFolders
+    if(ev.type == FileChangeType::DELETED || this->watched_songs_folder.empty()) return;
+    if(!ev.path.starts_with(this->watched_songs_folder)) return;
+
+    const std::string_view relative = std::string_view{ev.path}.substr(this->watched_songs_folder.size());
+    const auto slash = relative.find('/');
+    if(slash == std::string_view::npos) return;
+
+    // <songs folder>/<set folder>/, reported by the songs folder watch: watch the new set until it has been imported
+    if(slash + 1 == relative.size()) {
+        const std::string_view folder = relative.substr(0, slash);
+        if(this->raw_loaded_beatmap_folders.contains(folder)) return;
+
+        if(this->watched_new_song_folders.emplace(folder).second) {
+            directoryWatcher->watch_directory(ev.path, [](const FileChangeEvent &set_ev) {
+                if(db) db->onSongsFolderChange(set_ev);
+            });
+        }
+        // its files might have been moved in along with it, in which case there won't be any events for them
+        this->changed_song_folders[std::string{folder}] = Timing::getTicksMS();
+        return;
+    }
+
+    // <songs folder>/<set folder>/<diff>.osu, reported by the watch of a new set folder
+    if(SString::to_lower(Environment::getFileExtensionFromFilePath(ev.path)) != "osu") return;
+
+    const std::string_view folder = relative.substr(0, slash);
+    if(this->raw_loaded_beatmap_folders.contains(folder)) return;
+
+    this->changed_song_folders[std::string{folder}] = Timing::getTicksMS();
+}
+
+// Only imports set folders that weren't loaded yet. Edited or deleted sets stay as they are until the next refresh,
+// since nothing else removes sets from a loaded database (the song browser, collections and the current beatmap all
+// hold on to them).
+void Database::importChangedSongFolders() {
+    if(!this->isFinished() || this->raw_load_scheduled) return;
+
+    // a set's files usually all arrive at once (extracted/copied), wait for its folder to be quiet for a bit so
+    // that we don't import it with half of its difficulties
+    static constexpr u64 SETTLE_MS = 1000;
+
+    const u64 now = Timing::getTicksMS();
+    std::vector<std::string> settled;
+    for(const auto &[folder, last_change] : this->changed_song_folders) {
+        if(now - last_change >= SETTLE_MS) settled.push_back(folder);
+    }
+
+    for(auto &folder : settled) {
+        this->changed_song_folders.erase(folder);
+        if(this->raw_loaded_beatmap_folders.contains(folder)) continue;
+
+        // keep watching the folder if it doesn't have any (valid) diffs yet
+        const std::string path = fmt::format("{}{}/", this->watched_songs_folder, folder);
+        const BeatmapSet *set = this->addBeatmapSet(path, -1, true /* is_peppy */);
+        if(set == nullptr) continue;
+
+        debugLog("Imported new beatmapset from songs folder: {}", folder);
+        if(this->watched_new_song_folders.erase(folder) > 0) directoryWatcher->stop_watching(path);
+        this->raw_loaded_beatmap_folders.insert(std::move(folder));
+    }
+}
+
+namespace {
+// the diffs of one song folder, with their file contents still waiting to be hashed, so that the diffs of several
+// folders can go through crypto::hash::md5_batch together (see finishRawBeatmaps)
+struct RawBeatmapDiffs {
+    std::string path;
+    std::unique_ptr<DiffContainer> diffs;
+    std::vector<std::vector<u8>> files;  // parallel to diffs
+    DatabaseBeatmap::LoadError lastError;
+};
+
+RawBeatmapDiffs loadRawBeatmapDiffs(const std::string &beatmapPath, bool is_peppy) {
+    logIfCV(debug_db, "beatmap path: {:s}", beatmapPath);
+
+    RawBeatmapDiffs loaded{.path = beatmapPath, .diffs = std::make_unique<DiffContainer>()};
+
+    // try loading all diffs
+    std::vector<std::string> beatmapFiles = env->getFilesInFolder(beatmapPath);
+    for(const auto &beatmapFile : beatmapFiles) {
+        std::string ext = env->getFileExtensionFromFilePath(beatmapFile);
+        if(ext.compare("osu") != 0) continue;
 
-            // update progress
-            this->loading_progress = (float)this->cur_raw_load_idx / (float)this->num_beatmaps_to_load;
+        std::string fullFilePath = beatmapPath;
+        fullFilePath.append(beatmapFile);
 
-            // check if we are finished
-            if(this->cur_raw_load_idx >= this->num_beatmaps_to_load ||
-               std::cmp_greater(this->cur_raw_load_idx, (this->raw_load_beatmap_folders.size() - 1))) {
-                this->raw_load_beatmap_folders.clear();
-                this->raw_load_scheduled = false;
+        auto map = std::make_unique<BeatmapDifficulty>(fullFilePath, beatmapPath,
+                                                       is_peppy ? DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY
+                                                                : DatabaseBeatmap::BeatmapType::NEOMOD_DIFFICULTY);
+        auto res = map->loadMetadata(false);
+        if(!res.error.errc) {
+            loaded.diffs->push_back(std::move(map));
+            loaded.files.push_back(std::move(res.fileData));
+        } else {
+            loaded.lastError = res.error;
+            logIfCV(debug_db, "Couldn't loadMetadata: {}, deleting object.", res.error.error_string());
+        }
+    }
 
-                this->importTimer->update();
+    return loaded;
+}
 
-                debugLog("Refresh finished, added {} beatmaps in {:f} seconds.", this->beatmapsets.size(),
-                         this->importTimer->getElapsedTime());
+// hashes the diffs of all folders at once and builds their sets (nullptr for folders without any loadable diff)
+std::vector<std::unique_ptr<BeatmapSet>> finishRawBeatmaps(std::span<RawBeatmapDiffs> folders, bool is_peppy) {
+    std::vector<std::span<const u8>> hashInputs;
+    for(const auto &folder : folders) {
+        hashInputs.insert(hashInputs.end(), folder.files.begin(), folder.files.end());
+    }
+    std::vector<MD5Hash> hashes(hashInputs.size());
+    crypto::hash::md5_batch(hashInputs, hashes);
 
-                Collections::load_all(this->database_files[DatabaseType::MCNEOMOD_COLLECTIONS],
-                                      this->database_files[DatabaseType::STABLE_COLLECTIONS]);
+    std::vector<std::unique_ptr<BeatmapSet>> sets;
+    sets.reserve(folders.size());
 
-                // clang-format off
-                for(auto &diff : this->beatmapsets
-                                // for all diffs within the set with fStarsNomod <= 0.f (peppy difficulties needing recalc)
-                                | std::views::transform([](const auto &set) -> auto & { return *set->difficulties; })
-                                | std::views::join
-                                | std::views::filter([](const auto &diff) { return diff->fStarsNomod <= 0.f; })) {
-                    diff->fStarsNomod *= -1.f;
+    uSz hashIdx = 0;
+    for(auto &folder : folders) {
+        for(auto &diff : *folder.diffs) {
+            diff->writeMD5(hashes[hashIdx++]);
+        }
+        folder.files.clear();
+
+        std::unique_ptr<BeatmapSet> set{nullptr};
+        if(!folder.diffs->empty()) {
+            set = std::make_unique<BeatmapSet>(std::move(folder.diffs),
+                                               is_peppy ? DatabaseBeatmap::BeatmapType::PEPPY_BEATMAPSET
+                                                        : DatabaseBeatmap::BeatmapType::NEOMOD_BEATMAPSET);
+        } else if(folder.lastError.errc) {
+            debugLog("Couldn't load beatmapset {}: {}", folder.path, folder.lastError.error_string());
+        }
+        sets.push_back(std::move(set));
+    }
+
+    return sets;
+}
+}  // namespace
+
+void Database::startRawLoadTasks() {
+    // each task loads a chunk of folders (directory listing, .osu metadata, MD5) on the background lane and hands the
+    // finished sets to the main thread in one batch, where they are deduplicated and added to beatmapsets
+    static constexpr uSz RAW_LOAD_CHUNK_SIZE = 32;
+
+    const auto &folders = this->raw_load_beatmap_folders;
+    const u32 generation = this->raw_load_generation;
+    const bool is_peppy = !this->raw_load_is_neomod;
+
+    this->raw_load_tasks.clear();
+    this->raw_load_tasks.reserve((folders.size() + RAW_LOAD_CHUNK_SIZE - 1) / RAW_LOAD_CHUNK_SIZE);
+
+    for(uSz start = 0; start < folders.size(); start += RAW_LOAD_CHUNK_SIZE) {
+        const uSz end = std::min(start + RAW_LOAD_CHUNK_SIZE, folders.size());
+
+        this->raw_load_tasks.push_back(Async::submit(
+            [this, generation, is_peppy, song_folder = this->raw_load_osu_song_folder,
+             chunk = std::vector<std::string>(folders.begin() + start, folders.begin() + end)]() {
+                // the diffs of the whole chunk are hashed together, a single folder rarely has enough of them to
+                // fill the md5_batch lanes
+                std::vector<RawBeatmapDiffs> loaded;
+                loaded.reserve(chunk.size());
+
+                for(const auto &folder : chunk) {
+                    // cancellation point (only the atomic, db_load_handle belongs to the main thread)
+                    if(this->load_interrupted.load(std::memory_order_acquire)) return;
+
+                    loaded.push_back(loadRawBeatmapDiffs(fmt::format("{}{}/", song_folder, folder), is_peppy));
                 }
-                // clang-format on
-                this->loading_progress = 1.0f;
 
-                // will find maps/scores needing recalc dynamically
-                BatchDiffCalc::start_calc();
-                VolNormalization::start_calc(this->loudness_to_calc);
+                auto batch = std::make_shared<RawLoadBatch>(generation, chunk, finishRawBeatmaps(loaded, is_peppy));
 
-                break;
-            }
+                Async::queue_main([this, batch]() { this->addRawLoadBatch(*batch); });
+            },
+            Lane::Background));
+    }
+}
+
+void Database::addRawLoadBatch(RawLoadBatch &batch) {
+    // left over from a cancelled/restarted load
+    if(!this->raw_load_scheduled || batch.generation != this->raw_load_generation) return;
 
-            t.update();
+    for(uSz i = 0; i < batch.folders.size(); i++) {
+        // for future incremental loads, so that we know what's been loaded already
+        this->raw_loaded_beatmap_folders.insert(std::move(batch.folders[i]));
+
+        if(batch.sets[i] != nullptr) {
+            this->addLoadedBeatmapSet(std::move(batch.sets[i]), -1);
         }
     }
+
+    this->cur_raw_load_idx += batch.folders.size();
 }
 
 void Database::load() {
@@ -473,7 +712,7 @@ void Database::cancel() {
 void Database::save() {
     Collections::save_collections();
     this->saveMaps();
-    this->saveScores();
+    this->compactScores();
 }
 
 // NOTE: Should currently only be used for neomod beatmapsets! e.g. from maps/ folder
@@ -483,20 +722,24 @@ BeatmapSet *Database::addBeatmapSet(const std::string &beatmapFolderPath, i32 se
     std::unique_ptr<BeatmapSet> mapset = this->loadRawBeatmap(beatmapFolderPath, is_peppy);
     if(mapset == nullptr) return nullptr;
 
+    return this->addLoadedBeatmapSet(std::move(mapset), set_id_override);
+}
+
+BeatmapSet *Database::addLoadedBeatmapSet(std::unique_ptr<BeatmapSet> mapset, i32 set_id_override) {
     BeatmapSet *raw_mapset = mapset.get();
 
     {
         // deduplicate diffs
         // TODO: this will disallow adding a neomod beatmapset if we already have a peppy beatmapset that is the same (and vice versa)!
-        Sync::unique_lock lock(this->beatmap_difficulties_mtx);
+        Sync::unique_lock lock(this->diff_hash_mtx);
         for(auto diffit = mapset->difficulties->begin(); diffit != mapset->difficulties->end();) {
             const auto &diff = *diffit;
-            auto [existingit, inserted] = this->beatmap_difficulties.try_emplace(diff->getMD5(), diff.get());
-            if(!inserted) {
+            auto &slot = this->diff_hashes[diff->getMD5()];
+            if(slot.diff != nullptr) {
                 // update set id just in case we had an override, though
                 const i32 real_set_id = set_id_override != -1 ? set_id_override : mapset->iSetID;
 
-                BeatmapDifficulty *diffparent = existingit->second->parentSet;
+                BeatmapDifficulty *diffparent = slot.diff->parentSet;
                 if(const i32 old_set_id = diffparent->iSetID; old_set_id == -1 && real_set_id > 0) {
                     logIfCV(debug_db, "updating old set {} id {} -> {}", diffparent->getFolder(), old_set_id,
                             real_set_id);
@@ -505,12 +748,14 @@ BeatmapSet *Database::addBeatmapSet(const std::string &beatmapFolderPath, i32 se
                         existingdiff->iSetID = set_id_override;
                     }
                 }
-                logIfCV(debug_db, "skipping raw {} (already in beatmap_difficulties), current size: {}", diff->getMD5(),
-                        this->beatmap_difficulties.size());
+                logIfCV(debug_db, "skipping raw {} (already in diff_hashes), current size: {}", diff->getMD5(),
+                        this->diff_hashes.size());
                 diffit = mapset->difficulties->erase(diffit);
             } else {
-                logIfCV(debug_db, "adding raw {} to beatmap_difficulties, current size: {}", diff->getMD5(),
-                        this->beatmap_difficulties.size());
+                logIfCV(debug_db, "adding raw {} to diff_hashes, current size: {}", diff->getMD5(),
+                        this->diff_hashes.size());
+                slot.diff = diff.get();
+                if(slot.star_ratings) diff->star_ratings = slot.star_ratings.get();
                 ++diffit;
             }
         }
@@ -532,6 +777,7 @@ BeatmapSet *Database::addBeatmapSet(const std::string &beatmapFolderPath, i32 se
     }
 
     this->beatmapsets.push_back(std::move(mapset));
+    this->beatmap_columns.addSet(raw_mapset);
 
     // only notify songbrowser if loading is done (it rebuilds from beatmapsets in onDatabaseLoadingFinished)
     if(this->isFinished()) {
@@ -574,7 +820,8 @@ bool Database::addScore(const FinishedScore &score) {
                 }
 
                 if(!engine->isShuttingDown() && cv::scores_save_immediately.getBool()) {
-                    this->saveScores();
+                    this->appendScoreJournal(ScoreJournalOp::ADD, {&scorecopy, 1});
+                    this->compactScoresIfJournalLarge();
                 }
             },
             Lane::Background);
@@ -585,13 +832,12 @@ bool Database::addScore(const FinishedScore &score) {
 }
 
 int Database::isScoreAlreadyInDB(const MD5Hash &map_hash, u64 unix_timestamp, const std::string &playerName) {
-    Sync::shared_lock lock(this->scores_mtx);
+    Sync::shared_lock lock(this->diff_hash_mtx);
 
-    // operator[] might add a new entry
-    const auto &scoreit = this->scores.find(map_hash);
-    if(scoreit == this->scores.end()) return -1;
+    const auto *scores = this->getScores(map_hash);
+    if(scores == nullptr) return -1;
 
-    for(int existing_pos = -1; const auto &existing : scoreit->second) {
+    for(int existing_pos = -1; const auto &existing : *scores) {
         existing_pos++;
         if(existing.unixTimestamp == unix_timestamp && existing.playerName == playerName) {
             // Score has already been added
@@ -619,10 +865,10 @@ bool Database::addScoreRaw(const FinishedScore &score) {
         }
 
         {
-            Sync::shared_lock lock(this->scores_mtx);
+            Sync::shared_lock lock(this->diff_hash_mtx);
             // otherwise check if the old one doesn't have a replay
             // if it has one, don't overwrite it
-            overwrite = !this->scores[score.beatmap_hash][existing_pos].has_possible_replay();
+            overwrite = !(*this->getScores(score.beatmap_hash))[existing_pos].has_possible_replay();
         }
 
         if(!overwrite) {
@@ -631,27 +877,111 @@ bool Database::addScoreRaw(const FinishedScore &score) {
         // otherwise overwrite it
     }
 
-    Sync::unique_lock lock(this->scores_mtx);
+    Sync::unique_lock lock(this->diff_hash_mtx);
+
+    auto &slot = this->diff_hashes[score.beatmap_hash];
+    if(!slot.local_scores) slot.local_scores = std::make_unique<std::vector<FinishedScore>>();
 
     if(overwrite) {
-        this->scores[score.beatmap_hash][existing_pos] = score;
+        (*slot.local_scores)[existing_pos] = score;
     } else {
         // new score
-        this->scores[score.beatmap_hash].push_back(score);
+        slot.local_scores->push_back(score);
     }
+    this->reindexPlayerScores(slot);
 
     return true;
 }
 
+namespace {
+// what isScoreAlreadyInDB() considers the same score
+struct ScoreIdentity {
+    MD5Hash beatmap_hash;
+    u64 unix_timestamp;
+    std::string player_name;
+
+    bool operator==(const ScoreIdentity &) const = default;
+};
+
+struct ScoreIdentityHash {
+    using is_avalanching = void;
+    u64 operator()(const ScoreIdentity &id) const noexcept {
+        u64 h = Hash::flat::hash<MD5Hash>{}(id.beatmap_hash);
+
+        auto combine = [&h](u64 v) { h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2); };
+        combine(id.unix_timestamp);
+        combine(Hash::flat::hash<std::string_view>{}(id.player_name));
+
+        return h;
+    }
+};
+}  // namespace
+
+u32 Database::addScoresRaw(std::span<FinishedScore> scores) {
+    Sync::unique_lock lock(this->diff_hash_mtx);
+
+    // index what we already have once, instead of a linear isScoreAlreadyInDB() search for each imported score.
+    // slots never move, and scores are only ever appended to a slot here, so (slot, position) stays valid
+    Hash::flat::map<ScoreIdentity, std::pair<DiffHashExtraData *, u32>, ScoreIdentityHash> existing;
+    for(auto &slot : this->diff_hashes) {
+        if(!slot.local_scores) continue;
+        for(u32 pos = 0; const auto &score : *slot.local_scores) {
+            existing.try_emplace({slot.hash, score.unixTimestamp, score.playerName}, &slot, pos++);
+        }
+    }
+
+    Hash::flat::set<DiffHashExtraData *> changed_slots;
+    u32 nb_added = 0;
+    for(auto &score : scores) {
+        auto [it, inserted] =
+            existing.try_emplace({score.beatmap_hash, score.unixTimestamp, score.playerName}, nullptr, 0);
+
+        if(!inserted) {
+            // same rules as addScoreRaw(): only replace scores which can't have a replay with ones that might
+            auto &[slot, pos] = it->second;
+            FinishedScore &old = (*slot->local_scores)[pos];
+            if(!score.has_possible_replay() || old.has_possible_replay()) continue;
+
+            old = std::move(score);
+            changed_slots.insert(slot);
+            nb_added++;
+            continue;
+        }
+
+        auto &slot = this->diff_hashes[score.beatmap_hash];
+        if(!slot.local_scores) slot.local_scores = std::make_unique<std::vector<FinishedScore>>();
+
+        it->second = {&slot, static_cast<u32>(slot.local_scores->size())};
+        slot.local_scores->push_back(std::move(score));
+        changed_slots.insert(&slot);
+        nb_added++;
+    }
+
+    for(auto *slot : changed_slots) {
+        this->reindexPlayerScores(*slot);
+    }
+
+    return nb_added;
+}
+
 void Database::deleteScore(const FinishedScore &scoreToDelete) {
     if(scoreToDelete.beatmap_hash.empty()) return;
 
-    Sync::unique_lock lock(this->scores_mtx);
-    if(const auto &scoreit = this->scores.find(scoreToDelete.beatmap_hash); scoreit != this->scores.end()) {
-        if(std::erase(scoreit->second, scoreToDelete)) {
-            this->scores_changed.store(true, std::memory_order_release);
+    bool deleted = false;
+    {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        if(auto *slot = this->diff_hashes.find(scoreToDelete.beatmap_hash); slot && slot->local_scores) {
+            if(std::erase(*slot->local_scores, scoreToDelete)) {
+                this->reindexPlayerScores(*slot);
+                this->scores_changed.store(true, std::memory_order_release);
+                deleted = true;
+            }
         }
     }
+
+    if(deleted) {
+        this->appendScoreJournal(ScoreJournalOp::DELETE, {&scoreToDelete, 1});
+    }
 }
 
 void Database::sortScoresInPlace(std::vector<FinishedScore> &scores) {
@@ -675,132 +1005,194 @@ void Database::sortScoresInPlace(std::vector<FinishedScore> &scores) {
 }
 
 void Database::sortScores(const MD5Hash &beatmapMD5Hash) {
-    Sync::unique_lock lk(this->scores_mtx);
-    if(auto it = this->scores.find(beatmapMD5Hash); it != this->scores.end()) {
-        Database::sortScoresInPlace(it->second);
+    Sync::unique_lock lk(this->diff_hash_mtx);
+    if(auto *slot = this->diff_hashes.find(beatmapMD5Hash); slot && slot->local_scores) {
+        Database::sortScoresInPlace(*slot->local_scores);
     }
     return;
 }
 
-Database::PlayerPPScores Database::getPlayerPPScores(const std::string &playerName) {
-    PlayerPPScores ppScores;
-    ppScores.totalScore = 0;
-    if(this->getProgress() < 1.0f) return ppScores;
+namespace {
 
-    // hoist out of the loop
-    const bool include_autopilot_relax = cv::user_include_relax_and_autopilot_for_stats.getBool();
+// best pp score of a player on one diff, and the sum of that player's scores there
+FinishedScore *best_player_score(std::vector<FinishedScore> &scorevec, const std::string &playerName,
+                                 bool include_autopilot_relax, u64 &score_sum_out) {
+    FinishedScore *best = nullptr;
+    f64 prevPP = -1.0;
+    score_sum_out = 0;
+    for(auto &score : scorevec) {
+        // filter out scores set with a different name or if we shouldn't allow relax/autopilot
+        if((!include_autopilot_relax &&
+            (u64)score.mods.flags & ((u64)ModFlags::Relax | (u64)ModFlags::Autopilot)) ||
+           (playerName != score.playerName)) {
+            continue;
+        }
 
-    u64 totalScore = 0;
+        score_sum_out += score.score;
 
-    std::vector<FinishedScore *> scores;
-    {
-        Sync::shared_lock lock(this->scores_mtx);
+        const auto scorePP = score.get_pp();
+        if(!best || scorePP > prevPP || prevPP < 0.0) {
+            prevPP = scorePP;
+            best = &score;
+        }
+    }
+    return best;
+}
 
-        for(auto &[hash, scorevec] : this->scores) {
-            if(scorevec.empty()) continue;
+// weights past this rank are far below float precision relative to the total, so stats only look at the top plays
+constexpr uSz PLAYER_STATS_TOP_N = 1000;
 
-            FinishedScore *tempScore = &scorevec[0];
+}  // namespace
 
-            // only add highest pp score per diff
-            bool foundValidScore = false;
-            f64 prevPP = -1.0;
-            for(auto &score : scorevec) {
-                // filter out scores set with a different name or if we shouldn't allow relax/autopilot
-                if((!include_autopilot_relax &&
-                    (u64)score.mods.flags & ((u64)ModFlags::Relax | (u64)ModFlags::Autopilot)) ||
-                   (playerName != score.playerName)) {
-                    continue;
-                }
+bool Database::TopPlay::operator<(const TopPlay &other) const {
+    // same tie-breaking as sortScoreByPP, with the operands swapped
+    const auto a_pp = std::max(other.pp * 1000.0, 0.0);
+    const auto b_pp = std::max(this->pp * 1000.0, 0.0);
+    if(a_pp != b_pp) return a_pp > b_pp;
+    if(other.score != this->score) return other.score > this->score;
+    if(other.unix_timestamp != this->unix_timestamp) return other.unix_timestamp > this->unix_timestamp;
+    if(other.player_id != this->player_id) return other.player_id > this->player_id;
+    return other.play_time_ms > this->play_time_ms;
+}
 
-                foundValidScore = true;
-                totalScore += score.score;
+void Database::ensurePlayerIndex(const std::string &playerName) {
+    auto &index = this->player_index;
+    const bool include_autopilot_relax = cv::user_include_relax_and_autopilot_for_stats.getBool();
+    if(index.built && index.player_name == playerName && index.include_relax_autopilot == include_autopilot_relax) {
+        return;
+    }
 
-                const auto scorePP = score.get_pp();
-                if(scorePP > prevPP || prevPP < 0.0) {
-                    prevPP = scorePP;
-                    tempScore = &score;
-                }
-            }
+    index.player_name = playerName;
+    index.include_relax_autopilot = include_autopilot_relax;
+    index.total_score = 0;
+    index.top_plays.clear();
+    index.per_diff.clear();
+    index.built = true;
 
-            if(foundValidScore) scores.push_back(tempScore);
-        }
+    for(auto &slot : this->diff_hashes) {
+        this->reindexPlayerScores(slot);
+    }
+}
 
-        // sort by pp (reversed)
-        // for some reason this was originally backwards from sortScoreByPP, so negating it here
-        std::ranges::sort(scores, [](const FinishedScore *const a, const FinishedScore *const b) -> bool {
-            if(a == b) return false;
-            return sortScoreByPP(*b, *a);
-        });
+void Database::reindexPlayerScores(DiffHashExtraData &slot) {
+    auto &index = this->player_index;
+    if(!index.built) return;
+
+    if(const auto it = index.per_diff.find(&slot); it != index.per_diff.end()) {
+        index.total_score -= it->second.score_sum;
+        index.top_plays.erase(it->second.best);
+        index.per_diff.erase(it);
+    }
+    if(!slot.local_scores) return;
+
+    u64 score_sum = 0;
+    const FinishedScore *best =
+        best_player_score(*slot.local_scores, index.player_name, index.include_relax_autopilot, score_sum);
+    if(!best) return;
+
+    index.total_score += score_sum;
+    const auto top_it = index.top_plays.insert(TopPlay{
+        .pp = best->get_pp(),
+        .score = best->score,
+        .unix_timestamp = best->unixTimestamp,
+        .play_time_ms = best->play_time_ms,
+        .player_id = best->player_id,
+        .accuracy = LiveScore::calculateAccuracy(best->num300s, best->num100s, best->num50s, best->numMisses),
+        .slot = &slot,
+    });
+    index.per_diff.emplace(&slot, PlayerScoreIndex::DiffEntry{.best = top_it, .score_sum = score_sum});
+}
+
+void Database::reindexPlayerScores(const MD5Hash &beatmapMD5Hash) {
+    if(!this->player_index.built) return;
+    if(auto *slot = this->diff_hashes.find(beatmapMD5Hash)) {
+        this->reindexPlayerScores(*slot);
     }
+}
+
+Database::PlayerPPScores Database::getPlayerPPScores(const std::string &playerName) {
+    PlayerPPScores ppScores;
+    ppScores.totalScore = 0;
+    if(this->getProgress() < 1.0f) return ppScores;
 
-    ppScores.ppScores = std::move(scores);
-    ppScores.totalScore = totalScore;
+    // exclusive, since this might have to (re)build the index
+    Sync::unique_lock lock(this->diff_hash_mtx);
+    this->ensurePlayerIndex(playerName);
+
+    // sorted by pp (reversed)
+    const auto &index = this->player_index;
+    ppScores.ppScores.reserve(index.top_plays.size());
+    for(const auto &top : index.top_plays) {
+        u64 score_sum;
+        ppScores.ppScores.push_back(best_player_score(*top.slot->local_scores, index.player_name,
+                                                      index.include_relax_autopilot, score_sum));
+    }
+    ppScores.totalScore = index.total_score;
 
     return ppScores;
 }
 
 Database::PlayerStats Database::calculatePlayerStats(const std::string &playerName) {
-    // FIXME: returning cached statistics even if we got new scores
-    // this is makes this function a "sneaky" API that might return stale stats
-    // done for performance to not tank FPS during score recalc where this is done on the main thread
-    // every frame (by UserCard::updateUserStats)
-
     // should be done by the caller but it's more complicated because the prevPlayerStats are
     // cached inside Database...
     const bool scoresChanged = this->scores_changed.load(std::memory_order_acquire);
-    const bool returnCached =
-        playerName == this->prevPlayerStats.name.utf8View() &&
-        (!scoresChanged || (!BatchDiffCalc::scores_finished() && !engine->throttledShouldRun(120)));
-    if(returnCached) {
+    if(playerName == this->prevPlayerStats.name.utf8View() && !scoresChanged) {
         return this->prevPlayerStats;
     }
 
-    const PlayerPPScores ps = this->getPlayerPPScores(playerName);
-
-    // delay caching until we actually have scores loaded
-    if(ps.ppScores.size() > 0 || this->isFinished()) {
-        this->scores_changed.store(false, std::memory_order_release);
-    }
-
     // "If n is the amount of scores giving more pp than a given score, then the score's weight is 0.95^n"
     // "Total pp = PP[1] * 0.95^0 + PP[2] * 0.95^1 + PP[3] * 0.95^2 + ... + PP[n] * 0.95^(n-1)"
     // also, total accuracy is apparently weighted the same as pp
     float pp = 0.0f;
     float acc = 0.0f;
-    for(uSz i = 0; i < ps.ppScores.size(); i++) {
-        const float weight = getWeightForIndex(ps.ppScores.size() - 1 - i);
+    uSz num_scores = 0;
+    u64 total_score = 0;
+    if(this->getProgress() >= 1.0f) {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        this->ensurePlayerIndex(playerName);
+
+        const auto &top_plays = this->player_index.top_plays;
+        num_scores = top_plays.size();
+        total_score = this->player_index.total_score;
+
+        uSz rank = 0;
+        for(auto it = top_plays.rbegin(); it != top_plays.rend() && rank < PLAYER_STATS_TOP_N; ++it, ++rank) {
+            const float weight = getWeightForIndex((int)rank);
+            pp += it->pp * weight;
+            acc += it->accuracy * weight;
+        }
+    }
 
-        pp += ps.ppScores[i]->get_pp() * weight;
-        acc += LiveScore::calculateAccuracy(ps.ppScores[i]->num300s, ps.ppScores[i]->num100s, ps.ppScores[i]->num50s,
-                                            ps.ppScores[i]->numMisses) *
-               weight;
+    // delay caching until we actually have scores loaded
+    if(num_scores > 0 || this->isFinished()) {
+        this->scores_changed.store(false, std::memory_order_release);
     }
 
     // bonus pp
     // https://osu.ppy.sh/wiki/en/Performance_points
-    if(cv::scores_bonus_pp.getBool()) pp += getBonusPPForNumScores(ps.ppScores.size());
+    if(cv::scores_bonus_pp.getBool()) pp += getBonusPPForNumScores(num_scores);
 
     // normalize accuracy
-    if(ps.ppScores.size() > 0) acc /= (20.0f * (1.0f - getWeightForIndex(ps.ppScores.size())));
+    if(num_scores > 0) acc /= (20.0f * (1.0f - getWeightForIndex(num_scores)));
 
     // fill stats
     this->prevPlayerStats.name = playerName;
     this->prevPlayerStats.pp = pp;
     this->prevPlayerStats.accuracy = acc;
 
-    if(ps.totalScore != this->prevPlayerStats.totalScore) {
-        this->prevPlayerStats.level = getLevelForScore(ps.totalScore);
+    if(total_score != this->prevPlayerStats.totalScore) {
+        this->prevPlayerStats.level = getLevelForScore(total_score);
 
         const u64 requiredScoreForCurrentLevel = getRequiredScoreForLevel(this->prevPlayerStats.level);
         const u64 requiredScoreForNextLevel = getRequiredScoreForLevel(this->prevPlayerStats.level + 1);
 
         if(requiredScoreForNextLevel > requiredScoreForCurrentLevel)
             this->prevPlayerStats.percentToNextLevel =
-                (double)(ps.totalScore - requiredScoreForCurrentLevel) /
+                (double)(total_score - requiredScoreForCurrentLevel) /
                 (double)(requiredScoreForNextLevel - requiredScoreForCurrentLevel);
     }
 
-    this->prevPlayerStats.totalScore = ps.totalScore;
+    this->prevPlayerStats.totalScore = total_score;
 
     return this->prevPlayerStats;
 }
@@ -844,13 +1236,9 @@ BeatmapDifficulty *Database::getBeatmapDifficulty(const MD5Hash &md5hash) {
         return nullptr;
     }
 
-    Sync::shared_lock lock(this->beatmap_difficulties_mtx);
-    auto it = this->beatmap_difficulties.find(md5hash);
-    if(it == this->beatmap_difficulties.end()) {
-        return nullptr;
-    } else {
-        return it->second;
-    }
+    Sync::shared_lock lock(this->diff_hash_mtx);
+    const auto *slot = this->diff_hashes.find(md5hash);
+    return slot ? slot->diff : nullptr;
 }
 
 BeatmapDifficulty *Database::getBeatmapDifficulty(i32 map_id) {
@@ -859,10 +1247,10 @@ BeatmapDifficulty *Database::getBeatmapDifficulty(i32 map_id) {
         return nullptr;
     }
 
-    Sync::shared_lock lock(this->beatmap_difficulties_mtx);
-    for(const auto &[_, diff] : this->beatmap_difficulties) {
-        if(diff->getID() == map_id) {
-            return diff;
+    Sync::shared_lock lock(this->diff_hash_mtx);
+    for(const auto &slot : this->diff_hashes) {
+        if(slot.diff && slot.diff->getID() == map_id) {
+            return slot.diff;
         }
     }
 
@@ -933,15 +1321,8 @@ void Database::scheduleLoadRaw() {
     if(!this->is_first_load) {
         std::vector<std::string> toLoad;
         for(uSz i = 0; i < this->num_beatmaps_to_load; i++) {
-            bool alreadyLoaded = false;
-            for(const auto &rawBeatmapFolder : this->raw_loaded_beatmap_folders) {
-                if(this->raw_load_beatmap_folders[i] == rawBeatmapFolder) {
-                    alreadyLoaded = true;
-                    break;
-                }
-            }
-
-            if(!alreadyLoaded) toLoad.push_back(this->raw_load_beatmap_folders[i]);
+            if(!this->raw_loaded_beatmap_folders.contains(this->raw_load_beatmap_folders[i]))
+                toLoad.push_back(this->raw_load_beatmap_folders[i]);
         }
 
         // only load differences
@@ -970,6 +1351,7 @@ void Database::scheduleLoadRaw() {
 
         this->raw_load_scheduled = true;
         this->importTimer->start();
+        this->startRawLoadTasks();
     } else
         this->loading_progress = 1.0f;
 
@@ -978,6 +1360,180 @@ void Database::scheduleLoadRaw() {
 namespace {
 constexpr i64 TICKS_PER_SECOND = 10'000'000;
 constexpr i64 UNIX_EPOCH_TICKS = 621'355'968'000'000'000;  // ticks from 0001-01-01 to 1970-01-01
+
+// neomod_maps.db layout since 20261016. Every section is an array of fixed-stride records, so the loader can index
+// the mapped file in place instead of streaming it field by field:
+//   u32 version, u32 reserved
+//   MapsDbSection, MapsDbSet[count]           each set owns the next nb_diffs entries of the diff section
+//   MapsDbSection, MapsDbDiff[count]
+//   MapsDbSection, MapsDbOverride[count]      peppy_overrides
+//   MapsDbStarSection, MapsDbStars[count]     star_ratings
+//   MapsDbSection, char[count]                string pool, MapsDbStr offsets are relative to its start
+// Records are multiples of 8 bytes so every section stays aligned. New fields go at the end of a record; readers
+// use the stored stride and zero-fill whatever an older file doesn't have.
+struct MapsDbSection {
+    u32 count;
+    u32 stride;
+};
+
+struct MapsDbStr {
+    u32 offset;
+    u32 length;
+};
+
+struct MapsDbSet {
+    i32 set_id;
+    u32 nb_diffs;
+};
+
+struct MapsDbDiff {
+    f64 slider_multiplier;
+    f64 stars_nomod;
+    i64 last_modification_time;  // unix timestamp
+    MapsDbStr osu_filename;
+    MapsDbStr title;
+    MapsDbStr title_unicode;
+    MapsDbStr artist;
+    MapsDbStr artist_unicode;
+    MapsDbStr creator;
+    MapsDbStr difficulty_name;
+    MapsDbStr source;
+    MapsDbStr tags;
+    MapsDbStr audio_filename;
+    MapsDbStr background_filename;
+    std::array<MD5Byte, 16> md5;
+    i32 id;
+    i32 length_ms;
+    f32 stack_leniency;
+    f32 ar, cs, hp, od;
+    u32 preview_time;
+    i32 min_bpm, max_bpm, most_common_bpm;
+    f32 loudness;
+    u32 ppv2_version;
+    i16 local_offset, online_offset;
+    u16 nb_circles, nb_sliders, nb_spinners;
+    u8 draw_background;
+    u8 reserved[1];
+};
+
+struct MapsDbOverride {
+    MapsDbStr background_filename;
+    std::array<MD5Byte, 16> md5;
+    f32 star_rating;
+    f32 loudness;
+    i32 min_bpm, max_bpm, avg_bpm;
+    u32 ppv2_version;
+    i16 local_offset, online_offset;
+    u8 draw_background;
+    u8 reserved[3];
+};
+
+// speeds/combos let us notice StarPrecalc layout changes without bumping the db version
+struct MapsDbStarSection {
+    u32 count;
+    u32 stride;
+    u8 speeds;
+    u8 combos;
+    u8 reserved[6];
+};
+
+struct MapsDbStars {
+    std::array<MD5Byte, 16> md5;
+    StarPrecalc::SRArray ratings;
+};
+
+static_assert(std::is_trivially_copyable_v<MapsDbDiff> && sizeof(MapsDbDiff) == 192);
+static_assert(std::is_trivially_copyable_v<MapsDbOverride> && sizeof(MapsDbOverride) == 56);
+static_assert(std::is_trivially_copyable_v<MapsDbStars> && sizeof(MapsDbStars) % 8 == 0);
+static_assert(sizeof(MapsDbSection) == 8 && sizeof(MapsDbSet) == 8 && sizeof(MapsDbStarSection) == 16);
+
+// bounds-checked cursor over a mapped neomod_maps.db; any out-of-range access clears ok and yields zeroes
+struct MapsDbImage {
+    std::span<const u8> bytes;
+    uSz pos{0};
+    bool ok{true};
+
+    template <typename T>
+    T read() {
+        T out{};
+        if(this->ok && this->bytes.size() - this->pos >= sizeof(T)) {
+            std::memcpy(&out, this->bytes.data() + this->pos, sizeof(T));
+            this->pos += sizeof(T);
+        } else {
+            this->ok = false;
+        }
+        return out;
+    }
+
+    // start of count records of stride bytes each, or nullptr if they don't fit in the file
+    const u8 *records(u32 count, u32 stride) {
+        const u64 len = (u64)count * stride;
+        if(!this->ok || (u64)(this->bytes.size() - this->pos) < len) {
+            this->ok = false;
+            return nullptr;
+        }
+        const u8 *start = this->bytes.data() + this->pos;
+        this->pos += (uSz)len;
+        return start;
+    }
+
+    template <typename T>
+    static T record(const u8 *records, uSz idx, u32 stride) {
+        T out{};
+        std::memcpy(&out, records + idx * stride, std::min<uSz>(stride, sizeof(T)));
+        return out;
+    }
+};
+
+// one osu!.db beatmap entry, decoded off the loader thread
+struct PeppyDbEntry {
+    std::unique_ptr<BeatmapDifficulty> map{nullptr};  // empty for entries we don't load (corrupt, or not osu!standard)
+    std::string subfolder;                            // groups maps without a valid set ID
+    bool needs_loudness{false};
+};
+
+// Returns the offset of each of the (up to) count beatmap entries that follow the osu!.db header.
+// Only skips over fields, so it's much cheaper than decoding them; keep in sync with the reader in loadMaps().
+std::vector<uSz> scan_peppy_db_entries(ByteBufferedFile::SpanReader &dbr, u32 version, u32 count) {
+    std::vector<uSz> offsets;
+    offsets.reserve(count);
+
+    const uSz sr_entry_size = sizeof(u8) + sizeof(u32) + sizeof(u8) + (version < 20250108 ? sizeof(f64) : sizeof(f32));
+
+    for(u32 i = 0; i < count && dbr.good(); i++) {
+        offsets.push_back(dbr.total_pos);
+
+        if(version >= 20160408 && version < 20191106) dbr.skip<u32>();  // entry size
+
+        for(int s = 0; s < 9; s++) dbr.skip_string();  // artist..audio filename, md5, .osu filename
+        dbr.skip_bytes(sizeof(u8) + sizeof(u16) * 3 + sizeof(i64));
+        dbr.skip_bytes(version < 20140609 ? sizeof(u8) * 4 : sizeof(f32) * 4);  // AR, CS, HP, OD
+        dbr.skip<f64>();                                                        // slider multiplier
+        if(version >= 20140609) {
+            for(int mode = 0; mode < 4; mode++) {
+                dbr.skip_bytes(sr_entry_size * dbr.read<u32>());
+            }
+        }
+        dbr.skip_bytes(sizeof(u32) * 3);                           // drain time, duration, preview time
+        dbr.skip_bytes(sizeof(DB_TIMINGPOINT) * dbr.read<u32>());  // timing points
+        dbr.skip_bytes(sizeof(i32) * 3 + sizeof(u8) * 4 + sizeof(u16) + sizeof(f32) + sizeof(u8));
+        dbr.skip_string();  // source
+        dbr.skip_string();  // tags
+        dbr.skip<u16>();    // online offset
+        dbr.skip_string();  // title font
+        dbr.skip_bytes(sizeof(u8) + sizeof(u64) + sizeof(u8));
+        dbr.skip_string();  // folder
+        dbr.skip_bytes(sizeof(u64) + sizeof(u8) * 5);
+        if(version < 20140609) dbr.skip<u16>();
+        dbr.skip_bytes(sizeof(u32) + sizeof(u8));
+    }
+
+    // the last entry is only usable if it was complete
+    if(!dbr.good() && !offsets.empty()) offsets.pop_back();
+
+    return offsets;
+}
+
 }  // namespace
 
 MD5Hash Database::recalcMD5(std::string osu_path) {
@@ -1010,7 +1566,23 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
     u32 nb_overrides = 0;
 
     // Load neomod map database
+    bool loaded_maps_image = false;
     {
+        ByteBufferedFile::MappedReader mapped_maps(neomod_maps_path);
+        if(mapped_maps.total_size >= sizeof(u32)) {
+            u32 version;
+            std::memcpy(&version, mapped_maps.data().data(), sizeof(u32));
+            if(version >= NEOMOD_MAPS_DB_VERSION) {
+                this->loadMapsImage(mapped_maps.data(), temp_loading_beatmapsets, nb_neomod_maps, nb_overrides);
+                this->bytes_processed += mapped_maps.total_size;
+                this->neomod_maps_loaded = true;
+                loaded_maps_image = true;
+            }
+        }
+    }
+
+    // older layouts get streamed field by field, and rewritten in the current one on the next save
+    if(!loaded_maps_image) {
         ByteBufferedFile::Reader neomod_maps(neomod_maps_path);
         if(neomod_maps.total_size > 0) {
             u32 version = neomod_maps.read<u32>();
@@ -1283,8 +1855,8 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                     diff->ppv2Version = ppv2Version;
 
                     {
-                        Sync::unique_lock lock(this->beatmap_difficulties_mtx);
-                        this->beatmap_difficulties[diff_hash] = diff.get();
+                        Sync::unique_lock lock(this->diff_hash_mtx);
+                        this->diff_hashes[diff_hash].diff = diff.get();
                     }
                     diffs->push_back(std::move(diff));
                     nb_neomod_maps++;
@@ -1302,7 +1874,7 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
 
             if(version >= 20240812) {
                 nb_overrides = neomod_maps.read<u32>();
-                Sync::unique_lock lock(this->peppy_overrides_mtx);
+                Sync::unique_lock lock(this->diff_hash_mtx);
                 for(uSz i = 0; i < nb_overrides; i++) {
                     MapOverrides over;
                     MD5Hash map_md5;
@@ -1334,7 +1906,7 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                     if(version >= 20251225) {
                         over.ppv2_version = neomod_maps.read<u32>();
                     }
-                    this->peppy_overrides[map_md5] = over;
+                    this->diff_hashes[map_md5].overrides = std::make_unique<MapOverrides>(std::move(over));
                 }
             }
 
@@ -1348,15 +1920,17 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                     (stored_speeds == StarPrecalc::SPEEDS_NUM && stored_combos == StarPrecalc::NUM_MOD_COMBOS);
 
                 if(layout_matches) {
-                    Sync::unique_lock lock(this->star_ratings_mtx);
-                    this->star_ratings.reserve(nb_star_entries);
+                    Sync::unique_lock lock(this->diff_hash_mtx);
+                    this->diff_hashes.reserve(this->diff_hashes.size() + nb_star_entries);
                     for(u32 i = 0; i < nb_star_entries; i++) {
                         MD5Hash hash;
                         (void)neomod_maps.read_hash_digest(hash);
                         auto ratings = std::make_unique<StarPrecalc::SRArray>();
                         (void)neomod_maps.read_bytes(reinterpret_cast<u8 *>(ratings->data()),
                                                      sizeof(f32) * StarPrecalc::NUM_PRECALC_RATINGS);
-                        this->star_ratings.emplace(hash, std::move(ratings));
+                        if(auto &slot = this->diff_hashes[hash]; !slot.star_ratings) {
+                            slot.star_ratings = std::move(ratings);
+                        }
                     }
                 } else {
                     // layout changed; skip stored data, recalc will be triggered
@@ -1381,8 +1955,11 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
         Hash::flat::map<std::string, std::unique_ptr<DiffContainer>> invalid_sid_folder_to_diffcont;
         uSz nb_unique_peppy_sets = 0;
 
-        ByteBufferedFile::Reader dbr(peppy_db_path);
-        u32 osu_db_version = (dbr.good() && dbr.total_size > 0) ? dbr.read<u32>() : 0;
+        // decoded straight from the mapped file: a sequential pass finds where each entry starts, then the entries
+        // are decoded in parallel chunks and grouped into sets on this thread
+        ByteBufferedFile::MappedReader mapped_db(peppy_db_path);
+        ByteBufferedFile::SpanReader dbr(mapped_db.data());
+        u32 osu_db_version = (mapped_db.good() && dbr.total_size > 0) ? dbr.read<u32>() : 0;
         bool should_read_peppy_database = osu_db_version > 0;
         if(should_read_peppy_database) {
             // read header
@@ -1405,21 +1982,21 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
         }
         if(!should_read_peppy_database) {
             debugLog("not loading {}, ver: {} size: {} err: {}", peppy_db_path, osu_db_version, dbr.total_size,
-                     dbr.error());
+                     mapped_db.error());
         }
 
         if(should_read_peppy_database) {
-            std::vector<BPMTuple> bpm_calculation_buffer;
-            std::vector<DB_TIMINGPOINT> timing_points_buffer;
-
-            for(uSz i = 0; i < this->num_beatmaps_to_load; i++) {
-                if(this->isCancelled()) break;  // cancellation point
-
-                // update progress (another thread checks if progress >= 1.f to know when we're done)
-                u32 progress_bytes = this->bytes_processed + dbr.total_pos;
-                f64 progress_float = (f64)progress_bytes / (f64)this->total_bytes;
-                this->loading_progress = std::clamp(progress_float, 0.01, 0.99);
+            const std::vector<uSz> entry_offsets =
+                scan_peppy_db_entries(dbr, osu_db_version, this->num_beatmaps_to_load);
+            if(entry_offsets.size() != this->num_beatmaps_to_load) {
+                debugLog("WARNING: osu!.db is truncated, only found {} of {} beatmaps", entry_offsets.size(),
+                         this->num_beatmaps_to_load);
+            }
 
+            // fills out.map, or leaves it empty for entries we don't load
+            const auto read_entry = [&](ByteBufferedFile::SpanReader &dbr, PeppyDbEntry &out,
+                                        std::vector<BPMTuple> &bpm_calculation_buffer,
+                                        std::vector<DB_TIMINGPOINT> &timing_points_buffer) -> void {
                 // NOTE: This is documented wrongly in many places.
                 //       This int was added in 20160408 and removed in 20191106
                 //       https://osu.ppy.sh/home/changelog/stable40/20160408.3
@@ -1444,17 +2021,14 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                 MD5Hash md5hash;
                 (void)dbr.read_hash_chars(md5hash);  // TODO: validate
 
-                logIfCV(debug_db, "Reading osu!.db beatmap {:d}/{:d} md5hash {} ...", (i + 1),
-                        this->num_beatmaps_to_load, md5hash);
-
                 bool overrides_found = false;
                 MapOverrides override_;
                 {
-                    Sync::shared_lock lock(this->peppy_overrides_mtx);
-                    auto overrides = this->peppy_overrides.find(md5hash);
-                    overrides_found = overrides != this->peppy_overrides.end();
+                    Sync::shared_lock lock(this->diff_hash_mtx);
+                    const auto *slot = this->diff_hashes.find(md5hash);
+                    overrides_found = slot && slot->overrides;
                     if(overrides_found) {
-                        override_ = overrides->second;
+                        override_ = *slot->overrides;
                     }
                 }
                 std::string dotosu_filename = dbr.read_string();
@@ -1518,9 +2092,7 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                         sizeof(u8) /*ObjType*/ + sizeof(u32) /*mods*/ + sizeof(u8) /*ObjType*/ + sr_field_size;
                     for(auto _ : {1 /*taiko*/, 2 /*ctb*/, 3 /*mania*/}) {
                         const auto num_minigame_star_ratings = dbr.read<u32>();
-                        for(u32 s = 0; s < num_minigame_star_ratings; s++) {
-                            dbr.skip_bytes(minigame_skip_bytes);
-                        }
+                        dbr.skip_bytes((uSz)minigame_skip_bytes * num_minigame_star_ratings);
                     }
                 }
 
@@ -1541,7 +2113,7 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                     timing_points_buffer.resize(nb_timing_points);
                     if(dbr.read_bytes((u8 *)timing_points_buffer.data(), sizeof(DB_TIMINGPOINT) * nb_timing_points) !=
                        sizeof(DB_TIMINGPOINT) * nb_timing_points) {
-                        debugLog("WARNING: failed to read timing points from beatmap {:d} !", (i + 1));
+                        debugLog("WARNING: failed to read timing points from beatmap {} !", md5hash);
                     } else {
                         bpm = getBPM(timing_points_buffer, bpm_calculation_buffer);
                     }
@@ -1578,21 +2150,7 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                 std::string beatmap_subfolder = dbr.read_string();
                 SString::trim_inplace(beatmap_subfolder);
 
-                /*i64 lastOnlineCheck = */ dbr.skip<u64>();
-
-                /*bool ignoreBeatmapSounds = */ dbr.skip<u8>();
-                /*bool ignoreBeatmapSkin = */ dbr.skip<u8>();
-                /*bool disableStoryboard = */ dbr.skip<u8>();
-                /*bool disableVideo = */ dbr.skip<u8>();
-                /*bool visualOverride = */ dbr.skip<u8>();
-
-                if(osu_db_version < 20140609) {
-                    // https://github.com/ppy/osu/wiki/Legacy-database-file-structure defines it as "Unknown"
-                    dbr.skip<u16>();
-                }
-
-                /*int lastEditTime = */ dbr.skip<u32>();
-                /*unsigned char maniaScrollSpeed = */ dbr.skip<u8>();
+                // (the rest of the entry is unused, and the next one is found through its scanned offset)
 
                 // skip invalid/corrupt entries
                 // the good way would be to check if the .osu file actually exists on disk, but that is slow af, ain't
@@ -1600,10 +2158,9 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                 // just exclude those
                 if(artist_name.length() < 1 && song_title.length() < 1 && creator_name.length() < 1 &&
                    diff_name.length() < 1)
-                    continue;
+                    return;
 
-                if(mode != 0) continue;
-                // we have read all the bytes from this database entry at this point
+                if(mode != 0) return;
 
                 // it can happen that nested beatmaps are stored in the
                 // database, and that osu! stores that filepath with a backslash (because windows)
@@ -1635,127 +2192,132 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
                     beatmapset_id = -1;
                 }
 
-                BeatmapDifficulty *diffp = nullptr;
-                {
-                    // fill diff with data
-                    auto map = std::make_unique<BeatmapDifficulty>(std::move(dotosu_fullpath), std::move(beatmap_dir),
-                                                                   DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY);
+                // fill diff with data
+                auto map = std::make_unique<BeatmapDifficulty>(std::move(dotosu_fullpath), std::move(beatmap_dir),
+                                                               DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY);
 
-                    map->sTitle = SString::strcpy_u(song_title);
-                    if(!SString::is_wspace_only(unicode_song_title)) {
-                        map->sTitleUnicode = SString::strcpy_u(unicode_song_title);
-                    }
-                    map->sAudioFileName = SString::strcpy_u(audio_filename);
-                    map->iLengthMS = duration;
+                map->sTitle = SString::strcpy_u(song_title);
+                if(!SString::is_wspace_only(unicode_song_title)) {
+                    map->sTitleUnicode = SString::strcpy_u(unicode_song_title);
+                }
+                map->sAudioFileName = SString::strcpy_u(audio_filename);
+                map->iLengthMS = duration;
 
-                    map->fStackLeniency = stack_leniency;
+                map->fStackLeniency = stack_leniency;
 
-                    map->sArtist = SString::strcpy_u(artist_name);
-                    if(!SString::is_wspace_only(unicode_artist_name)) {
-                        map->sArtistUnicode = SString::strcpy_u(unicode_artist_name);
+                map->sArtist = SString::strcpy_u(artist_name);
+                if(!SString::is_wspace_only(unicode_artist_name)) {
+                    map->sArtistUnicode = SString::strcpy_u(unicode_artist_name);
+                }
+                map->sCreator = SString::strcpy_u(creator_name);
+                map->sDifficultyName = SString::strcpy_u(diff_name);
+                map->sSource = SString::strcpy_u(song_source);
+                map->sTags = SString::strcpy_u(song_tags);
+                map->writeMD5(md5hash);
+                map->iID = beatmap_id;
+                map->iSetID = beatmapset_id;
+
+                map->fAR = AR;
+                map->fCS = CS;
+                map->fHP = HP;
+                map->fOD = OD;
+                map->fSliderMultiplier = slider_multiplier;
+
+                // map->sBackgroundImageFileName = "";
+
+                map->iPreviewTime = preview_time;
+                map->last_modification_time = last_modification_time;
+
+                map->iNumCircles = nb_circles;
+                map->iNumSliders = nb_sliders;
+                map->iNumSpinners = nb_spinners;
+                map->iMinBPM = bpm.min;
+                map->iMaxBPM = bpm.max;
+                map->iMostCommonBPM = bpm.most_common;
+
+                bool loudness_found = false;
+                if(overrides_found) {
+                    map->iLocalOffset = override_.local_offset;
+                    map->iOnlineOffset = override_.online_offset;
+                    map->fStarsNomod = override_.star_rating;
+                    map->ppv2Version = override_.ppv2_version;
+                    map->loudness = override_.loudness;
+                    map->draw_background = override_.draw_background;
+                    map->sBackgroundImageFileName = SString::strcpy_u(override_.background_image_filename);
+                    if(override_.loudness != 0.f) {
+                        loudness_found = true;
                     }
-                    map->sCreator = SString::strcpy_u(creator_name);
-                    map->sDifficultyName = SString::strcpy_u(diff_name);
-                    map->sSource = SString::strcpy_u(song_source);
-                    map->sTags = SString::strcpy_u(song_tags);
-                    map->writeMD5(md5hash);
-                    map->iID = beatmap_id;
-                    map->iSetID = beatmapset_id;
-
-                    map->fAR = AR;
-                    map->fCS = CS;
-                    map->fHP = HP;
-                    map->fOD = OD;
-                    map->fSliderMultiplier = slider_multiplier;
-
-                    // map->sBackgroundImageFileName = "";
-
-                    map->iPreviewTime = preview_time;
-                    map->last_modification_time = last_modification_time;
-
-                    map->iNumCircles = nb_circles;
-                    map->iNumSliders = nb_sliders;
-                    map->iNumSpinners = nb_spinners;
-                    map->iMinBPM = bpm.min;
-                    map->iMaxBPM = bpm.max;
-                    map->iMostCommonBPM = bpm.most_common;
-                    // (the diff is now fully built)
-
-                    // now, search if the current setID container (to which this diff would belong) already exists and add it there, or
-                    // if it doesn't exist then create the container
-                    if(beatmapset_id != -1) {
-                        if(const auto &existingit = sid_to_diffcont.find(beatmapset_id);
-                           existingit != sid_to_diffcont.end()) {
-                            const auto &[_, diffc] = *existingit;
-                            assert(diffc);
-                            // if a diff with a the same md5hash hasn't already been added here
-                            if(!std::ranges::contains(*diffc, md5hash, &DatabaseBeatmap::getMD5)) {
-                                diffp = map.get();
-                                diffc->push_back(std::move(map));
-                            }
-                        } else {
-                            diffp = map.get();
+                } else {
+                    if(nomod_star_rating <= 0.f) {
+                        nomod_star_rating *= -1.f;
+                    }
+
+                    map->iLocalOffset = offset_local;
+                    map->iOnlineOffset = offset_online;
+                    map->fStarsNomod = nomod_star_rating;
+                    map->draw_background = true;
+                }
+                // (the diff is now fully built)
 
-                            auto diffc = std::make_unique<DiffContainer>();
-                            diffc->push_back(std::move(map));
-                            sid_to_diffcont.emplace(beatmapset_id, std::move(diffc));
+                out.map = std::move(map);
+                out.subfolder = std::move(beatmap_subfolder);
+                out.needs_loudness = !loudness_found;
+            };
 
-                            ++nb_unique_peppy_sets;
-                        }
-                    } else {
-                        // group maps with invalid set IDs by folder
-                        if(const auto &existingit = invalid_sid_folder_to_diffcont.find(beatmap_subfolder);
-                           existingit != invalid_sid_folder_to_diffcont.end()) {
-                            const auto &[_, diffc] = *existingit;
-                            assert(diffc);
-                            // if a diff with a the same md5hash hasn't already been added here
-                            if(!std::ranges::contains(*diffc, md5hash, &DatabaseBeatmap::getMD5)) {
-                                diffp = map.get();
-                                diffc->push_back(std::move(map));
-                            }
-                        } else {
-                            diffp = map.get();
+            static constexpr uSz PEPPY_DB_CHUNK_SIZE = 1024;
+            const uSz nb_entries = entry_offsets.size();
+            const uSz nb_chunks = (nb_entries + PEPPY_DB_CHUNK_SIZE - 1) / PEPPY_DB_CHUNK_SIZE;
 
-                            auto diffc = std::make_unique<DiffContainer>();
-                            diffc->push_back(std::move(map));
-                            invalid_sid_folder_to_diffcont.emplace(beatmap_subfolder, std::move(diffc));
+            std::vector<PeppyDbEntry> entries(nb_entries);
+            std::atomic<uSz> nb_chunks_done{0};
 
-                            ++nb_unique_peppy_sets;
-                        }
-                    }
+            Async::parallel_for(nb_chunks, [&](uSz chunk) {
+                if(this->isCancelled()) return;  // cancellation point
+
+                ByteBufferedFile::SpanReader chunk_reader{mapped_db.data()};
+                std::vector<BPMTuple> bpm_calculation_buffer;
+                std::vector<DB_TIMINGPOINT> timing_points_buffer;
+
+                const uSz end = std::min(nb_entries, (chunk + 1) * PEPPY_DB_CHUNK_SIZE);
+                for(uSz i = chunk * PEPPY_DB_CHUNK_SIZE; i < end; i++) {
+                    chunk_reader.seek(entry_offsets[i]);
+                    read_entry(chunk_reader, entries[i], bpm_calculation_buffer, timing_points_buffer);
                 }
 
-                if(diffp != nullptr) {  // if we actually added it
-                    bool loudness_found = false;
-                    if(overrides_found) {
-                        diffp->iLocalOffset = override_.local_offset;
-                        diffp->iOnlineOffset = override_.online_offset;
-                        diffp->fStarsNomod = override_.star_rating;
-                        diffp->ppv2Version = override_.ppv2_version;
-                        diffp->loudness = override_.loudness;
-                        diffp->draw_background = override_.draw_background;
-                        diffp->sBackgroundImageFileName =
-                            SString::strcpy_u(override_.background_image_filename);
-                        if(override_.loudness != 0.f) {
-                            loudness_found = true;
-                        }
-                    } else {
-                        if(nomod_star_rating <= 0.f) {
-                            nomod_star_rating *= -1.f;
-                        }
+                // update progress (another thread checks if progress >= 1.f to know when we're done)
+                const uSz done = nb_chunks_done.fetch_add(1, std::memory_order_relaxed) + 1;
+                const f64 progress_float =
+                    (f64)(this->bytes_processed + dbr.total_size * done / nb_chunks) / (f64)this->total_bytes;
+                this->loading_progress = std::clamp(progress_float, 0.01, 0.99);
+            });
 
-                        diffp->iLocalOffset = offset_local;
-                        diffp->iOnlineOffset = offset_online;
-                        diffp->fStarsNomod = nomod_star_rating;
-                        diffp->draw_background = true;
-                    }
+            // now, search if the setID container (to which each diff would belong) already exists and add it there,
+            // or if it doesn't exist then create the container (in file order, so the first of duplicate diffs wins)
+            for(auto &entry : entries) {
+                if(this->isCancelled()) break;  // cancellation point
+                if(!entry.map) continue;
+
+                const MD5Hash md5hash = entry.map->getMD5();
+                const i32 beatmapset_id = entry.map->getSetID();
 
-                    if(!loudness_found) {
+                // group maps with invalid set IDs by folder
+                auto &diffc = beatmapset_id != -1 ? sid_to_diffcont[beatmapset_id]
+                                                  : invalid_sid_folder_to_diffcont[entry.subfolder];
+                if(!diffc) {
+                    diffc = std::make_unique<DiffContainer>();
+                    ++nb_unique_peppy_sets;
+                }
+
+                // if a diff with a the same md5hash hasn't already been added here
+                if(!std::ranges::contains(*diffc, md5hash, &DatabaseBeatmap::getMD5)) {
+                    BeatmapDifficulty *diffp = diffc->emplace_back(std::move(entry.map)).get();
+
+                    if(entry.needs_loudness) {
                         this->loudness_to_calc.push_back(diffp);
                     }
 
-                    Sync::unique_lock lock(this->beatmap_difficulties_mtx);
-                    this->beatmap_difficulties[md5hash] = diffp;
+                    Sync::unique_lock lock(this->diff_hash_mtx);
+                    this->diff_hashes[md5hash].diff = diffp;
                 }
 
                 nb_peppy_maps++;
@@ -1789,22 +2351,35 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
     if(!this->isCancelled()) {
         this->beatmapsets = std::move(temp_loading_beatmapsets);
 
-        // link each diff's star_ratings pointer to its entry in the star_ratings map
+        // link each diff's star_ratings pointer to its slot's stored ratings
         {
-            Sync::shared_lock sr_lock(this->star_ratings_mtx);
-            Sync::unique_lock diff_lock(this->beatmap_difficulties_mtx);
-            for(const auto &[hash, diff] : this->beatmap_difficulties) {
-                if(auto it = this->star_ratings.find(hash); it != this->star_ratings.end()) {
-                    diff->star_ratings = it->second.get();
+            Sync::unique_lock lock(this->diff_hash_mtx);
+            for(const auto &slot : this->diff_hashes) {
+                if(slot.diff && slot.star_ratings) {
+                    slot.diff->star_ratings = slot.star_ratings.get();
                 }
             }
         }
+
+        // fill the columns now that the diffs point at their stored star ratings
+        uSz num_rows = this->beatmapsets.size();
+        for(const auto &set : this->beatmapsets) {
+            num_rows += set->getDifficulties().size();
+        }
+        this->beatmap_columns.clear();
+        this->beatmap_columns.reserve(num_rows);
+        for(const auto &set : this->beatmapsets) {
+            this->beatmap_columns.addSet(set.get());
+        }
     } else {
-        Sync::unique_lock lock(this->beatmap_difficulties_mtx);
+        Sync::unique_lock lock(this->diff_hash_mtx);
 
-        this->beatmap_difficulties.clear();
+        for(auto &slot : this->diff_hashes) {
+            slot.diff = nullptr;
+        }
         this->loudness_to_calc.clear();
         this->beatmapsets.clear();
+        this->beatmap_columns.clear();
     }
 
     this->importTimer->update();
@@ -1813,6 +2388,203 @@ void Database::loadMaps(std::string_view neomod_maps_path, std::string_view pepp
     debugLog("Found {:d} overrides; {:d} maps need loudness recalc", nb_overrides, this->loudness_to_calc.size());
 }
 
+void Database::loadMapsImage(std::span<const u8> image, std::vector<std::unique_ptr<BeatmapSet>> &sets_out,
+                             u32 &nb_maps_out, u32 &nb_overrides_out) {
+    MapsDbImage img{.bytes = image};
+
+    (void)img.read<u32>();  // version
+    (void)img.read<u32>();  // reserved
+
+    const auto sets_section = img.read<MapsDbSection>();
+    const u8 *set_records = img.records(sets_section.count, sets_section.stride);
+    const auto diffs_section = img.read<MapsDbSection>();
+    const u8 *diff_records = img.records(diffs_section.count, diffs_section.stride);
+    const auto overrides_section = img.read<MapsDbSection>();
+    const u8 *override_records = img.records(overrides_section.count, overrides_section.stride);
+    const auto stars_section = img.read<MapsDbStarSection>();
+    const u8 *star_records = img.records(stars_section.count, stars_section.stride);
+    const auto strings_section = img.read<MapsDbSection>();
+    const u8 *strings = img.records(strings_section.count, 1);
+
+    if(!img.ok || sets_section.stride == 0 || diffs_section.stride == 0 || overrides_section.stride == 0) {
+        debugLog("ignoring corrupt maps database ({} bytes)", image.size());
+        return;
+    }
+
+    const std::string_view pool{reinterpret_cast<const char *>(strings), strings_section.count};
+    const auto str = [pool](MapsDbStr ref) -> std::string_view {
+        if(ref.offset > pool.size() || ref.length > pool.size() - ref.offset) return {};
+        return pool.substr(ref.offset, ref.length);
+    };
+    // same as ByteBufferedFile::Reader::read_cstring, empty strings are still allocated
+    const auto cstr = [&str](MapsDbStr ref) -> std::unique_ptr<char[]> {
+        const std::string_view sv = str(ref);
+        auto out = std::make_unique_for_overwrite<char[]>(sv.size() + 1);
+        std::memcpy(out.get(), sv.data(), sv.size());
+        out[sv.size()] = '\0';
+        return out;
+    };
+
+    sets_out.reserve(sets_out.size() + sets_section.count);
+    {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        this->diff_hashes.reserve(this->diff_hashes.size() + diffs_section.count);
+    }
+
+    std::vector<std::pair<MD5Hash, BeatmapDifficulty *>> set_hashes;
+    u32 next_diff = 0;
+    for(u32 i = 0; i < sets_section.count; i++) {
+        if(this->isCancelled()) break;  // cancellation point
+
+        const f64 progress_float =
+            (f64)(this->bytes_processed + (u64)image.size() * i / sets_section.count) / (f64)this->total_bytes;
+        this->loading_progress = std::clamp(progress_float, 0.01, 0.99);
+
+        const auto set = MapsDbImage::record<MapsDbSet>(set_records, i, sets_section.stride);
+        if(set.nb_diffs > diffs_section.count - next_diff) {
+            debugLog("maps database set {} claims {} difficulties, only {} left", set.set_id, set.nb_diffs,
+                     diffs_section.count - next_diff);
+            break;
+        }
+        const u32 first_diff = next_diff;
+        next_diff += set.nb_diffs;
+
+        // NOTE: Ignoring mapsets with ID -1, since we most likely saved them in the correct folder,
+        //       but mistakenly set their ID to -1 (because the ID was missing from the .osu file).
+        if(set.set_id == -1 || set.nb_diffs == 0) {
+            logIfCV(debug_db, "skipped set {} with {} difficulties, load idx: {}", set.set_id, set.nb_diffs, i);
+            continue;
+        }
+
+        auto diffs = std::make_unique<DiffContainer>();
+        diffs->reserve(set.nb_diffs);
+        set_hashes.clear();
+        const std::string mapset_path = fmt::format(NEOMOD_MAPS_PATH "/{}/", set.set_id);
+
+        for(u32 j = first_diff; j < next_diff; j++) {
+            const auto rec = MapsDbImage::record<MapsDbDiff>(diff_records, j, diffs_section.stride);
+            const std::string osu_path = fmt::format("{}{}", mapset_path, str(rec.osu_filename));
+
+            MD5Hash diff_hash;
+            std::memcpy(diff_hash.data(), rec.md5.data(), rec.md5.size());
+            // force calculate hash if we saved with empty/0 hash
+            if(diff_hash.empty()) {
+                diff_hash = recalcMD5(osu_path);
+            }
+
+            auto diff = std::make_unique<BeatmapDifficulty>(osu_path, mapset_path,
+                                                            DatabaseBeatmap::BeatmapType::NEOMOD_DIFFICULTY);
+
+            diff->iID = rec.id;
+            diff->iSetID = set.set_id;
+            diff->sTitle = cstr(rec.title);
+            diff->sAudioFileName = cstr(rec.audio_filename);
+            diff->iLengthMS = rec.length_ms;
+            diff->fStackLeniency = rec.stack_leniency;
+            diff->sArtist = cstr(rec.artist);
+            diff->sCreator = cstr(rec.creator);
+            diff->sDifficultyName = cstr(rec.difficulty_name);
+            diff->sSource = cstr(rec.source);
+            diff->sTags = cstr(rec.tags);
+            diff->writeMD5(diff_hash);
+            diff->fAR = rec.ar;
+            diff->fCS = rec.cs;
+            diff->fHP = rec.hp;
+            diff->fOD = rec.od;
+            diff->fSliderMultiplier = rec.slider_multiplier;
+            diff->iPreviewTime = rec.preview_time;
+            diff->last_modification_time = rec.last_modification_time;
+            diff->iLocalOffset = rec.local_offset;
+            diff->iOnlineOffset = rec.online_offset;
+            diff->iNumCircles = rec.nb_circles;
+            diff->iNumSliders = rec.nb_sliders;
+            diff->iNumSpinners = rec.nb_spinners;
+            diff->fStarsNomod = rec.stars_nomod;
+
+            diff->iMinBPM = rec.min_bpm;
+            diff->iMaxBPM = rec.max_bpm;
+            diff->iMostCommonBPM = rec.most_common_bpm;
+
+            diff->draw_background = rec.draw_background;
+
+            if(rec.loudness == 0.f) {
+                this->loudness_to_calc.push_back(diff.get());
+            } else {
+                diff->loudness = rec.loudness;
+            }
+
+            if(const auto title_unicode = str(rec.title_unicode); !SString::is_wspace_only(title_unicode)) {
+                diff->sTitleUnicode = SString::strcpy_u(title_unicode);
+            }
+            if(const auto artist_unicode = str(rec.artist_unicode); !SString::is_wspace_only(artist_unicode)) {
+                diff->sArtistUnicode = SString::strcpy_u(artist_unicode);
+            }
+
+            diff->sBackgroundImageFileName = cstr(rec.background_filename);
+
+            diff->ppv2Version = rec.ppv2_version;
+
+            set_hashes.emplace_back(diff_hash, diff.get());
+            diffs->push_back(std::move(diff));
+            nb_maps_out++;
+        }
+
+        {
+            Sync::unique_lock lock(this->diff_hash_mtx);
+            for(const auto &[hash, diff] : set_hashes) {
+                this->diff_hashes[hash].diff = diff;
+            }
+        }
+
+        // NOTE: Don't add neomod sets to beatmapSets since they're already processed
+        sets_out.push_back(
+            std::make_unique<BeatmapSet>(std::move(diffs), DatabaseBeatmap::BeatmapType::NEOMOD_BEATMAPSET));
+    }
+
+    {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        for(u32 i = 0; i < overrides_section.count; i++) {
+            const auto rec = MapsDbImage::record<MapsDbOverride>(override_records, i, overrides_section.stride);
+
+            MD5Hash map_md5;
+            std::memcpy(map_md5.data(), rec.md5.data(), rec.md5.size());
+
+            MapOverrides over;
+            over.local_offset = rec.local_offset;
+            over.online_offset = rec.online_offset;
+            over.star_rating = rec.star_rating;
+            over.loudness = rec.loudness;
+            over.min_bpm = rec.min_bpm;
+            over.max_bpm = rec.max_bpm;
+            over.avg_bpm = rec.avg_bpm;
+            over.draw_background = rec.draw_background;
+            over.background_image_filename = str(rec.background_filename);
+            over.ppv2_version = rec.ppv2_version;
+            this->diff_hashes[map_md5].overrides = std::make_unique<MapOverrides>(std::move(over));
+        }
+        nb_overrides_out = overrides_section.count;
+    }
+
+    // star ratings are copied straight out of the mapping, no per-field decoding
+    if(stars_section.speeds == StarPrecalc::SPEEDS_NUM && stars_section.combos == StarPrecalc::NUM_MOD_COMBOS &&
+       stars_section.stride >= sizeof(MapsDbStars)) {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        for(u32 i = 0; i < stars_section.count; i++) {
+            const u8 *rec = star_records + (uSz)i * stars_section.stride;
+
+            MD5Hash hash;
+            std::memcpy(hash.data(), rec + offsetof(MapsDbStars, md5), sizeof(MapsDbStars::md5));
+            auto ratings = std::make_unique_for_overwrite<StarPrecalc::SRArray>();
+            std::memcpy(ratings->data(), rec + offsetof(MapsDbStars, ratings), sizeof(StarPrecalc::SRArray));
+            this->diff_hashes[hash].star_ratings = std::move(ratings);
+        }
+    } else if(stars_section.count > 0) {
+        // layout changed; skip stored data, recalc will be triggered
+        debugLog("star ratings layout changed (stored {}x{}, current {}x{}), skipping", stars_section.speeds,
+                 stars_section.combos, (u8)StarPrecalc::SPEEDS_NUM, (uSz)StarPrecalc::NUM_MOD_COMBOS);
+    }
+}
+
 void Database::saveMaps() {
     if(this->beatmapsets.empty() || this->isLoading() || this->isCancelled()) {
         return;
@@ -1850,114 +2622,153 @@ void Database::saveMaps() {
         }
     }
 
-    maps.write<u32>(NEOMOD_MAPS_DB_VERSION);
-
-    // Save neomod-downloaded maps
-    u32 nb_diffs_saved = 0;
-    maps.write<u32>(temp_neomod_sets.size());
-    for(BeatmapSet *beatmap : temp_neomod_sets) {
-        maps.write<i32>(beatmap->getSetID());
-        maps.write<u16>(beatmap->getDifficulties().size());
-
-        for(const auto &diff : beatmap->getDifficulties()) {
-            maps.write_string(env->getFileNameFromFilePath(diff->getFilePath()));
-            maps.write<i32>(diff->iID);
-            maps.write_string(diff->getTitle());
-            maps.write_string(diff->getAudioFileName());
-            maps.write<i32>(diff->iLengthMS);
-            maps.write<f32>(diff->fStackLeniency);
-            maps.write_string(diff->getArtist());
-            maps.write_string(diff->getCreator());
-            maps.write_string(diff->getDifficultyName());
-            maps.write_string(diff->getSource());
-            maps.write_string(diff->getTags());
-            maps.write_hash_digest(diff->getMD5());
-            maps.write<f32>(diff->fAR);
-            maps.write<f32>(diff->fCS);
-            maps.write<f32>(diff->fHP);
-            maps.write<f32>(diff->fOD);
-            maps.write<f64>(diff->fSliderMultiplier);
-            maps.write<u32>(diff->iPreviewTime);
-            maps.write<i64>(diff->last_modification_time);
-            maps.write<i16>(diff->iLocalOffset);
-            maps.write<i16>(diff->iOnlineOffset);
-            maps.write<u16>(diff->iNumCircles);
-            maps.write<u16>(diff->iNumSliders);
-            maps.write<u16>(diff->iNumSpinners);
-            maps.write<f64>(diff->fStarsNomod);
-            maps.write<i32>(diff->iMinBPM);
-            maps.write<i32>(diff->iMaxBPM);
-            maps.write<i32>(diff->iMostCommonBPM);
-            maps.write<u8>(diff->draw_background);
-            maps.write<f32>(diff->loudness.load(std::memory_order_acquire));
-            maps.write_string(diff->getTitleUnicode());
-            maps.write_string(diff->getArtistUnicode());
-            maps.write_string(diff->getBackgroundImageFileName());
-            maps.write<u32>(diff->ppv2Version);
-
-            nb_diffs_saved++;
-        }
-    }
-
     // We want to save settings we applied on peppy-imported maps
     // When calculating loudness we don't call update_overrides() for performance reasons
     {
-        Sync::unique_lock lock(this->peppy_overrides_mtx);
+        Sync::unique_lock lock(this->diff_hash_mtx);
         for(const auto &map : this->loudness_to_calc) {
             if(map->type != DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY) continue;
             if(map->loudness.load(std::memory_order_acquire) == 0.f) continue;
-            this->peppy_overrides[map->getMD5()] = map->get_overrides();
+            this->diff_hashes[map->getMD5()].overrides = std::make_unique<MapOverrides>(map->get_overrides());
         }
     }
 
-    u32 nb_overrides = 0;
-    Hash::flat::map<MD5Hash, MapOverrides> real_overrides;
+    // collected up front, since the section header carries the count
+    std::vector<std::pair<MD5Hash, MapOverrides>> real_overrides;
 
     // avoid adding overrides with empty/0/"suspicious" hashes
     {
         // only need read lock here
-        Sync::shared_lock lock(this->peppy_overrides_mtx);
-        real_overrides.reserve(this->peppy_overrides.size());
+        Sync::shared_lock lock(this->diff_hash_mtx);
+        for(const auto &slot : this->diff_hashes) {
+            if(!slot.overrides || slot.hash.is_suspicious()) continue;
+            real_overrides.emplace_back(slot.hash, *slot.overrides);
+        }
+    }
+
+    // see MapsDbSection for the layout
+    // strings go into a pool written after all records. strings repeated within a set (artist, creator, ...)
+    // are only stored once; the views point into the difficulties themselves, which outlive this function
+    std::string string_pool;
+    Hash::flat::map<std::string_view, MapsDbStr> set_strings;
+    const auto add_string = [&string_pool](std::string_view str) -> MapsDbStr {
+        const MapsDbStr ref{.offset = static_cast<u32>(string_pool.size()), .length = static_cast<u32>(str.size())};
+        string_pool.append(str);
+        return ref;
+    };
+    const auto add_set_string = [&set_strings, &add_string](std::string_view str) -> MapsDbStr {
+        if(str.empty()) return {};
+        const auto [it, newly_inserted] = set_strings.try_emplace(str);
+        if(newly_inserted) it->second = add_string(str);
+        return it->second;
+    };
+
+    u32 nb_diffs_total = 0;
+    for(BeatmapSet *beatmap : temp_neomod_sets) {
+        nb_diffs_total += beatmap->getDifficulties().size();
+    }
+
+    maps.write<u32>(NEOMOD_MAPS_DB_VERSION);
+    maps.write<u32>(0);
+
+    // Save neomod-downloaded maps
+    maps.write(MapsDbSection{.count = static_cast<u32>(temp_neomod_sets.size()), .stride = sizeof(MapsDbSet)});
+    for(BeatmapSet *beatmap : temp_neomod_sets) {
+        maps.write(MapsDbSet{.set_id = beatmap->getSetID(),
+                             .nb_diffs = static_cast<u32>(beatmap->getDifficulties().size())});
+    }
+
+    u32 nb_diffs_saved = 0;
+    maps.write(MapsDbSection{.count = nb_diffs_total, .stride = sizeof(MapsDbDiff)});
+    for(BeatmapSet *beatmap : temp_neomod_sets) {
+        set_strings.clear();
+
+        for(const auto &diff : beatmap->getDifficulties()) {
+            MapsDbDiff rec{};
+            rec.slider_multiplier = diff->fSliderMultiplier;
+            rec.stars_nomod = diff->fStarsNomod;
+            rec.last_modification_time = diff->last_modification_time;
+            rec.osu_filename = add_string(env->getFileNameFromFilePath(diff->getFilePath()));
+            rec.title = add_set_string(diff->getTitleLatin());
+            rec.title_unicode = add_set_string(diff->getTitleUnicode());
+            rec.artist = add_set_string(diff->getArtistLatin());
+            rec.artist_unicode = add_set_string(diff->getArtistUnicode());
+            rec.creator = add_set_string(diff->getCreator());
+            rec.difficulty_name = add_set_string(diff->getDifficultyName());
+            rec.source = add_set_string(diff->getSource());
+            rec.tags = add_set_string(diff->getTags());
+            rec.audio_filename = add_set_string(diff->getAudioFileName());
+            rec.background_filename = add_set_string(diff->getBackgroundImageFileName());
+            std::memcpy(rec.md5.data(), diff->getMD5().data(), rec.md5.size());
+            rec.id = diff->iID;
+            rec.length_ms = diff->iLengthMS;
+            rec.stack_leniency = diff->fStackLeniency;
+            rec.ar = diff->fAR;
+            rec.cs = diff->fCS;
+            rec.hp = diff->fHP;
+            rec.od = diff->fOD;
+            rec.preview_time = diff->iPreviewTime;
+            rec.min_bpm = diff->iMinBPM;
+            rec.max_bpm = diff->iMaxBPM;
+            rec.most_common_bpm = diff->iMostCommonBPM;
+            rec.loudness = diff->loudness.load(std::memory_order_acquire);
+            rec.ppv2_version = diff->ppv2Version;
+            rec.local_offset = diff->iLocalOffset;
+            rec.online_offset = diff->iOnlineOffset;
+            rec.nb_circles = diff->iNumCircles;
+            rec.nb_sliders = diff->iNumSliders;
+            rec.nb_spinners = diff->iNumSpinners;
+            rec.draw_background = diff->draw_background;
+            maps.write(rec);
 
-        for(const auto &it : this->peppy_overrides) {
-            if(it.first.is_suspicious()) continue;
-            real_overrides.emplace(it);
+            nb_diffs_saved++;
         }
     }
 
-    maps.write<u32>(real_overrides.size());
+    u32 nb_overrides = 0;
+    maps.write(MapsDbSection{.count = static_cast<u32>(real_overrides.size()), .stride = sizeof(MapsDbOverride)});
     for(const auto &[hash, override_] : real_overrides) {
-        maps.write_hash_digest(hash);
-        maps.write<i16>(override_.local_offset);
-        maps.write<i16>(override_.online_offset);
-        maps.write<f32>(override_.star_rating);
-        maps.write<f32>(override_.loudness);
-        maps.write<i32>(override_.min_bpm);
-        maps.write<i32>(override_.max_bpm);
-        maps.write<i32>(override_.avg_bpm);
-        maps.write<u8>(override_.draw_background);
-        maps.write_string(override_.background_image_filename);
-        maps.write<u32>(override_.ppv2_version);
+        MapsDbOverride rec{};
+        rec.background_filename = add_string(override_.background_image_filename);
+        std::memcpy(rec.md5.data(), hash.data(), rec.md5.size());
+        rec.star_rating = override_.star_rating;
+        rec.loudness = override_.loudness;
+        rec.min_bpm = override_.min_bpm;
+        rec.max_bpm = override_.max_bpm;
+        rec.avg_bpm = override_.avg_bpm;
+        rec.ppv2_version = override_.ppv2_version;
+        rec.local_offset = override_.local_offset;
+        rec.online_offset = override_.online_offset;
+        rec.draw_background = override_.draw_background;
+        maps.write(rec);
 
         nb_overrides++;
     }
 
     // star ratings section
-    // header: num_speeds, num_combos so we can detect layout changes without bumping db version
     u32 nb_star_entries = 0;
     {
-        Sync::shared_lock lock(this->star_ratings_mtx);
-        maps.write<u8>(StarPrecalc::SPEEDS_NUM);
-        maps.write<u8>(StarPrecalc::NUM_MOD_COMBOS);
-        maps.write<u32>(this->star_ratings.size());
-        for(const auto &[hash, ratings] : this->star_ratings) {
-            maps.write_hash_digest(hash);
-            maps.write_bytes(reinterpret_cast<const u8 *>(ratings->data()),
-                             sizeof(f32) * StarPrecalc::NUM_PRECALC_RATINGS);
+        Sync::shared_lock lock(this->diff_hash_mtx);
+        const auto nb_slots_with_stars = std::ranges::count_if(
+            this->diff_hashes, [](const DiffHashExtraData &slot) -> bool { return slot.star_ratings != nullptr; });
+        maps.write(MapsDbStarSection{.count = static_cast<u32>(nb_slots_with_stars),
+                                     .stride = sizeof(MapsDbStars),
+                                     .speeds = StarPrecalc::SPEEDS_NUM,
+                                     .combos = StarPrecalc::NUM_MOD_COMBOS,
+                                     .reserved = {}});
+        for(const auto &slot : this->diff_hashes) {
+            if(!slot.star_ratings) continue;
+            MapsDbStars rec;
+            std::memcpy(rec.md5.data(), slot.hash.data(), rec.md5.size());
+            rec.ratings = *slot.star_ratings;
+            maps.write(rec);
             nb_star_entries++;
         }
     }
 
+    maps.write(MapsDbSection{.count = static_cast<u32>(string_pool.size()), .stride = 1});
+    maps.write_bytes(reinterpret_cast<const u8 *>(string_pool.data()), string_pool.size());
+
     t.update();
     debugLog("Saved {:d} maps (+ {:d} overrides, {:d} star ratings) in {:f} seconds.", nb_diffs_saved, nb_overrides,
              nb_star_entries, t.getElapsedTime());
@@ -2051,6 +2862,189 @@ bool Database::importDatabase(const std::pair<DatabaseType, std::string> &db_pai
     std::unreachable();
 }
 
+namespace {
+// neomod_scores.db.journal: "NEOSJ", u32 score db version, followed by records of
+//   u8 op, u32 payload size, u64 payload hash, payload (beatmap hash digest + the same score fields as neomod_scores.db)
+// appended and fsynced per change, and folded back into neomod_scores.db by Database::compactScores().
+// Replaying is idempotent (ADD dedupes through addScoreRaw, DELETE/PP_UPDATE match on FinishedScore::operator==), so
+// a crash between rewriting neomod_scores.db and removing the journal only replays records that are already applied.
+constexpr const char *SCORE_JOURNAL_PATH = NEOMOD_DB_DIR PACKAGE_NAME "_scores.db.journal";
+constexpr uSz SCORE_JOURNAL_HEADER_SIZE = 5 + sizeof(u32);
+constexpr uSz SCORE_JOURNAL_RECORD_HEADER_SIZE = sizeof(u8) + sizeof(u32) + sizeof(u64);
+constexpr u64 SCORE_JOURNAL_COMPACT_SIZE = 8ULL * 1024 * 1024;
+
+// FNV-1a, only needs to catch torn/partial writes, and has to stay stable across versions
+u64 score_journal_hash(const u8 *data, uSz size) {
+    u64 hash = 0xcbf29ce484222325ULL;
+    for(uSz i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool sync_score_journal(FILE *file) {
+    if(fflush(file) != 0) return false;
+#if defined(MCENGINE_PLATFORM_WINDOWS)
+    return _commit(_fileno(file)) == 0;
+#elif defined(MCENGINE_PLATFORM_WASM)
+    File::flushToDisk();
+    return true;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// per-score fields, shared by neomod_scores.db (ByteBufferedFile) and its journal (Packet)
+template <Replay::GenericWriter W>
+void write_score_fields(W &w, const FinishedScore &score) {
+    Replay::Mods::pack_and_write(w, score.mods);
+    w.template write<u64>(score.score);
+    w.template write<u64>(score.spinner_bonus);
+    w.template write<u64>(score.unixTimestamp);
+    w.template write<i32>(score.player_id);
+    w.write_string(score.playerName);
+    w.template write<u8>((u8)score.grade);
+
+    w.write_string(score.client);
+    w.write_string(score.server);
+    w.template write<i64>(score.bancho_score_id);
+    w.template write<u64>(score.peppy_replay_tms);
+
+    w.template write<u16>(score.num300s);
+    w.template write<u16>(score.num100s);
+    w.template write<u16>(score.num50s);
+    w.template write<u16>(score.numGekis);
+    w.template write<u16>(score.numKatus);
+    w.template write<u16>(score.numMisses);
+    w.template write<u16>(score.comboMax);
+
+    w.template write<u32>(score.ppv2_version);
+    w.template write<f32>(score.ppv2_score);
+    w.template write<f32>(score.ppv2_total_stars);
+    w.template write<f32>(score.ppv2_aim_stars);
+    w.template write<f32>(score.ppv2_speed_stars);
+
+    w.template write<u16>(score.numSliderBreaks);
+    w.template write<f32>(score.unstableRate);
+    w.template write<f32>(score.hitErrorAvgMin);
+    w.template write<f32>(score.hitErrorAvgMax);
+    w.template write<u32>(score.maxPossibleCombo);
+    w.template write<u32>(score.numHitObjects);
+    w.template write<u32>(score.numCircles);
+}
+
+template <Replay::GenericReader R>
+void read_score_fields(R &r, FinishedScore &sc) {
+    const auto read_str = [&r](std::string &out) {
+        if constexpr(std::is_same_v<R, Packet>) {
+            out = r.read_stdstring();
+        } else {
+            r.read_string(out);
+        }
+    };
+
+    sc.mods = Replay::Mods::unpack(r);
+    sc.score = r.template read<u64>();
+    sc.spinner_bonus = r.template read<u64>();
+    sc.unixTimestamp = r.template read<u64>();
+    sc.player_id = r.template read<i32>();
+    read_str(sc.playerName);
+    sc.grade = (ScoreGrade)r.template read<u8>();
+
+    read_str(sc.client);
+    read_str(sc.server);
+    sc.bancho_score_id = r.template read<i64>();
+    sc.peppy_replay_tms = r.template read<u64>();
+
+    sc.num300s = r.template read<u16>();
+    sc.num100s = r.template read<u16>();
+    sc.num50s = r.template read<u16>();
+    sc.numGekis = r.template read<u16>();
+    sc.numKatus = r.template read<u16>();
+    sc.numMisses = r.template read<u16>();
+    sc.comboMax = r.template read<u16>();
+
+    sc.ppv2_version = r.template read<u32>();
+    sc.ppv2_score = r.template read<f32>();
+    sc.ppv2_total_stars = r.template read<f32>();
+    sc.ppv2_aim_stars = r.template read<f32>();
+    sc.ppv2_speed_stars = r.template read<f32>();
+
+    sc.numSliderBreaks = r.template read<u16>();
+    sc.unstableRate = r.template read<f32>();
+    sc.hitErrorAvgMin = r.template read<f32>();
+    sc.hitErrorAvgMax = r.template read<f32>();
+    sc.maxPossibleCombo = r.template read<u32>();
+    sc.numHitObjects = r.template read<u32>();
+    sc.numCircles = r.template read<u32>();
+}
+
+// where the scores of one scores.db beatmap are, in the file and in the decoded scores array
+struct PeppyScoresBeatmap {
+    MD5Hash hash;
+    uSz offset;
+    u32 first_score;
+    u32 nb_scores;
+};
+
+// Skips over the (up to) nb_beatmaps beatmaps that follow the scores.db header, counting their scores in nb_scores_out.
+// keep in sync with the reader in loadPeppyScores().
+std::vector<PeppyScoresBeatmap> scan_peppy_scores(ByteBufferedFile::SpanReader &dbr, u32 nb_beatmaps,
+                                                  u32 &nb_scores_out) {
+    std::vector<PeppyScoresBeatmap> beatmaps;
+    beatmaps.reserve(nb_beatmaps);
+
+    std::string md5hash_str;
+    for(u32 b = 0; b < nb_beatmaps && dbr.good(); b++) {
+        dbr.read_string(md5hash_str);
+        if(md5hash_str.length() < 32) {
+            debugLog("WARNING: Invalid score on beatmap {:d} with md5hash_str.length() = {:d}!", b,
+                     md5hash_str.length());
+            continue;
+        } else if(md5hash_str.length() > 32) {
+            debugLog("ERROR: Corrupt score database/entry detected, stopping.");
+            break;
+        }
+
+        const u32 nb_scores = dbr.read<u32>();
+        PeppyScoresBeatmap beatmap{.hash = MD5Hash{md5hash_str.c_str()},
+                                   .offset = dbr.total_pos,
+                                   .first_score = nb_scores_out,
+                                   .nb_scores = nb_scores};
+
+        for(u32 s = 0; s < nb_scores && dbr.good(); s++) {
+            dbr.skip<u8>();  // gamemode
+            const u32 score_version = dbr.read<u32>();
+            for(int i = 0; i < 3; i++) dbr.skip_string();  // beatmap hash, player name, replay hash
+            dbr.skip_bytes(sizeof(u16) * 6 + sizeof(i32) + sizeof(u16) + sizeof(u8));
+            const auto legacy_mods = static_cast<u32>(dbr.read<LegacyFlags>());
+            dbr.skip_string();  // hp graph
+            dbr.skip<u64>();    // timestamp
+
+            const i32 old_replay_size = dbr.read<i32>();
+            if(old_replay_size > 0) dbr.skip_bytes(old_replay_size);
+
+            if(score_version >= 20131110) {
+                dbr.skip<i64>();
+            } else if(score_version >= 20121008) {
+                dbr.skip<i32>();
+            }
+
+            if(legacy_mods & static_cast<u32>(LegacyFlags::Target)) dbr.skip<f64>();
+        }
+
+        // a beatmap is only usable if all of its scores were there
+        if(!dbr.good()) break;
+
+        beatmaps.push_back(beatmap);
+        nb_scores_out += nb_scores;
+    }
+
+    return beatmaps;
+}
+}  // namespace
+
 void Database::loadScores(std::string_view dbPath) {
     ByteBufferedFile::Reader dbr(dbPath);
     if(dbr.total_size == 0) {
@@ -2082,7 +3076,10 @@ void Database::loadScores(std::string_view dbPath) {
 
     u32 nb_beatmaps = dbr.read<u32>();
     u32 nb_scores = dbr.read<u32>();
-    this->scores.reserve(nb_beatmaps);
+    {
+        Sync::unique_lock lock(this->diff_hash_mtx);
+        this->diff_hashes.reserve(this->diff_hashes.size() + nb_beatmaps);
+    }
 
     for(u32 b = 0; b < nb_beatmaps; b++) {
         MD5Hash beatmap_hash;
@@ -2092,42 +3089,7 @@ void Database::loadScores(std::string_view dbPath) {
 
         for(u32 s = 0; s < nb_beatmap_scores; s++) {
             FinishedScore sc;
-
-            sc.mods = Replay::Mods::unpack(dbr);
-            sc.score = dbr.read<u64>();
-            sc.spinner_bonus = dbr.read<u64>();
-            sc.unixTimestamp = dbr.read<u64>();
-            sc.player_id = dbr.read<i32>();
-            dbr.read_string(sc.playerName);
-            sc.grade = (ScoreGrade)dbr.read<u8>();
-
-            dbr.read_string(sc.client);
-            dbr.read_string(sc.server);
-            sc.bancho_score_id = dbr.read<i64>();
-            sc.peppy_replay_tms = dbr.read<u64>();
-
-            sc.num300s = dbr.read<u16>();
-            sc.num100s = dbr.read<u16>();
-            sc.num50s = dbr.read<u16>();
-            sc.numGekis = dbr.read<u16>();
-            sc.numKatus = dbr.read<u16>();
-            sc.numMisses = dbr.read<u16>();
-            sc.comboMax = dbr.read<u16>();
-
-            sc.ppv2_version = dbr.read<u32>();
-            sc.ppv2_score = dbr.read<f32>();
-            sc.ppv2_total_stars = dbr.read<f32>();
-            sc.ppv2_aim_stars = dbr.read<f32>();
-            sc.ppv2_speed_stars = dbr.read<f32>();
-
-            sc.numSliderBreaks = dbr.read<u16>();
-            sc.unstableRate = dbr.read<f32>();
-            sc.hitErrorAvgMin = dbr.read<f32>();
-            sc.hitErrorAvgMax = dbr.read<f32>();
-            sc.maxPossibleCombo = dbr.read<u32>();
-            sc.numHitObjects = dbr.read<u32>();
-            sc.numCircles = dbr.read<u32>();
-
+            read_score_fields(dbr, sc);
             sc.beatmap_hash = beatmap_hash;
 
             this->addScoreRaw(sc);
@@ -2432,8 +3394,10 @@ void Database::loadOldMcNeomodScores(std::string_view dbPath) {
 }
 
 void Database::loadPeppyScores(std::string_view dbPath) {
-    ByteBufferedFile::Reader dbr(dbPath);
-    int nb_imported = 0;
+    // decoded straight from the mapped file: a sequential pass finds where each beatmap's scores start, then they are
+    // decoded in parallel chunks and merged into the database in one go
+    ByteBufferedFile::MappedReader mapped_db(dbPath);
+    ByteBufferedFile::SpanReader dbr(mapped_db.data());
 
     u32 db_version = dbr.read<u32>();
     u32 nb_beatmaps = dbr.read<u32>();
@@ -2444,98 +3408,107 @@ void Database::loadPeppyScores(std::string_view dbPath) {
 
     debugLog("osu!stable scores.db: version = {:d}, nb_beatmaps = {:d}", db_version, nb_beatmaps);
 
-    char client_str[15] = "peppy-YYYYMMDD";
-    for(u32 b = 0; b < nb_beatmaps; b++) {
-        const std::string md5hash_str = dbr.read_string();
-        if(md5hash_str.length() < 32) {
-            debugLog("WARNING: Invalid score on beatmap {:d} with md5hash_str.length() = {:d}!", b,
-                     md5hash_str.length());
-            continue;
-        } else if(md5hash_str.length() > 32) {
-            debugLog("ERROR: Corrupt score database/entry detected, stopping.");
-            break;
-        }
+    u32 nb_scores = 0;
+    const std::vector<PeppyScoresBeatmap> beatmaps = scan_peppy_scores(dbr, nb_beatmaps, nb_scores);
 
-        MD5Hash md5hash{md5hash_str.c_str()};
+    static constexpr uSz PEPPY_SCORES_CHUNK_SIZE = 256;  // beatmaps
+    const uSz nb_chunks = (beatmaps.size() + PEPPY_SCORES_CHUNK_SIZE - 1) / PEPPY_SCORES_CHUNK_SIZE;
 
-        u32 nb_scores = dbr.read<u32>();
+    // scores we don't import are left without a beatmap hash
+    std::vector<FinishedScore> scores(nb_scores);
+    std::atomic<uSz> nb_chunks_done{0};
 
-        for(u32 s = 0; s < nb_scores; s++) {
-            FinishedScore sc;
+    Async::parallel_for(nb_chunks, [&](uSz chunk) {
+        if(this->isCancelled()) return;  // cancellation point
 
-            u8 gamemode = dbr.read<u8>();
+        ByteBufferedFile::SpanReader chunk_reader{mapped_db.data()};
+        char client_str[15] = "peppy-YYYYMMDD";
 
-            u32 score_version = dbr.read<u32>();
-            snprintf(client_str, 14, "peppy-%d", score_version);
-            sc.client = client_str;
+        const uSz end = std::min(beatmaps.size(), (chunk + 1) * PEPPY_SCORES_CHUNK_SIZE);
+        for(uSz b = chunk * PEPPY_SCORES_CHUNK_SIZE; b < end; b++) {
+            const PeppyScoresBeatmap &beatmap = beatmaps[b];
+            chunk_reader.seek(beatmap.offset);
 
-            sc.server = "ppy.sh";
-            dbr.skip_string();  // beatmap hash (already have it)
-            dbr.read_string(sc.playerName);
-            dbr.skip_string();  // replay hash (unused)
+            for(u32 s = 0; s < beatmap.nb_scores; s++) {
+                FinishedScore &sc = scores[beatmap.first_score + s];
 
-            sc.num300s = dbr.read<u16>();
-            sc.num100s = dbr.read<u16>();
-            sc.num50s = dbr.read<u16>();
-            sc.numGekis = dbr.read<u16>();
-            sc.numKatus = dbr.read<u16>();
-            sc.numMisses = dbr.read<u16>();
+                u8 gamemode = chunk_reader.read<u8>();
 
-            i32 score = dbr.read<i32>();
-            sc.score = (score < 0 ? 0 : score);
+                u32 score_version = chunk_reader.read<u32>();
+                snprintf(client_str, 14, "peppy-%d", score_version);
+                sc.client = client_str;
 
-            sc.comboMax = dbr.read<u16>();
-            sc.perfect = dbr.read<u8>();
-            sc.mods = Replay::Mods::from_legacy(dbr.read<LegacyFlags>());
+                sc.server = "ppy.sh";
+                chunk_reader.skip_string();  // beatmap hash (already have it)
+                chunk_reader.read_string(sc.playerName);
+                chunk_reader.skip_string();  // replay hash (unused)
 
-            dbr.skip_string();  // hp graph
+                sc.num300s = chunk_reader.read<u16>();
+                sc.num100s = chunk_reader.read<u16>();
+                sc.num50s = chunk_reader.read<u16>();
+                sc.numGekis = chunk_reader.read<u16>();
+                sc.numKatus = chunk_reader.read<u16>();
+                sc.numMisses = chunk_reader.read<u16>();
 
-            u64 full_tms = dbr.read<u64>();
-            sc.unixTimestamp = (full_tms - UNIX_EPOCH_TICKS) / TICKS_PER_SECOND;
-            sc.peppy_replay_tms = full_tms - 504911232000000000;
+                i32 score = chunk_reader.read<i32>();
+                sc.score = (score < 0 ? 0 : score);
 
-            // Always -1, but let's skip it properly just in case
-            i32 old_replay_size = dbr.read<i32>();
-            if(old_replay_size > 0) {
-                dbr.skip_bytes(old_replay_size);
-            }
+                sc.comboMax = chunk_reader.read<u16>();
+                sc.perfect = chunk_reader.read<u8>();
+                sc.mods = Replay::Mods::from_legacy(chunk_reader.read<LegacyFlags>());
 
-            if(score_version >= 20131110) {
-                sc.bancho_score_id = dbr.read<i64>();
-            } else if(score_version >= 20121008) {
-                sc.bancho_score_id = dbr.read<i32>();
-            } else {
-                sc.bancho_score_id = 0;
-            }
+                chunk_reader.skip_string();  // hp graph
 
-            if(sc.mods.has(ModFlags::Target)) {
-                dbr.skip<f64>();  // total accuracy
-            }
+                u64 full_tms = chunk_reader.read<u64>();
+                sc.unixTimestamp = (full_tms - UNIX_EPOCH_TICKS) / TICKS_PER_SECOND;
+                sc.peppy_replay_tms = full_tms - 504911232000000000;
 
-            if(gamemode == 0 && sc.bancho_score_id != 0) {
-                sc.beatmap_hash = md5hash;
-                sc.grade = sc.calculate_grade();
+                // Always -1, but let's skip it properly just in case
+                i32 old_replay_size = chunk_reader.read<i32>();
+                if(old_replay_size > 0) {
+                    chunk_reader.skip_bytes(old_replay_size);
+                }
 
-                if(this->addScoreRaw(sc)) {
-                    nb_imported++;
+                if(score_version >= 20131110) {
+                    sc.bancho_score_id = chunk_reader.read<i64>();
+                } else if(score_version >= 20121008) {
+                    sc.bancho_score_id = chunk_reader.read<i32>();
+                } else {
+                    sc.bancho_score_id = 0;
+                }
+
+                if(sc.mods.has(ModFlags::Target)) {
+                    chunk_reader.skip<f64>();  // total accuracy
+                }
+
+                if(gamemode == 0 && sc.bancho_score_id != 0) {
+                    sc.beatmap_hash = beatmap.hash;
+                    sc.grade = sc.calculate_grade();
                 }
             }
         }
 
-        u32 progress_bytes = this->bytes_processed + dbr.total_pos;
-        f64 progress_float = (f64)progress_bytes / (f64)this->total_bytes;
+        const uSz done = nb_chunks_done.fetch_add(1, std::memory_order_relaxed) + 1;
+        const f64 progress_float =
+            (f64)(this->bytes_processed + dbr.total_size * done / nb_chunks) / (f64)this->total_bytes;
         this->loading_progress = std::clamp(progress_float, 0.01, 0.99);
+    });
+
+    u32 nb_imported = 0;
+    if(!this->isCancelled()) {
+        std::erase_if(scores, [](const FinishedScore &sc) { return sc.beatmap_hash.empty(); });
+        nb_imported = this->addScoresRaw(scores);
     }
 
     debugLog("Loaded {:d} osu!stable scores", nb_imported);
     this->bytes_processed += dbr.total_size;
 }
 
-void Database::saveScores() {
+bool Database::saveScores() {
     debugLog("Osu: Saving scores ...");
     if(!this->scores_loaded) {
         debugLog("Cannot save scores since they weren't loaded properly first!");
-        return;
+        return false;
     }
 
     const double startTime = Timing::getTimeReal();
@@ -2546,7 +3519,7 @@ void Database::saveScores() {
 
     if(!dbr.good()) {
         debugLog("Cannot save scores to {}: {}", neomod_scores_db, dbr.error());
-        return;
+        return false;
     }
 
     dbr.write_bytes((u8 *)"NEOSC", 5);
@@ -2555,9 +3528,9 @@ void Database::saveScores() {
     u32 nb_beatmaps = 0;
     u32 nb_scores = 0;
 
-    Sync::shared_lock lock(this->scores_mtx);  // only need read lock here
-    for(const auto &[_, scorevec] : this->scores) {
-        u32 beatmap_scores = scorevec.size();
+    Sync::shared_lock lock(this->diff_hash_mtx);  // only need read lock here
+    for(const auto &slot : this->diff_hashes) {
+        const u32 beatmap_scores = slot.local_scores ? slot.local_scores->size() : 0;
         if(beatmap_scores > 0) {
             nb_beatmaps++;
             nb_scores += beatmap_scores;
@@ -2566,14 +3539,15 @@ void Database::saveScores() {
     dbr.write<u32>(nb_beatmaps);
     dbr.write<u32>(nb_scores);
 
-    for(const auto &[hash, scorevec] : this->scores) {
-        if(scorevec.empty()) continue;
+    for(const auto &slot : this->diff_hashes) {
+        if(!slot.local_scores || slot.local_scores->empty()) continue;
         if(!dbr.good()) {
             break;
         }
+        const auto &scorevec = *slot.local_scores;
 
         // TODO: should store as digest directly, need score db version bump
-        dbr.write_hash_chars(hash);
+        dbr.write_hash_chars(slot.hash);
         dbr.write<u32>(scorevec.size());
 
         for(const auto &score : scorevec) {
@@ -2582,92 +3556,211 @@ void Database::saveScores() {
                 break;
             }
 
-            Replay::Mods::pack_and_write(dbr, score.mods);
-            dbr.write<u64>(score.score);
-            dbr.write<u64>(score.spinner_bonus);
-            dbr.write<u64>(score.unixTimestamp);
-            dbr.write<i32>(score.player_id);
-            dbr.write_string(score.playerName);
-            dbr.write<u8>((u8)score.grade);
-
-            dbr.write_string(score.client);
-            dbr.write_string(score.server);
-            dbr.write<i64>(score.bancho_score_id);
-            dbr.write<u64>(score.peppy_replay_tms);
-
-            dbr.write<u16>(score.num300s);
-            dbr.write<u16>(score.num100s);
-            dbr.write<u16>(score.num50s);
-            dbr.write<u16>(score.numGekis);
-            dbr.write<u16>(score.numKatus);
-            dbr.write<u16>(score.numMisses);
-            dbr.write<u16>(score.comboMax);
-
-            dbr.write<u32>(score.ppv2_version);
-            dbr.write<f32>(score.ppv2_score);
-            dbr.write<f32>(score.ppv2_total_stars);
-            dbr.write<f32>(score.ppv2_aim_stars);
-            dbr.write<f32>(score.ppv2_speed_stars);
-
-            dbr.write<u16>(score.numSliderBreaks);
-            dbr.write<f32>(score.unstableRate);
-            dbr.write<f32>(score.hitErrorAvgMin);
-            dbr.write<f32>(score.hitErrorAvgMax);
-            dbr.write<u32>(score.maxPossibleCombo);
-            dbr.write<u32>(score.numHitObjects);
-            dbr.write<u32>(score.numCircles);
+            write_score_fields(dbr, score);
         }
     }
 
     debugLog("Saved {:d} scores in {:f} seconds.", nb_scores, (Timing::getTimeReal() - startTime));
+    return dbr.good();
 }
 
-std::unique_ptr<BeatmapSet> Database::loadRawBeatmap(const std::string &beatmapPath, bool is_peppy) {
-    logIfCV(debug_db, "beatmap path: {:s}", beatmapPath);
+void Database::appendScoreJournal(ScoreJournalOp op, std::span<const FinishedScore> scores) {
+    if(scores.empty()) return;
 
-    // try loading all diffs
-    DatabaseBeatmap::LoadError lastError;
+    // serialize everything up front, so the file is only touched once per call (e.g. a whole BatchDiffCalc flush)
+    Packet records;
+    records.reserve(static_cast<u32>(scores.size()) * 256);
+    for(const auto &score : scores) {
+        const uSz header_pos = records.pos;
+        records.write<u8>(static_cast<u8>(op));
+        records.write<u32>(0);  // payload size, patched below
+        records.write<u64>(0);  // payload hash, patched below
 
-    auto diffs = std::make_unique<DiffContainer>();
+        const uSz payload_pos = records.pos;
+        records.write_hash_digest(score.beatmap_hash);
+        write_score_fields(records, score);
 
-    std::vector<std::string> beatmapFiles = env->getFilesInFolder(beatmapPath);
+        const u32 payload_size = records.pos - payload_pos;
+        const u64 payload_hash = score_journal_hash(&records.memory[payload_pos], payload_size);
+        std::memcpy(&records.memory[header_pos + 1], &payload_size, sizeof(payload_size));
+        std::memcpy(&records.memory[header_pos + 5], &payload_hash, sizeof(payload_hash));
+    }
 
-    for(const auto &beatmapFile : beatmapFiles) {
-        std::string ext = env->getFileExtensionFromFilePath(beatmapFile);
-        if(ext.compare("osu") != 0) continue;
+    Sync::scoped_lock lock(this->score_journal_mtx);
 
-        std::string fullFilePath = beatmapPath;
-        fullFilePath.append(beatmapFile);
+    FILE *journal = File::fopen_c(SCORE_JOURNAL_PATH, "ab");
+    if(!journal) {
+        debugLog("Cannot open {} for appending: {}", SCORE_JOURNAL_PATH, std::generic_category().message(errno));
+        free(records.memory);
+        return;
+    }
 
-        auto map = std::make_unique<BeatmapDifficulty>(fullFilePath, beatmapPath,
-                                                       is_peppy ? DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY
-                                                                : DatabaseBeatmap::BeatmapType::NEOMOD_DIFFICULTY);
-        auto res = map->loadMetadata();
-        if(!res.error.errc) {
-            diffs->push_back(std::move(map));
+    bool ok = fseek(journal, 0, SEEK_END) == 0;
+    const long existing_size = ok ? ftell(journal) : -1;
+    ok = existing_size >= 0;
+    if(ok && existing_size == 0) {
+        u8 header[SCORE_JOURNAL_HEADER_SIZE];
+        const u32 version = NEOMOD_SCORE_DB_VERSION;
+        std::memcpy(&header[0], "NEOSJ", 5);
+        std::memcpy(&header[5], &version, sizeof(version));
+        ok = fwrite(header, 1, sizeof(header), journal) == sizeof(header);
+    }
+
+    ok = ok && fwrite(records.memory, 1, records.pos, journal) == records.pos && sync_score_journal(journal);
+    const long new_size = ok ? ftell(journal) : -1;
+    fclose(journal);
+
+    if(ok && new_size > 0) {
+        this->score_journal_size = static_cast<u64>(new_size);
+        logIfCV(debug_db, "journaled {} score record(s), journal is now {} bytes", scores.size(),
+                this->score_journal_size.load(std::memory_order_relaxed));
+    } else {
+        debugLog("Failed to append {} score record(s) to {}: {}", scores.size(), SCORE_JOURNAL_PATH,
+                 std::generic_category().message(errno));
+    }
+
+    free(records.memory);
+}
+
+u32 Database::replayScoreJournal() {
+    Sync::scoped_lock lock(this->score_journal_mtx);
+    this->score_journal_size = 0;
+
+    if(File::exists(SCORE_JOURNAL_PATH) != File::FILETYPE::FILE) return 0;
+
+    u32 nb_records = 0;
+    uSz valid_size = 0;
+    uSz file_size = 0;
+    bool discard = false;
+    {
+        ByteBufferedFile::MappedReader journal(SCORE_JOURNAL_PATH);
+        if(!journal.good()) {
+            debugLog("Cannot read {}: {}", SCORE_JOURNAL_PATH, journal.error());
+            return 0;
+        }
+        file_size = journal.total_size;
+
+        // read-only, Packet never writes through memory unless asked to
+        Packet reader;
+        reader.memory = const_cast<u8 *>(journal.data().data());
+        reader.size = journal.total_size;
+
+        u8 magic[5]{};
+        reader.read_bytes(magic, sizeof(magic));
+        const u32 version = reader.read<u32>();
+        if(reader.pos > reader.size || memcmp(magic, "NEOSJ", 5) != 0 || version != NEOMOD_SCORE_DB_VERSION) {
+            debugLog("{} has an unknown header/version ({}), not replaying it", SCORE_JOURNAL_PATH, version);
+            discard = file_size > 0;
         } else {
-            lastError = res.error;
-            logIfCV(debug_db, "Couldn't loadMetadata: {}, deleting object.", res.error.error_string());
+            valid_size = reader.pos;
+
+            while(reader.pos + SCORE_JOURNAL_RECORD_HEADER_SIZE <= reader.size) {
+                const auto op = static_cast<ScoreJournalOp>(reader.read<u8>());
+                const u32 payload_size = reader.read<u32>();
+                const u64 payload_hash = reader.read<u64>();
+
+                // torn write from a crash, everything before it is intact
+                if(payload_size > reader.size - reader.pos ||
+                   score_journal_hash(&reader.memory[reader.pos], payload_size) != payload_hash) {
+                    break;
+                }
+
+                Packet payload;
+                payload.memory = &reader.memory[reader.pos];
+                payload.size = payload_size;
+                reader.pos += payload_size;
+
+                FinishedScore sc;
+                sc.beatmap_hash = payload.read_hash_digest();
+                read_score_fields(payload, sc);
+                if(payload.pos > payload.size) break;
+
+                valid_size = reader.pos;
+                nb_records++;
+
+                switch(op) {
+                    case ScoreJournalOp::ADD:
+                        this->addScoreRaw(sc);
+                        break;
+                    case ScoreJournalOp::DELETE: {
+                        Sync::unique_lock scores_lock(this->diff_hash_mtx);
+                        if(auto *slot = this->diff_hashes.find(sc.beatmap_hash); slot && slot->local_scores) {
+                            std::erase(*slot->local_scores, sc);
+                            this->reindexPlayerScores(*slot);
+                        }
+                        break;
+                    }
+                    case ScoreJournalOp::PP_UPDATE: {
+                        Sync::unique_lock scores_lock(this->diff_hash_mtx);
+                        if(auto *slot = this->diff_hashes.find(sc.beatmap_hash); slot && slot->local_scores) {
+                            auto &scorevec = *slot->local_scores;
+                            if(const auto &scoreit = std::ranges::find(scorevec, sc); scoreit != scorevec.end()) {
+                                scoreit->ppv2_version = sc.ppv2_version;
+                                scoreit->ppv2_score = sc.ppv2_score;
+                                scoreit->ppv2_total_stars = sc.ppv2_total_stars;
+                                scoreit->ppv2_aim_stars = sc.ppv2_aim_stars;
+                                scoreit->ppv2_speed_stars = sc.ppv2_speed_stars;
+                                this->reindexPlayerScores(*slot);
+                            }
+                        }
+                        break;
+                    }
+                    default:
+                        debugLog("skipping unknown score journal record type {}", static_cast<u8>(op));
+                        break;
+                }
+            }
         }
     }
 
-    std::unique_ptr<BeatmapSet> set{nullptr};
-    if(diffs && !diffs->empty()) {
-        set =
-            std::make_unique<BeatmapSet>(std::move(diffs), is_peppy ? DatabaseBeatmap::BeatmapType::PEPPY_BEATMAPSET
-                                                                    : DatabaseBeatmap::BeatmapType::NEOMOD_BEATMAPSET);
+    const auto journal_fspath = File::getFsPath(SCORE_JOURNAL_PATH);
+    std::error_code ec;
+    if(discard) {
+        // keep it around instead of silently dropping scores, but get it out of the way of new appends
+        auto backup_path = fmt::format("{}.{:%F}", SCORE_JOURNAL_PATH, fmt::gmtime(std::time(nullptr)));
+        std::filesystem::rename(journal_fspath, File::getFsPath(backup_path), ec);
+        debugLog("moved {} -> {}{}", SCORE_JOURNAL_PATH, backup_path, ec ? fmt::format(" (failed: {})", ec.message()) : "");
+        return 0;
     }
 
-    if(!set && lastError.errc) {
-        debugLog("Couldn't load beatmapset {}: {}", beatmapPath, lastError.error_string());
+    if(valid_size < file_size) {
+        // cut off the torn tail, otherwise new records would be appended after it and never replayed
+        debugLog("dropping {} trailing bytes of incomplete score journal record(s)", file_size - valid_size);
+        std::filesystem::resize_file(journal_fspath, valid_size, ec);
+    }
+    this->score_journal_size = valid_size;
+
+    debugLog("Replayed {:d} score journal record(s)", nb_records);
+    return nb_records;
+}
+
+bool Database::compactScores() {
+    // held across the rewrite, so nothing can be appended between the snapshot and removing the journal
+    Sync::scoped_lock lock(this->score_journal_mtx);
+    if(!this->saveScores()) return false;
+
+    // everything journaled so far is part of neomod_scores.db now
+    if(this->score_journal_size > 0) {
+        std::error_code ec;
+        std::filesystem::remove(File::getFsPath(SCORE_JOURNAL_PATH), ec);
+        this->score_journal_size = 0;
     }
+    return true;
+}
 
-    return set;
+void Database::compactScoresIfJournalLarge() {
+    if(this->score_journal_size.load(std::memory_order_relaxed) < SCORE_JOURNAL_COMPACT_SIZE) return;
+    this->compactScores();
+}
+
+std::unique_ptr<BeatmapSet> Database::loadRawBeatmap(const std::string &beatmapPath, bool is_peppy) {
+    RawBeatmapDiffs loaded = loadRawBeatmapDiffs(beatmapPath, is_peppy);
+    return std::move(finishRawBeatmaps({&loaded, 1}, is_peppy)[0]);
 }
 
 void Database::update_overrides(BeatmapDifficulty *diff) {
     if(!diff || diff->do_not_store || diff->type != DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY) return;
 
-    Sync::unique_lock lock(this->peppy_overrides_mtx);
-    this->peppy_overrides[diff->getMD5()] = diff->get_overrides();
+    Sync::unique_lock lock(this->diff_hash_mtx);
+    this->diff_hashes[diff->getMD5()].overrides = std::make_unique<MapOverrides>(diff->get_overrides());
 }
@@ -9,10 +9,13 @@
 #include "SyncMutex.h"
 
 #include "Hashing.h"
+#include "BeatmapColumns.h"
+#include "DiffHashTable.h"
 #include "DiffCalc/StarPrecalc.h"
 
 #include <atomic>
 #include <set>
+#include <span>
 
 namespace Timing {
 class Timer;
@@ -32,12 +35,13 @@ struct internal;
 
 class ScoreButton;
 class ConVar;
+struct FileChangeEvent;
 
 class DatabaseBeatmap;
 using BeatmapDifficulty = DatabaseBeatmap;
 using BeatmapSet = DatabaseBeatmap;
 
-#define NEOMOD_MAPS_DB_VERSION 20260202
+#define NEOMOD_MAPS_DB_VERSION 20261016
 #define NEOMOD_SCORE_DB_VERSION 20240725
 
 class Database;
@@ -53,28 +57,6 @@ struct alignas(1) DB_TIMINGPOINT {
 };
 #pragma pack(pop)
 
-using HashToScoreMap = Hash::flat::map<MD5Hash, std::vector<FinishedScore>>;
-
-// // TODO: we are redundantly storing MD5Hashes for each MD5Hash->{data} map
-// // with 150k difficulties, we are potentially redundantly storing them:
-// // 1. peppy_overrides
-// // 2. scores (local)
-// // 3. online_scores
-// // 4. star_ratings
-// // 5. beatmap_difficulties
-// // 6. inside each BeatmapDifficulty itself
-// // 150,000 diffs * 32 bytes * 6 duplications = 24MB
-// // PLUS: FinishedScore itself stores an MD5Hash of the associated beatmap inside of it! so if we have 50k scores, that's another
-// // 50,000 * 32 bytes = 1.6MB
-// //
-// struct DiffHashExtraData {
-//     BeatmapDifficulty *diff{nullptr};                                    // the BeatmapDifficulty this MD5Hash points to
-//     std::unique_ptr<std::vector<FinishedScore>> local_scores{nullptr};   // all local scores stored for this diff
-//     std::unique_ptr<std::vector<FinishedScore>> online_scores{nullptr};  // all online scores stored for this diff
-//     std::unique_ptr<StarPrecalc::SRArray> star_ratings{nullptr};         // stored star ratings
-//     std::unique_ptr<MapOverrides> overrides{nullptr};  // stored peppy_overrides (only relevant for PEPPY_DIFFICULTYs)
-// };
-
 class Database final {
     NOCOPY_NOMOVE(Database)
    public:
@@ -157,10 +139,16 @@ class Database final {
     [[nodiscard]] inline const std::vector<std::unique_ptr<BeatmapSet>> &getBeatmapSets() const {
         return this->beatmapsets;
     }
+    // numeric attributes of every loaded set/diff, for sorting without touching the DatabaseBeatmaps
+    [[nodiscard]] inline BeatmapColumns &getBeatmapColumns() { return this->beatmap_columns; }
 
-    // WARNING: Before calling getScores(), you need to lock db->scores_mtx!
-    [[nodiscard]] inline const HashToScoreMap &getScores() const { return this->scores; }
-    inline HashToScoreMap &getOnlineScores() { return this->online_scores; }
+    // WARNING: Before calling getScores() or getOnlineScores(), you need to lock db->diff_hash_mtx!
+    // both return nullptr if nothing is stored for that hash
+    [[nodiscard]] const std::vector<FinishedScore> *getScores(const MD5Hash &hash) const;
+    [[nodiscard]] std::vector<FinishedScore> *getOnlineScores(const MD5Hash &hash);
+    // these lock diff_hash_mtx themselves
+    void setOnlineScores(const MD5Hash &hash, std::vector<FinishedScore> scores);
+    void clearOnlineScores();
 
     static std::string getOsuSongsFolder();
 
@@ -169,20 +157,18 @@ class Database final {
 
     inline void addPathToImport(const std::string &dbPath) { this->extern_db_paths_to_import.push_back(dbPath); }
 
-    // locks peppy_overrides mutex and updates overrides for loaded-from-stable-db maps which will be stored in the local database
+    // locks diff_hash_mtx and updates overrides for loaded-from-stable-db maps which will be stored in the local database
     void update_overrides(BeatmapDifficulty *diff);
 
-    Sync::shared_mutex peppy_overrides_mtx;
-    Sync::shared_mutex scores_mtx;
+    // guards diff_hashes, i.e. the diff pointers, local/online scores, star ratings and overrides of every MD5.
+    // this is the only lock for all of them, so there is no ordering to get wrong between them.
+    mutable Sync::shared_mutex diff_hash_mtx;
     std::atomic<bool> scores_changed{true};
 
-    Hash::flat::map<MD5Hash, MapOverrides> peppy_overrides;
     std::vector<BeatmapDifficulty *> loudness_to_calc;
 
     bool batch_diffcalc_pending{false};
 
-    mutable Sync::shared_mutex star_ratings_mtx;
-    Hash::flat::map<MD5Hash, std::unique_ptr<StarPrecalc::SRArray>> star_ratings;
     [[nodiscard]] f32 get_star_rating(const MD5Hash &hash, ModFlags flags, f32 speed) const;
 
     // this copies neosu_maps.db and neosu_scores.db to
@@ -197,14 +183,30 @@ class Database final {
 
     void scheduleLoadRaw();
 
+    // a chunk of raw-loaded song folders, built on the background lane and integrated on the main thread
+    struct RawLoadBatch {
+        u32 generation;
+        std::vector<std::string> folders;
+        std::vector<std::unique_ptr<BeatmapSet>> sets;  // parallel to folders, nullptr if nothing could be loaded
+    };
+    void startRawLoadTasks();
+    void addRawLoadBatch(RawLoadBatch &batch);
+
+    // deduplicates the set's diffs against diff_hashes and takes ownership of it
+    BeatmapSet *addLoadedBeatmapSet(std::unique_ptr<BeatmapSet> mapset, i32 set_id_override);
+
     // for updating scores externally
     friend struct BatchDiffCalc::internal;
     friend class ScoreButton;  // HACKHACK: why are we updating database scores from a BUTTON???
     friend bool LegacyReplay::load_from_disk(FinishedScore &score, bool update_db);
-    inline HashToScoreMap &getScoresMutable() { return this->scores; }
+    // same as getScores(), but mutable
+    std::vector<FinishedScore> *getScoresMutable(const MD5Hash &hash);
+
+    // one slot per MD5 for everything we know about that difficulty, see DiffHashExtraData
+    DiffHashTable diff_hashes;
 
-    HashToScoreMap scores;
-    HashToScoreMap online_scores;
+    // one row per set and difficulty in beatmapsets
+    BeatmapColumns beatmap_columns;
 
     enum class DatabaseType : u8 {
         INVALID_DB = 0,
@@ -244,12 +246,61 @@ class Database final {
     void findDatabases();
     bool importDatabase(const std::pair<DatabaseType, std::string> &db_pair);
     void loadMaps(std::string_view neomod_maps_path, std::string_view peppy_db_path);
+    // current (mappable) neomod_maps.db layout, see MapsDbSection in Database.cpp
+    void loadMapsImage(std::span<const u8> image, std::vector<std::unique_ptr<BeatmapSet>> &sets_out,
+                       u32 &nb_maps_out, u32 &nb_overrides_out);
     void loadScores(std::string_view dbPath);
     void loadOldMcNeomodScores(std::string_view dbPath);
     void loadPeppyScores(std::string_view dbPath);
-    void saveScores();
+    bool saveScores();
+
+    // write-ahead journal for neomod_scores.db, see SCORE_JOURNAL_PATH in Database.cpp
+    enum class ScoreJournalOp : u8 { ADD = 1, DELETE = 2, PP_UPDATE = 3 };
+    void appendScoreJournal(ScoreJournalOp op, std::span<const FinishedScore> scores);
+    u32 replayScoreJournal();  // returns the number of records applied
+    bool compactScores();      // rewrite neomod_scores.db and drop the journal
+    void compactScoresIfJournalLarge();
     void sortScores(const MD5Hash &beatmapMD5Hash);
     bool addScoreRaw(const FinishedScore &score);
+    // same as calling addScoreRaw() for each score (moving from them), for database imports.
+    // returns the number of scores added or replaced
+    u32 addScoresRaw(std::span<FinishedScore> scores);
+
+    // incrementally maintained pp ranking of one player (whoever stats were last requested for), so that
+    // calculatePlayerStats() doesn't have to walk every score in the database after each change
+    struct TopPlay {
+        f64 pp;
+        u64 score;
+        u64 unix_timestamp;
+        u64 play_time_ms;
+        i32 player_id;
+        f32 accuracy;
+        DiffHashExtraData *slot;
+
+        // ascending, i.e. the reverse of sortScoreByPP
+        bool operator<(const TopPlay &other) const;
+    };
+    struct PlayerScoreIndex {
+        struct DiffEntry {
+            std::multiset<TopPlay>::iterator best;
+            u64 score_sum;  // total score of all of the player's scores on this diff
+        };
+
+        std::string player_name;
+        bool include_relax_autopilot{false};
+        bool built{false};
+        u64 total_score{0};
+        std::multiset<TopPlay> top_plays;                                // best score per diff, by pp
+        Hash::flat::map<const DiffHashExtraData *, DiffEntry> per_diff;  // keyed by slot, which never moves
+    };
+    PlayerScoreIndex player_index;
+
+    // these need diff_hash_mtx held exclusively
+    // (re)builds player_index if it was built for a different player or relax/autopilot setting
+    void ensurePlayerIndex(const std::string &playerName);
+    // call after anything in a slot's local_scores was added, removed or had its pp changed
+    void reindexPlayerScores(DiffHashExtraData &slot);
+    void reindexPlayerScores(const MD5Hash &beatmapMD5Hash);
     // returns position of existing score in the scores[hash] array if found, -1 otherwise
     // this isn't completely accurate but allows skipping importing some duplicate entries early from dbs
     int isScoreAlreadyInDB(const MD5Hash &map_hash, u64 unix_timestamp, const std::string &playerName);
@@ -258,6 +309,8 @@ class Database final {
 
     Async::CancellableHandle<void> db_load_handle;
     Async::Future<void> score_save_future;
+    Sync::mutex score_journal_mtx;
+    std::atomic<u64> score_journal_size{0};
 
     std::unique_ptr<Timing::Timer> importTimer;
     bool is_first_load{true};      // only load differences after first raw load
@@ -269,9 +322,6 @@ class Database final {
     // this vector owns all loaded beatmapsets, raw beatmapset pointers are assumed not ownable
     std::vector<std::unique_ptr<BeatmapSet>> beatmapsets;
 
-    Sync::shared_mutex beatmap_difficulties_mtx;
-    Hash::flat::map<MD5Hash, BeatmapDifficulty *> beatmap_difficulties;
-
     bool neomod_maps_loaded{false};
 
     // scores.db (legacy and custom)
@@ -287,11 +337,22 @@ class Database final {
     };
 
     std::string raw_load_osu_song_folder;
-    std::vector<std::string> raw_loaded_beatmap_folders;
+    Hash::unstable_stringset raw_loaded_beatmap_folders;
     std::vector<std::string> raw_load_beatmap_folders;
 
+    // new set folders showing up in the raw loaded songs folder are imported one by one, instead of needing a refresh
+    // (only if the platform can watch it without polling)
+    // sets that were already loaded are left alone, edited or deleted sets are picked up by a refresh
+    void onSongsFolderChange(const FileChangeEvent &ev);
+    void importChangedSongFolders();
+    std::string watched_songs_folder;                    // empty if not watching, only watched non-recursively
+    Hash::unstable_stringset watched_new_song_folders;   // set folders created since, watched until they're imported
+    Hash::unstable_stringmap<u64> changed_song_folders;  // set folder name -> time of its last change (ms)
+
     // raw load
-    u32 cur_raw_load_idx{0};
+    std::vector<Async::Future<void>> raw_load_tasks;
+    u32 raw_load_generation{0};  // bumped on cancel, so batches still queued for the main thread get dropped
+    u32 cur_raw_load_idx{0};     // number of folders integrated so far
     bool needs_raw_load{false};
     bool raw_load_scheduled{false};
     bool raw_load_is_neomod{
@@ -4,11 +4,21 @@
 
 #include "GameRules.h"
 #include "Parsing.h"
+#include "Stacking.h"
 
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
 #include <source_location>
+#include <type_traits>
 #include <utility>
 #include <cassert>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifndef BUILD_TOOLS_ONLY
 
 #include "BeatmapInterface.h"
@@ -78,6 +88,7 @@ enum {
 
 // defined here to avoid including diffcalc things in DatabaseBeatmap.h
 DatabaseBeatmap::LOAD_DIFFOBJ_RESULT::LOAD_DIFFOBJ_RESULT() = default;
+DatabaseBeatmap::LOAD_DIFFOBJ_RESULT::LOAD_DIFFOBJ_RESULT(std::pmr::memory_resource *mem) : diffobjects(mem) {}
 DatabaseBeatmap::LOAD_DIFFOBJ_RESULT::~LOAD_DIFFOBJ_RESULT() = default;
 
 DatabaseBeatmap::LOAD_DIFFOBJ_RESULT::LOAD_DIFFOBJ_RESULT(DatabaseBeatmap::LOAD_DIFFOBJ_RESULT &&) noexcept = default;
@@ -317,10 +328,15 @@ bool parse_timing_point(std::string_view curLine, DatabaseBeatmap::TIMINGPOINT &
     i32 tpUninherited;
     i32 tpKiai = 0;  // optional
 
-    if(Parsing::parse(curLine, &tpOffset, ',', &tpMSPerBeat, ',', &tpMeter, ',', &tpSampleSet, ',', &tpSampleIndex, ',',
-                      &tpVolume, ',', &tpUninherited, ',', &tpKiai) ||
-       Parsing::parse(curLine, &tpOffset, ',', &tpMSPerBeat, ',', &tpMeter, ',', &tpSampleSet, ',', &tpSampleIndex, ',',
-                      &tpVolume, ',', &tpUninherited)) {
+    // parse the common prefix once, then try the longer formats on whatever is left
+    const auto afterBeat = Parsing::parse_prefix(curLine, &tpOffset, ',', &tpMSPerBeat);
+    if(!afterBeat) return false;
+
+    const auto afterUninherited = Parsing::parse_prefix(*afterBeat, ',', &tpMeter, ',', &tpSampleSet, ',',
+                                                        &tpSampleIndex, ',', &tpVolume, ',', &tpUninherited);
+    if(afterUninherited) {
+        Parsing::parse(*afterUninherited, ',', &tpKiai);
+
         out.offset = std::round(tpOffset);
         out.msPerBeat = tpMSPerBeat;
         out.sampleSet = tpSampleSet;
@@ -331,50 +347,217 @@ bool parse_timing_point(std::string_view curLine, DatabaseBeatmap::TIMINGPOINT &
         return true;
     }
 
-    if(Parsing::parse(curLine, &tpOffset, ',', &tpMSPerBeat)) {
-        out.offset = std::round(tpOffset);
-        out.msPerBeat = tpMSPerBeat;
-        out.sampleSet = 0;
-        out.sampleIndex = 0;
-        out.volume = 100;
-        out.uninherited = true;
-        out.kiai = false;
+    out.offset = std::round(tpOffset);
+    out.msPerBeat = tpMSPerBeat;
+    out.sampleSet = 0;
+    out.sampleIndex = 0;
+    out.volume = 100;
+    out.uninherited = true;
+    out.kiai = false;
+    return true;
+}
+
+// Splits line by delim into at most N fields, returning how many were filled.
+// Tokens are identical to the first N produced by SString::split (an empty line yields one empty field),
+// but nothing is allocated and the delimiter scan runs 16 bytes at a time where SSE2 is available.
+template <uSz N>
+uSz split_fields(std::string_view line, char delim, std::array<std::string_view, N> &fields) {
+    const char *const begin = line.data();
+    const char *const end = begin + line.size();
+    const char *tokStart = begin;
+    const char *p = begin;
+    uSz n = 0;
+
+#if defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi8(delim);
+    for(; p < end; p += 16) {
+        __m128i block;
+        u32 valid = 0xFFFF;
+        if(end - p >= 16) {
+            block = _mm_loadu_si128((const __m128i *)p);
+        } else {
+            // copy the tail instead of reading past the end of the buffer (or calling memchr once per field)
+            alignas(16) char tail[16]{};
+            std::memcpy(tail, p, end - p);
+            block = _mm_load_si128((const __m128i *)tail);
+            valid = (1u << (end - p)) - 1;
+        }
+
+        u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)) & valid;
+        while(mask != 0) {
+            const char *hit = p + std::countr_zero(mask);
+            fields[n++] = std::string_view{tokStart, (uSz)(hit - tokStart)};
+            if(n == N) return n;
+            tokStart = hit + 1;
+            mask &= mask - 1;
+        }
+    }
+#else
+    while(const char *hit = (const char *)std::memchr(p, delim, end - p)) {
+        fields[n++] = std::string_view{tokStart, (uSz)(hit - tokStart)};
+        if(n == N) return n;
+        tokStart = p = hit + 1;
+    }
+#endif
+
+    fields[n++] = std::string_view{tokStart, (uSz)(end - tokStart)};
+    return n;
+}
+
+// Walks the same tokens as SString::split one at a time, for delimited lists of unbounded length
+// (lines, curve points, edge sounds) that would otherwise be materialized into a vector first.
+// A default-constructed cursor yields nothing, which stands in for an absent field.
+struct FieldCursor {
+    std::string_view rest;
+    char delim{','};
+    bool done{true};
+
+    FieldCursor() = default;
+    FieldCursor(std::string_view str, char delim) : rest(str), delim(delim), done(false) {}
+
+    bool next(std::string_view &out) {
+        if(done) return false;
+        const uSz pos = rest.find(delim);
+        if(pos == std::string_view::npos) {
+            out = rest;
+            done = true;
+        } else {
+            out = rest.substr(0, pos);
+            rest.remove_prefix(pos + 1);
+        }
         return true;
     }
+};
 
-    return false;
+// Nearly every number in a hit object line is a short plain decimal integer (even x/y/curve points, which are floats
+// in the format), so convert those directly instead of going through from_chars and its float parsing.
+// Returns false for anything else (fractions, exponents, whitespace, signs on unsigned types, overlong values) so the
+// caller can fall back to the general parser, which keeps the results identical to it.
+template <typename T>
+forceinline bool parse_plain_decimal(std::string_view str, T &out) {
+    const char *p = str.data();
+    const char *const end = p + str.size();
+
+    bool negative = false;
+    if constexpr(std::is_signed_v<T> || std::is_floating_point_v<T>) {
+        if(p != end && *p == '-') {
+            negative = true;
+            p++;
+        }
+    }
+
+    // 9 digits can't overflow an i32, longer values take the slow path
+    const uSz numDigits = end - p;
+    if(numDigits == 0 || numDigits > 9) return false;
+
+    u32 value = 0;
+    for(; p != end; p++) {
+        const u32 digit = (u32)(u8)*p - '0';
+        if(digit > 9) return false;
+        value = value * 10 + digit;
+    }
+
+    if constexpr(std::is_floating_point_v<T>) {
+        // exact for up to 2^24, and correctly rounded beyond that, same as from_chars (including "-0")
+        out = negative ? -(T)value : (T)value;
+    } else if constexpr(std::is_signed_v<T>) {
+        out = negative ? -(T)value : (T)value;
+    } else {
+        if(value > std::numeric_limits<T>::max()) return false;
+        out = (T)value;
+    }
+    return true;
+}
+
+// same result as Parsing::parse(str, &out)
+template <typename T>
+forceinline bool parse_number(std::string_view str, T &out) {
+    return parse_plain_decimal(str, out) || Parsing::parse(str, &out);
+}
+
+// same result as Parsing::strto<T>(str)
+template <typename T>
+forceinline T strto_number(std::string_view str) {
+    T value;
+    return parse_plain_decimal(str, value) ? value : Parsing::strto<T>(str);
+}
+
+// Counts the hit objects of each type in the rest of the [HitObjects] block, so that their containers get allocated
+// once instead of growing (and moving every object parsed so far) a dozen times on large maps.
+// Only reads up to the type (4th) field of each line, so it's cheap next to the actual parsing.
+void reserve_hitobjects(std::string_view block, DatabaseBeatmap::PRIMITIVE_CONTAINER &c) {
+    uSz numCircles = 0, numSliders = 0, numSpinners = 0;
+
+    FieldCursor lines(block, '\n');
+    std::string_view line;
+    while(lines.next(line)) {
+        if(line.starts_with('[')) break;  // next block
+
+        const char *p = line.data();
+        const char *const end = p + line.size();
+        for(int i = 0; i < 3 && p != nullptr; i++) {
+            p = (const char *)std::memchr(p, ',', end - p);
+            if(p != nullptr) p++;
+        }
+        if(p == nullptr) continue;
+
+        u32 type = 0;
+        for(; p != end && *p >= '0' && *p <= '9'; p++) type = type * 10 + (*p - '0');
+
+        if(type & PpyHitObjectType::CIRCLE)
+            numCircles++;
+        else if(type & PpyHitObjectType::SLIDER)
+            numSliders++;
+        else if(type & PpyHitObjectType::SPINNER)
+            numSpinners++;
+    }
+
+    c.hitcircles.reserve(c.hitcircles.size() + numCircles);
+    c.sliders.reserve(c.sliders.size() + numSliders);
+    c.spinners.reserve(c.spinners.size() + numSpinners);
 }
 
 // parse a sample set value with lenient handling, matching lazer behavior:
 // values outside 0-3 default to Normal (1)
 // see: https://github.com/ppy/osu/blob/56ef5eae1409622518fbc19872d5e3477abe90a2/osu.Game/Rulesets/Objects/Legacy/ConvertHitObjectParser.cs#L203
 forceinline u8 parse_sampleset_value(std::string_view str) {
-    i32 val = Parsing::strto<i32>(str);
+    i32 val = strto_number<i32>(str);
     return (val >= 0 && val <= 3) ? static_cast<u8>(val) : static_cast<u8>(SampleSetType::NORMAL);
 }
 
 // hitSamples are colon-separated optional components (up to 5), and not all 5 have to be specified
-void parse_hitsamples(std::vector<std::string_view> &parts, std::string_view hitSampleStr, HitSamples &samples) {
+void parse_hitsamples(std::string_view hitSampleStr, HitSamples &samples) {
     if(hitSampleStr.empty()) return;
 
-    SString::split(parts, hitSampleStr, ':');
+    // nearly every object in a map has the default samples, skip splitting and parsing them
+    if(hitSampleStr == "0:0:0:0:"sv) {
+        samples.normalSet = 0;
+        samples.additionSet = 0;
+        samples.index = 0;
+        samples.volume = 0;
+        samples.filename.clear();
+        return;
+    }
+
+    std::array<std::string_view, 5> parts;
+    const uSz numParts = split_fields(hitSampleStr, ':', parts);
 
     // Parse available components, using defaults for missing ones
-    if(parts.size() >= 1) {
+    if(numParts >= 1) {
         samples.normalSet = parse_sampleset_value(parts[0]);
     }
-    if(parts.size() >= 2) {
+    if(numParts >= 2) {
         samples.additionSet = parse_sampleset_value(parts[1]);
     }
-    if(parts.size() >= 3) {
-        samples.index = Parsing::strto<i32>(parts[2]);
+    if(numParts >= 3) {
+        samples.index = strto_number<i32>(parts[2]);
     }
-    if(parts.size() >= 4) {
+    if(numParts >= 4) {
         i32 volume{};
-        volume = Parsing::strto<i32>(parts[3]);  // for some reason this can be negative
+        volume = strto_number<i32>(parts[3]);  // for some reason this can be negative
         samples.volume = std::clamp<u8>(volume, 0, 100);
     }
-    if(parts.size() >= 5) {
+    if(numParts >= 5) {
         samples.filename = parts[4];  // filename can be empty
     }
 };
@@ -428,9 +611,6 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjects(std::
 DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromData(const std::vector<u8> &fileBuffer,
                                                                                    std::string_view osuFilePath,
                                                                                    const Sync::stop_token &dead) {
-    thread_local std::vector<std::string_view> spbuf1, spbuf2, spbuf3, spbuf4, spbuf5,
-        hitsamplebuf;  // to avoid reallocations; "spbuf" == SString::split buffer
-
     PRIMITIVE_CONTAINER c{};
 
     if(dead.stop_requested()) {
@@ -464,22 +644,28 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
 
     using enum BlockId;
 
-    for(const auto curLine : SString::split_newlines(beatmapFile)) {
+    // walk the lines in place instead of collecting them with SString::split_newlines first
+    FieldCursor lines(beatmapFile, '\n');
+    std::string_view curLine;
+    while(lines.next(curLine)) {
         if(dead.stop_requested()) {
             c.error.errc = LoadError::LOAD_INTERRUPTED;
             return c;
         }
 
+        if(curLine.ends_with('\r')) curLine.remove_suffix(1);
+
         // ignore comments, but only if at the beginning of a line (e.g. allow Artist:DJ'TEKINA//SOMETHING)
         if(curLine.empty() || SString::is_comment(curLine)) continue;
 
         // skip the for loop on the first go-around, the header has to be at the start
         if(curBlock == Sentinel) {
             curBlock = Header;
-        } else {
+        } else if(curLine[0] == '[') {
             if(auto it = std::ranges::find(blocksUnseen, curLine, &MetadataBlock::str); it != blocksUnseen.end()) {
                 curBlock = it->id;
                 blocksUnseen.erase(it);
+                if(curBlock == HitObjects) reserve_hitobjects(lines.rest, c);
             }
         }
 
@@ -585,17 +771,18 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                 // this actually should be initialized since we use it unconditionally after trying to parse it
                 u8 type = 0;
 
-                std::vector<std::string_view> &csvs = spbuf1;
-                SString::split(csvs, curLine, ',');
-
-                if(csvs.size() < 5) break;
-                upd_last_error(!Parsing::parse(csvs[0], &x) || !std::isfinite(x) || std::isnan(x));
-                upd_last_error(!Parsing::parse(csvs[1], &y) || !std::isfinite(y) || std::isnan(y));
-                upd_last_error(!Parsing::parse(csvs[2], &time));
-                upd_last_error(!Parsing::parse(csvs[3], &type));
-                upd_last_error(!Parsing::parse(csvs[4], &hitSounds));
-                upd_last_error((type & PpyHitObjectType::SLIDER) && (csvs.size() < 8));
-                upd_last_error((type & PpyHitObjectType::SPINNER) && (csvs.size() < 6));
+                // fields past the 11th (hover samples) are never looked at
+                std::array<std::string_view, 11> csvs;
+                const uSz numCsvs = split_fields(curLine, ',', csvs);
+
+                if(numCsvs < 5) break;
+                upd_last_error(!parse_number(csvs[0], x) || !std::isfinite(x) || std::isnan(x));
+                upd_last_error(!parse_number(csvs[1], y) || !std::isfinite(y) || std::isnan(y));
+                upd_last_error(!parse_number(csvs[2], time));
+                upd_last_error(!parse_number(csvs[3], type));
+                upd_last_error(!parse_number(csvs[4], hitSounds));
+                upd_last_error((type & PpyHitObjectType::SLIDER) && (numCsvs < 8));
+                upd_last_error((type & PpyHitObjectType::SPINNER) && (numCsvs < 6));
                 upd_last_error((type & PpyHitObjectType::MANIA_HOLD_NOTE));
                 if(err_line) {
                     debugLog("File: {} Invalid hit object (error on line {}): {}", osuFilePath, err_line, curLine);
@@ -628,30 +815,47 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                     h.clicked = false;
                     h.samples.hitSounds = (hitSounds & HitSoundType::VALID_HITSOUNDS);
 
-                    if(csvs.size() > 5) {
+                    if(numCsvs > 5) {
                         // ignore errors, use defaults
-                        parse_hitsamples(hitsamplebuf, csvs[5], h.samples);
+                        parse_hitsamples(csvs[5], h.samples);
                     }
 
                     c.hitcircles.push_back(std::move(h));
                 } else if(type & PpyHitObjectType::SLIDER) {
-                    SLIDER slider{};
+                    // built in place, and dropped again if the line turns out to be invalid
+                    SLIDER &slider = c.sliders.emplace_back();
                     slider.colorCounter = colorCounter;
                     slider.colorOffset = colorOffset;
                     slider.time = time;
                     slider.hoverSamples.hitSounds = (hitSounds & HitSoundType::VALID_SLIDER_HITSOUNDS);
 
-                    std::vector<std::string_view> &curves = spbuf2;
-                    SString::split(curves, csvs[5], '|');
-
-                    slider.type = curves[0][0];
-                    curves.erase(curves.begin());
-                    for(const auto &curvePoints : curves) {
+                    // special case: osu! logic for handling the hitobject point vs the controlpoints (since
+                    // sliders have both, and older beatmaps store the start point inside the control
+                    // points). the hitobject point goes in first and is dropped again below if the control points
+                    // already start with it, instead of being inserted at the front afterwards
+                    vec2 xy = vec2(std::clamp(x, -sliderSanityRange, sliderSanityRange),
+                                   std::clamp(y, -sliderSanityRange, sliderSanityRange));
+                    slider.points.reserve(std::ranges::count(csvs[5], '|') + 2);
+                    slider.points.push_back(xy);
+
+                    // first entry is the curve type, the rest are control points
+                    FieldCursor curves(csvs[5], '|');
+                    std::string_view curvePoints;
+                    curves.next(curvePoints);
+                    slider.type = curvePoints.empty() ? '\0' : curvePoints[0];
+                    while(curves.next(curvePoints)) {
                         f32 cpX{}, cpY{};
                         // just skip infinite/invalid curve points (https://osu.ppy.sh/b/1029976)
-                        const bool valid = Parsing::parse(curvePoints, &cpX, ':', &cpY) &&  //
-                                           std::isfinite(cpX) && !std::isnan(cpX) &&        //
-                                           std::isfinite(cpY) && !std::isnan(cpY);          //
+                        bool parsed = false;
+                        if(const uSz colon = curvePoints.find(':'); colon != std::string_view::npos) {
+                            parsed = parse_plain_decimal(curvePoints.substr(0, colon), cpX) &&
+                                     parse_plain_decimal(curvePoints.substr(colon + 1), cpY);
+                        }
+                        if(!parsed) parsed = Parsing::parse(curvePoints, &cpX, ':', &cpY);
+
+                        const bool valid = parsed &&                                   //
+                                           std::isfinite(cpX) && !std::isnan(cpX) &&  //
+                                           std::isfinite(cpY) && !std::isnan(cpY);    //
 
                         if(!valid) continue;
 
@@ -659,12 +863,13 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                                                    std::clamp(cpY, -sliderSanityRange, sliderSanityRange));
                     }
 
-                    upd_last_error(!Parsing::parse(csvs[6], &slider.repeat));
+                    upd_last_error(!parse_number(csvs[6], slider.repeat));
                     if(err_line) {
                         debugLog("File: {} Invalid slider: (error on line {}): {}", osuFilePath, err_line, curLine);
+                        c.sliders.pop_back();
                         break;
                     }
-                    upd_last_error(!Parsing::parse(csvs[7], &slider.pixelLength));
+                    upd_last_error(!parse_number(csvs[7], slider.pixelLength));
                     if(err_line && !csvs[7].empty()) {
                         // fix up infinite pixelLength
                         if(SString::contains_ncase(csvs[7], "e+")) {
@@ -679,47 +884,34 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                     if(err_line) {
                         debugLog("File: {} Invalid slider pixel length: {} slider.pixelLength: {}", osuFilePath,
                                  csvs[7], slider.pixelLength);
+                        c.sliders.pop_back();
                         break;
                     }
 
-                    // special case: osu! logic for handling the hitobject point vs the controlpoints (since
-                    // sliders have both, and older beatmaps store the start point inside the control
-                    // points)
-                    vec2 xy = vec2(std::clamp(x, -sliderSanityRange, sliderSanityRange),
-                                   std::clamp(y, -sliderSanityRange, sliderSanityRange));
-                    if(slider.points.size() > 0) {
-                        if(slider.points[0] != xy) slider.points.insert(slider.points.begin(), xy);
-                    } else {
-                        slider.points.push_back(xy);
-                    }
+                    if(slider.points.size() > 1 && slider.points[1] == xy) slider.points.erase(slider.points.begin());
 
                     // partially allow bullshit sliders (add second point to make valid)
                     // e.g. https://osu.ppy.sh/beatmapsets/791900#osu/1676490
                     if(slider.points.size() == 1) slider.points.push_back(xy);
 
-                    std::vector<std::string_view> &edgeSounds = spbuf3;
-                    if(csvs.size() > 8)
-                        SString::split(edgeSounds, csvs[8], '|');
-                    else
-                        edgeSounds.clear();
+                    // edge sets pair up with edge sounds by index, and may run out before them
+                    FieldCursor edgeSounds = numCsvs > 8 ? FieldCursor(csvs[8], '|') : FieldCursor();
+                    FieldCursor edgeSets = numCsvs > 9 ? FieldCursor(csvs[9], '|') : FieldCursor();
 
-                    std::vector<std::string_view> &edgeSets = spbuf4;
-                    if(csvs.size() > 9)
-                        SString::split(edgeSets, csvs[9], '|');
-                    else
-                        edgeSets.clear();
+                    slider.edgeSamples.reserve(numCsvs > 8 ? std::max<uSz>(std::ranges::count(csvs[8], '|') + 1, 2) : 2);
 
-                    for(i32 i = 0; i < edgeSounds.size(); i++) {
+                    std::string_view edgeSound, edgeSet;
+                    while(edgeSounds.next(edgeSound)) {
                         HitSamples samples;
                         // ignore parse errors, default hitSounds to 0
-                        (void)Parsing::parse(edgeSounds[i], &samples.hitSounds);
+                        (void)parse_number(edgeSound, samples.hitSounds);
                         samples.hitSounds &= HitSoundType::VALID_HITSOUNDS;
 
-                        if(!edgeSets.empty() && i < edgeSets.size()) {
-                            std::vector<std::string_view> &parts = spbuf5;
-                            SString::split(parts, edgeSets[i], ':');
-                            if(parts.size() >= 1) samples.normalSet = parse_sampleset_value(parts[0]);
-                            if(parts.size() >= 2) samples.additionSet = parse_sampleset_value(parts[1]);
+                        if(edgeSets.next(edgeSet)) {
+                            std::array<std::string_view, 2> parts;
+                            const uSz numParts = split_fields(edgeSet, ':', parts);
+                            if(numParts >= 1) samples.normalSet = parse_sampleset_value(parts[0]);
+                            if(numParts >= 2) samples.additionSet = parse_sampleset_value(parts[1]);
                         }
 
                         slider.edgeSamples.push_back(std::move(samples));
@@ -731,8 +923,8 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                     // No end sample specified, use the same as start
                     if(slider.edgeSamples.size() == 1) slider.edgeSamples.push_back(slider.edgeSamples.front());
 
-                    if(csvs.size() > 10) {
-                        parse_hitsamples(hitsamplebuf, csvs[10], slider.hoverSamples);
+                    if(numCsvs > 10) {
+                        parse_hitsamples(csvs[10], slider.hoverSamples);
                     }
 
                     slider.x = xy.x;
@@ -740,10 +932,9 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                     slider.repeat = std::clamp(slider.repeat, 0, sliderMaxRepeatRange);
                     slider.pixelLength = std::clamp(slider.pixelLength, -sliderSanityRange, sliderSanityRange);
                     slider.number = comboNumber++;
-                    c.sliders.push_back(std::move(slider));
                 } else if(type & PpyHitObjectType::SPINNER) {
                     i32 endTime{0};
-                    upd_last_error(!Parsing::parse(csvs[5], &endTime));
+                    upd_last_error(!parse_number(csvs[5], endTime));
 
                     if(err_line) {
                         debugLog("File: {} Invalid spinner (error on line {}): {}", osuFilePath, err_line, curLine);
@@ -756,8 +947,8 @@ DatabaseBeatmap::PRIMITIVE_CONTAINER DatabaseBeatmap::loadPrimitiveObjectsFromDa
                               .endTime = endTime,
                               .samples = {.hitSounds = (u8)(hitSounds & HitSoundType::VALID_HITSOUNDS)}};
 
-                    if(csvs.size() > 6) {
-                        parse_hitsamples(hitsamplebuf, csvs[6], s.samples);
+                    if(numCsvs > 6) {
+                        parse_hitsamples(csvs[6], s.samples);
                     }
 
                     c.spinners.push_back(std::move(s));
@@ -950,6 +1141,20 @@ DatabaseBeatmap::LoadError DatabaseBeatmap::calculateSliderTimesClicksTicks(
     return r;
 }
 
+void DatabaseBeatmap::calculateSliderCurves(PRIMITIVE_CONTAINER &c, const Sync::stop_token &dead) {
+    if(c.sliderCurvesCalculated || c.sliders.size() >= DifficultyHitObject::max_precalculated_curves) return;
+
+    for(auto &slider : c.sliders) {
+        if(dead.stop_requested()) return;
+
+        if(slider.curveForStarCalc == nullptr && slider.points.size() > 1) {
+            slider.curveForStarCalc = DifficultyHitObject::createCurve(slider.type, slider.points, slider.pixelLength);
+        }
+    }
+
+    c.sliderCurvesCalculated = true;
+}
+
 #ifndef BUILD_TOOLS_ONLY
 
 DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(std::string_view osuFilePath, float AR,
@@ -966,8 +1171,9 @@ DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(s
 DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(PRIMITIVE_CONTAINER &c, float AR,
                                                                                float CS, float speedMultiplier,
                                                                                bool calculateStarsInaccurately,
-                                                                               const Sync::stop_token &dead) {
-    LOAD_DIFFOBJ_RESULT result{};
+                                                                               const Sync::stop_token &dead,
+                                                                               std::pmr::memory_resource *mem) {
+    LOAD_DIFFOBJ_RESULT result{mem};
 
     // build generalized OsuDifficultyHitObjects from the vectors (hitcircles, sliders, spinners)
     // the OsuDifficultyHitObject class is the one getting used in all pp/star calculations, it encompasses every object
@@ -997,11 +1203,11 @@ DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(P
 
     for(auto &hitcircle : c.hitcircles) {
         result.diffobjects.emplace_back(DifficultyHitObject::TYPE::CIRCLE, vec2(hitcircle.x, hitcircle.y),
-                                        (i32)hitcircle.time);
+                                        (i32)hitcircle.time, mem);
     }
 
-    const bool calculateSliderCurveInConstructor =
-        (c.sliders.size() < 5000);  // NOTE: for explanation see OsuDifficultyHitObject constructor
+    // NOTE: for explanation see OsuDifficultyHitObject constructor
+    const bool calculateSliderCurveInConstructor = c.sliders.size() < DifficultyHitObject::max_precalculated_curves;
     for(const auto &slider : c.sliders) {
         if(dead.stop_requested()) {
             result.error.errc = LoadError::LOAD_INTERRUPTED;
@@ -1012,7 +1218,8 @@ DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(P
             result.diffobjects.emplace_back(
                 DifficultyHitObject::TYPE::SLIDER, vec2(slider.x, slider.y), slider.time,
                 slider.time + (i32)slider.sliderTime, slider.sliderTimeWithoutRepeats, slider.type, slider.points,
-                slider.pixelLength, slider.scoringTimesForStarCalc, slider.repeat, calculateSliderCurveInConstructor);
+                slider.pixelLength, slider.scoringTimesForStarCalc, slider.repeat, calculateSliderCurveInConstructor,
+                slider.curveForStarCalc, mem);
         } else {
             result.diffobjects.emplace_back(DifficultyHitObject::TYPE::SLIDER, vec2(slider.x, slider.y), slider.time,
                                             slider.time + (i32)slider.sliderTime, slider.sliderTimeWithoutRepeats,
@@ -1022,13 +1229,14 @@ DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(P
                                             std::vector<SLIDER_SCORING_TIME>(),  // NOTE: ignore curve when calculating
                                                                                  // inaccurately
                                             slider.repeat,
-                                            false);  // NOTE: ignore curve when calculating inaccurately
+                                            false,  // NOTE: ignore curve when calculating inaccurately
+                                            nullptr, mem);
         }
     }
 
     for(const auto &spinner : c.spinners) {
         result.diffobjects.emplace_back(DifficultyHitObject::TYPE::SPINNER, vec2(spinner.x, spinner.y),
-                                        (i32)spinner.time, (i32)spinner.endTime);
+                                        (i32)spinner.time, (i32)spinner.endTime, mem);
     }
 
     if(dead.stop_requested()) {
@@ -1056,124 +1264,37 @@ DatabaseBeatmap::LOAD_DIFFOBJ_RESULT DatabaseBeatmap::loadDifficultyHitObjects(P
     }
 
     // calculate stacks
-    // see Beatmap.cpp
+    // see Stacking.h
     // NOTE: this must be done before the speed multiplier is applied!
-    // HACKHACK: code duplication ffs
     if(STARS_STACKING && !calculateStarsInaccurately)  // NOTE: ignore stacking when calculating inaccurately
     {
         const float finalAR = AR;
         const float finalCS = CS;
         const float rawHitCircleDiameter = GameRules::getRawHitCircleDiameter(finalCS);
 
-        const float STACK_LENIENCE = 3.0f;
-
         const float approachTime = GameRules::getApproachTimeForStacking(finalAR);
 
-        if(c.version > 5) {
-            // peppy's algorithm
-            // https://gist.github.com/peppy/1167470
-
-            for(int i = result.diffobjects.size() - 1; i >= 0; i--) {
-                int n = i;
-
-                DifficultyHitObject *objectI = &result.diffobjects[i];
-
-                const bool isSpinner = (objectI->type == DifficultyHitObject::TYPE::SPINNER);
-
-                if(objectI->stack != 0 || isSpinner) continue;
-
-                const bool isHitCircle = (objectI->type == DifficultyHitObject::TYPE::CIRCLE);
-                const bool isSlider = (objectI->type == DifficultyHitObject::TYPE::SLIDER);
-
-                if(isHitCircle) {
-                    while(--n >= 0) {
-                        DifficultyHitObject *objectN = &result.diffobjects[n];
-
-                        const bool isSpinnerN = (objectN->type == DifficultyHitObject::TYPE::SPINNER);
-
-                        if(isSpinnerN) continue;
-
-                        if(objectI->time - (approachTime * c.stackLeniency) > (objectN->endTime)) break;
-
-                        vec2 objectNEndPosition = objectN->getOriginalRawPosAt(objectN->time + objectN->getDuration());
-                        if(objectN->getDuration() != 0 &&
-                           vec::length(objectNEndPosition - objectI->getOriginalRawPosAt(objectI->time)) <
-                               STACK_LENIENCE) {
-                            int offset = objectI->stack - objectN->stack + 1;
-                            for(int j = n + 1; j <= i; j++) {
-                                if(vec::length(objectNEndPosition - result.diffobjects[j].getOriginalRawPosAt(
-                                                                        result.diffobjects[j].time)) < STACK_LENIENCE)
-                                    result.diffobjects[j].stack = (result.diffobjects[j].stack - offset);
-                            }
-
-                            break;
-                        }
-
-                        if(vec::length(objectN->getOriginalRawPosAt(objectN->time) -
-                                       objectI->getOriginalRawPosAt(objectI->time)) < STACK_LENIENCE) {
-                            objectN->stack = (objectI->stack + 1);
-                            objectI = objectN;
-                        }
-                    }
-                } else if(isSlider) {
-                    while(--n >= 0) {
-                        DifficultyHitObject *objectN = &result.diffobjects[n];
-
-                        const bool isSpinner = (objectN->type == DifficultyHitObject::TYPE::SPINNER);
-
-                        if(isSpinner) continue;
-
-                        if(objectI->time - (approachTime * c.stackLeniency) > objectN->time) break;
-
-                        if(vec::length((objectN->getDuration() != 0
-                                            ? objectN->getOriginalRawPosAt(objectN->time + objectN->getDuration())
-                                            : objectN->getOriginalRawPosAt(objectN->time)) -
-                                       objectI->getOriginalRawPosAt(objectI->time)) < STACK_LENIENCE) {
-                            objectN->stack = (objectI->stack + 1);
-                            objectI = objectN;
-                        }
-                    }
-                }
-            }
-        } else  // version < 6
-        {
-            // old stacking algorithm for old beatmaps
-            // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Beatmaps/OsuBeatmapProcessor.cs
-
-            for(int i = 0; i < result.diffobjects.size(); i++) {
-                DifficultyHitObject *currHitObject = &result.diffobjects[i];
-
-                const bool isSlider = (currHitObject->type == DifficultyHitObject::TYPE::SLIDER);
-
-                if(currHitObject->stack != 0 && !isSlider) continue;
-
-                i32 startTime = currHitObject->time + currHitObject->getDuration();
-                int sliderStack = 0;
-
-                for(int j = i + 1; j < result.diffobjects.size(); j++) {
-                    DifficultyHitObject *objectJ = &result.diffobjects[j];
-
-                    if(objectJ->time - (approachTime * c.stackLeniency) > startTime) break;
-
-                    // "The start position of the hitobject, or the position at the end of the path if the hitobject is
-                    // a slider"
-                    vec2 position2 =
-                        isSlider
-                            ? currHitObject->getOriginalRawPosAt(currHitObject->time + currHitObject->getDuration())
-                            : currHitObject->getOriginalRawPosAt(currHitObject->time);
+        std::pmr::vector<Stacking::Object> stackObjects(mem);
+        stackObjects.reserve(result.diffobjects.size());
+        for(const auto &diffobject : result.diffobjects) {
+            using enum Stacking::Object::Type;
+            const bool isSlider = diffobject.type == DifficultyHitObject::TYPE::SLIDER;
+            const bool isSpinner = diffobject.type == DifficultyHitObject::TYPE::SPINNER;
+            const vec2 pos = diffobject.getOriginalRawPosAt(diffobject.time);
+            stackObjects.push_back({
+                .pos = pos,
+                .endPos = isSlider ? diffobject.getOriginalRawPosAt(diffobject.time + diffobject.getDuration()) : pos,
+                .time = diffobject.time,
+                .endTime = diffobject.endTime,
+                .duration = diffobject.getDuration(),
+                .type = isSlider ? SLIDER : (isSpinner ? SPINNER : CIRCLE),
+            });
+        }
 
-                    if(vec::length(objectJ->getOriginalRawPosAt(objectJ->time) -
-                                   currHitObject->getOriginalRawPosAt(currHitObject->time)) < 3) {
-                        currHitObject->stack++;
-                        startTime = objectJ->time + objectJ->getDuration();
-                    } else if(vec::length(objectJ->getOriginalRawPosAt(objectJ->time) - position2) < 3) {
-                        // "Case for sliders - bump notes down and right, rather than up and left."
-                        sliderStack++;
-                        objectJ->stack -= sliderStack;
-                        startTime = objectJ->time + objectJ->getDuration();
-                    }
-                }
-            }
+        std::pmr::vector<i32> stacks(stackObjects.size(), mem);
+        Stacking::calculate(stackObjects, stacks, c.version, approachTime * c.stackLeniency);
+        for(uSz i = 0; i < stacks.size(); i++) {
+            result.diffobjects[i].stack = stacks[i];
         }
 
         // update hitobject positions
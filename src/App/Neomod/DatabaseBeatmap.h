@@ -62,7 +62,9 @@ using std::stop_token;
 #include <atomic>
 #include <string_view>
 #include <memory>
+#include <memory_resource>
 #include <functional>
+#include <limits>
 
 using std::string_view_literals::operator""sv;
 
@@ -75,6 +77,7 @@ using std::string_view_literals::operator""sv;
 class AbstractBeatmapInterface;
 class HitObject;
 class DifficultyHitObject;
+class SliderCurve;
 
 class Database;
 
@@ -176,6 +179,7 @@ class DatabaseBeatmap final {
     // custom structs
     struct LOAD_DIFFOBJ_RESULT final {
         LOAD_DIFFOBJ_RESULT();
+        explicit LOAD_DIFFOBJ_RESULT(std::pmr::memory_resource *mem);
         ~LOAD_DIFFOBJ_RESULT();
 
         LOAD_DIFFOBJ_RESULT(const LOAD_DIFFOBJ_RESULT &) = delete;
@@ -184,7 +188,8 @@ class DatabaseBeatmap final {
         LOAD_DIFFOBJ_RESULT &operator=(LOAD_DIFFOBJ_RESULT &&) noexcept;
 
         // DifficultyHitObject defined in DifficultyCalculator.h
-        std::vector<DifficultyHitObject> diffobjects;
+        // (a move-assigned result keeps the target's resource, so arena-backed results should be move-constructed)
+        std::pmr::vector<DifficultyHitObject> diffobjects;
 
         u32 playableLength{0};
         u32 totalBreakDuration{0};
@@ -251,6 +256,10 @@ class DatabaseBeatmap final {
         std::vector<float> ticks;
 
         std::vector<SLIDER_SCORING_TIME> scoringTimesForStarCalc;
+
+        // unstacked star calculation curve, set by calculateSliderCurves (shared by every loadDifficultyHitObjects
+        // call on the same container)
+        std::shared_ptr<const SliderCurve> curveForStarCalc;
     };
 
     struct SPINNER final {
@@ -287,6 +296,9 @@ class DatabaseBeatmap final {
         // Set after calculateSliderTimesClicksTicks has populated slider timing data.
         // Allows reuse of the container for multiple loadDifficultyHitObjects calls.
         bool sliderTimesCalculated{false};
+
+        // Set after calculateSliderCurves has built the star calculation curve of every slider.
+        bool sliderCurvesCalculated{false};
     };
 
 #ifndef BUILD_TOOLS_ONLY  // pass data/primitives directly for tools build
@@ -298,9 +310,11 @@ class DatabaseBeatmap final {
                                                     const Sync::stop_token &dead = alwaysFalseStopPred);
 #endif
 
-    static LOAD_DIFFOBJ_RESULT loadDifficultyHitObjects(PRIMITIVE_CONTAINER &c, float AR, float CS,
-                                                        float speedMultiplier, bool calculateStarsInaccurately,
-                                                        const Sync::stop_token &dead = alwaysFalseStopPred);
+    // mem backs the returned diffobjects and their slider data, it must outlive the result
+    static LOAD_DIFFOBJ_RESULT loadDifficultyHitObjects(
+        PRIMITIVE_CONTAINER &c, float AR, float CS, float speedMultiplier, bool calculateStarsInaccurately,
+        const Sync::stop_token &dead = alwaysFalseStopPred,
+        std::pmr::memory_resource *mem = std::pmr::get_default_resource());
 
     static PRIMITIVE_CONTAINER loadPrimitiveObjectsFromData(const std::vector<u8> &fileData,
                                                             std::string_view osuFilePath,
@@ -313,6 +327,11 @@ class DatabaseBeatmap final {
                                                      float sliderMultiplier, float sliderTickRate,
                                                      const Sync::stop_token &dead);
 
+    // build the star calculation curves once, so that repeated loadDifficultyHitObjects calls (different AR/CS/speed)
+    // on the same container share them instead of each building their own.
+    // no-op for beatmaps with too many sliders to keep every curve in memory (see DifficultyHitObject).
+    static void calculateSliderCurves(PRIMITIVE_CONTAINER &c, const Sync::stop_token &dead = alwaysFalseStopPred);
+
     static TIMING_INFO getTimingInfoForTimeAndTimingPoints(
         i32 positionMS, const FixedSizeArray<DatabaseBeatmap::TIMINGPOINT> &timingpoints);
 
@@ -508,6 +527,7 @@ class DatabaseBeatmap final {
     [[nodiscard]] inline i32 getMinBPM() const { return this->iMinBPM; }
     [[nodiscard]] inline i32 getMaxBPM() const { return this->iMaxBPM; }
     [[nodiscard]] inline i32 getMostCommonBPM() const { return this->iMostCommonBPM; }
+    [[nodiscard]] inline u32 getColumnRow() const { return this->column_row; }
 
     [[nodiscard]] inline i32 getNumObjects() const {
         return this->iNumCircles + this->iNumSliders + this->iNumSpinners;
@@ -593,7 +613,7 @@ class DatabaseBeatmap final {
     // precomputed data (can-run-without-but-nice-to-have data)
     u32 ppv2Version{0};  // necessary for knowing if stars are up to date
     float fStarsNomod{0.f};
-    // points into Database::star_ratings map (stable via unique_ptr)
+    // points into this diff's slot in Database::diff_hashes (stable via unique_ptr)
     // NOTE?TODO?WARNING @spec: i just realized this is unsafe if we ever want to copy DatabaseBeatmap objects around and the star ratings map removes an entry...
     StarPrecalc::SRArray *star_ratings{nullptr};
 
@@ -625,8 +645,13 @@ class DatabaseBeatmap final {
 
     // class internal data (custom)
 
+   private:
+    // row in Database's BeatmapColumns (not copied, a copy isn't registered anywhere)
+    u32 column_row{std::numeric_limits<u32>::max()};
+
     friend class Database;
     friend class BGImageHandler;
+    friend class BeatmapColumns;
 };
 
 struct BPMInfo {
@@ -27,6 +27,13 @@ struct hitobject_cache {
     [[nodiscard]] bool matches(f32 spd, f32 ar, f32 cs) const { return speed == spd && AR == ar && CS == cs; }
 };
 
+// parsed beatmap, shared by every hitobject_cache entry of the same map
+// (so each AR/CS/speed combination doesn't re-read the file and rebuild the slider curves)
+struct primitive_cache {
+    const BeatmapDifficulty* map{nullptr};
+    std::unique_ptr<DatabaseBeatmap::PRIMITIVE_CONTAINER> primitives;
+};
+
 struct info_cache {
     // Selectors
     f32 speed{};
@@ -66,6 +73,7 @@ std::vector<std::pair<pp_calc_request, bool>> work;
 Sync::mutex cache_mtx;
 
 std::vector<std::pair<pp_calc_request, pp_res>> cache;
+primitive_cache prim_cache;
 std::vector<hitobject_cache> ho_cache;
 std::vector<info_cache> inf_cache;
 
@@ -75,6 +83,7 @@ void clear_caches() {
 
     work.clear();
     cache.clear();
+    prim_cache = {};
     ho_cache.clear();
     inf_cache.clear();
 }
@@ -144,7 +153,18 @@ void run_thread(const Sync::stop_token& stoken) {
                     .CS = rqt.CS,
                 };
 
-                new_ho.diffres = DatabaseBeatmap::loadDifficultyHitObjects(map_for_rqt->getFilePath(), rqt.AR, rqt.CS,
+                if(prim_cache.map != map_for_rqt || !prim_cache.primitives) {
+                    prim_cache.map = map_for_rqt;
+                    prim_cache.primitives = std::make_unique<DatabaseBeatmap::PRIMITIVE_CONTAINER>(
+                        DatabaseBeatmap::loadPrimitiveObjects(map_for_rqt->getFilePath(), stoken));
+                    DatabaseBeatmap::calculateSliderCurves(*prim_cache.primitives, stoken);
+                    if(stoken.stop_requested()) {
+                        prim_cache = {};  // possibly incomplete
+                        return;
+                    }
+                }
+
+                new_ho.diffres = DatabaseBeatmap::loadDifficultyHitObjects(*prim_cache.primitives, rqt.AR, rqt.CS,
                                                                            rqt.speedOverride, false, stoken);
 
                 if(stoken.stop_requested()) return;
@@ -5,9 +5,14 @@
 //   difficulty attributes are calculated once per unique parameter set
 // - Pre-calculates star ratings for 54 common mod combinations per beatmap
 //   (9 speeds x 6 mod combos: None, HR, HD, EZ, HD|HR, HD|EZ)
+// - Each parsed beatmap's star calc is split into one subtask per AR/CS variant (nomod/HR/EZ),
+//   which any idle worker can pick up, so a single long map doesn't hold up the tail of the batch
+// - Score groups keep the strain inputs of their beatmap in DiffAttrCache, so later groups (and later recalculations)
+//   with the same CS/speed only redo the strains and rating for their AR/OD/mods, without loading the beatmap
 
 #include "BatchDiffCalc.h"
 #include "StarPrecalc.h"
+#include "DiffAttrCache.h"
 
 #include "Database.h"
 #include "DatabaseBeatmap.h"
@@ -23,7 +28,9 @@
 #include "ContainerRanges.h"
 
 #include <atomic>
+#include <deque>
 #include <memory>
+#include <memory_resource>
 
 namespace cv {
 extern ConVar debug_pp;
@@ -44,20 +51,22 @@ struct ScoreResult {
 struct internal {
     static void collect_outdated_db_diffs(const Sync::stop_token& stoken, std::vector<BeatmapDifficulty*>& outdiffs);
     static void flush_score_results(std::vector<ScoreResult>& pending);
+
+    // callers must hold db->diff_hash_mtx (exclusively for slot())
+    static inline const DiffHashTable& diff_hashes() { return db->diff_hashes; }
+    static inline DiffHashExtraData& slot(const MD5Hash& hash) { return db->diff_hashes[hash]; }
 };
 
 void internal::collect_outdated_db_diffs(const Sync::stop_token& stoken, std::vector<BeatmapDifficulty*>& outdiffs) {
-    // NOTE: the order of these two locks matters to avoid lock-order-inversion, needs to match the order of other
-    // occurrences where they're both locked at the same time (like Database::loadMaps, at the end)
-    Sync::shared_lock sr_lock(db->star_ratings_mtx);
-    Sync::shared_lock readlock(db->beatmap_difficulties_mtx);
-    for(const auto& [_, diff] : db->beatmap_difficulties) {
+    Sync::shared_lock lock(db->diff_hash_mtx);
+    for(const auto& slot : db->diff_hashes) {
         if(stoken.stop_requested()) break;
+        auto* diff = slot.diff;
+        if(!diff) continue;
         // checking fStarsNomod <= 0.f might cause us to redundantly try re-calculating it, but
         // that might actually be desirable, since we might have only failed to calculate it due to a bug
         // that is now fixed
-        if(diff->ppv2Version < DiffCalc::PP_ALGORITHM_VERSION || diff->fStarsNomod <= 0.f ||
-           !db->star_ratings.contains(diff->getMD5())) {
+        if(diff->ppv2Version < DiffCalc::PP_ALGORITHM_VERSION || diff->fStarsNomod <= 0.f || !slot.star_ratings) {
             outdiffs.push_back(diff);
         }
     }
@@ -117,12 +126,39 @@ struct MapResult {
     i32 avg_bpm{};
 };
 
+// Star rating precalc state for one parsed beatmap, shared by its variant subtasks.
+// Each variant writes disjoint star_ratings indices; whoever finishes the last variant submits the result.
+struct MapJob {
+    std::shared_ptr<DatabaseBeatmap::PRIMITIVE_CONTAINER> primitives;  // read-only once published
+    MapResult result;
+    std::atomic<u8> variants_remaining{(u8)StarPrecalc::VARIANTS.size()};
+};
+
+// One AR/CS variant of a MapJob (9 speeds x [nomod, HD])
+struct VariantTask {
+    std::shared_ptr<MapJob> job;
+    u8 variant_idx;
+};
+
 // per-thread mutable state for worker threads
 struct WorkerContext {
     std::unique_ptr<std::vector<DifficultyCalculator::DiffObject>> diffobj_cache;
     std::vector<BPMTuple> bpm_calc_buf;
     std::vector<f32> base_span_durations;
     std::vector<f32> base_scoring_times;
+
+    // backs the DifficultyHitObjects (and their slider scoring times/control points) of the variant or score group
+    // currently being calculated, so that building them is a pointer bump instead of a malloc per slider.
+    // released after every variant/score group; the initial buffer is kept, only overflow blocks are freed.
+    static constexpr const uSz arena_initial_size = 4ULL * 1024 * 1024;
+    std::unique_ptr<std::byte[]> arena_buf{std::make_unique_for_overwrite<std::byte[]>(arena_initial_size)};
+    std::pmr::monotonic_buffer_resource arena{arena_buf.get(), arena_initial_size};
+};
+
+// releases the worker arena on scope exit, declare before anything allocated from it
+struct ArenaReleaser {
+    std::pmr::monotonic_buffer_resource& arena;
+    ~ArenaReleaser() { arena.release(); }
 };
 
 Timing::Timer recalc_timer;
@@ -134,6 +170,8 @@ std::atomic<u32> scores_processed{0};
 std::atomic<u32> scores_total{0};
 std::atomic<u32> maps_processed{0};
 std::atomic<u32> maps_total{0};
+std::atomic<u32> maps_parsed{0};
+std::atomic<u32> variants_processed{0};
 std::atomic<bool> workqueue_ready{false};
 std::atomic<bool> did_work{false};
 
@@ -144,19 +182,104 @@ Sync::mutex results_mutex;
 // owned by coordinator thread during execution
 std::vector<WorkItem> work_queue;
 std::atomic<u32> next_work_index{0};
+// work items claimed by a worker but not finished yet (they may still publish variant tasks)
+std::atomic<u32> items_in_flight{0};
+
+// star rating subtasks of already parsed beatmaps, taken by whichever worker is free first
+std::deque<VariantTask> variant_tasks;
+Sync::mutex variant_tasks_mtx;
 
 forceinline bool score_needs_recalc(const FinishedScore& score) {
     return score.ppv2_version < DiffCalc::PP_ALGORITHM_VERSION || (score.score > 0 && score.ppv2_score <= 0.f);
 }
 
+// Calculate PP for a group of scores sharing mod parameters, from already calculated difficulty attributes.
+void finish_score_group(const ModParams& params, std::vector<ScoreWork*>& scores,
+                        const DifficultyCalculator::DifficultyAttributes& attributes, f64 total_stars,
+                        const DiffAttrCache::Entry& counts) {
+    std::vector<ScoreResult> group_results;
+    group_results.reserve(scores.size());
+
+    for(auto* sw : scores) {
+        DifficultyCalculator::PPv2CalcParams ppv2params{
+            .attributes = attributes,
+            .modFlags = sw->score.mods.flags,
+            .timescale = sw->score.mods.speed,
+            .ar = params.ar,
+            .od = params.od,
+            .numHitObjects = (i32)(counts.num_circles + counts.num_sliders + counts.num_spinners),
+            .numCircles = (i32)counts.num_circles,
+            .numSliders = (i32)counts.num_sliders,
+            .numSpinners = (i32)counts.num_spinners,
+            .maxPossibleCombo = (i32)counts.max_combo,
+            .combo = sw->score.comboMax,
+            .misses = sw->score.numMisses,
+            .c300 = sw->score.num300s,
+            .c100 = sw->score.num100s,
+            .c50 = sw->score.num50s,
+            .legacyTotalScore = (u32)sw->score.score,
+            .isMcOsuImported = sw->score.is_mcosu_imported()};
+
+        // mcosu scores use a different scorev1 algorithm
+        const f64 pp = DifficultyCalculator::calculatePPv2(ppv2params);
+
+        if(pp <= 0.f) {
+            errored_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        group_results.push_back(ScoreResult{.score = std::move(sw->score),
+                                            .pp = pp,
+                                            .total_stars = total_stars,
+                                            .aim_stars = attributes.AimDifficulty,
+                                            .speed_stars = attributes.SpeedDifficulty});
+    }
+
+    {
+        Sync::scoped_lock lock(results_mutex);
+        Mc::append_range(score_results, std::move(group_results));
+    }
+    scores_processed.fetch_add(static_cast<u32>(scores.size()), std::memory_order_relaxed);
+}
+
+// Calculate PP for a group of scores sharing mod parameters, from the cached strain data of their beatmap.
+// Only the strains, weighing and rating are calculated, for this group's AR/OD/HP/mods.
+void finish_cached_score_group(const ModParams& params, std::vector<ScoreWork*>& scores,
+                               const DiffAttrCache::Entry& cached) {
+    std::pmr::vector<DifficultyHitObject> no_objects;  // not read, everything comes from the strain data
+    const DifficultyCalculator::BeatmapDiffcalcData diffcalc_data{.sortedHitObjects = no_objects,
+                                                                  .CS = params.cs,
+                                                                  .HP = params.hp,
+                                                                  .AR = params.ar,
+                                                                  .OD = params.od,
+                                                                  .hidden = params.hd,
+                                                                  .relax = params.rx,
+                                                                  .autopilot = params.ap,
+                                                                  .touchDevice = params.td,
+                                                                  .speedMultiplier = params.speed};
+
+    DifficultyCalculator::DifficultyAttributes attributes{};
+    const f64 total_stars =
+        DifficultyCalculator::calculateStarDiffForStrainData(cached.strain_data, diffcalc_data, attributes);
+
+    finish_score_group(params, scores, attributes, total_stars, cached);
+}
+
 // Calculate difficulty and PP for a group of scores sharing mod parameters.
 void process_score_group(const BeatmapDifficulty* map, const ModParams& params, std::vector<ScoreWork*>& scores,
                          DatabaseBeatmap::PRIMITIVE_CONTAINER& primitives, const Sync::stop_token& stoken,
                          WorkerContext& ctx) {
     if(scores.empty()) return;
 
-    auto diffres =
-        DatabaseBeatmap::loadDifficultyHitObjects(primitives, params.ar, params.cs, params.speed, false, stoken);
+    // an earlier group of this beatmap may have stored strain data which this group can use
+    const auto cache_key = DiffAttrCache::make_key(map->getMD5(), params.ar, params.cs, params.speed);
+    if(const auto cached = DiffAttrCache::lookup(cache_key)) {
+        finish_cached_score_group(params, scores, *cached);
+        return;
+    }
+
+    ArenaReleaser release_arena{ctx.arena};
+    auto diffres = DatabaseBeatmap::loadDifficultyHitObjects(primitives, params.ar, params.cs, params.speed, false,
+                                                             stoken, &ctx.arena);
     if(stoken.stop_requested()) return;
     if(diffres.error.errc) {
         const u32 item_failed_scores = scores.size();
@@ -180,8 +303,13 @@ void process_score_group(const BeatmapDifficulty* map, const ModParams& params,
                                                             .breakDuration = diffres.totalBreakDuration,
                                                             .playableLength = diffres.playableLength};
 
-    DifficultyCalculator::DifficultyAttributes attributes{};
+    auto entry = std::make_shared<DiffAttrCache::Entry>();
+    entry->max_combo = (u32)diffres.getTotalMaxCombo();
+    entry->num_circles = (u32)primitives.hitcircles.size();
+    entry->num_sliders = (u32)primitives.sliders.size();
+    entry->num_spinners = (u32)primitives.spinners.size();
 
+    DifficultyCalculator::DifficultyAttributes attributes{};
     DifficultyCalculator::StarCalcParams star_params{.cachedDiffObjects = std::move(ctx.diffobj_cache),
                                                      .outAttributes = attributes,
                                                      .beatmapData = diffcalc_data,
@@ -189,56 +317,19 @@ void process_score_group(const BeatmapDifficulty* map, const ModParams& params,
                                                      .outSpeedStrains = nullptr,
                                                      .incremental = nullptr,
                                                      .upToObjectIndex = -1,
-                                                     .cancelCheck = stoken};
+                                                     .cancelCheck = stoken,
+                                                     .outStrainData = &entry->strain_data};
 
-    f64 total_stars = DifficultyCalculator::calculateStarDiffForHitObjects(star_params);
+    const f64 total_stars = DifficultyCalculator::calculateStarDiffForHitObjects(star_params);
     ctx.diffobj_cache = std::move(star_params.cachedDiffObjects);
     ctx.diffobj_cache->clear();
 
     if(stoken.stop_requested()) return;
 
     // calculate PP for each score using shared difficulty attributes
-    std::vector<ScoreResult> group_results;
-    group_results.reserve(scores.size());
-
-    for(auto* sw : scores) {
-        DifficultyCalculator::PPv2CalcParams ppv2params{.attributes = attributes,
-                                                        .modFlags = sw->score.mods.flags,
-                                                        .timescale = sw->score.mods.speed,
-                                                        .ar = params.ar,
-                                                        .od = params.od,
-                                                        .numHitObjects = (i32)primitives.getNumObjects(),
-                                                        .numCircles = (i32)primitives.hitcircles.size(),
-                                                        .numSliders = (i32)primitives.sliders.size(),
-                                                        .numSpinners = (i32)primitives.spinners.size(),
-                                                        .maxPossibleCombo = (i32)diffres.getTotalMaxCombo(),
-                                                        .combo = sw->score.comboMax,
-                                                        .misses = sw->score.numMisses,
-                                                        .c300 = sw->score.num300s,
-                                                        .c100 = sw->score.num100s,
-                                                        .c50 = sw->score.num50s,
-                                                        .legacyTotalScore = (u32)sw->score.score,
-                                                        .isMcOsuImported = sw->score.is_mcosu_imported()};
-
-        // mcosu scores use a different scorev1 algorithm
-        const f64 pp = DifficultyCalculator::calculatePPv2(ppv2params);
-
-        if(pp <= 0.f) {
-            errored_count.fetch_add(1, std::memory_order_relaxed);
-        }
+    finish_score_group(params, scores, attributes, total_stars, *entry);
 
-        group_results.push_back(ScoreResult{.score = std::move(sw->score),
-                                            .pp = pp,
-                                            .total_stars = total_stars,
-                                            .aim_stars = attributes.AimDifficulty,
-                                            .speed_stars = attributes.SpeedDifficulty});
-    }
-
-    {
-        Sync::scoped_lock lock(results_mutex);
-        Mc::append_range(score_results, std::move(group_results));
-    }
-    scores_processed.fetch_add(static_cast<u32>(scores.size()), std::memory_order_relaxed);
+    DiffAttrCache::store(cache_key, std::move(entry));
 }
 
 // Build work queue on worker thread to avoid blocking main thread.
@@ -265,15 +356,17 @@ void build_work_queue(const Sync::stop_token& stoken) {
     // find all scores needing PP recalc, grouped by beatmap
     u32 score_count = 0;
     {
-        Sync::shared_lock lock(db->scores_mtx);
-        for(const auto& [hash, scores] : db->getScores()) {
+        Sync::shared_lock lock(db->diff_hash_mtx);
+        for(const auto& slot : internal::diff_hashes()) {
             if(stoken.stop_requested()) return;
 
-            for(const auto& score : scores) {
-                if(!score_needs_recalc(score)) continue;
+            // the diff lives in the same slot as its scores, no separate lookup needed
+            auto* diff = slot.diff;
+            if(!diff || !slot.local_scores) continue;
+            const MD5Hash& hash = slot.hash;
 
-                auto* diff = db->getBeatmapDifficulty(hash);
-                if(!diff) continue;
+            for(const auto& score : *slot.local_scores) {
+                if(!score_needs_recalc(score)) continue;
 
                 auto& item = work_by_hash[hash];
                 if(item.map == nullptr) {
@@ -312,20 +405,140 @@ void build_work_queue(const Sync::stop_token& stoken) {
     std::ranges::sort(work_queue, std::ranges::less{}, [](const auto& work) { return work.scores.empty(); });
 }
 
+// Calculate star ratings for all speeds of one AR/CS variant.
+void calc_map_variant(MapJob& job, const StarPrecalc::ArCsVariant& var, const Sync::stop_token& stoken,
+                      WorkerContext& ctx) {
+    const BeatmapDifficulty* map = job.result.map;
+    auto& primitives = *job.primitives;
+
+    const f32 ar = std::clamp(map->getAR() * var.ar_od_hp_mul, 0.f, 10.f);
+    const f32 cs = std::clamp(map->getCS() * var.cs_mul, 0.f, 10.f);
+    const f32 od = std::clamp(map->getOD() * var.ar_od_hp_mul, 0.f, 10.f);
+    const f32 hp = std::clamp(map->getHP() * var.ar_od_hp_mul, 0.f, 10.f);
+
+    // build DifficultyHitObjects once at speed=1.0 for this AR/CS variant.
+    // object construction, sorting, and stacking are all speed-independent;
+    // only the timing fields need rescaling per speed. slider timing was
+    // already calculated by the worker which parsed the beatmap.
+    ArenaReleaser release_arena{ctx.arena};
+    auto diffres = DatabaseBeatmap::loadDifficultyHitObjects(primitives, ar, cs, 1.0f, false, stoken, &ctx.arena);
+    if(stoken.stop_requested()) return;
+
+    if(&var == &StarPrecalc::VARIANTS[0]) {
+        job.result.length_ms = diffres.playableLength;
+    }
+
+    if(diffres.error.errc) {
+        logFailure(diffres.error, "loadDifficultyHitObjects map hash: {} map path: {}", map->getMD5(),
+                   map->getFilePath());
+        return;
+    }
+
+    DifficultyCalculator::BeatmapDiffcalcData diffcalc_data{.sortedHitObjects = diffres.diffobjects,
+                                                            .CS = cs,
+                                                            .HP = hp,
+                                                            .AR = ar,
+                                                            .OD = od,
+                                                            .breakDuration = primitives.totalBreakDuration,
+                                                            .playableLength = diffres.playableLength};
+
+    DifficultyCalculator::PrecalcVariantParams precalc_params{.beatmapData = diffcalc_data,
+                                                              .variant = var,
+                                                              .outRatings = job.result.star_ratings,
+                                                              .cachedDiffObjects = ctx.diffobj_cache,
+                                                              .baseSpanDurations = ctx.base_span_durations,
+                                                              .baseScoringTimes = ctx.base_scoring_times,
+                                                              .cancelCheck = stoken};
+    DifficultyCalculator::calculatePrecalcVariant(precalc_params);
+}
+
+// Fan-in: called once per MapJob, by the worker that finished its last variant.
+void finish_map_job(MapJob& job, WorkerContext& ctx) {
+    auto& result = job.result;
+    const auto& primitives = *job.primitives;
+
+    if(result.star_ratings[StarPrecalc::NOMOD_1X_INDEX] <= 0.f) {
+        errored_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(!primitives.timingpoints.empty()) {
+        ctx.bpm_calc_buf.resize(primitives.timingpoints.size());
+        BPMInfo bpm = getBPM(primitives.timingpoints, ctx.bpm_calc_buf);
+        result.min_bpm = bpm.min;
+        result.max_bpm = bpm.max;
+        result.avg_bpm = bpm.most_common;
+    }
+
+    {
+        Sync::scoped_lock lock(results_mutex);
+        map_results.push_back(result);
+    }
+    maps_processed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void run_variant_task(const VariantTask& task, const Sync::stop_token& stoken, WorkerContext& ctx) {
+    calc_map_variant(*task.job, StarPrecalc::VARIANTS[task.variant_idx], stoken, ctx);
+    if(stoken.stop_requested()) return;
+
+    variants_processed.fetch_add(1, std::memory_order_relaxed);
+    // acq_rel so the finishing worker sees the star ratings written by the other variants
+    if(task.job->variants_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finish_map_job(*task.job, ctx);
+    }
+}
+
+bool pop_variant_task(VariantTask& out) {
+    Sync::scoped_lock lock(variant_tasks_mtx);
+    if(variant_tasks.empty()) return false;
+    out = std::move(variant_tasks.front());
+    variant_tasks.pop_front();
+    return true;
+}
+
 void process_work_item(WorkItem& item, const Sync::stop_token& stoken, WorkerContext& ctx) {
     if(!item.map) {
         errored_count.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
+    // group scores by mod parameters to share difficulty calc, and resolve as many groups as possible
+    // from the persistent attribute cache before touching the .osu file at all
+    Hash::flat::map<ModParams, std::vector<ScoreWork*>, ModParamsHash> score_groups;
+    for(auto& sw : item.scores) {
+        score_groups[sw.params].push_back(&sw);
+    }
+
+    u32 uncached_scores = 0;
+    for(auto it = score_groups.begin(); it != score_groups.end();) {
+        const auto& params = it->first;
+        if(const auto cached = DiffAttrCache::lookup(
+               DiffAttrCache::make_key(item.hash, params.ar, params.cs, params.speed))) {
+            finish_cached_score_group(params, it->second, *cached);
+            it = score_groups.erase(it);
+        } else {
+            uncached_scores += it->second.size();
+            ++it;
+        }
+    }
+
+    if(!item.needs_map_calc && score_groups.empty()) {
+        item.scores.clear();
+        item.scores.shrink_to_fit();
+        return;
+    }
+
     // load primitive objects once for this beatmap
-    auto primitives = DatabaseBeatmap::loadPrimitiveObjects(item.map->getFilePath(), stoken);
+    auto primitives = std::make_shared<DatabaseBeatmap::PRIMITIVE_CONTAINER>(
+        DatabaseBeatmap::loadPrimitiveObjects(item.map->getFilePath(), stoken));
     if(stoken.stop_requested()) return;
 
-    if(primitives.error.errc) {
-        const u32 item_failed_scores = item.scores.size();
-        errored_count.fetch_add(item_failed_scores, std::memory_order_relaxed);
-        logFailure(primitives.error, "loadPrimitiveObjects map hash: {} map path: {}", item.map->getMD5(),
+    if(item.needs_map_calc) {
+        maps_parsed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(primitives->error.errc) {
+        errored_count.fetch_add(uncached_scores, std::memory_order_relaxed);
+        logFailure(primitives->error, "loadPrimitiveObjects map hash: {} map path: {}", item.map->getMD5(),
                    item.map->getFilePath());
         if(item.needs_map_calc) {
             errored_count.fetch_add(1, std::memory_order_relaxed);
@@ -333,183 +546,54 @@ void process_work_item(WorkItem& item, const Sync::stop_token& stoken, WorkerCon
             map_results.push_back(MapResult{.map = item.map});
             maps_processed.fetch_add(1, std::memory_order_relaxed);
         }
-        scores_processed.fetch_add(item_failed_scores, std::memory_order_relaxed);
+        scores_processed.fetch_add(uncached_scores, std::memory_order_relaxed);
         return;
     }
 
-    // process map calculation (multi-mod star ratings, BPM, object counts)
-    if(item.needs_map_calc) {
-        MapResult result{.map = item.map,
-                         .nb_circles = (u32)primitives.hitcircles.size(),
-                         .nb_sliders = (u32)primitives.sliders.size(),
-                         .nb_spinners = (u32)primitives.spinners.size()};
-
-        const f32 base_ar = item.map->getAR();
-        const f32 base_cs = item.map->getCS();
-        const f32 base_od = item.map->getOD();
-        const f32 base_hp = item.map->getHP();
-
-        // AR/CS/OD/HP variant: {multiplier for AR/OD/HP, multiplier for CS}
-        // BASE=nomod, HR=1.4x (CS=1.3x), EZ=0.5x
-        struct ArCsVariant {
-            f32 ar_od_hp_mul;
-            f32 cs_mul;
-            // mod combo indices: [hidden=false, hidden=true]
-            u8 combo_idx[2];
-        };
-        static constexpr std::array VARIANTS{
-            ArCsVariant{1.0f, 1.0f, {0, 2}},  // BASE: None(0), HD(2)
-            ArCsVariant{1.4f, 1.3f, {1, 4}},  // HR: HR(1), HD|HR(4)
-            ArCsVariant{0.5f, 0.5f, {3, 5}},  // EZ: EZ(3), HD|EZ(5)
-        };
-
-        for(const auto& var : VARIANTS) {
-            if(stoken.stop_requested()) return;
-
-            const f32 ar = std::clamp(base_ar * var.ar_od_hp_mul, 0.f, 10.f);
-            const f32 cs = std::clamp(base_cs * var.cs_mul, 0.f, 10.f);
-            const f32 od = std::clamp(base_od * var.ar_od_hp_mul, 0.f, 10.f);
-            const f32 hp = std::clamp(base_hp * var.ar_od_hp_mul, 0.f, 10.f);
-
-            // build DifficultyHitObjects once at speed=1.0 for this AR/CS variant.
-            // object construction, sorting, and stacking are all speed-independent;
-            // only the timing fields need rescaling per speed. slider timing is
-            // calculated once (sliderTimesCalculated flag on primitives).
-            auto diffres = DatabaseBeatmap::loadDifficultyHitObjects(primitives, ar, cs, 1.0f, false, stoken);
-            if(stoken.stop_requested()) return;
-
-            if(&var == &VARIANTS[0]) {
-                result.length_ms = diffres.playableLength;
-            }
-
-            if(diffres.error.errc) {
-                logFailure(diffres.error, "loadDifficultyHitObjects map hash: {} map path: {}", item.map->getMD5(),
-                           item.map->getFilePath());
-                continue;
-            }
-
-            // save base slider timing (overwritten by speed rescaling below).
-            // baseTime/baseEndTime are already preserved on DifficultyHitObject,
-            // but spanDuration and scoringTimes have no base counterpart.
-            ctx.base_span_durations.clear();
-            ctx.base_scoring_times.clear();
-            for(const auto& obj : diffres.diffobjects) {
-                if(obj.type == DifficultyHitObject::TYPE::SLIDER) {
-                    ctx.base_span_durations.push_back(obj.spanDuration);
-                    for(const auto& st : obj.scoringTimes) {
-                        ctx.base_scoring_times.push_back(st.time);
-                    }
-                }
-            }
-
-            for(u8 speed_idx = 0; speed_idx < StarPrecalc::SPEEDS_NUM; speed_idx++) {
-                if(stoken.stop_requested()) return;
-                const f32 speed = StarPrecalc::SPEEDS[speed_idx];
-                const f64 inv_speed = 1.0 / (f64)speed;
-
-                // rescale timing fields from base values for this speed
-                {
-                    uSz si = 0, sti = 0;
-                    for(auto& obj : diffres.diffobjects) {
-                        obj.time = (i32)((f64)obj.baseTime * inv_speed);
-                        obj.endTime = (i32)((f64)obj.baseEndTime * inv_speed);
-                        if(obj.type == DifficultyHitObject::TYPE::SLIDER) {
-                            obj.spanDuration = (f32)((f64)ctx.base_span_durations[si] * inv_speed);
-                            for(auto& st : obj.scoringTimes) {
-                                st.time = (f32)((f64)ctx.base_scoring_times[sti] * inv_speed);
-                                sti++;
-                            }
-                            si++;
-                        }
-                    }
-                }
-
-                // HD=0: full calculation, saving raw difficulty values
-                {
-                    const u8 flat_idx = speed_idx * StarPrecalc::NUM_MOD_COMBOS + var.combo_idx[0];
-
-                    DifficultyCalculator::BeatmapDiffcalcData diffcalc_data{
-                        .sortedHitObjects = diffres.diffobjects,
-                        .CS = cs,
-                        .HP = hp,
-                        .AR = ar,
-                        .OD = od,
-                        .hidden = false,
-                        .relax = false,
-                        .autopilot = false,
-                        .touchDevice = false,
-                        .speedMultiplier = speed,
-                        .breakDuration = primitives.totalBreakDuration,
-                        .playableLength = diffres.playableLength};
-
-                    DifficultyCalculator::DifficultyAttributes attributes{};
-                    DifficultyCalculator::RawDifficultyValues raw_diff{};
-
-                    DifficultyCalculator::StarCalcParams star_params{.cachedDiffObjects = std::move(ctx.diffobj_cache),
-                                                                     .outAttributes = attributes,
-                                                                     .beatmapData = diffcalc_data,
-                                                                     .outAimStrains = nullptr,
-                                                                     .outSpeedStrains = nullptr,
-                                                                     .incremental = nullptr,
-                                                                     .upToObjectIndex = -1,
-                                                                     .cancelCheck = stoken,
-                                                                     .outRawDifficulty = &raw_diff};
-
-                    result.star_ratings[flat_idx] =
-                        static_cast<f32>(DifficultyCalculator::calculateStarDiffForHitObjects(star_params));
-
-                    ctx.diffobj_cache = std::move(star_params.cachedDiffObjects);
-
-                    if(stoken.stop_requested()) return;
-
-                    // HD=1: recompute star rating from cached raw difficulty values.
-                    // strains are identical (hidden only affects the final rating transform),
-                    // so we skip DiffObject construction, strain calc, and calculate_difficulty.
-                    const u8 hd_flat_idx = speed_idx * StarPrecalc::NUM_MOD_COMBOS + var.combo_idx[1];
-                    diffcalc_data.hidden = true;
-                    result.star_ratings[hd_flat_idx] =
-                        static_cast<f32>(DifficultyCalculator::recomputeStarRating(raw_diff, diffcalc_data));
-                }
-
-                ctx.diffobj_cache->clear();
-            }
-        }
-
-        if(result.star_ratings[StarPrecalc::NOMOD_1X_INDEX] <= 0.f) {
-            errored_count.fetch_add(1, std::memory_order_relaxed);
+    // calculate slider timing up front, so that the variant subtasks (possibly running on other workers) and the
+    // score groups below only ever read from the primitives
+    if(!primitives->sliderTimesCalculated) {
+        const auto slider_err = DatabaseBeatmap::calculateSliderTimesClicksTicks(
+            primitives->version, primitives->sliders, primitives->timingpoints, primitives->sliderMultiplier,
+            primitives->sliderTickRate, stoken);
+        if(stoken.stop_requested()) return;
+        if(slider_err.errc) {
+            // loadDifficultyHitObjects will report it for every variant/score group
+            primitives->error = slider_err;
+        } else {
+            primitives->sliderTimesCalculated = true;
         }
+    }
 
+    // same for the star calculation slider curves: built once here and shared by every variant/score group,
+    // instead of each loadDifficultyHitObjects call building its own copy
+    if(!primitives->error.errc) {
+        DatabaseBeatmap::calculateSliderCurves(*primitives, stoken);
         if(stoken.stop_requested()) return;
+    }
 
-        if(!primitives.timingpoints.empty()) {
-            ctx.bpm_calc_buf.resize(primitives.timingpoints.size());
-            BPMInfo bpm = getBPM(primitives.timingpoints, ctx.bpm_calc_buf);
-            result.min_bpm = bpm.min;
-            result.max_bpm = bpm.max;
-            result.avg_bpm = bpm.most_common;
-        }
-
-        {
-            Sync::scoped_lock lock(results_mutex);
-            map_results.push_back(result);
+    // publish map calculation (multi-mod star ratings, BPM, object counts) as stealable subtasks
+    if(item.needs_map_calc) {
+        auto job = std::make_shared<MapJob>();
+        job->primitives = primitives;
+        job->result = MapResult{.map = item.map,
+                                .nb_circles = (u32)primitives->hitcircles.size(),
+                                .nb_sliders = (u32)primitives->sliders.size(),
+                                .nb_spinners = (u32)primitives->spinners.size()};
+
+        Sync::scoped_lock lock(variant_tasks_mtx);
+        for(u8 i = 0; i < StarPrecalc::VARIANTS.size(); i++) {
+            variant_tasks.push_back(VariantTask{.job = job, .variant_idx = i});
         }
-        maps_processed.fetch_add(1, std::memory_order_relaxed);
     }
 
     if(stoken.stop_requested()) return;
 
-    // process score calculations, grouped by mod parameters to share difficulty calc
-    // subsequent loadDifficultyHitObjects calls skip slider timing (sliderTimesCalculated == true)
-    if(!item.scores.empty()) {
-        Hash::flat::map<ModParams, std::vector<ScoreWork*>, ModParamsHash> score_groups;
-        for(auto& sw : item.scores) {
-            score_groups[sw.params].push_back(&sw);
-        }
-
-        for(auto& [params, group] : score_groups) {
-            if(stoken.stop_requested()) return;
-            process_score_group(item.map, params, group, primitives, stoken, ctx);
-        }
+    // process remaining (uncached) score calculations
+    // loadDifficultyHitObjects calls skip slider timing (sliderTimesCalculated == true) and reuse the slider curves
+    for(auto& [params, group] : score_groups) {
+        if(stoken.stop_requested()) return;
+        process_score_group(item.map, params, group, *primitives, stoken, ctx);
     }
 
     // free memory from processed scores
@@ -527,16 +611,36 @@ void worker_fn(i32 thread_index, const Sync::stop_token& coord_stoken) {
 
     const u32 queue_size = work_queue.size();
     while(!coord_stoken.stop_requested()) {
-        u32 idx = next_work_index.fetch_add(1, std::memory_order_relaxed);
-        if(idx >= queue_size) break;
-
         while(osu->shouldPauseBGThreads() && !coord_stoken.stop_requested()) {
             Timing::sleepMS(100);
         }
         if(coord_stoken.stop_requested()) break;
 
-        process_work_item(work_queue[idx], coord_stoken, ctx);
-        Timing::sleep(0);
+        // finish star calculations of already parsed beatmaps (ours or someone else's) before parsing new ones
+        if(VariantTask task; pop_variant_task(task)) {
+            run_variant_task(task, coord_stoken, ctx);
+            Timing::sleep(0);
+            continue;
+        }
+
+        if(next_work_index.load(std::memory_order_relaxed) < queue_size) {
+            items_in_flight.fetch_add(1, std::memory_order_acq_rel);
+            const u32 idx = next_work_index.fetch_add(1, std::memory_order_relaxed);
+            if(idx < queue_size) {
+                process_work_item(work_queue[idx], coord_stoken, ctx);
+            }
+            items_in_flight.fetch_sub(1, std::memory_order_acq_rel);
+            Timing::sleep(0);
+            continue;
+        }
+
+        // nothing left to claim, but beatmaps still being processed by other workers may publish more subtasks
+        if(items_in_flight.load(std::memory_order_acquire) == 0) {
+            Sync::scoped_lock lock(variant_tasks_mtx);
+            if(variant_tasks.empty()) break;
+            continue;
+        }
+        Timing::sleepMS(1);
     }
 }
 
@@ -547,6 +651,7 @@ void coordinator(const Sync::stop_token& stoken) {
     errored_count.store(0, std::memory_order_relaxed);
     recalc_timer.reset();
 
+    DiffAttrCache::load();
     build_work_queue(stoken);
     workqueue_ready.store(true, std::memory_order_release);
 
@@ -578,6 +683,7 @@ void coordinator(const Sync::stop_token& stoken) {
     }
 
     next_work_index.store(0, std::memory_order_relaxed);
+    items_in_flight.store(0, std::memory_order_relaxed);
 
     // spawn workers
     {
@@ -594,9 +700,14 @@ void coordinator(const Sync::stop_token& stoken) {
         recalc_timer.update();
         debugLog("DB recalculator: took {} seconds, failed to recalculate {}/{}.", recalc_timer.getDelta(),
                  errored_count.load(std::memory_order_relaxed), initial_workqueue_size);
+        debugLog("DB recalculator: parsed {} maps, calculated {} star rating variants, {} scores on {} threads",
+                 get_maps_parsed(), get_variants_processed(), get_scores_processed(), nb_threads);
         did_work.store(true, std::memory_order_release);
     }
 
+    DiffAttrCache::save();
+    DiffAttrCache::clear();
+
     // just in case
     maps_processed.store(get_maps_total(), std::memory_order_release);
     scores_processed.store(get_scores_total(), std::memory_order_release);
@@ -604,32 +715,42 @@ void coordinator(const Sync::stop_token& stoken) {
     // cleanup
     work_queue.clear();
     work_queue.shrink_to_fit();
+    {
+        Sync::scoped_lock lock(variant_tasks_mtx);
+        variant_tasks.clear();
+    }
 }
 
 }  // namespace
 
 void internal::flush_score_results(std::vector<ScoreResult>& pending) {
-    bool any_updated = false;
-
-    Sync::unique_lock lk(db->scores_mtx);
-    auto& db_scores = db->getScoresMutable();
-    for(auto& res : pending) {
-        const auto& it = db_scores.find(res.score.beatmap_hash);
-        if(it == db_scores.end()) continue;
-
-        auto& scorevec = it->second;
-
-        if(const auto& scoreIt = std::ranges::find(scorevec, res.score); scoreIt != scorevec.end()) {
-            scoreIt->ppv2_version = DiffCalc::PP_ALGORITHM_VERSION;
-            scoreIt->ppv2_score = res.pp;
-            scoreIt->ppv2_total_stars = res.total_stars;
-            scoreIt->ppv2_aim_stars = res.aim_stars;
-            scoreIt->ppv2_speed_stars = res.speed_stars;
-            any_updated = true;
+    // copies of the updated scores, journaled once the scores lock is released
+    std::vector<FinishedScore> updated;
+
+    {
+        Sync::unique_lock lk(db->diff_hash_mtx);
+        for(auto& res : pending) {
+            auto* scores = db->getScoresMutable(res.score.beatmap_hash);
+            if(!scores) continue;
+
+            auto& scorevec = *scores;
+
+            if(const auto& scoreIt = std::ranges::find(scorevec, res.score); scoreIt != scorevec.end()) {
+                scoreIt->ppv2_version = DiffCalc::PP_ALGORITHM_VERSION;
+                scoreIt->ppv2_score = res.pp;
+                scoreIt->ppv2_total_stars = res.total_stars;
+                scoreIt->ppv2_aim_stars = res.aim_stars;
+                scoreIt->ppv2_speed_stars = res.speed_stars;
+                updated.push_back(*scoreIt);
+                db->reindexPlayerScores(res.score.beatmap_hash);
+            }
         }
     }
-    if(any_updated) {
+
+    if(!updated.empty()) {
         db->scores_changed.store(true, std::memory_order_release);
+        db->appendScoreJournal(Database::ScoreJournalOp::PP_UPDATE, updated);
+        db->compactScoresIfJournalLarge();
     }
 }
 
@@ -640,6 +761,8 @@ void start_calc() {
     scores_processed = 0;
     maps_total = 0;
     scores_total = 0;
+    maps_parsed = 0;
+    variants_processed = 0;
     workqueue_ready = false;
     map_results.clear();
     score_results.clear();
@@ -656,8 +779,14 @@ void abort_calc() {
     maps_total = 0;
     maps_processed = 0;
     scores_processed = 0;
+    maps_parsed = 0;
+    variants_processed = 0;
     workqueue_ready = false;
     work_queue.clear();
+    {
+        Sync::scoped_lock lock(variant_tasks_mtx);
+        variant_tasks.clear();
+    }
     map_results.clear();
     score_results.clear();
 }
@@ -689,9 +818,10 @@ bool update_mainthread() {
     if(const uSz num_pending = pending_maps.size(); num_pending > 0) {
         unique_parents.reserve(num_pending);
         {
-            Sync::unique_lock lock(db->peppy_overrides_mtx);
+            Sync::unique_lock lock(db->diff_hash_mtx);
             for(const auto& res : pending_maps) {
                 auto* map = res.map;
+                auto& slot = internal::slot(map->getMD5());
                 unique_parents.insert(map->getParentSet());
                 // only override existing values if we got some non-zero result, otherwise use what's already there
                 map->iNumCircles = res.nb_circles > 0 ? (i32)res.nb_circles : map->iNumCircles;
@@ -706,23 +836,22 @@ bool update_mainthread() {
                 map->iMostCommonBPM = res.avg_bpm != 0 ? res.avg_bpm : map->iMostCommonBPM;
                 map->ppv2Version = DiffCalc::PP_ALGORITHM_VERSION;
                 if(map->type == DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY) {
-                    db->peppy_overrides[map->getMD5()] = map->get_overrides();
+                    slot.overrides = std::make_unique<MapOverrides>(map->get_overrides());
                 }
-            }
-        }
 
-        {
-            Sync::unique_lock slk(db->star_ratings_mtx);
-            for(const auto& res : pending_maps) {
-                auto& ptr = db->star_ratings[res.map->getMD5()];
-                if(!ptr) ptr = std::make_unique<StarPrecalc::SRArray>();
-                *ptr = res.star_ratings;
-                res.map->star_ratings = ptr.get();
+                if(!slot.star_ratings) slot.star_ratings = std::make_unique<StarPrecalc::SRArray>();
+                *slot.star_ratings = res.star_ratings;
+                map->star_ratings = slot.star_ratings.get();
             }
         }
 
+        auto& columns = db->getBeatmapColumns();
+        for(const auto& res : pending_maps) {
+            columns.update(res.map);
+        }
         for(auto* set : unique_parents) {
             set->updateRepresentativeValues();
+            columns.update(set);
         }
 
         pending_maps.clear();
@@ -742,6 +871,12 @@ u32 get_maps_total() { return maps_total.load(std::memory_order_acquire); }
 
 u32 get_maps_processed() { return maps_processed.load(std::memory_order_acquire); }
 
+u32 get_maps_parsed() { return maps_parsed.load(std::memory_order_acquire); }
+
+u32 get_variants_total() { return get_maps_total() * (u32)StarPrecalc::VARIANTS.size(); }
+
+u32 get_variants_processed() { return variants_processed.load(std::memory_order_acquire); }
+
 u32 get_scores_total() { return scores_total.load(std::memory_order_acquire); }
 
 u32 get_scores_processed() { return scores_processed.load(std::memory_order_acquire); }
@@ -18,6 +18,11 @@ void abort_calc();
 [[nodiscard]] u32 get_maps_total();
 [[nodiscard]] u32 get_maps_processed();
 
+// per-stage progress: beatmaps parsed, and star rating subtasks (3 AR/CS variants per beatmap) calculated
+[[nodiscard]] u32 get_maps_parsed();
+[[nodiscard]] u32 get_variants_total();
+[[nodiscard]] u32 get_variants_processed();
+
 [[nodiscard]] u32 get_scores_total();
 [[nodiscard]] u32 get_scores_processed();
 
@@ -0,0 +1,328 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "DiffAttrCache.h"
+
+#include "ByteBufferedFile.h"
+#include "File.h"
+#include "Hashing.h"
+#include "Logging.h"
+#include "OsuConfig.h"
+#include "OsuConVars.h"
+#include "SyncMutex.h"
+#include "Timing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+// bump when RecordHeader or the column layout changes
+#define DIFFATTR_CACHE_VERSION 20260415
+
+namespace DiffAttrCache {
+namespace {
+
+constexpr const char *CACHE_PATH = NEOMOD_DB_DIR PACKAGE_NAME "_diffcalc.cache";
+
+// least recently used entries are dropped once the in-memory (and so on-disk) size of all entries exceeds this,
+// until it is below MAX_CACHE_BYTES * 3 / 4
+constexpr uSz MAX_CACHE_BYTES = 128ULL * 1024 * 1024;
+
+// size of one object across all StrainInputs columns
+constexpr uSz BYTES_PER_OBJECT = sizeof(i32) + sizeof(DifficultyHitObject::TYPE) + sizeof(vec2) + 6 * sizeof(f64);
+
+// sanity limit, larger entries aren't cached (or read back)
+constexpr u32 MAX_ENTRY_OBJECTS = 1U << 20;
+
+// ByteBufferedFile can't read or write more than its buffer size at once
+constexpr uSz COLUMN_CHUNK_BYTES = 1024ULL * 1024;
+
+// on-disk layout: "NEODC", u32 cache version, u32 strain data version, u32 record header size, u32 record count,
+// followed by record count RecordHeaders, each followed by its num_objects long StrainInputs columns.
+// records are ordered from least to most recently used
+struct RecordHeader {
+    std::array<MD5Byte, 16> md5;
+    f32 ar, cs, speed;
+    Settings settings;
+    u32 max_combo, num_circles, num_sliders, num_spinners;
+    u32 break_duration, playable_length;
+    f64 nested_score;
+    u64 combo_sum;
+    f64 small_circle_bonus;
+    u32 num_objects;
+};
+static_assert(std::is_trivially_copyable_v<RecordHeader>);
+
+struct KeyHash {
+    uSz operator()(const Key &k) const {
+        uSz h = std::hash<MD5Hash>{}(k.md5);
+        h ^= std::hash<f32>{}(k.ar) << 1;
+        h ^= std::hash<f32>{}(k.cs) << 2;
+        h ^= std::hash<f32>{}(k.speed) << 3;
+        // the settings are (almost) always the same for every entry, no point in hashing them
+        return h;
+    }
+};
+
+struct Slot {
+    std::shared_ptr<const Entry> entry;
+    u64 last_used;
+};
+
+Sync::mutex cache_mtx;
+Hash::flat::map<Key, Slot, KeyHash> entries;
+u64 use_clock{0};
+uSz total_bytes{0};
+bool loaded{false};
+bool dirty{false};
+
+uSz entry_bytes(const Entry &entry) { return sizeof(Entry) + entry.strain_data.inputs.size() * BYTES_PER_OBJECT; }
+
+// callers must hold cache_mtx
+void evict_least_recently_used() {
+    if(total_bytes <= MAX_CACHE_BYTES) return;
+
+    std::vector<std::pair<u64, const Key *>> by_age;
+    by_age.reserve(entries.size());
+    for(const auto &[key, slot] : entries) {
+        by_age.emplace_back(slot.last_used, &key);
+    }
+    std::ranges::sort(by_age, std::ranges::less{}, [](const auto &p) { return p.first; });
+
+    std::vector<Key> evicted;
+    for(const auto &[_, key] : by_age) {
+        if(total_bytes <= MAX_CACHE_BYTES / 4 * 3) break;
+        total_bytes -= entry_bytes(*entries.find(*key)->second.entry);
+        evicted.push_back(*key);
+    }
+    for(const Key &key : evicted) {
+        entries.erase(key);
+    }
+
+    dirty = true;
+    debugLog("evicted {} cached strain data entries", evicted.size());
+}
+
+template <typename T>
+bool read_column(ByteBufferedFile::Reader &reader, std::vector<T> &column, u32 count) {
+    column.resize(count);
+    auto *bytes = reinterpret_cast<u8 *>(column.data());
+    for(uSz pos = 0, len = count * sizeof(T); pos < len; pos += COLUMN_CHUNK_BYTES) {
+        const uSz chunk = std::min(COLUMN_CHUNK_BYTES, len - pos);
+        if(reader.read_bytes(bytes + pos, chunk) != chunk) return false;
+    }
+    return true;
+}
+
+template <typename T>
+void write_column(ByteBufferedFile::Writer &writer, const std::vector<T> &column) {
+    const auto *bytes = reinterpret_cast<const u8 *>(column.data());
+    for(uSz pos = 0, len = column.size() * sizeof(T); pos < len; pos += COLUMN_CHUNK_BYTES) {
+        writer.write_bytes(bytes + pos, std::min(COLUMN_CHUNK_BYTES, len - pos));
+    }
+}
+
+// nullptr if the record is truncated or invalid
+std::shared_ptr<Entry> read_entry(ByteBufferedFile::Reader &reader, const RecordHeader &rec) {
+    if(rec.num_objects > MAX_ENTRY_OBJECTS) return nullptr;
+
+    auto entry = std::make_shared<Entry>();
+    entry->max_combo = rec.max_combo;
+    entry->num_circles = rec.num_circles;
+    entry->num_sliders = rec.num_sliders;
+    entry->num_spinners = rec.num_spinners;
+
+    auto &data = entry->strain_data;
+    data.breakDuration = rec.break_duration;
+    data.playableLength = rec.playable_length;
+    data.nestedScore = rec.nested_score;
+    data.comboSum = rec.combo_sum;
+
+    auto &in = data.inputs;
+    in.smallCircleBonus = rec.small_circle_bonus;
+    const u32 n = rec.num_objects;
+    const bool complete = read_column(reader, in.time, n) && read_column(reader, in.type, n) &&
+                          read_column(reader, in.pos, n) && read_column(reader, in.jumpDistance, n) &&
+                          read_column(reader, in.minJumpDistance, n) && read_column(reader, in.minJumpTime, n) &&
+                          read_column(reader, in.travelDistance, n) && read_column(reader, in.travelTime, n) &&
+                          read_column(reader, in.angle, n);
+    if(!complete) return nullptr;
+
+    if(std::ranges::any_of(in.type, [](auto type) { return type > DifficultyHitObject::TYPE::SLIDER; })) {
+        return nullptr;
+    }
+    return entry;
+}
+
+}  // namespace
+
+Key make_key(const MD5Hash &md5, f32 ar, f32 cs, f32 speed) {
+    Key key{.md5 = md5,
+            .ar = ar,
+            .cs = cs,
+            .speed = speed,
+            .settings = {.slider_curve_points_separation = cv::stars_slider_curve_points_separation.getFloat(),
+                         .slider_curve_max_length = cv::slider_curve_max_length.getFloat(),
+                         .slider_end_inside_check_offset = cv::slider_end_inside_check_offset.getInt(),
+                         .slider_max_repeats = cv::slider_max_repeats.getInt(),
+                         .slider_max_ticks = cv::slider_max_ticks.getInt(),
+                         .max_num_slider_scoringtimes = cv::beatmap_max_num_slider_scoringtimes.getInt(),
+                         .max_num_hitobjects = cv::beatmap_max_num_hitobjects.getVal<u32>(),
+                         .stacking = cv::stars_stacking.getBool(),
+                         .ignore_clamped_sliders = cv::stars_ignore_clamped_sliders.getBool()}};
+
+    // AR only changes the StrainData through the stacking time window
+    if(!key.settings.stacking) key.ar = 0.f;
+    return key;
+}
+
+void load() {
+    Sync::scoped_lock lock(cache_mtx);
+    if(loaded) return;
+    loaded = true;
+    dirty = false;
+    entries.clear();
+    use_clock = 0;
+    total_bytes = 0;
+
+    if(File::exists(CACHE_PATH) != File::FILETYPE::FILE) return;
+
+    ByteBufferedFile::Reader reader(CACHE_PATH);
+    if(!reader.good() || reader.total_size == 0) return;
+
+    u8 magic[5]{};
+    if(reader.read_bytes(magic, 5) != 5 || memcmp(magic, "NEODC", 5) != 0) {
+        debugLog("ignoring {}: bad magic", CACHE_PATH);
+        return;
+    }
+
+    const u32 cache_version = reader.read<u32>();
+    const u32 strain_data_version = reader.read<u32>();
+    const u32 header_size = reader.read<u32>();
+    const u32 nb_records = reader.read<u32>();
+
+    if(cache_version != DIFFATTR_CACHE_VERSION || strain_data_version != DiffCalc::STRAIN_DATA_VERSION ||
+       header_size != sizeof(RecordHeader)) {
+        debugLog("discarding outdated {} (version {}/{}, current {}/{})", CACHE_PATH, cache_version,
+                 strain_data_version, DIFFATTR_CACHE_VERSION, DiffCalc::STRAIN_DATA_VERSION);
+        dirty = true;  // overwrite it on next save
+        return;
+    }
+
+    for(u32 i = 0; i < nb_records; i++) {
+        RecordHeader rec;
+        std::shared_ptr<Entry> entry;
+        if(reader.read_bytes(reinterpret_cast<u8 *>(&rec), sizeof(RecordHeader)) != sizeof(RecordHeader) ||
+           !(entry = read_entry(reader, rec))) {
+            debugLog("{} is truncated or corrupt, got {}/{} records", CACHE_PATH, i, nb_records);
+            dirty = true;
+            break;
+        }
+
+        Key key{.ar = rec.ar, .cs = rec.cs, .speed = rec.speed, .settings = rec.settings};
+        std::memcpy(key.md5.data(), rec.md5.data(), rec.md5.size());
+
+        total_bytes += entry_bytes(*entry);
+        if(const auto it = entries.find(key); it != entries.end()) total_bytes -= entry_bytes(*it->second.entry);
+        entries.insert_or_assign(key, Slot{.entry = std::move(entry), .last_used = ++use_clock});
+    }
+    evict_least_recently_used();
+
+    debugLog("loaded {} cached strain data entries ({} MiB)", entries.size(), total_bytes / (1024 * 1024));
+}
+
+void save() {
+    Sync::scoped_lock lock(cache_mtx);
+    if(!loaded || !dirty) return;
+
+    const f64 start_time = Timing::getTimeReal();
+
+    ByteBufferedFile::Writer writer(CACHE_PATH);
+    if(!writer.good()) {
+        debugLog("cannot save {}: {}", CACHE_PATH, writer.error());
+        return;
+    }
+
+    writer.write_bytes(reinterpret_cast<const u8 *>("NEODC"), 5);
+    writer.write<u32>(DIFFATTR_CACHE_VERSION);
+    writer.write<u32>(DiffCalc::STRAIN_DATA_VERSION);
+    writer.write<u32>(sizeof(RecordHeader));
+    writer.write<u32>(static_cast<u32>(entries.size()));
+
+    // oldest first, so that loading restores the usage order
+    std::vector<std::pair<u64, const Key *>> by_age;
+    by_age.reserve(entries.size());
+    for(const auto &[key, slot] : entries) {
+        by_age.emplace_back(slot.last_used, &key);
+    }
+    std::ranges::sort(by_age, std::ranges::less{}, [](const auto &p) { return p.first; });
+
+    for(const auto &[_, key] : by_age) {
+        if(!writer.good()) break;
+        const Entry &entry = *entries.find(*key)->second.entry;
+        const auto &data = entry.strain_data;
+
+        RecordHeader rec{};
+        std::memcpy(rec.md5.data(), key->md5.data(), rec.md5.size());
+        rec.ar = key->ar;
+        rec.cs = key->cs;
+        rec.speed = key->speed;
+        rec.settings = key->settings;
+        rec.max_combo = entry.max_combo;
+        rec.num_circles = entry.num_circles;
+        rec.num_sliders = entry.num_sliders;
+        rec.num_spinners = entry.num_spinners;
+        rec.break_duration = data.breakDuration;
+        rec.playable_length = data.playableLength;
+        rec.nested_score = data.nestedScore;
+        rec.combo_sum = data.comboSum;
+        rec.small_circle_bonus = data.inputs.smallCircleBonus;
+        rec.num_objects = (u32)data.inputs.size();
+        writer.write_bytes(reinterpret_cast<const u8 *>(&rec), sizeof(RecordHeader));
+
+        const auto &in = data.inputs;
+        write_column(writer, in.time);
+        write_column(writer, in.type);
+        write_column(writer, in.pos);
+        write_column(writer, in.jumpDistance);
+        write_column(writer, in.minJumpDistance);
+        write_column(writer, in.minJumpTime);
+        write_column(writer, in.travelDistance);
+        write_column(writer, in.travelTime);
+        write_column(writer, in.angle);
+    }
+
+    if(writer.good()) {
+        dirty = false;
+    }
+
+    debugLog("saved {} cached strain data entries in {:.3f}s", entries.size(), Timing::getTimeReal() - start_time);
+}
+
+void clear() {
+    Sync::scoped_lock lock(cache_mtx);
+    entries.clear();
+    total_bytes = 0;
+    loaded = false;
+    dirty = false;
+}
+
+std::shared_ptr<const Entry> lookup(const Key &key) {
+    Sync::scoped_lock lock(cache_mtx);
+    const auto it = entries.find(key);
+    if(it == entries.end()) return nullptr;
+    it->second.last_used = ++use_clock;
+    return it->second.entry;
+}
+
+void store(const Key &key, std::shared_ptr<const Entry> entry) {
+    if(!entry || entry->strain_data.inputs.size() > MAX_ENTRY_OBJECTS) return;
+
+    Sync::scoped_lock lock(cache_mtx);
+    total_bytes += entry_bytes(*entry);
+    if(const auto it = entries.find(key); it != entries.end()) total_bytes -= entry_bytes(*it->second.entry);
+    entries.insert_or_assign(key, Slot{.entry = std::move(entry), .last_used = ++use_clock});
+    dirty = true;
+
+    evict_least_recently_used();
+}
+
+}  // namespace DiffAttrCache
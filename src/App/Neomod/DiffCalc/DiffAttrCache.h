@@ -0,0 +1,69 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#pragma once
+// persistent cache of the per-beatmap strain inputs, keyed by beatmap MD5 + the parameters they depend on
+
+#include "types.h"
+#include "MD5Hash.h"
+#include "DifficultyCalculator.h"
+
+#include <memory>
+
+// Stores the DifficultyCalculator::StrainData (plus the object counts needed by calculatePPv2) of every
+// (beatmap, CS, speed) combination that has been calculated before. A hit lets score recalculation skip parsing the
+// .osu file and building DiffObjects entirely, only the strains, weighing and rating are redone
+// (DifficultyCalculator::calculateStarDiffForStrainData), so the same entry serves every AR/OD/HP and HD/RX/AP/TD.
+// AR is still part of the key while stacking is enabled, since it decides the stacking time window.
+// The whole file is discarded when DiffCalc::STRAIN_DATA_VERSION changes, and the least recently used entries are
+// dropped once the cache grows past a fixed size.
+namespace DiffAttrCache {
+
+// convars which change the hitobjects (and so the StrainData) of a beatmap
+struct Settings {
+    f32 slider_curve_points_separation{0.f};
+    f32 slider_curve_max_length{0.f};
+    i32 slider_end_inside_check_offset{0};
+    i32 slider_max_repeats{0};
+    i32 slider_max_ticks{0};
+    i32 max_num_slider_scoringtimes{0};
+    u32 max_num_hitobjects{0};
+    bool stacking{false};
+    bool ignore_clamped_sliders{false};
+
+    bool operator==(const Settings &) const = default;
+};
+
+struct Key {
+    MD5Hash md5;
+    f32 ar{0.f};  // 0 while stacking is disabled, see make_key
+    f32 cs{5.f};
+    f32 speed{1.f};
+    Settings settings{};
+
+    bool operator==(const Key &) const = default;
+};
+
+// key for the current convar values
+[[nodiscard]] Key make_key(const MD5Hash &md5, f32 ar, f32 cs, f32 speed);
+
+struct Entry {
+    DifficultyCalculator::StrainData strain_data;
+    u32 max_combo{0};
+    u32 num_circles{0};
+    u32 num_sliders{0};
+    u32 num_spinners{0};
+};
+
+// read the cache file from disk, replacing the current contents. no-op if already loaded.
+void load();
+
+// write the cache file to disk if anything was added since the last load/save
+void save();
+
+// drop all in-memory entries (the file on disk is left alone until the next save)
+void clear();
+
+// nullptr if there is no entry for key
+[[nodiscard]] std::shared_ptr<const Entry> lookup(const Key &key);
+void store(const Key &key, std::shared_ptr<const Entry> entry);
+
+}  // namespace DiffAttrCache
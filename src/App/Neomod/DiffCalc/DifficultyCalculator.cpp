@@ -9,6 +9,12 @@
 #include <utility>
 #include <cstring>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifndef BUILD_TOOLS_ONLY
 #include "OsuConVars.h"
 #define STARS_SLIDER_CURVE_POINTS_SEPARATION cv::stars_slider_curve_points_separation.getFloat()
@@ -41,36 +47,43 @@
 namespace DiffCalc {
 // NOTE: bumped version from 20251007 because of a bug in the first implementation with mcosu-imported scores
 const u32 PP_ALGORITHM_VERSION{20251008};
+
+// bump whenever the StrainData calculated for a beatmap changes (hitobject loading, stacking, slider curves, distances
+// and angles, scorev1 totals), so that cached StrainData (see DiffAttrCache) isn't reused.
+// changes to the strain evaluators, weighing or rating only need PP_ALGORITHM_VERSION
+const u32 STRAIN_DATA_VERSION{20260301};
 }  // namespace DiffCalc
 
-DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time) : DifficultyHitObject(type, pos, time, time) {}
+DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time, std::pmr::memory_resource *mem)
+    : DifficultyHitObject(type, pos, time, time, mem) {}
 
-DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime)
-    : DifficultyHitObject(type, pos, time, endTime, 0.0f, '\0', std::vector<vec2>(), 0.0f,
-                          std::vector<SLIDER_SCORING_TIME>(), 0, true) {}
+DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime, std::pmr::memory_resource *mem)
+    : DifficultyHitObject(type, pos, time, endTime, 0.0f, '\0', std::vector<vec2>(), 0.0f, {}, 0, true, nullptr, mem) {}
 
 DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime, f32 spanDuration,
                                          i8 osuSliderCurveType, const std::vector<vec2> &controlPoints, f32 pixelLength,
-                                         std::vector<SLIDER_SCORING_TIME> scoringTimes, i32 repeats,
-                                         bool calculateSliderCurveInConstructor)
+                                         std::span<const SLIDER_SCORING_TIME> scoringTimes, i32 repeats,
+                                         bool calculateSliderCurveInConstructor,
+                                         std::shared_ptr<const SliderCurve> sharedCurve, std::pmr::memory_resource *mem)
     : pos(pos),
       time(time),
       baseTime(time),
       endTime(endTime),
       baseEndTime(endTime),
-      scoringTimes(std::move(scoringTimes)),
-      curve(nullptr),
+      scoringTimes(scoringTimes.begin(), scoringTimes.end(), mem),
+      scheduledCurveAllocControlPoints(mem),
+      curve(std::move(sharedCurve)),
       spanDuration(spanDuration),
       pixelLength(pixelLength),
       repeats(repeats),
-      scheduledCurveAllocStackOffset(0.f),
+      curveStackOffset(0.f),
       stack(0),
       originalPos(pos),
       type(type),
       osuSliderCurveType(osuSliderCurveType),
       scheduledCurveAlloc(false) {
-    // build slider curve, if this is a (valid) slider
-    if(this->type == TYPE::SLIDER && controlPoints.size() > 1) {
+    // build slider curve, if this is a (valid) slider and the caller didn't already build one
+    if(this->type == TYPE::SLIDER && controlPoints.size() > 1 && this->curve == nullptr) {
         if(calculateSliderCurveInConstructor) {
             // old: too much kept memory allocations for over 14000 sliders in https://osu.ppy.sh/beatmapsets/592138#osu/1277649
 
@@ -85,20 +98,23 @@ DifficultyHitObject::DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endT
             // 14960 sliders @ pishifat - H E L L O  T H E R E (Kondou-Shinichi) [Sliders in the 69th centries].osu
             // 5208 sliders @ MillhioreF - haitai but every hai adds another haitai in the background (Chewy-san) [Weriko Rank the dream (nerf) but loli].osu
 
-            this->curve = SliderCurve::createCurve(this->osuSliderCurveType, controlPoints, this->pixelLength,
-                                                   STARS_SLIDER_CURVE_POINTS_SEPARATION);
+            this->curve = createCurve(this->osuSliderCurveType, controlPoints, this->pixelLength);
         } else {
             // new: delay curve creation to when it's needed, and also immediately delete afterwards (at the cost of having to store a copy of the control points)
             this->scheduledCurveAlloc = true;
-            this->scheduledCurveAllocControlPoints = controlPoints;
+            this->scheduledCurveAllocControlPoints.assign(controlPoints.begin(), controlPoints.end());
         }
     }
 }
 
 DifficultyHitObject::~DifficultyHitObject() = default;
 
+// the pmr vectors are move-constructed here (instead of move-assigned below) so that they keep the source's resource
 DifficultyHitObject::DifficultyHitObject(DifficultyHitObject &&dobj) noexcept
-    : pos(dobj.pos), originalPos(dobj.originalPos) {
+    : pos(dobj.pos),
+      scoringTimes(std::move(dobj.scoringTimes)),
+      scheduledCurveAllocControlPoints(std::move(dobj.scheduledCurveAllocControlPoints)),
+      originalPos(dobj.originalPos) {
     // move
     this->type = dobj.type;
     this->time = dobj.time;
@@ -108,12 +124,10 @@ DifficultyHitObject::DifficultyHitObject(DifficultyHitObject &&dobj) noexcept
     this->spanDuration = dobj.spanDuration;
     this->osuSliderCurveType = dobj.osuSliderCurveType;
     this->pixelLength = dobj.pixelLength;
-    this->scoringTimes = std::move(dobj.scoringTimes);
 
     this->curve = std::move(dobj.curve);
     this->scheduledCurveAlloc = dobj.scheduledCurveAlloc;
-    this->scheduledCurveAllocControlPoints = std::move(dobj.scheduledCurveAllocControlPoints);
-    this->scheduledCurveAllocStackOffset = dobj.scheduledCurveAllocStackOffset;
+    this->curveStackOffset = dobj.curveStackOffset;
     this->repeats = dobj.repeats;
 
     this->stack = dobj.stack;
@@ -141,7 +155,7 @@ DifficultyHitObject &DifficultyHitObject::operator=(DifficultyHitObject &&dobj)
     this->stack = dobj.stack;
     this->originalPos = dobj.originalPos;
     this->scheduledCurveAlloc = dobj.scheduledCurveAlloc;
-    this->scheduledCurveAllocStackOffset = dobj.scheduledCurveAllocStackOffset;
+    this->curveStackOffset = dobj.curveStackOffset;
 
     this->scoringTimes = std::move(dobj.scoringTimes);
     this->scheduledCurveAllocControlPoints = std::move(dobj.scheduledCurveAllocControlPoints);
@@ -150,16 +164,22 @@ DifficultyHitObject &DifficultyHitObject::operator=(DifficultyHitObject &&dobj)
     return *this;
 }
 
+std::shared_ptr<const SliderCurve> DifficultyHitObject::createCurve(i8 osuSliderCurveType,
+                                                                    std::span<const vec2> controlPoints,
+                                                                    f32 pixelLength) {
+    return SliderCurve::createCurve(osuSliderCurveType, std::vector<vec2>(controlPoints.begin(), controlPoints.end()),
+                                    pixelLength, STARS_SLIDER_CURVE_POINTS_SEPARATION);
+}
+
 void DifficultyHitObject::updateStackPosition(f32 stackOffset) {
-    scheduledCurveAllocStackOffset = stackOffset;
+    curveStackOffset = stackOffset;
 
     pos = originalPos - vec2(stack * stackOffset, stack * stackOffset);
-
-    updateCurveStackPosition(stackOffset);
 }
 
-void DifficultyHitObject::updateCurveStackPosition(f32 stackOffset) {
-    if(curve != nullptr) curve->updateStackPosition(stack * stackOffset, false);
+vec2 DifficultyHitObject::curvePointAt(f32 t) const {
+    const f32 offset = stack * curveStackOffset;
+    return curve->originalPointAt(t) - vec2(offset, offset);
 }
 
 vec2 DifficultyHitObject::getOriginalRawPosAt(i32 pos) const {
@@ -194,6 +214,66 @@ f32 DifficultyHitObject::getT(i32 pos, bool raw) const {
     }
 }
 
+namespace {
+// per thread, so that the columns keep their capacity between maps
+thread_local DifficultyCalculator::StrainInputs strainInputs;
+thread_local DifficultyCalculator::StrainOutputs strainOutputs;
+}  // namespace
+
+template <typename WeighSkill>
+f64 DifficultyCalculator::rateSkills(WeighSkill &&weighSkill, uSz numObjects, const BeatmapDiffcalcData &beatmapData,
+                                     DifficultyAttributes &attributes, bool starRatingOnly,
+                                     std::vector<f64> *outAimStrains, std::vector<f64> *outSpeedStrains,
+                                     RawDifficultyValues *outRawDifficulty) {
+    // the strain/note counts are only used by the performance calculation
+    DifficultyAttributes *outAttributes = starRatingOnly ? nullptr : &attributes;
+
+    // calculate final difficulty (weigh strains)
+    f64 aimNoSliders = weighSkill(Skills::AIM_NO_SLIDERS, nullptr, outAttributes);
+
+    f64 speed = weighSkill(Skills::SPEED, outSpeedStrains, outAttributes);
+
+    // Very important hack (because otherwise I have to rewrite how to `DiffObject::calculate_difficulty` works):
+    // At this point params.outAttributes `AimDifficultStrains` and `AimTopWeightedSlidersFactor` are calculated on aimNoSliders, what is exactly what we need here
+    // Later it would be overriden by normal Aim that includes sliders
+    // Technically TopWeightedSliderFactor attribute here is TopWeightedSliderCount, we're temporary using it for calculations
+    f64 aimTopWeightedSliderFactor =
+        attributes.AimTopWeightedSliderFactor /
+        std::max(1.0, attributes.AimDifficultStrainCount - attributes.AimTopWeightedSliderFactor);
+    f64 speedTopWeightedSliderFactor =
+        attributes.SpeedTopWeightedSliderFactor /
+        std::max(1.0, attributes.SpeedDifficultStrainCount - attributes.SpeedTopWeightedSliderFactor);
+
+    // Don't move this aim above, it's intended, read previous comments
+    f64 aim = weighSkill(Skills::AIM_SLIDERS, outAimStrains, outAttributes);
+
+    attributes.SliderFactor = aim > 0.0 ? calculateDifficultyRating(aimNoSliders) / calculateDifficultyRating(aim) : 1.0;
+
+    f64 mechanicalDifficultyRating = calculateMechanicalDifficultyRating(aim, speed);
+
+    // Don't forget to scale AR and OD by rate here before using it in rating calculation
+    const f64 adjAR = GameRules::arWithSpeed(beatmapData.AR, beatmapData.speedMultiplier);
+    const f64 adjOD = adjustOverallDifficultyByClockRate(beatmapData.OD, beatmapData.speedMultiplier);
+
+    if(outRawDifficulty) {
+        *outRawDifficulty = {aimNoSliders, aim, speed};
+    }
+
+    aimNoSliders = computeAimRating(aimNoSliders, numObjects, adjAR, adjOD, mechanicalDifficultyRating,
+                                    attributes.SliderFactor, beatmapData);
+    aim = computeAimRating(aim, numObjects, adjAR, adjOD, mechanicalDifficultyRating, attributes.SliderFactor,
+                           beatmapData);
+    speed = computeSpeedRating(speed, numObjects, adjAR, adjOD, mechanicalDifficultyRating, beatmapData);
+
+    attributes.AimDifficulty = aim;
+    attributes.SpeedDifficulty = speed;
+
+    attributes.AimTopWeightedSliderFactor = aimTopWeightedSliderFactor;
+    attributes.SpeedTopWeightedSliderFactor = speedTopWeightedSliderFactor;
+
+    return calculateTotalStarsFromSkills(aim, speed);
+}
+
 f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params) {
     // NOTE: upToObjectIndex is applied way below, during the construction of the 'dobjects'
 
@@ -258,7 +338,7 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
             else
                 endTimeMin = std::fmod(endTimeMin, 1.0);
 
-            slider.lazyEndPos = slider.ho->curve->pointAt(endTimeMin);
+            slider.lazyEndPos = slider.ho->curvePointAt(endTimeMin);
 
             vec2 cursor_pos = slider.ho->pos;
             f64 scaling_factor = 50.0 / circleRadius;
@@ -268,7 +348,7 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
 
                 if(slider.ho->scoringTimes[i].type == SLIDER_SCORING_TIME::TYPE::END) {
                     // NOTE: In lazer, the position of the slider end is at the visual end, but the time is at the scoring end
-                    diff = slider.ho->curve->pointAt(slider.ho->repeats % 2 ? 1.0 : 0.0) - cursor_pos;
+                    diff = slider.ho->curvePointAt(slider.ho->repeats % 2 ? 1.0 : 0.0) - cursor_pos;
                 } else {
                     f64 progress = (std::clamp<f32>(slider.ho->scoringTimes[i].time - (f32)slider.ho->time, 0.0f,
                                                     slider.ho->getDuration())) /
@@ -278,7 +358,7 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
                     else
                         progress = std::fmod(progress, 1.0);
 
-                    diff = slider.ho->curve->pointAt(progress) - cursor_pos;
+                    diff = slider.ho->curvePointAt(progress) - cursor_pos;
                 }
 
                 f64 diff_len = scaling_factor * vec::length(diff);
@@ -346,7 +426,6 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
             DiffObject newDiffObject{&params.beatmapData.sortedHitObjects[i], radius_scaling_factor,
                                      params.cachedDiffObjects.get(),
                                      (i32)i - 1};  // this already initializes the angle to NaN
-            newDiffObject.smallCircleBonus = smallCircleBonus;
             cachedDiffObjsRef.push_back(std::move(newDiffObject));
         }
     }
@@ -354,7 +433,6 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
 
     // calculate angles and travel/jump distances (before calculating strains)
     if(!isUsingCachedDiffObjects) {
-        const f32 starsSliderCurvePointsSeparation = STARS_SLIDER_CURVE_POINTS_SEPARATION;
         for(uSz i = 0; i < cacheSize; i++) {
             if(params.cancelCheck.stop_requested()) return 0.0;
 
@@ -369,11 +447,9 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
                 {
                     // delay curve creation to when it's needed (1)
                     if(prev1.ho->scheduledCurveAlloc && prev1.ho->curve == nullptr) {
-                        prev1.ho->curve = SliderCurve::createCurve(
-                            prev1.ho->osuSliderCurveType, prev1.ho->scheduledCurveAllocControlPoints,
-                            prev1.ho->pixelLength, starsSliderCurvePointsSeparation);
-                        prev1.ho->updateCurveStackPosition(
-                            prev1.ho->scheduledCurveAllocStackOffset);  // NOTE: respect stacking
+                        prev1.ho->curve = DifficultyHitObject::createCurve(prev1.ho->osuSliderCurveType,
+                                                                           prev1.ho->scheduledCurveAllocControlPoints,
+                                                                           prev1.ho->pixelLength);
                     }
                 }
 
@@ -403,7 +479,7 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
                     // NOTE: "curve shouldn't be null here, but Yin [test7] causes that to happen"
                     // NOTE: the curve can be null if controlPoints.size() < 1 because the OsuDifficultyHitObject() constructor will then not set scheduledCurveAlloc to true (which is perfectly fine and correct)
                     f32 tail_jump_dist =
-                        vec::distance(prev1.ho->curve ? prev1.ho->curve->pointAt(prev1.ho->repeats % 2 ? 1.0 : 0.0)
+                        vec::distance(prev1.ho->curve ? prev1.ho->curvePointAt(prev1.ho->repeats % 2 ? 1.0 : 0.0)
                                                       : prev1.ho->pos,
                                       cur.ho->pos) *
                         radius_scaling_factor;
@@ -446,67 +522,48 @@ f64 DifficultyCalculator::calculateStarDiffForHitObjects(StarCalcParams &params)
     // calculate strains/skills
     if(!isUsingCachedDiffObjects)  // NOTE: yes, this loses some extremely minor accuracy (~0.001 stars territory) for live star/pp for some rare individual upToObjectIndex due to not being recomputed for the cut set of cached diffObjects every time, but the performance gain is so insane I don't care
     {
-        for(uSz i = 1; i < cacheSize; i++)  // NOTE: start at 1
-        {
-            diffObjects[i].calculate_strains(diffObjects[i - 1], (i == cacheSize - 1) ? nullptr : &diffObjects[i + 1],
-                                             hitWindow300, params.beatmapData.autopilot);
+        StrainInputs &inputs = strainInputs;
+        StrainOutputs &outputs = strainOutputs;
+        inputs.gather(diffObjects, cacheSize, smallCircleBonus);
+        calculateStrains(inputs, hitWindow300, params.beatmapData.autopilot, outputs);
+
+        for(uSz i = 0; i < cacheSize; i++) {
+            DiffObject &dobj = diffObjects[i];
+            for(u8 skill = 0; skill < Skills::NUM_SKILLS; skill++) dobj.strains[skill] = outputs.strains[skill][i];
+            dobj.rhythm = outputs.rhythm[i];
         }
     }
 
-    // calculate final difficulty (weigh strains)
-    f64 aimNoSliders = DiffObject::calculate_difficulty(
-        Skills::AIM_NO_SLIDERS, diffObjects, numDiffObjects,
-        params.incremental ? &params.incremental[Skills::AIM_NO_SLIDERS] : nullptr, nullptr, &params.outAttributes);
-
-    f64 speed = DiffObject::calculate_difficulty(Skills::SPEED, diffObjects, numDiffObjects,
-                                                 params.incremental ? &params.incremental[Skills::SPEED] : nullptr,
-                                                 params.outSpeedStrains, &params.outAttributes);
-
-    // Very important hack (because otherwise I have to rewrite how to `DiffObject::calculate_difficulty` works):
-    // At this point params.outAttributes `AimDifficultStrains` and `AimTopWeightedSlidersFactor` are calculated on aimNoSliders, what is exactly what we need here
-    // Later it would be overriden by normal Aim that includes sliders
-    // Technically TopWeightedSliderFactor attribute here is TopWeightedSliderCount, we're temporary using it for calculations
-    f64 aimTopWeightedSliderFactor =
-        params.outAttributes.AimTopWeightedSliderFactor /
-        std::max(1.0, params.outAttributes.AimDifficultStrainCount - params.outAttributes.AimTopWeightedSliderFactor);
-    f64 speedTopWeightedSliderFactor = params.outAttributes.SpeedTopWeightedSliderFactor /
-                                       std::max(1.0, params.outAttributes.SpeedDifficultStrainCount -
-                                                         params.outAttributes.SpeedTopWeightedSliderFactor);
-
-    // Don't move this aim above, it's intended, read previous comments
-    f64 aim = DiffObject::calculate_difficulty(Skills::AIM_SLIDERS, diffObjects, numDiffObjects,
-                                               params.incremental ? &params.incremental[Skills::AIM_SLIDERS] : nullptr,
-                                               params.outAimStrains, &params.outAttributes);
-
-    params.outAttributes.SliderFactor =
-        aim > 0.0 ? calculateDifficultyRating(aimNoSliders) / calculateDifficultyRating(aim) : 1.0;
-
-    f64 mechanicalDifficultyRating = calculateMechanicalDifficultyRating(aim, speed);
-
-    // Don't forget to scale AR and OD by rate here before using it in rating calculation
-    const f64 adjAR = GameRules::arWithSpeed(params.beatmapData.AR, params.beatmapData.speedMultiplier);
-    const f64 adjOD = adjustOverallDifficultyByClockRate(params.beatmapData.OD, params.beatmapData.speedMultiplier);
-
-    if(params.outRawDifficulty) {
-        *params.outRawDifficulty = {aimNoSliders, aim, speed};
+    const bool fullCalculation = !params.incremental && params.upToObjectIndex < 0 && !params.starRatingOnly;
+    if(params.outStrainData && fullCalculation) {
+        params.outStrainData->inputs.gather(diffObjects, numDiffObjects, smallCircleBonus);
+        params.outStrainData->breakDuration = params.beatmapData.breakDuration;
+        params.outStrainData->playableLength = params.beatmapData.playableLength;
     }
 
-    aimNoSliders = computeAimRating(aimNoSliders, numDiffObjects, adjAR, adjOD, mechanicalDifficultyRating,
-                                    params.outAttributes.SliderFactor, params.beatmapData);
-    aim = computeAimRating(aim, numDiffObjects, adjAR, adjOD, mechanicalDifficultyRating,
-                           params.outAttributes.SliderFactor, params.beatmapData);
-    speed = computeSpeedRating(speed, numDiffObjects, adjAR, adjOD, mechanicalDifficultyRating, params.beatmapData);
+    const f64 stars = rateSkills(
+        [&](Skills::Skill skill, std::vector<f64> *outStrains, DifficultyAttributes *outAttributes) {
+            return DiffObject::calculate_difficulty(skill, diffObjects, numDiffObjects,
+                                                    params.incremental ? &params.incremental[skill] : nullptr,
+                                                    outStrains, outAttributes);
+        },
+        numDiffObjects, params.beatmapData, params.outAttributes, params.starRatingOnly, params.outAimStrains,
+        params.outSpeedStrains, params.outRawDifficulty);
 
     // Scorev1
-    calculateScoreV1Attributes(params.outAttributes, params.beatmapData, params.upToObjectIndex);
-
-    params.outAttributes.AimDifficulty = aim;
-    params.outAttributes.SpeedDifficulty = speed;
-
-    params.outAttributes.AimTopWeightedSliderFactor = aimTopWeightedSliderFactor;
-    params.outAttributes.SpeedTopWeightedSliderFactor = speedTopWeightedSliderFactor;
+    if(!params.starRatingOnly) {
+        IncrementalScoreV1State totals{};
+        IncrementalScoreV1State *scoreV1State =
+            params.incrementalScoreV1 ? params.incrementalScoreV1 : (params.outStrainData ? &totals : nullptr);
+        calculateScoreV1Attributes(params.outAttributes, params.beatmapData, params.upToObjectIndex, scoreV1State);
+
+        if(params.outStrainData && fullCalculation) {
+            params.outStrainData->nestedScore = totals.nested_score;
+            params.outStrainData->comboSum = totals.combo_sum;
+        }
+    }
 
-    return calculateTotalStarsFromSkills(aim, speed);
+    return stars;
 }
 
 f64 DifficultyCalculator::recomputeStarRating(const RawDifficultyValues &raw, const BeatmapDiffcalcData &beatmapData) {
@@ -526,18 +583,102 @@ f64 DifficultyCalculator::recomputeStarRating(const RawDifficultyValues &raw, co
     return calculateTotalStarsFromSkills(aim, speed);
 }
 
+void DifficultyCalculator::calculatePrecalcVariant(PrecalcVariantParams &params) {
+    BeatmapDiffcalcData &beatmapData = params.beatmapData;
+    auto &diffobjects = beatmapData.sortedHitObjects;
+
+    // object construction, sorting, and stacking are all speed-independent, only the timing fields need rescaling
+    // per speed. baseTime/baseEndTime are already preserved on DifficultyHitObject, but spanDuration and scoringTimes
+    // have no base counterpart, so save them before they are overwritten
+    params.baseSpanDurations.clear();
+    params.baseScoringTimes.clear();
+    for(const auto &obj : diffobjects) {
+        if(obj.type == DifficultyHitObject::TYPE::SLIDER) {
+            params.baseSpanDurations.push_back(obj.spanDuration);
+            for(const auto &st : obj.scoringTimes) {
+                params.baseScoringTimes.push_back(st.time);
+            }
+        }
+    }
+
+    for(u8 speedIdx = 0; speedIdx < StarPrecalc::SPEEDS_NUM; speedIdx++) {
+        if(params.cancelCheck.stop_requested()) return;
+        const f32 speed = StarPrecalc::SPEEDS[speedIdx];
+        const f64 invSpeed = 1.0 / (f64)speed;
+
+        // rescale timing fields from base values for this speed
+        {
+            uSz si = 0, sti = 0;
+            for(auto &obj : diffobjects) {
+                obj.time = (i32)((f64)obj.baseTime * invSpeed);
+                obj.endTime = (i32)((f64)obj.baseEndTime * invSpeed);
+                if(obj.type == DifficultyHitObject::TYPE::SLIDER) {
+                    obj.spanDuration = (f32)((f64)params.baseSpanDurations[si] * invSpeed);
+                    for(auto &st : obj.scoringTimes) {
+                        st.time = (f32)((f64)params.baseScoringTimes[sti] * invSpeed);
+                        sti++;
+                    }
+                    si++;
+                }
+            }
+        }
+
+        // HD=0: full calculation, saving raw difficulty values
+        beatmapData.hidden = false;
+        beatmapData.speedMultiplier = speed;
+
+        DifficultyAttributes attributes{};
+        RawDifficultyValues rawDiff{};
+        StarCalcParams starParams{.cachedDiffObjects = std::move(params.cachedDiffObjects),
+                                  .outAttributes = attributes,
+                                  .beatmapData = beatmapData,
+                                  .outAimStrains = nullptr,
+                                  .outSpeedStrains = nullptr,
+                                  .incremental = nullptr,
+                                  .upToObjectIndex = -1,
+                                  .cancelCheck = params.cancelCheck,
+                                  .outRawDifficulty = &rawDiff,
+                                  .starRatingOnly = params.starRatingOnly};
+
+        params.outRatings[speedIdx * StarPrecalc::NUM_MOD_COMBOS + params.variant.combo_idx[0]] =
+            static_cast<f32>(calculateStarDiffForHitObjects(starParams));
+
+        params.cachedDiffObjects = std::move(starParams.cachedDiffObjects);
+        if(params.cachedDiffObjects) params.cachedDiffObjects->clear();
+
+        if(params.cancelCheck.stop_requested()) return;
+
+        // HD=1: recompute star rating from the raw difficulty values.
+        // strains are identical (hidden only affects the final rating transform),
+        // so we skip DiffObject construction, strain calc, and calculate_difficulty.
+        beatmapData.hidden = true;
+        params.outRatings[speedIdx * StarPrecalc::NUM_MOD_COMBOS + params.variant.combo_idx[1]] =
+            static_cast<f32>(recomputeStarRating(rawDiff, beatmapData));
+    }
+}
+
 void DifficultyCalculator::calculateScoreV1Attributes(DifficultyAttributes &attributes, const BeatmapDiffcalcData &b,
-                                                      i32 upToObjectIndex) {
+                                                      i32 upToObjectIndex, IncrementalScoreV1State *incremental) {
     // Nested score per object
     const f64 big_tick_score = 30;
     const f64 small_tick_score = 10;
 
-    f64 sliderScore = 0;
-    f64 spinnerScore = 0;
-
     if(upToObjectIndex < 1) upToObjectIndex = (i32)b.sortedHitObjects.size();
 
-    for(i32 i = 0; i < upToObjectIndex; i++) {
+    IncrementalScoreV1State state{};
+    if(incremental) {
+        if(upToObjectIndex < incremental->processed_count) *incremental = {};  // seeked backwards
+        state = *incremental;
+    }
+
+    // Legacy score base multiplier
+    attributes.LegacyScoreBaseMultiplier = calculateLegacyScoreBaseMultiplier(
+        b.CS, b.HP, b.OD, b.sortedHitObjects.size(), b.breakDuration, b.playableLength);
+
+    // Maximum combo score
+    const f64 score_increase = 300.;
+
+    for(i32 i = state.processed_count; i < upToObjectIndex; i++) {
         const auto &hitObject = b.sortedHitObjects[i];
 
         if(hitObject.type == DifficultyHitObject::TYPE::SLIDER) {
@@ -554,42 +695,36 @@ void DifficultyCalculator::calculateScoreV1Attributes(DifficultyAttributes &attr
                 if(nestedHitObject.type == SLIDER_SCORING_TIME::TYPE::TICK) amountOfSmallTicks++;
             }
 
-            sliderScore += amountOfBigTicks * big_tick_score + amountOfSmallTicks * small_tick_score;
-        } else if(hitObject.type == DifficultyHitObject::TYPE::SPINNER)
-            spinnerScore += calculateScoreV1SpinnerScore(hitObject.baseEndTime - hitObject.baseTime);
-    }
-
-    attributes.NestedScorePerObject = (sliderScore + spinnerScore) / (f64)std::max(upToObjectIndex, 1);
-
-    // Legacy score base multiplier
-    const u32 breakTimeMS = b.breakDuration;
-    const u32 drainLength = std::max(b.playableLength - std::min(breakTimeMS, b.playableLength), (u32)1000) / 1000;
-    attributes.LegacyScoreBaseMultiplier = (i32)std::round(
-        (b.CS + b.HP + b.OD + std::clamp<f32>((f32)b.sortedHitObjects.size() / (f32)drainLength * 8.0f, 0.0f, 16.0f)) /
-        38.0f * 5.0f);
-
-    // Maximum combo score
-    const f64 score_increase = 300.;
-    i32 combo = 0;
-    attributes.MaximumLegacyComboScore = 0;
-
-    for(i32 i = 0; i < upToObjectIndex; i++) {
-        const auto &hitObject = b.sortedHitObjects[i];
+            state.nested_score += amountOfBigTicks * big_tick_score + amountOfSmallTicks * small_tick_score;
 
-        if(hitObject.type == DifficultyHitObject::TYPE::SLIDER) {
             // Increase combo for each nested object
-            combo += hitObject.scoringTimes.size();
+            state.combo += hitObject.scoringTimes.size();
 
             // For sliders we need to increase combo BEFORE giving score
-            combo++;
-        }
+            state.combo++;
+        } else if(hitObject.type == DifficultyHitObject::TYPE::SPINNER)
+            state.nested_score += calculateScoreV1SpinnerScore(hitObject.baseEndTime - hitObject.baseTime);
 
-        attributes.MaximumLegacyComboScore +=
-            (i32)(std::max(0, combo - 1) * (score_increase / 25. * attributes.LegacyScoreBaseMultiplier));
+        state.max_combo_score +=
+            (i32)(std::max(0, state.combo - 1) * (score_increase / 25. * attributes.LegacyScoreBaseMultiplier));
+        state.combo_sum += std::max(0, state.combo - 1);
 
         // We have already increased combo for slider
-        if(hitObject.type != DifficultyHitObject::TYPE::SLIDER) combo++;
+        if(hitObject.type != DifficultyHitObject::TYPE::SLIDER) state.combo++;
     }
+    state.processed_count = upToObjectIndex;
+
+    attributes.NestedScorePerObject = state.nested_score / (f64)std::max(upToObjectIndex, 1);
+    attributes.MaximumLegacyComboScore = state.max_combo_score;
+
+    if(incremental) *incremental = state;
+}
+
+i32 DifficultyCalculator::calculateLegacyScoreBaseMultiplier(f32 CS, f32 HP, f32 OD, uSz numObjects,
+                                                             u32 breakDuration, u32 playableLength) {
+    const u32 drainLength = std::max(playableLength - std::min(breakDuration, playableLength), (u32)1000) / 1000;
+    return (i32)std::round(
+        (CS + HP + OD + std::clamp<f32>((f32)numObjects / (f32)drainLength * 8.0f, 0.0f, 16.0f)) / 38.0f * 5.0f);
 }
 
 f64 DifficultyCalculator::calculateScoreV1SpinnerScore(f64 spinnerDuration) {
@@ -1298,111 +1433,563 @@ f64 DifficultyCalculator::erfInv(f64 x) {
     return erfInv;
 }
 
-void DifficultyCalculator::DiffObject::calculate_strains(const DiffObject &prev, const DiffObject *next,
-                                                         f64 hitWindow300, bool autopilotNerf) {
-    calculate_strain(prev, next, hitWindow300, autopilotNerf, Skills::SPEED);
-    calculate_strain(prev, next, hitWindow300, autopilotNerf, Skills::AIM_SLIDERS);
-    calculate_strain(prev, next, hitWindow300, autopilotNerf, Skills::AIM_NO_SLIDERS);
+void DifficultyCalculator::StrainInputs::resize(uSz count) {
+    time.resize(count);
+    type.resize(count);
+    pos.resize(count);
+    jumpDistance.resize(count);
+    minJumpDistance.resize(count);
+    minJumpTime.resize(count);
+    travelDistance.resize(count);
+    travelTime.resize(count);
+    angle.resize(count);
 }
 
-void DifficultyCalculator::DiffObject::calculate_strain(const DiffObject &prev, const DiffObject *next,
-                                                        f64 hitWindow300, bool autopilotNerf,
-                                                        const Skills::Skill dtype) {
-    const f64 AimMultiplier = 26;
-    const f64 SpeedMultiplier = 1.47;
+void DifficultyCalculator::StrainInputs::gather(const DiffObject *dobjects, uSz count, f64 smallCircleBonus) {
+    this->resize(count);
+    this->smallCircleBonus = smallCircleBonus;
+    for(uSz i = 0; i < count; i++) {
+        const DiffObject &dobj = dobjects[i];
+        this->time[i] = dobj.ho->time;
+        this->type[i] = dobj.ho->type;
+        this->pos[i] = dobj.ho->pos;
+        this->jumpDistance[i] = dobj.jumpDistance;
+        this->minJumpDistance[i] = dobj.minJumpDistance;
+        this->minJumpTime[i] = dobj.minJumpTime;
+        this->travelDistance[i] = dobj.travelDistance;
+        this->travelTime[i] = dobj.travelTime;
+        this->angle[i] = dobj.angle;
+    }
+}
 
-    f64 currentStrainOfDiffObject = 0;
+void DifficultyCalculator::calculateStrains(const StrainInputs &in, f64 hitWindow300, bool autopilotNerf,
+                                            StrainOutputs &out) {
+    static constexpr f64 AimMultiplier = 26;
+    static constexpr f64 SpeedMultiplier = 1.47;
+
+    const uSz count = in.size();
+    const i32 *time = in.time.data();
+    const auto *type = in.type.data();
+
+    out.deltaTime.resize(count);
+    out.adjustedDeltaTime.resize(count);
+    out.rhythm.assign(count, 0.0);
+    for(auto &column : out.strains) column.assign(count, 0.0);
+    for(auto &column : out.objectStrains) column.assign(count, 0.0);
+    if(count < 1) return;
+
+    // the first object has no previous one, so it never gets a delta time (or any strain)
+    f64 *deltaTime = out.deltaTime.data();
+    f64 *adjustedDeltaTime = out.adjustedDeltaTime.data();
+    deltaTime[0] = 0.0;
+    adjustedDeltaTime[0] = 0.0;
+    for(uSz i = 1; i < count; i++) {
+        const i32 elapsed = time[i] - time[i - 1];
+        deltaTime[i] = (f64)elapsed;
+        adjustedDeltaTime[i] = (f64)std::max(elapsed, 25);
+    }
 
-    const i32 time_elapsed = ho->time - prev.ho->time;
+    // evaluators, one pass each. spinners and invalid objects are left at 0
+    f64 *speedObjectStrains = out.objectStrains[Skills::SPEED].data();
+    f64 *rhythm = out.rhythm.data();
+    for(uSz i = 1; i < count; i++) {
+        if(type[i] == DifficultyHitObject::TYPE::CIRCLE || type[i] == DifficultyHitObject::TYPE::SLIDER) {
+            speedObjectStrains[i] = evaluateSpeed(in, out, i, hitWindow300, autopilotNerf, rhythm[i]);
+        }
+    }
 
-    // update our delta time
-    delta_time = (f64)time_elapsed;
-    adjusted_delta_time = (f64)std::max(time_elapsed, 25);
+    f64 *aimObjectStrains = out.objectStrains[Skills::AIM_SLIDERS].data();
+    f64 *aimNoSlidersObjectStrains = out.objectStrains[Skills::AIM_NO_SLIDERS].data();
+    for(uSz i = 3; i < count; i++) {
+        if(type[i] == DifficultyHitObject::TYPE::CIRCLE || type[i] == DifficultyHitObject::TYPE::SLIDER) {
+            aimObjectStrains[i] = evaluateAim(in, out, i, true);
+            aimNoSlidersObjectStrains[i] = evaluateAim(in, out, i, false);
+        }
+    }
 
-    switch(ho->type) {
-        case DifficultyHitObject::TYPE::SLIDER:
-        case DifficultyHitObject::TYPE::CIRCLE:
-            currentStrainOfDiffObject = spacing_weight2(dtype, prev, next, hitWindow300, autopilotNerf);
-            break;
+    // see Process() @ https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/Skill.cs
+    // the strain of an invalid object stays 0, which also resets the decay for the object after it
+    for(u8 skill = 0; skill < Skills::NUM_SKILLS; skill++) {
+        const auto dtype = (Skills::Skill)skill;
+        const f64 *decayTime = dtype == Skills::SPEED ? adjustedDeltaTime : deltaTime;
+        const f64 multiplier = dtype == Skills::SPEED ? SpeedMultiplier : AimMultiplier;
+        const f64 *objectStrains = out.objectStrains[skill].data();
+        f64 *strains = out.strains[skill].data();
+
+        for(uSz i = 1; i < count; i++) {
+            if(type[i] == DifficultyHitObject::TYPE::INVALID) continue;
+
+            f64 currentStrain = strains[i - 1];
+            currentStrain *= DiffObject::strainDecay(dtype, decayTime[i]);
+            currentStrain += objectStrains[i] * multiplier;
+            strains[i] = currentStrain;
+        }
+    }
+}
 
-        case DifficultyHitObject::TYPE::SPINNER:
-            break;
+// new implementation, Xexxar, (ppv2.1), see https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/
+// https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Speed.cs
+f64 DifficultyCalculator::evaluateSpeed(const StrainInputs &in, const StrainOutputs &out, uSz i, f64 hitWindow300,
+                                        bool autopilotNerf, f64 &rhythm) {
+    static constexpr f64 single_spacing_threshold = 125.0;
+
+    static constexpr f64 min_speed_bonus = 75.0; /* ~200BPM 1/4 streams */
+    static constexpr f64 speed_balancing_factor = 40.0;
+    static constexpr f64 distance_multiplier = 0.8;
+
+    static constexpr i32 history_time_max = 5000;
+    static constexpr i32 history_objects_max = 32;
+    static constexpr f64 rhythm_overall_multiplier = 1.0;
+    static constexpr f64 rhythm_ratio_multiplier = 15.0;
 
-        case DifficultyHitObject::TYPE::INVALID:
-            // NOTE: silently ignore
-            return;
+    const i32 *time = in.time.data();
+    const auto *type = in.type.data();
+    const f64 *deltaTime = out.deltaTime.data();
+
+    // index of the object backwardsIdx objects before the previous one (clamped to the first object)
+    const i32 prevObjectIndex = (i32)i - 1;
+    const auto previous = [prevObjectIndex](i32 backwardsIdx) -> uSz {
+        return (uSz)std::max(0, prevObjectIndex - backwardsIdx);
+    };
+
+    // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/SpeedEvaluator.cs
+    const f64 distance = std::min(single_spacing_threshold, in.travelDistance[i - 1] + in.minJumpDistance[i]);
+
+    f64 adjusted_delta_time = out.adjustedDeltaTime[i];
+    adjusted_delta_time /= std::clamp<f64>((adjusted_delta_time / hitWindow300) / 0.93, 0.92, 1.0);
+
+    f64 doubletapnessFactor = 1.0 - (i + 1 < in.size() ? doubletapness(in, out, i, i + 1, hitWindow300) : 0.0);
+
+    f64 speed_bonus = 0.0;
+    if(adjusted_delta_time < min_speed_bonus)
+        speed_bonus = 0.75 * std::pow((min_speed_bonus - adjusted_delta_time) / speed_balancing_factor, 2.0);
+
+    f64 distance_bonus =
+        autopilotNerf ? 0.0 : std::pow(distance / single_spacing_threshold, 3.95) * distance_multiplier;
+
+    // Apply reduced small circle bonus because flow aim difficulty on small circles doesn't scale as hard as jumps
+    distance_bonus *= std::sqrt(in.smallCircleBonus);
+
+    const f64 raw_speed_strain =
+        (1.0 + speed_bonus + distance_bonus) * 1000.0 * doubletapnessFactor / adjusted_delta_time;
+
+    // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/RhythmEvaluator.cs
+    f64 rhythmComplexitySum = 0;
+
+    const f64 deltaDifferenceEpsilon = hitWindow300 * 0.3;
+
+    RhythmIsland island{INT_MAX, 0};
+    RhythmIsland previousIsland{INT_MAX, 0};
+
+    static thread_local std::vector<std::pair<RhythmIsland, int>> islandCounts;
+    islandCounts.clear();
+
+    f64 startRatio = 0.0;  // store the ratio of the current start of an island to buff for tighter rhythms
+
+    bool firstDeltaSwitch = false;
+
+    i32 historicalNoteCount = std::min(prevObjectIndex, history_objects_max);
+
+    i32 rhythmStart = 0;
+
+    while(rhythmStart < historicalNoteCount - 2 && time[i] - time[previous(rhythmStart)] < history_time_max) {
+        rhythmStart++;
     }
 
-    // see Process() @ https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/Skill.cs
-    f64 currentStrain = prev.strains[dtype];
-    {
-        currentStrain *= strainDecay(dtype, dtype == Skills::SPEED ? adjusted_delta_time : delta_time);
-        currentStrain += currentStrainOfDiffObject * (dtype == Skills::SPEED ? SpeedMultiplier : AimMultiplier);
+    uSz prevObj = previous(rhythmStart);
+    uSz lastObj = previous(rhythmStart + 1);
+
+    for(i32 h = rhythmStart; h > 0; h--) {
+        const uSz currObj = previous(h - 1);
+
+        // scales note 0 to 1 from history to now
+        f64 timeDecay = (history_time_max - (time[i] - time[currObj])) / (f64)history_time_max;
+        f64 noteDecay = (f64)(historicalNoteCount - h) / historicalNoteCount;
+
+        f64 currHistoricalDecay = std::min(noteDecay, timeDecay);  // either we're limited by time or limited by object count.
+
+        f64 currDelta = std::max(deltaTime[currObj], 1e-7);
+        f64 prevDelta = std::max(deltaTime[prevObj], 1e-7);
+        f64 lastDelta = std::max(deltaTime[lastObj], 1e-7);
+
+        // calculate how much current delta difference deserves a rhythm bonus
+        // this function is meant to reduce rhythm bonus for deltas that are multiples of each other (i.e 100 and 200)
+        f64 deltaDifference = std::max(prevDelta, currDelta) / std::min(prevDelta, currDelta);
+
+        // Take only the fractional part of the value since we're only interested in punishing multiples
+        f64 deltaDifferenceFraction = deltaDifference - std::trunc(deltaDifference);
+
+        f64 currRatio = 1.0 + rhythm_ratio_multiplier * std::min(0.5, smoothstepBellCurve(deltaDifferenceFraction));
+
+        // reduce ratio bonus if delta difference is too big
+        f64 differenceMultiplier = std::clamp<f64>(2.0 - deltaDifference / 8.0, 0.0, 1.0);
+
+        f64 windowPenalty = std::min(
+            1.0, std::max(0.0, std::abs(prevDelta - currDelta) - deltaDifferenceEpsilon) / deltaDifferenceEpsilon);
+
+        f64 effectiveRatio = windowPenalty * currRatio * differenceMultiplier;
+
+        if(firstDeltaSwitch) {
+            if(std::abs(prevDelta - currDelta) < deltaDifferenceEpsilon) {
+                // island is still progressing
+                if(island.delta == INT_MAX) {
+                    island.delta = std::max((i32)currDelta, 25);
+                }
+                island.deltaCount++;
+            } else {
+                if(type[currObj] == DifficultyHitObject::TYPE::SLIDER)  // bpm change is into slider, this is easy acc window
+                    effectiveRatio *= 0.125;
+
+                if(type[prevObj] == DifficultyHitObject::TYPE::SLIDER)  // bpm change was from a slider, this is easier typically than circle -> circle
+                    effectiveRatio *= 0.3;
+
+                if(island.deltaCount % 2 == previousIsland.deltaCount % 2)  // repeated island polarity (2 -> 4, 3 -> 5)
+                    effectiveRatio *= 0.5;
+
+                if(lastDelta > prevDelta + deltaDifferenceEpsilon &&
+                   prevDelta > currDelta + deltaDifferenceEpsilon)  // previous increase happened a note ago, 1/1->1/2-1/4, dont want to buff this.
+                    effectiveRatio *= 0.125;
+
+                if(previousIsland.deltaCount == island.deltaCount)  // repeated island size (ex: triplet -> triplet)
+                    effectiveRatio *= 0.5;
+
+                std::pair<RhythmIsland, int> *islandCount = nullptr;
+                for(auto &c : islandCounts) {
+                    if(c.first.equals(island, deltaDifferenceEpsilon)) {
+                        islandCount = &c;
+                        break;
+                    }
+                }
+
+                if(islandCount != nullptr) {
+                    // only add island to island counts if they're going one after another
+                    if(previousIsland.equals(island, deltaDifferenceEpsilon)) islandCount->second++;
+
+                    // repeated island (ex: triplet -> triplet)
+                    static constexpr f64 E = 2.7182818284590451;
+                    f64 power = 2.75 / (1.0 + std::pow(E, 14.0 - (0.24 * island.delta)));
+                    effectiveRatio *= std::min(3.0 / islandCount->second, std::pow(1.0 / islandCount->second, power));
+                } else {
+                    islandCounts.emplace_back(island, 1);
+                }
+
+                // scale down the difficulty if the object is doubletappable
+                effectiveRatio *= 1.0 - doubletapness(in, out, prevObj, currObj, hitWindow300) * 0.75;
+
+                rhythmComplexitySum += std::sqrt(effectiveRatio * startRatio) * currHistoricalDecay;
+
+                startRatio = effectiveRatio;
+
+                previousIsland = island;
+
+                if(prevDelta + deltaDifferenceEpsilon < currDelta)  // we're slowing down, stop counting
+                    firstDeltaSwitch = false;  // if we're speeding up, this stays true and  we keep counting island size.
+
+                island = RhythmIsland{std::max((i32)currDelta, 25), 1};
+            }
+        } else if(prevDelta > currDelta + deltaDifferenceEpsilon)  // we want to be speeding up.
+        {
+            // Begin counting island until we change speed again.
+            firstDeltaSwitch = true;
+
+            if(type[currObj] == DifficultyHitObject::TYPE::SLIDER)  // bpm change is into slider, this is easy acc window
+                effectiveRatio *= 0.6;
+
+            if(type[prevObj] == DifficultyHitObject::TYPE::SLIDER)  // bpm change was from a slider, this is easier typically than circle -> circle
+                effectiveRatio *= 0.6;
+
+            startRatio = effectiveRatio;
+
+            island = RhythmIsland{std::max((i32)currDelta, 25), 1};
+        }
+
+        lastObj = prevObj;
+        prevObj = currObj;
     }
-    strains[dtype] = currentStrain;
+
+    // produces multiplier that can be applied to strain. range [1, infinity) (not really though)
+    // NOTE: the "next" object here is the previous one (lazer's Next(0) with McOsu's index offset), kept as is
+    rhythm = (std::sqrt(4.0 + rhythmComplexitySum * rhythm_overall_multiplier) / 2.0) *
+             (1.0 - doubletapness(in, out, i, previous(0), hitWindow300));
+
+    islandCounts.clear();
+    return raw_speed_strain;
 }
 
-f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill type, const DiffObject *dobjects,
-                                                           uSz dobjectCount, IncrementalState *incremental,
-                                                           std::vector<f64> *outStrains,
-                                                           DifficultyAttributes *outAttributes) {
-    // (old) see https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/Skill.cs
-    // (new) see https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/StrainSkill.cs
+// https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/AimEvaluator.cs
+f64 DifficultyCalculator::evaluateAim(const StrainInputs &in, const StrainOutputs &out, uSz i, bool withSliders) {
+    static constexpr f64 wide_angle_multiplier = 1.5;
+    static constexpr f64 acute_angle_multiplier = 2.55;
+    static constexpr f64 slider_multiplier = 1.35;
+    static constexpr f64 velocity_change_multiplier = 0.75;
+    static constexpr f64 wiggle_multiplier = 1.02;
+
+    const auto *type = in.type.data();
+    const f64 *jumpDistance = in.jumpDistance.data();
+    const f64 *angle = in.angle.data();
+    const f64 *adjustedDeltaTime = out.adjustedDeltaTime.data();
+
+    // needs two previous objects (i > 2)
+    const uSz prev = i - 1;
+    const uSz prevPrev = i - 2;
+    const uSz prev2 = i - 3;
+
+    if(type[prev] == DifficultyHitObject::TYPE::SPINNER) return 0.0;
+
+    static constexpr auto calcWideAngleBonus =
+        +[](f64 angle) { return smoothstep(angle, 40.0 * (PI / 180.0), 140.0 * (PI / 180.0)); };
+    static constexpr auto calcAcuteAngleBonus =
+        +[](f64 angle) { return smoothstep(angle, 140.0 * (PI / 180.0), 40.0 * (PI / 180.0)); };
+
+    f64 currVelocity = jumpDistance[i] / adjustedDeltaTime[i];
+
+    if(type[prev] == DifficultyHitObject::TYPE::SLIDER && withSliders) {
+        f64 travelVelocity = in.travelDistance[prev] / in.travelTime[prev];
+        f64 movementVelocity = in.minJumpDistance[i] / in.minJumpTime[i];
+        currVelocity = std::max(currVelocity, movementVelocity + travelVelocity);
+    }
+    f64 aimStrain = currVelocity;
 
-    static constexpr f64 strain_step = 400.0;  // the length of each strain section
-    static constexpr f64 decay_weight =
-        0.9;  // max strains are weighted from highest to lowest, and this is how much the weight decays.
+    f64 prevVelocity = jumpDistance[prev] / adjustedDeltaTime[prev];
+    if(type[prevPrev] == DifficultyHitObject::TYPE::SLIDER && withSliders) {
+        f64 travelVelocity = in.travelDistance[prevPrev] / in.travelTime[prevPrev];
+        f64 movementVelocity = in.minJumpDistance[prev] / in.minJumpTime[prev];
+        prevVelocity = std::max(prevVelocity, movementVelocity + travelVelocity);
+    }
 
-    if(dobjectCount < 1) return 0.0;
+    f64 wideAngleBonus = 0;
+    f64 acuteAngleBonus = 0;
+    f64 sliderBonus = 0;
+    f64 velocityChangeBonus = 0;
+    f64 wiggleBonus = 0;
+
+    const f64 currDeltaTime = adjustedDeltaTime[i];
+    const f64 prevDeltaTime = adjustedDeltaTime[prev];
 
-    f64 interval_end =
-        incremental ? incremental->interval_end : (std::ceil((f64)dobjects[0].ho->time / strain_step) * strain_step);
-    f64 max_strain = incremental ? incremental->max_strain : 0.0;
+    if(!std::isnan(angle[i]) && !std::isnan(angle[prev])) {
+        f64 angleBonus = std::min(currVelocity, prevVelocity);
+
+        if(std::max(currDeltaTime, prevDeltaTime) < 1.25 * std::min(currDeltaTime, prevDeltaTime)) {
+            acuteAngleBonus = calcAcuteAngleBonus(angle[i]);
+            acuteAngleBonus *=
+                0.08 + 0.92 * (1.0 - std::min(acuteAngleBonus, std::pow(calcAcuteAngleBonus(angle[prev]), 3.0)));
+            acuteAngleBonus *= angleBonus * smootherStep(60000.0 / (currDeltaTime * 2.0), 300.0, 400.0) *
+                               smootherStep(jumpDistance[i], 100.0, 200.0);
+        }
+
+        wideAngleBonus = calcWideAngleBonus(angle[i]);
+        wideAngleBonus *= 1.0 - std::min(wideAngleBonus, std::pow(calcWideAngleBonus(angle[prev]), 3.0));
+        wideAngleBonus *= angleBonus * smootherStep(jumpDistance[i], 0.0, 100.0);
+
+        wiggleBonus = angleBonus * smootherStep(jumpDistance[i], 50.0, 100.0) *
+                      std::pow(reverseLerp(jumpDistance[i], 300.0, 100.0), 1.8) *
+                      smootherStep(angle[i], 110.0 * (PI / 180.0), 60.0 * (PI / 180.0)) *
+                      smootherStep(jumpDistance[prev], 50.0, 100.0) *
+                      std::pow(reverseLerp(jumpDistance[prev], 300.0, 100.0), 1.8) *
+                      smootherStep(angle[prev], 110.0 * (PI / 180.0), 60.0 * (PI / 180.0));
+
+        f32 distance = vec::length(in.pos[prev] - in.pos[prev2]);
+        if(distance < 1.0) wideAngleBonus *= 1.0 - 0.35 * (1.0 - distance);
+    }
+
+    if(std::max(prevVelocity, currVelocity) != 0.0) {
+        prevVelocity = (jumpDistance[prev] + in.travelDistance[prevPrev]) / prevDeltaTime;
+        currVelocity = (jumpDistance[i] + in.travelDistance[prev]) / currDeltaTime;
+
+        f64 distRatio = smoothstep(std::abs(prevVelocity - currVelocity) / std::max(prevVelocity, currVelocity), 0, 1);
+        f64 overlapVelocityBuff =
+            std::min(125.0 / std::min(currDeltaTime, prevDeltaTime), std::abs(prevVelocity - currVelocity));
+        velocityChangeBonus = overlapVelocityBuff * distRatio *
+                              std::pow(std::min(currDeltaTime, prevDeltaTime) / std::max(currDeltaTime, prevDeltaTime),
+                                       2.0);
+    }
+
+    if(type[prev] == DifficultyHitObject::TYPE::SLIDER) sliderBonus = in.travelDistance[prev] / in.travelTime[prev];
+
+    aimStrain += wiggleBonus * wiggle_multiplier;
+    aimStrain += velocityChangeBonus * velocity_change_multiplier;
+    aimStrain += std::max(acuteAngleBonus * acute_angle_multiplier, wideAngleBonus * wide_angle_multiplier);
+
+    // Apply high circle size bonus
+    aimStrain *= in.smallCircleBonus;
+
+    if(withSliders) aimStrain += sliderBonus * slider_multiplier;
+
+    return aimStrain;
+}
+
+f64 DifficultyCalculator::doubletapness(const StrainInputs &in, const StrainOutputs &out, uSz i, uSz next,
+                                        f64 hitWindow300) {
+    f64 cur_delta = std::max(1.0, out.deltaTime[i]);
+    f64 next_delta = std::max(1, in.time[next] - in.time[i]);  // NOTE: next delta time isn't initialized yet
+    f64 delta_diff = std::abs(next_delta - cur_delta);
+    f64 speedRatio = cur_delta / std::max(cur_delta, delta_diff);
+    f64 windowRatio = std::pow(std::min(1.0, cur_delta / hitWindow300), 2.0);
+
+    return 1.0 - std::pow(speedRatio, 1.0 - windowRatio);
+}
+
+namespace {
+// columnar copy of the per-object values which calculate_difficulty reads.
+// DiffObject is a large record, so every weighting pass (interval peaks, max strain, logistic sums) would otherwise
+// stride across a whole cache line per object just to read a single f64 out of it.
+// gathered once per skill into thread-local storage which keeps its capacity between maps.
+struct StrainColumns {
+    std::vector<f64> times;
+    std::vector<f64> strains;
+    std::vector<f64> sliderStrains;  // -1 for non-sliders, same as DiffObject::get_slider_strain
+
+    void gather(DifficultyCalculator::Skills::Skill type, const DifficultyCalculator::DiffObject *dobjects,
+                uSz count) {
+        times.resize(count);
+        strains.resize(count);
+        sliderStrains.resize(count);
+        for(uSz i = 0; i < count; i++) {
+            const auto &dobj = dobjects[i];
+            const bool slider = dobj.ho->type == DifficultyHitObject::TYPE::SLIDER;
+            const f64 strain = dobj.get_strain(type);
+            times[i] = (f64)dobj.ho->time;
+            strains[i] = strain;
+            sliderStrains[i] = slider ? strain : -1.0;
+        }
+    }
+
+    // same values from the columns calculateStrains works on
+    void gather(DifficultyCalculator::Skills::Skill type, const DifficultyCalculator::StrainInputs &in,
+                const DifficultyCalculator::StrainOutputs &out) {
+        const uSz count = in.size();
+        times.resize(count);
+        strains.resize(count);
+        sliderStrains.resize(count);
+        for(uSz i = 0; i < count; i++) {
+            const bool slider = in.type[i] == DifficultyHitObject::TYPE::SLIDER;
+            const f64 strain =
+                out.strains[type][i] * (type == DifficultyCalculator::Skills::SPEED ? out.rhythm[i] : 1.0);
+            times[i] = (f64)in.time[i];
+            strains[i] = strain;
+            sliderStrains[i] = slider ? strain : -1.0;
+        }
+    }
+};
+
+thread_local StrainColumns strainColumns;
+
+// maximum of a column. same value as *std::max_element for finite input (strains are never NaN),
+// but without a loop-carried dependency on a single accumulator
+f64 columnMax(const f64 *values, uSz count) {
+    uSz i = 0;
+    f64 result = -std::numeric_limits<f64>::infinity();
+#if defined(__AVX2__)
+    if(count >= 8) {
+        __m256d acc0 = _mm256_set1_pd(result), acc1 = acc0;
+        for(; i + 8 <= count; i += 8) {
+            acc0 = _mm256_max_pd(acc0, _mm256_loadu_pd(values + i));
+            acc1 = _mm256_max_pd(acc1, _mm256_loadu_pd(values + i + 4));
+        }
+        alignas(32) f64 lanes[4];
+        _mm256_store_pd(lanes, _mm256_max_pd(acc0, acc1));
+        result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    if(count >= 4) {
+        float64x2_t acc0 = vdupq_n_f64(result), acc1 = acc0;
+        for(; i + 4 <= count; i += 4) {
+            acc0 = vmaxq_f64(acc0, vld1q_f64(values + i));
+            acc1 = vmaxq_f64(acc1, vld1q_f64(values + i + 2));
+        }
+        result = vmaxvq_f64(vmaxq_f64(acc0, acc1));
+    }
+#else
+    if(count >= 4) {
+        f64 acc[4]{result, result, result, result};
+        for(; i + 4 <= count; i += 4) {
+            for(uSz lane = 0; lane < 4; lane++) acc[lane] = std::max(acc[lane], values[i + lane]);
+        }
+        result = std::max(std::max(acc[0], acc[1]), std::max(acc[2], acc[3]));
+    }
+#endif
+    for(; i < count; i++) result = std::max(result, values[i]);
+    return result;
+}
+
+// (old) see https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/Skill.cs
+// (new) see https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/StrainSkill.cs
+constexpr f64 strain_step = 400.0;  // the length of each strain section
+constexpr f64 decay_weight = 0.9;   // max strains are weighted from highest to lowest, and this is how much the weight decays.
+
+constexpr uSz reducedSectionCount = 10;
+constexpr f64 reducedStrainBaseline = 0.75;
+
+uSz getReducedSectionCount(DifficultyCalculator::Skills::Skill type) {
+    switch(type) {
+        case DifficultyCalculator::Skills::NUM_SKILLS:
+            std::unreachable();
+            break;
+        case DifficultyCalculator::Skills::SPEED:
+            return 5;
+        case DifficultyCalculator::Skills::AIM_SLIDERS:
+        case DifficultyCalculator::Skills::AIM_NO_SLIDERS:
+            break;
+    }
+    return reducedSectionCount;
+}
+
+// "We are reducing the highest strains first to account for extreme difficulty spikes"
+f64 getReducedStrainScale(uSz i, uSz skillSpecificReducedSectionCount) {
+    const f64 scale = std::log10(
+        std::lerp(1.0, 10.0, std::clamp<f64>((f64)i / (f64)skillSpecificReducedSectionCount, 0.0, 1.0)));
+    return std::lerp(reducedStrainBaseline, 1.0, scale);
+}
+
+forceinline f64 difficultStrainWeight(f64 strain, f64 consistentTopStrain) {
+    return 1.1 / (1.0 + std::exp(-10.0 * (strain / consistentTopStrain - 0.88)));
+}
+
+// -d/dc difficultStrainWeight(strain, c) * c, i.e. how much the weight drops per relative increase of c
+forceinline f64 difficultStrainWeightSlope(f64 strain, f64 consistentTopStrain, f64 weight) {
+    return 10.0 * weight * (1.0 - weight / 1.1) * (strain / consistentTopStrain);
+}
+
+forceinline f64 relevantStrainWeight(f64 strain, f64 maxStrain) {
+    return 1.0 / (1.0 + std::exp(-((strain / maxStrain * 12.0) - 6.0)));
+}
+
+// weighs the strains of one skill, see calculate_difficulty
+f64 weighStrainColumns(const DifficultyCalculator::Skills::Skill type, const StrainColumns &cols, uSz dobjectCount,
+                       std::vector<f64> *outStrains, DifficultyCalculator::DifficultyAttributes *outAttributes) {
+    using Skills = DifficultyCalculator::Skills;
+    const f64 *times = cols.times.data();
+    const f64 *strains = cols.strains.data();
+    const f64 *sliderStrainCol = cols.sliderStrains.data();
+
+    f64 interval_end = std::ceil(times[0] / strain_step) * strain_step;
+    f64 max_strain = 0.0;
 
     std::vector<f64> highestStrains;
-    std::vector<f64> *highestStrainsRef = incremental ? &incremental->highest_strains : &highestStrains;
-    std::vector<f64> sliderStrains;
-    std::vector<f64> *sliderStrainsRef = incremental ? &incremental->slider_strains : &sliderStrains;
-    for(uSz i = (incremental ? dobjectCount - 1 : 0); i < dobjectCount; i++) {
-        const DiffObject &cur = dobjects[i];
-        const DiffObject &prev = dobjects[i > 0 ? i - 1 : i];
+    for(uSz i = 0; i < dobjectCount; i++) {
+        const uSz prevIdx = i > 0 ? i - 1 : i;
 
         // make previous peak strain decay until the current object
-        while(cur.ho->time > interval_end) {
-            if(incremental)
-                highestStrainsRef->insert(std::ranges::upper_bound(*highestStrainsRef, max_strain), max_strain);
-            else
-                highestStrainsRef->push_back(max_strain);
+        while(times[i] > interval_end) {
+            highestStrains.push_back(max_strain);
 
             // skip calculating strain decay for very long breaks (e.g. beatmap upload size limit hack diffs)
             // strainDecay with a base of 0.3 at 60 seconds is 4.23911583e-32, well below any meaningful difference even after being multiplied by object strain
-            f64 strainDelta = interval_end - (f64)prev.ho->time;
+            f64 strainDelta = interval_end - times[prevIdx];
             if(i < 1 || strainDelta > 600000.0)  // !prev
                 max_strain = 0.0;
             else
-                max_strain = prev.get_strain(type) * strainDecay(type, strainDelta);
+                max_strain = strains[prevIdx] * DifficultyCalculator::DiffObject::strainDecay(type, strainDelta);
 
             interval_end += strain_step;
         }
 
         // calculate max strain for this interval
-        f64 cur_strain = cur.get_strain(type);
-        max_strain = std::max(max_strain, cur_strain);
-
-        // NOTE: this is done in StrainValueAt in lazer's code, but doing it here is more convenient for the incremental case
-        if(type == Skills::AIM_SLIDERS && cur.ho->type == DifficultyHitObject::TYPE::SLIDER)
-            sliderStrainsRef->push_back(cur_strain);
+        max_strain = std::max(max_strain, strains[i]);
     }
 
     // the peak strain will not be saved for the last section in the above loop
-    if(incremental) {
-        incremental->interval_end = interval_end;
-        incremental->max_strain = max_strain;
-        highestStrains.reserve(incremental->highest_strains.size() + 1);  // required so insert call doesn't reallocate
-        highestStrains = incremental->highest_strains;
-        highestStrains.insert(std::ranges::upper_bound(highestStrains, max_strain), max_strain);
-    } else
-        highestStrains.push_back(max_strain);
+    highestStrains.push_back(max_strain);
 
     if(outStrains != nullptr) (*outStrains) = highestStrains;  // save a copy
 
@@ -1410,88 +1997,31 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
         if(type == Skills::SPEED) {
             // calculate relevant speed note count
             // RelevantNoteCount @ https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Speed.cs
-            static constexpr auto compareDiffObjects = +[](const DiffObject &x, const DiffObject &y) -> bool {
-                return (x.get_strain(Skills::SPEED) < y.get_strain(Skills::SPEED));
-            };
-
-            f64 maxObjectStrain;
-            {
-                if(incremental)
-                    maxObjectStrain =
-                        std::max(incremental->max_object_strain, dobjects[dobjectCount - 1].get_strain(type));
-                else
-                    maxObjectStrain =
-                        (*std::max_element(dobjects, dobjects + dobjectCount, compareDiffObjects)).get_strain(type);
-            }
+            const f64 maxObjectStrain = columnMax(strains, dobjectCount);
 
             if(maxObjectStrain == 0.0)
                 outAttributes->SpeedNoteCount = 0.0;
             else {
                 f64 tempSum = 0.0;
-                if(incremental && std::abs(incremental->max_object_strain - maxObjectStrain) < DIFFCALC_EPSILON) {
-                    incremental->speed_note_count +=
-                        1.0 / (1.0 + std::exp(-((dobjects[dobjectCount - 1].get_strain(type) / maxObjectStrain * 12.0) -
-                                                6.0)));
-                    tempSum = incremental->speed_note_count;
-                } else {
-                    for(uSz i = 0; i < dobjectCount; i++) {
-                        tempSum +=
-                            1.0 / (1.0 + std::exp(-((dobjects[i].get_strain(type) / maxObjectStrain * 12.0) - 6.0)));
-                    }
-
-                    if(incremental) {
-                        incremental->max_object_strain = maxObjectStrain;
-                        incremental->speed_note_count = tempSum;
-                    }
+                for(uSz i = 0; i < dobjectCount; i++) {
+                    tempSum += relevantStrainWeight(strains[i], maxObjectStrain);
                 }
                 outAttributes->SpeedNoteCount = tempSum;
             }
         } else if(type == Skills::AIM_SLIDERS) {
             // calculate difficult sliders
             // GetDifficultSliders @ https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Aim.cs
-            static constexpr auto compareSliderObjects = +[](const DiffObject &x, const DiffObject &y) -> bool {
-                return (x.get_slider_strain(Skills::AIM_SLIDERS) < y.get_slider_strain(Skills::AIM_SLIDERS));
-            };
+            const f64 maxSliderStrain = columnMax(sliderStrainCol, dobjectCount);
 
-            if(incremental && dobjects[dobjectCount - 1].ho->type != DifficultyHitObject::TYPE::SLIDER)
-                outAttributes->AimDifficultSliderCount = incremental->aim_difficult_slider_count;
+            if(maxSliderStrain <= 0.0)
+                outAttributes->AimDifficultSliderCount = 0.0;
             else {
-                f64 maxSliderStrain;
-                f64 curSliderStrain = incremental ? dobjects[dobjectCount - 1].strains[Skills::AIM_SLIDERS] : 0.0;
-                {
-                    if(incremental) {
-                        incremental->slider_strains.push_back(curSliderStrain);
-                        maxSliderStrain = std::max(incremental->max_slider_strain, curSliderStrain);
-                    } else
-                        maxSliderStrain = (*std::max_element(dobjects, dobjects + dobjectCount, compareSliderObjects))
-                                              .get_slider_strain(Skills::AIM_SLIDERS);
-                }
-
-                if(maxSliderStrain <= 0.0)
-                    outAttributes->AimDifficultSliderCount = 0.0;
-                else {
-                    f64 tempSum = 0.0;
-                    if(incremental && std::abs(incremental->max_slider_strain - maxSliderStrain) < DIFFCALC_EPSILON) {
-                        incremental->aim_difficult_slider_count +=
-                            1.0 / (1.0 + std::exp(-((curSliderStrain / maxSliderStrain * 12.0) - 6.0)));
-                        tempSum = incremental->aim_difficult_slider_count;
-                    } else {
-                        if(incremental) {
-                            for(f64 slider_strain : incremental->slider_strains) {
-                                tempSum += 1.0 / (1.0 + std::exp(-((slider_strain / maxSliderStrain * 12.0) - 6.0)));
-                            }
-                            incremental->max_slider_strain = maxSliderStrain;
-                            incremental->aim_difficult_slider_count = tempSum;
-                        } else {
-                            for(uSz i = 0; i < dobjectCount; i++) {
-                                f64 sliderStrain = dobjects[i].get_slider_strain(Skills::AIM_SLIDERS);
-                                if(sliderStrain >= 0.0)
-                                    tempSum += 1.0 / (1.0 + std::exp(-((sliderStrain / maxSliderStrain * 12.0) - 6.0)));
-                            }
-                        }
-                    }
-                    outAttributes->AimDifficultSliderCount = tempSum;
+                f64 tempSum = 0.0;
+                for(uSz i = 0; i < dobjectCount; i++) {
+                    f64 sliderStrain = sliderStrainCol[i];
+                    if(sliderStrain >= 0.0) tempSum += relevantStrainWeight(sliderStrain, maxSliderStrain);
                 }
+                outAttributes->AimDifficultSliderCount = tempSum;
             }
         }
     }
@@ -1500,9 +2030,6 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
     // (new) see DifficultyValue() @ https://github.com/ppy/osu/blob/master/osu.Game/Rulesets/Difficulty/Skills/StrainSkill.cs
     // (new) see DifficultyValue() @ https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/OsuStrainSkill.cs
 
-    static constexpr uSz reducedSectionCount = 10;
-    static constexpr f64 reducedStrainBaseline = 0.75;
-
     f64 difficulty = 0.0;
     f64 weight = 1.0;
 
@@ -1510,32 +2037,17 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
     {
         // new implementation
         // NOTE: lazer does this from highest to lowest, but sorting it in reverse lets the reduced top section loop below have a better average insertion time
-        if(!incremental) SPREADSORT_RANGE(highestStrains);
+        SPREADSORT_RANGE(highestStrains);
     }
 
     // new implementation (https://github.com/ppy/osu/pull/13483/)
     {
-        uSz skillSpecificReducedSectionCount = reducedSectionCount;
-        {
-            switch(type) {
-                case Skills::NUM_SKILLS:
-                    std::unreachable();
-                    break;
-                case Skills::SPEED:
-                    skillSpecificReducedSectionCount = 5;
-                    break;
-                case Skills::AIM_SLIDERS:
-                case Skills::AIM_NO_SLIDERS:
-                    break;
-            }
-        }
+        const uSz skillSpecificReducedSectionCount = getReducedSectionCount(type);
 
         // "We are reducing the highest strains first to account for extreme difficulty spikes"
         uSz actualReducedSectionCount = std::min(highestStrains.size(), skillSpecificReducedSectionCount);
         for(uSz i = 0; i < actualReducedSectionCount; i++) {
-            const f64 scale = std::log10(
-                std::lerp(1.0, 10.0, std::clamp<f64>((f64)i / (f64)skillSpecificReducedSectionCount, 0.0, 1.0)));
-            highestStrains[highestStrains.size() - i - 1] *= std::lerp(reducedStrainBaseline, 1.0, scale);
+            highestStrains[highestStrains.size() - i - 1] *= getReducedStrainScale(i, skillSpecificReducedSectionCount);
         }
 
         // re-sort
@@ -1553,7 +2065,7 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
             f64 last = difficulty;
             difficulty += highestStrains[highestStrains.size() - i - 1] * weight;
             weight *= decay_weight;
-            if(std::abs(difficulty - last) < DIFFCALC_EPSILON) break;
+            if(std::abs(difficulty - last) < DifficultyCalculator::DIFFCALC_EPSILON) break;
         }
     }
 
@@ -1572,33 +2084,11 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
             f64 tempSliderSum = 0.0;
             f64 consistentTopStrain = difficulty / 10.0;
 
-            if(incremental && std::abs(incremental->consistent_top_strain - consistentTopStrain) < DIFFCALC_EPSILON) {
-                incremental->difficult_strains +=
-                    1.1 / (1.0 + std::exp(-10.0 *
-                                          (dobjects[dobjectCount - 1].get_strain(type) / consistentTopStrain - 0.88)));
-                tempTotalSum = incremental->difficult_strains;
-
-                f64 sliderStrain = dobjects[dobjectCount - 1].get_slider_strain(type);
-                if(sliderStrain >= 0) {
-                    incremental->top_weighted_sliders +=
-                        1.1 / (1.0 + std::exp(-10.0 * (sliderStrain / consistentTopStrain - 0.88)));
-                }
-                tempSliderSum = incremental->top_weighted_sliders;
-            } else {
-                for(uSz i = 0; i < dobjectCount; i++) {
-                    tempTotalSum +=
-                        1.1 / (1.0 + std::exp(-10.0 * (dobjects[i].get_strain(type) / consistentTopStrain - 0.88)));
-
-                    f64 sliderStrain = dobjects[i].get_slider_strain(type);
-                    if(sliderStrain >= 0)
-                        tempSliderSum += 1.1 / (1.0 + std::exp(-10.0 * (sliderStrain / consistentTopStrain - 0.88)));
-                }
+            for(uSz i = 0; i < dobjectCount; i++) {
+                tempTotalSum += difficultStrainWeight(strains[i], consistentTopStrain);
 
-                if(incremental) {
-                    incremental->consistent_top_strain = consistentTopStrain;
-                    incremental->difficult_strains = tempTotalSum;
-                    incremental->top_weighted_sliders = tempSliderSum;
-                }
+                f64 sliderStrain = sliderStrainCol[i];
+                if(sliderStrain >= 0) tempSliderSum += difficultStrainWeight(sliderStrain, consistentTopStrain);
             }
 
             difficultStrainCount = tempTotalSum;
@@ -1609,332 +2099,268 @@ f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill t
     return difficulty;
 }
 
-thread_local std::vector<std::pair<DifficultyCalculator::RhythmIsland, int>> DifficultyCalculator::islandCounts;
-// new implementation, Xexxar, (ppv2.1), see https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/
-f64 DifficultyCalculator::DiffObject::spacing_weight2(const Skills::Skill diff_type, const DiffObject &prev,
-                                                      const DiffObject *next, f64 hitWindow300, bool autopilotNerf) {
-    static constexpr f64 single_spacing_threshold = 125.0;
-
-    static constexpr f64 min_speed_bonus = 75.0; /* ~200BPM 1/4 streams */
-    static constexpr f64 speed_balancing_factor = 40.0;
-    static constexpr f64 distance_multiplier = 0.8;
-
-    static constexpr i32 history_time_max = 5000;
-    static constexpr i32 history_objects_max = 32;
-    static constexpr f64 rhythm_overall_multiplier = 1.0;
-    static constexpr f64 rhythm_ratio_multiplier = 15.0;
-
-    //f64 angle_bonus = 1.0; // (apparently unused now in lazer?)
-
-    switch(diff_type) {
-        case Skills::NUM_SKILLS:
-            std::unreachable();
-            break;
-        case Skills::SPEED: {
-            // see https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Speed.cs
-            if(ho->type == DifficultyHitObject::TYPE::SPINNER) {
-                raw_speed_strain = 0.0;
-                rhythm = 0.0;
-
-                return 0.0;
-            }
-
-            // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/SpeedEvaluator.cs
-            const f64 distance = std::min(single_spacing_threshold, prev.travelDistance + minJumpDistance);
-
-            f64 adjusted_delta_time = this->adjusted_delta_time;
-            adjusted_delta_time /= std::clamp<f64>((adjusted_delta_time / hitWindow300) / 0.93, 0.92, 1.0);
-
-            f64 doubletapness = 1.0 - get_doubletapness(next, hitWindow300);
+}  // namespace
 
-            f64 speed_bonus = 0.0;
-            if(adjusted_delta_time < min_speed_bonus)
-                speed_bonus = 0.75 * std::pow((min_speed_bonus - adjusted_delta_time) / speed_balancing_factor, 2.0);
+f64 DifficultyCalculator::DiffObject::calculate_difficulty(const Skills::Skill type, const DiffObject *dobjects,
+                                                           uSz dobjectCount, IncrementalState *incremental,
+                                                           std::vector<f64> *outStrains,
+                                                           DifficultyAttributes *outAttributes) {
+    if(incremental) {
+        return calculate_difficulty_incremental(type, dobjects, dobjectCount, *incremental, outStrains, outAttributes);
+    }
 
-            f64 distance_bonus =
-                autopilotNerf ? 0.0 : std::pow(distance / single_spacing_threshold, 3.95) * distance_multiplier;
+    if(dobjectCount < 1) return 0.0;
 
-            // Apply reduced small circle bonus because flow aim difficulty on small circles doesn't scale as hard as jumps
-            distance_bonus *= std::sqrt(smallCircleBonus);
+    StrainColumns &cols = strainColumns;
+    cols.gather(type, dobjects, dobjectCount);
+    return weighStrainColumns(type, cols, dobjectCount, outStrains, outAttributes);
+}
 
-            raw_speed_strain = (1.0 + speed_bonus + distance_bonus) * 1000.0 * doubletapness / adjusted_delta_time;
+f64 DifficultyCalculator::calculateStarDiffForStrainData(const StrainData &data, const BeatmapDiffcalcData &beatmapData,
+                                                        DifficultyAttributes &outAttributes) {
+    const StrainInputs &inputs = data.inputs;
+    const uSz numObjects = inputs.size();
 
-            // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/RhythmEvaluator.cs
-            f64 rhythmComplexitySum = 0;
+    // same special case as calculateStarDiffForHitObjects
+    if(numObjects < 2) {
+        if(numObjects < 1) return 0.0;
+        if(inputs.type[0] != DifficultyHitObject::TYPE::SLIDER) return 0.0;
+    }
 
-            const f64 deltaDifferenceEpsilon = hitWindow300 * 0.3;
+    const f64 hitWindow300 =
+        2.0 * adjustHitWindow(GameRules::odTo300HitWindowMS(beatmapData.OD)) / beatmapData.speedMultiplier;
+
+    StrainOutputs &outputs = strainOutputs;
+    calculateStrains(inputs, hitWindow300, beatmapData.autopilot, outputs);
+
+    const f64 stars = rateSkills(
+        [&](Skills::Skill skill, std::vector<f64> *outStrains, DifficultyAttributes *skillAttributes) {
+            StrainColumns &cols = strainColumns;
+            cols.gather(skill, inputs, outputs);
+            return weighStrainColumns(skill, cols, numObjects, outStrains, skillAttributes);
+        },
+        numObjects, beatmapData, outAttributes, false, nullptr, nullptr, nullptr);
+
+    // Scorev1, from the totals calculateScoreV1Attributes saved
+    const i32 multiplier = calculateLegacyScoreBaseMultiplier(beatmapData.CS, beatmapData.HP, beatmapData.OD,
+                                                              numObjects, data.breakDuration, data.playableLength);
+    outAttributes.LegacyScoreBaseMultiplier = multiplier;
+    outAttributes.NestedScorePerObject = data.nestedScore / (f64)std::max<uSz>(numObjects, 1);
+    // every term of the per-object sum is an integer, so this is the same as summing them one by one
+    outAttributes.MaximumLegacyComboScore = (u32)(data.comboSum * (u64)(300 / 25 * multiplier));
+
+    return stars;
+}
 
-            RhythmIsland island{INT_MAX, 0};
-            RhythmIsland previousIsland{INT_MAX, 0};
+f64 DifficultyCalculator::DiffObject::calculate_difficulty_incremental(const Skills::Skill type,
+                                                                       const DiffObject *dobjects, uSz dobjectCount,
+                                                                       IncrementalState &inc,
+                                                                       std::vector<f64> *outStrains,
+                                                                       DifficultyAttributes *outAttributes) {
+    // same calculation as calculate_difficulty, but only folds in the objects in [inc.processed_count, dobjectCount)
 
-            DifficultyCalculator::islandCounts.clear();
+    if(dobjectCount < inc.processed_count) inc = {};  // seeked backwards
+    if(dobjectCount < 1) return 0.0;
 
-            f64 startRatio = 0.0;  // store the ratio of the current start of an island to buff for tighter rhythms
+    const uSz firstNew = inc.processed_count;
+    if(firstNew == 0) {
+        inc.interval_end = std::ceil((f64)dobjects[0].ho->time / strain_step) * strain_step;
+        inc.max_strain = 0.0;
+    }
 
-            bool firstDeltaSwitch = false;
+    inc.object_strains.reserve(dobjectCount);
+    inc.object_slider_strains.reserve(dobjectCount);
 
-            i32 historicalNoteCount = std::min(prevObjectIndex, history_objects_max);
+    f64 newMaxObjectStrain = inc.max_object_strain;
+    f64 newMaxSliderStrain = inc.max_slider_strain;
 
-            i32 rhythmStart = 0;
+    for(uSz i = firstNew; i < dobjectCount; i++) {
+        const DiffObject &cur = dobjects[i];
+        const f64 time = (f64)cur.ho->time;
+        const f64 strain = cur.get_strain(type);
+        const bool slider = cur.ho->type == DifficultyHitObject::TYPE::SLIDER;
 
-            while(rhythmStart < historicalNoteCount - 2 &&
-                  ho->time - get_previous(rhythmStart)->ho->time < history_time_max) {
-                rhythmStart++;
+        // make previous peak strain decay until the current object
+        while(time > inc.interval_end) {
+            inc.highest_strains.insert(
+                std::upper_bound(inc.highest_strains.begin(), inc.highest_strains.end(), inc.max_strain),
+                inc.max_strain);
+
+            // skip calculating strain decay for very long breaks (see calculate_difficulty)
+            if(i < 1) {
+                inc.max_strain = 0.0;
+            } else {
+                const f64 strainDelta = inc.interval_end - (f64)dobjects[i - 1].ho->time;
+                inc.max_strain =
+                    strainDelta > 600000.0 ? 0.0 : inc.object_strains[i - 1] * strainDecay(type, strainDelta);
             }
 
-            const DiffObject *prevObj = get_previous(rhythmStart);
-            const DiffObject *lastObj = get_previous(rhythmStart + 1);
-
-            for(i32 i = rhythmStart; i > 0; i--) {
-                const DiffObject *currObj = get_previous(i - 1);
-
-                // scales note 0 to 1 from history to now
-                f64 timeDecay = (history_time_max - (ho->time - currObj->ho->time)) / (f64)history_time_max;
-                f64 noteDecay = (f64)(historicalNoteCount - i) / historicalNoteCount;
-
-                f64 currHistoricalDecay =
-                    std::min(noteDecay, timeDecay);  // either we're limited by time or limited by object count.
-
-                f64 currDelta = std::max(currObj->delta_time, 1e-7);
-                f64 prevDelta = std::max(prevObj->delta_time, 1e-7);
-                f64 lastDelta = std::max(lastObj->delta_time, 1e-7);
-
-                // calculate how much current delta difference deserves a rhythm bonus
-                // this function is meant to reduce rhythm bonus for deltas that are multiples of each other (i.e 100 and 200)
-                f64 deltaDifference = std::max(prevDelta, currDelta) / std::min(prevDelta, currDelta);
-
-                // Take only the fractional part of the value since we're only interested in punishing multiples
-                f64 deltaDifferenceFraction = deltaDifference - std::trunc(deltaDifference);
-
-                f64 currRatio =
-                    1.0 + rhythm_ratio_multiplier * std::min(0.5, smoothstepBellCurve(deltaDifferenceFraction));
-
-                // reduce ratio bonus if delta difference is too big
-                f64 differenceMultiplier = std::clamp<f64>(2.0 - deltaDifference / 8.0, 0.0, 1.0);
-
-                f64 windowPenalty =
-                    std::min(1.0, std::max(0.0, std::abs(prevDelta - currDelta) - deltaDifferenceEpsilon) /
-                                      deltaDifferenceEpsilon);
-
-                f64 effectiveRatio = windowPenalty * currRatio * differenceMultiplier;
-
-                if(firstDeltaSwitch) {
-                    if(std::abs(prevDelta - currDelta) < deltaDifferenceEpsilon) {
-                        // island is still progressing
-                        if(island.delta == INT_MAX) {
-                            island.delta = std::max((i32)currDelta, 25);
-                        }
-                        island.deltaCount++;
-                    } else {
-                        if(currObj->ho->type ==
-                           DifficultyHitObject::TYPE::SLIDER)  // bpm change is into slider, this is easy acc window
-                            effectiveRatio *= 0.125;
-
-                        if(prevObj->ho->type ==
-                           DifficultyHitObject::TYPE::
-                               SLIDER)  // bpm change was from a slider, this is easier typically than circle -> circle
-                            effectiveRatio *= 0.3;
-
-                        if(island.deltaCount % 2 ==
-                           previousIsland.deltaCount % 2)  // repeated island polarity (2 -> 4, 3 -> 5)
-                            effectiveRatio *= 0.5;
-
-                        if(lastDelta > prevDelta + deltaDifferenceEpsilon &&
-                           prevDelta >
-                               currDelta +
-                                   deltaDifferenceEpsilon)  // previous increase happened a note ago, 1/1->1/2-1/4, dont want to buff this.
-                            effectiveRatio *= 0.125;
-
-                        if(previousIsland.deltaCount ==
-                           island.deltaCount)  // repeated island size (ex: triplet -> triplet)
-                            effectiveRatio *= 0.5;
-
-                        std::pair<RhythmIsland, int> *islandCount = nullptr;
-                        for(auto &i : DifficultyCalculator::islandCounts) {
-                            if(i.first.equals(island, deltaDifferenceEpsilon)) {
-                                islandCount = &i;
-                                break;
-                            }
-                        }
-
-                        if(islandCount != nullptr) {
-                            // only add island to island counts if they're going one after another
-                            if(previousIsland.equals(island, deltaDifferenceEpsilon)) islandCount->second++;
-
-                            // repeated island (ex: triplet -> triplet)
-                            static constexpr f64 E = 2.7182818284590451;
-                            f64 power = 2.75 / (1.0 + std::pow(E, 14.0 - (0.24 * island.delta)));
-                            effectiveRatio *=
-                                std::min(3.0 / islandCount->second, std::pow(1.0 / islandCount->second, power));
-                        } else {
-                            DifficultyCalculator::islandCounts.emplace_back(island, 1);
-                        }
-
-                        // scale down the difficulty if the object is doubletappable
-                        f64 doubletapness = prevObj->get_doubletapness(currObj, hitWindow300);
-                        effectiveRatio *= 1.0 - doubletapness * 0.75;
-
-                        rhythmComplexitySum += std::sqrt(effectiveRatio * startRatio) * currHistoricalDecay;
+            inc.interval_end += strain_step;
+        }
 
-                        startRatio = effectiveRatio;
+        // calculate max strain for this interval
+        inc.max_strain = std::max(inc.max_strain, strain);
 
-                        previousIsland = island;
+        inc.object_strains.push_back(strain);
+        inc.object_slider_strains.push_back(slider ? strain : -1.0);
 
-                        if(prevDelta + deltaDifferenceEpsilon < currDelta)  // we're slowing down, stop counting
-                            firstDeltaSwitch =
-                                false;  // if we're speeding up, this stays true and  we keep counting island size.
+        newMaxObjectStrain = std::max(newMaxObjectStrain, strain);
+        if(slider) newMaxSliderStrain = std::max(newMaxSliderStrain, strain);
+    }
 
-                        island = RhythmIsland{std::max((i32)currDelta, 25), 1};
-                    }
-                } else if(prevDelta > currDelta + deltaDifferenceEpsilon)  // we want to be speeding up.
-                {
-                    // Begin counting island until we change speed again.
-                    firstDeltaSwitch = true;
+    inc.processed_count = dobjectCount;
 
-                    if(currObj->ho->type ==
-                       DifficultyHitObject::TYPE::SLIDER)  // bpm change is into slider, this is easy acc window
-                        effectiveRatio *= 0.6;
+    const f64 *strains = inc.object_strains.data();
+    const f64 *sliderStrainCol = inc.object_slider_strains.data();
 
-                    if(prevObj->ho->type ==
-                       DifficultyHitObject::TYPE::
-                           SLIDER)  // bpm change was from a slider, this is easier typically than circle -> circle
-                        effectiveRatio *= 0.6;
+    // the peak strain of the last (unfinished) section is only included temporarily
+    const auto pendingSection = inc.highest_strains.insert(
+        std::upper_bound(inc.highest_strains.begin(), inc.highest_strains.end(), inc.max_strain), inc.max_strain);
+    const auto pendingIndex = pendingSection - inc.highest_strains.begin();
 
-                    startRatio = effectiveRatio;
+    if(outStrains != nullptr) outStrains->assign(inc.highest_strains.begin(), inc.highest_strains.end());
 
-                    island = RhythmIsland{std::max((i32)currDelta, 25), 1};
+    if(outAttributes) {
+        if(type == Skills::SPEED) {
+            // calculate relevant speed note count
+            // RelevantNoteCount @ https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Speed.cs
+            if(newMaxObjectStrain == 0.0)
+                inc.speed_note_count = 0.0;
+            else if(firstNew > 0 && std::abs(inc.max_object_strain - newMaxObjectStrain) < DIFFCALC_EPSILON) {
+                for(uSz i = firstNew; i < dobjectCount; i++) {
+                    inc.speed_note_count += relevantStrainWeight(strains[i], newMaxObjectStrain);
                 }
-
-                lastObj = prevObj;
-                prevObj = currObj;
-            }
-
-            // produces multiplier that can be applied to strain. range [1, infinity) (not really though)
-            rhythm = (std::sqrt(4.0 + rhythmComplexitySum * rhythm_overall_multiplier) / 2.0) *
-                     (1.0 - get_doubletapness(get_next(0), hitWindow300));
-
-            DifficultyCalculator::islandCounts.clear();
-            return raw_speed_strain;
-        } break;
-
-        case Skills::AIM_SLIDERS:
-        case Skills::AIM_NO_SLIDERS: {
-            // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Evaluators/AimEvaluator.cs
-            static constexpr f64 wide_angle_multiplier = 1.5;
-            static constexpr f64 acute_angle_multiplier = 2.55;
-            static constexpr f64 slider_multiplier = 1.35;
-            static constexpr f64 velocity_change_multiplier = 0.75;
-            static constexpr f64 wiggle_multiplier = 1.02;
-
-            const bool withSliders = (diff_type == Skills::AIM_SLIDERS);
-
-            if(ho->type == DifficultyHitObject::TYPE::SPINNER || prevObjectIndex <= 1 ||
-               prev.ho->type == DifficultyHitObject::TYPE::SPINNER)
-                return 0.0;
-
-            static constexpr auto calcWideAngleBonus =
-                +[](f64 angle) { return smoothstep(angle, 40.0 * (PI / 180.0), 140.0 * (PI / 180.0)); };
-            static constexpr auto calcAcuteAngleBonus =
-                +[](f64 angle) { return smoothstep(angle, 140.0 * (PI / 180.0), 40.0 * (PI / 180.0)); };
-
-            const DiffObject *prevPrev = get_previous(1);
-            const DiffObject *prev2 = get_previous(2);
-
-            f64 currVelocity = jumpDistance / adjusted_delta_time;
-
-            if(prev.ho->type == DifficultyHitObject::TYPE::SLIDER && withSliders) {
-                f64 travelVelocity = prev.travelDistance / prev.travelTime;
-                f64 movementVelocity = minJumpDistance / minJumpTime;
-                currVelocity = std::max(currVelocity, movementVelocity + travelVelocity);
-            }
-            f64 aimStrain = currVelocity;
-
-            f64 prevVelocity = prev.jumpDistance / prev.adjusted_delta_time;
-            if(prevPrev->ho->type == DifficultyHitObject::TYPE::SLIDER && withSliders) {
-                f64 travelVelocity = prevPrev->travelDistance / prevPrev->travelTime;
-                f64 movementVelocity = prev.minJumpDistance / prev.minJumpTime;
-                prevVelocity = std::max(prevVelocity, movementVelocity + travelVelocity);
+            } else {
+                f64 tempSum = 0.0;
+                for(uSz i = 0; i < dobjectCount; i++) {
+                    tempSum += relevantStrainWeight(strains[i], newMaxObjectStrain);
+                }
+                inc.speed_note_count = tempSum;
             }
-
-            f64 wideAngleBonus = 0;
-            f64 acuteAngleBonus = 0;
-            f64 sliderBonus = 0;
-            f64 velocityChangeBonus = 0;
-            f64 wiggleBonus = 0;
-
-            if(!std::isnan(angle) && !std::isnan(prev.angle)) {
-                f64 angleBonus = std::min(currVelocity, prevVelocity);
-
-                if(std::max(adjusted_delta_time, prev.adjusted_delta_time) <
-                   1.25 * std::min(adjusted_delta_time, prev.adjusted_delta_time)) {
-                    acuteAngleBonus = calcAcuteAngleBonus(angle);
-                    acuteAngleBonus *=
-                        0.08 + 0.92 * (1.0 - std::min(acuteAngleBonus, std::pow(calcAcuteAngleBonus(prev.angle), 3.0)));
-                    acuteAngleBonus *= angleBonus * smootherStep(60000.0 / (adjusted_delta_time * 2.0), 300.0, 400.0) *
-                                       smootherStep(jumpDistance, 100.0, 200.0);
+            outAttributes->SpeedNoteCount = inc.speed_note_count;
+        } else if(type == Skills::AIM_SLIDERS) {
+            // calculate difficult sliders
+            // GetDifficultSliders @ https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Aim.cs
+            if(newMaxSliderStrain <= 0.0)
+                inc.aim_difficult_slider_count = 0.0;
+            else if(firstNew > 0 && std::abs(inc.max_slider_strain - newMaxSliderStrain) < DIFFCALC_EPSILON) {
+                for(uSz i = firstNew; i < dobjectCount; i++) {
+                    if(sliderStrainCol[i] >= 0.0)
+                        inc.aim_difficult_slider_count += relevantStrainWeight(sliderStrainCol[i], newMaxSliderStrain);
                 }
-
-                wideAngleBonus = calcWideAngleBonus(angle);
-                wideAngleBonus *= 1.0 - std::min(wideAngleBonus, pow(calcWideAngleBonus(prev.angle), 3.0));
-                wideAngleBonus *= angleBonus * smootherStep(jumpDistance, 0.0, 100.0);
-
-                wiggleBonus = angleBonus * smootherStep(jumpDistance, 50.0, 100.0) *
-                              pow(reverseLerp(jumpDistance, 300.0, 100.0), 1.8) *
-                              smootherStep(angle, 110.0 * (PI / 180.0), 60.0 * (PI / 180.0)) *
-                              smootherStep(prev.jumpDistance, 50.0, 100.0) *
-                              pow(reverseLerp(prev.jumpDistance, 300.0, 100.0), 1.8) *
-                              smootherStep(prev.angle, 110.0 * (PI / 180.0), 60.0 * (PI / 180.0));
-
-                if(prev2 != nullptr) {
-                    f32 distance = vec::length(prev.ho->pos - prev2->ho->pos);
-                    if(distance < 1.0) wideAngleBonus *= 1.0 - 0.35 * (1.0 - distance);
+            } else {
+                f64 tempSum = 0.0;
+                for(uSz i = 0; i < dobjectCount; i++) {
+                    if(sliderStrainCol[i] >= 0.0) tempSum += relevantStrainWeight(sliderStrainCol[i], newMaxSliderStrain);
                 }
+                inc.aim_difficult_slider_count = tempSum;
             }
+            outAttributes->AimDifficultSliderCount = inc.aim_difficult_slider_count;
+        }
+    }
+    inc.max_object_strain = newMaxObjectStrain;
+    inc.max_slider_strain = newMaxSliderStrain;
+
+    // weigh the top strains, same as calculate_difficulty but walking the sorted sections from the top instead of
+    // sorting them every time. the weighing loop stops once the weight makes contributions negligible, so this only
+    // ever looks at a bounded number of the highest sections
+    f64 difficulty = 0.0;
+    {
+        const uSz skillSpecificReducedSectionCount = getReducedSectionCount(type);
+        const uSz actualReducedSectionCount = std::min(inc.highest_strains.size(), skillSpecificReducedSectionCount);
 
-            if(std::max(prevVelocity, currVelocity) != 0.0) {
-                prevVelocity = (prev.jumpDistance + prevPrev->travelDistance) / prev.adjusted_delta_time;
-                currVelocity = (jumpDistance + prev.travelDistance) / adjusted_delta_time;
-
-                f64 distRatio =
-                    smoothstep(std::abs(prevVelocity - currVelocity) / std::max(prevVelocity, currVelocity), 0, 1);
-                f64 overlapVelocityBuff = std::min(125.0 / std::min(adjusted_delta_time, prev.adjusted_delta_time),
-                                                   std::abs(prevVelocity - currVelocity));
-                velocityChangeBonus = overlapVelocityBuff * distRatio *
-                                      std::pow(std::min(adjusted_delta_time, prev.adjusted_delta_time) /
-                                                   std::max(adjusted_delta_time, prev.adjusted_delta_time),
-                                               2.0);
+        f64 reducedSections[reducedSectionCount];
+        auto it = inc.highest_strains.rbegin();
+        for(uSz i = 0; i < actualReducedSectionCount; i++, ++it) {
+            reducedSections[i] = *it * getReducedStrainScale(i, skillSpecificReducedSectionCount);
+        }
+        // highest first
+        std::sort(reducedSections, reducedSections + actualReducedSectionCount, std::greater{});
+
+        f64 weight = 1.0;
+        uSz r = 0;
+        while(r < actualReducedSectionCount || it != inc.highest_strains.rend()) {
+            // on ties the reduced section goes first, like re-inserting it with upper_bound
+            f64 strain;
+            if(it == inc.highest_strains.rend() || (r < actualReducedSectionCount && reducedSections[r] >= *it)) {
+                strain = reducedSections[r++];
+            } else {
+                strain = *it++;
             }
 
-            if(prev.ho->type == DifficultyHitObject::TYPE::SLIDER) sliderBonus = prev.travelDistance / prev.travelTime;
+            f64 last = difficulty;
+            difficulty += strain * weight;
+            weight *= decay_weight;
+            if(std::abs(difficulty - last) < DIFFCALC_EPSILON) break;
+        }
+    }
 
-            aimStrain += wiggleBonus * wiggle_multiplier;
-            aimStrain += velocityChangeBonus * velocity_change_multiplier;
-            aimStrain += std::max(acuteAngleBonus * acute_angle_multiplier, wideAngleBonus * wide_angle_multiplier);
+    inc.highest_strains.erase(inc.highest_strains.begin() + pendingIndex);
 
-            // Apply high circle size bonus
-            aimStrain *= smallCircleBonus;
+    // see CountDifficultStrains @ https://github.com/ppy/osu/pull/16280/files#diff-07543a9ffe2a8d7f02cadf8ef7f81e3d7ec795ec376b2fff8bba7b10fb574e19R78
+    if(outAttributes) {
+        f64 &difficultStrainCount =
+            (type == Skills::SPEED ? outAttributes->SpeedDifficultStrainCount : outAttributes->AimDifficultStrainCount);
+        f64 &topWeightedSlidersCount = (type == Skills::SPEED ? outAttributes->SpeedTopWeightedSliderFactor
+                                                              : outAttributes->AimTopWeightedSliderFactor);
 
-            if(withSliders) aimStrain += sliderBonus * slider_multiplier;
+        if(difficulty == 0.0) {
+            inc.consistent_top_strain = 0.0;
+            inc.difficult_strains = 0.0;
+            inc.top_weighted_sliders = 0.0;
+            inc.difficult_strains_slope = 0.0;
+            inc.top_weighted_sliders_slope = 0.0;
+        } else {
+            const f64 consistentTopStrain = difficulty / 10.0;
+
+            // difficulty (almost) always changes with every object, and the weights aren't linear in it, so the
+            // sums can't be kept exact without recounting every object each time (O(n) per object). instead, the
+            // sums (and their derivative) are kept for the top strain of the last recount, corrected to first order
+            // for the current one, and only recounted once it drifts by more than incremental_rescale_tolerance.
+            // see IncrementalState for the resulting error
+            if(firstNew > 0 && inc.consistent_top_strain > 0.0 &&
+               std::abs(consistentTopStrain - inc.consistent_top_strain) <=
+                   inc.consistent_top_strain * incremental_rescale_tolerance) {
+                for(uSz i = firstNew; i < dobjectCount; i++) {
+                    const f64 weight = difficultStrainWeight(strains[i], inc.consistent_top_strain);
+                    inc.difficult_strains += weight;
+                    inc.difficult_strains_slope += difficultStrainWeightSlope(strains[i], inc.consistent_top_strain, weight);
+                    if(sliderStrainCol[i] >= 0) {
+                        const f64 sliderWeight = difficultStrainWeight(sliderStrainCol[i], inc.consistent_top_strain);
+                        inc.top_weighted_sliders += sliderWeight;
+                        inc.top_weighted_sliders_slope +=
+                            difficultStrainWeightSlope(sliderStrainCol[i], inc.consistent_top_strain, sliderWeight);
+                    }
+                }
+            } else {
+                f64 tempTotalSum = 0.0, tempTotalSlope = 0.0;
+                f64 tempSliderSum = 0.0, tempSliderSlope = 0.0;
+                for(uSz i = 0; i < dobjectCount; i++) {
+                    const f64 weight = difficultStrainWeight(strains[i], consistentTopStrain);
+                    tempTotalSum += weight;
+                    tempTotalSlope += difficultStrainWeightSlope(strains[i], consistentTopStrain, weight);
+                    if(sliderStrainCol[i] >= 0) {
+                        const f64 sliderWeight = difficultStrainWeight(sliderStrainCol[i], consistentTopStrain);
+                        tempSliderSum += sliderWeight;
+                        tempSliderSlope += difficultStrainWeightSlope(sliderStrainCol[i], consistentTopStrain, sliderWeight);
+                    }
+                }
+                inc.consistent_top_strain = consistentTopStrain;
+                inc.difficult_strains = tempTotalSum;
+                inc.difficult_strains_slope = tempTotalSlope;
+                inc.top_weighted_sliders = tempSliderSum;
+                inc.top_weighted_sliders_slope = tempSliderSlope;
+            }
+        }
 
-            return aimStrain;
-        } break;
+        // relative drift of the top strain since the last recount, 0 right after one
+        const f64 drift =
+            inc.consistent_top_strain > 0.0 ? difficulty / 10.0 / inc.consistent_top_strain - 1.0 : 0.0;
+        difficultStrainCount = inc.difficult_strains - drift * inc.difficult_strains_slope;
+        topWeightedSlidersCount = inc.top_weighted_sliders - drift * inc.top_weighted_sliders_slope;
     }
 
-    return 0.0;
-}
-
-f64 DifficultyCalculator::DiffObject::get_doubletapness(const DifficultyCalculator::DiffObject *next,
-                                                        f64 hitWindow300) const {
-    if(next != nullptr) {
-        f64 cur_delta = std::max(1.0, delta_time);
-        f64 next_delta = std::max(1, next->ho->time - ho->time);  // NOTE: next delta time isn't initialized yet
-        f64 delta_diff = std::abs(next_delta - cur_delta);
-        f64 speedRatio = cur_delta / std::max(cur_delta, delta_diff);
-        f64 windowRatio = std::pow(std::min(1.0, cur_delta / hitWindow300), 2.0);
-
-        return 1.0 - std::pow(speedRatio, 1.0 - windowRatio);
-    }
-    return 0.0;
+    return difficulty;
 }
 
 std::string DifficultyCalculator::PPv2CalcParamsToString(const PPv2CalcParams &pars) {
@@ -8,6 +8,7 @@
 #include "noinclude.h"
 #include "types.h"
 #include "Vectors.h"
+#include "StarPrecalc.h"
 
 #ifndef BUILD_TOOLS_ONLY
 #include "SyncStoptoken.h"
@@ -22,6 +23,8 @@ using std::stop_token;
 #include <vector>
 #include <array>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <algorithm>
 
 enum class ModFlags : u64;
@@ -56,12 +59,16 @@ class DifficultyHitObject {
    public:
     DifficultyHitObject() = delete;
 
-    DifficultyHitObject(TYPE type, vec2 pos, i32 time);               // circle
-    DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime);  // spinner
+    // mem backs the slider scoring times and scheduled control points (e.g. a per-map arena, see BatchDiffCalc)
+    DifficultyHitObject(TYPE type, vec2 pos, i32 time,
+                        std::pmr::memory_resource *mem = std::pmr::get_default_resource());  // circle
+    DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime,
+                        std::pmr::memory_resource *mem = std::pmr::get_default_resource());  // spinner
     DifficultyHitObject(TYPE type, vec2 pos, i32 time, i32 endTime, f32 spanDuration, i8 osuSliderCurveType,
                         const std::vector<vec2> &controlPoints, f32 pixelLength,
-                        std::vector<SLIDER_SCORING_TIME> scoringTimes, i32 repeats,
-                        bool calculateSliderCurveInConstructor);  // slider
+                        std::span<const SLIDER_SCORING_TIME> scoringTimes, i32 repeats,
+                        bool calculateSliderCurveInConstructor, std::shared_ptr<const SliderCurve> sharedCurve = nullptr,
+                        std::pmr::memory_resource *mem = std::pmr::get_default_resource());  // slider
     ~DifficultyHitObject();
 
     DifficultyHitObject(const DifficultyHitObject &) = delete;
@@ -70,8 +77,19 @@ class DifficultyHitObject {
     DifficultyHitObject &operator=(const DifficultyHitObject &dobj) = delete;
     DifficultyHitObject &operator=(DifficultyHitObject &&dobj) noexcept;
 
+    // the unstacked curve used for star calculation, shareable between DifficultyHitObjects of the same slider
+    // (stacking is applied by curvePointAt instead of being baked into the curve)
+    [[nodiscard]] static std::shared_ptr<const SliderCurve> createCurve(i8 osuSliderCurveType,
+                                                                        std::span<const vec2> controlPoints,
+                                                                        f32 pixelLength);
+
+    // beatmaps with at least this many sliders don't keep every curve alive at once, see the constructor
+    static constexpr const uSz max_precalculated_curves = 5000;
+
     void updateStackPosition(f32 stackOffset);
-    void updateCurveStackPosition(f32 stackOffset);
+
+    // curve position with stacking applied
+    [[nodiscard]] vec2 curvePointAt(f32 t) const;
 
     // for stacking calculations, always returns the unstacked original position at that point in time
     [[nodiscard]] vec2 getOriginalRawPosAt(i32 pos) const;
@@ -94,16 +112,16 @@ class DifficultyHitObject {
     i32 baseEndTime;  // not adjusted by clockrate
 
     // sliders
-    std::vector<SLIDER_SCORING_TIME> scoringTimes;
-    std::vector<vec2> scheduledCurveAllocControlPoints;
-    std::unique_ptr<SliderCurve> curve;
+    std::pmr::vector<SLIDER_SCORING_TIME> scoringTimes;
+    std::pmr::vector<vec2> scheduledCurveAllocControlPoints;
+    std::shared_ptr<const SliderCurve> curve;
 
     f32 spanDuration;  // i.e. sliderTimeWithoutRepeats
     f32 pixelLength;
     i32 repeats;
 
     // custom
-    f32 scheduledCurveAllocStackOffset;
+    f32 curveStackOffset;  // per stack level, see curvePointAt()
     i32 stack;
     vec2 originalPos;
 
@@ -115,6 +133,7 @@ class DifficultyHitObject {
 namespace DiffCalc {
 // for forward declaration
 extern const u32 PP_ALGORITHM_VERSION;
+extern const u32 STRAIN_DATA_VERSION;
 }  // namespace DiffCalc
 
 class DifficultyCalculator {
@@ -135,23 +154,57 @@ class DifficultyCalculator {
     static constexpr const f64 DIFFCALC_EPSILON = 1e-32;
 
     // This struct is the stripped out version of difficulty attributes needed for incremental (per-object) calculation
+    // One per skill. Each calculate_difficulty call folds in the objects added since the previous call, so feeding a
+    // whole map costs amortized O(sections) memmove plus a bounded top-strain walk per object instead of sorting and
+    // re-weighing every strain on every call.
+    // Going backwards (dobjectCount < processed_count) resets the state.
     struct IncrementalState {
-        f64 interval_end;
-        f64 max_strain;
-        f64 max_object_strain;
-        f64 max_slider_strain;
+        f64 interval_end{0.};
+        f64 max_strain{0.};
+        f64 max_object_strain{0.};
+        f64 max_slider_strain{0.};
 
         // for difficult strain count calculation
-        f64 consistent_top_strain;
-        f64 difficult_strains;
-        f64 top_weighted_sliders;
+        // the sums (and their derivatives, *_slope) are for consistent_top_strain as of the last full recount, and
+        // the reported counts are corrected to first order for the current top strain. the sums are only
+        // recomputed from scratch once the top strain drifts by more than incremental_rescale_tolerance, so
+        // AimDifficultStrainCount, SpeedDifficultStrainCount and the TopWeightedSliderFactors (and the pp derived
+        // from them) can differ from a full calculation by the second order term, at most
+        // incremental_count_tolerance relative. everything else matches the full calculation exactly.
+        f64 consistent_top_strain{0.};
+        f64 difficult_strains{0.};
+        f64 difficult_strains_slope{0.};
+        f64 top_weighted_sliders{0.};
+        f64 top_weighted_sliders_slope{0.};
 
         // difficulty attributes
-        f64 aim_difficult_slider_count;
-        f64 speed_note_count;
+        f64 aim_difficult_slider_count{0.};
+        f64 speed_note_count{0.};
+
+        // number of objects already folded into this state
+        uSz processed_count{0};
+
+        // strain per processed object, and slider strain per processed object (-1 for non-sliders)
+        std::vector<f64> object_strains;
+        std::vector<f64> object_slider_strains;
 
+        // peak strain of every finished section, sorted ascending
         std::vector<f64> highest_strains;
-        std::vector<f64> slider_strains;
+    };
+
+    // a looser rescale tolerance barely saves recounts (about 1 in 6 objects recounts at 1e-3, 1 in 12 at 1e-2) but
+    // the count error grows with its square. at 1e-3 the error stays below ~1.5e-5 on real maps, checked per object
+    // against the full calculation by `diffcalc --regress`
+    static constexpr const f64 incremental_rescale_tolerance = 1e-3;
+    static constexpr const f64 incremental_count_tolerance = 1e-4;
+
+    // running sums for the scorev1 attributes, so incremental calculation doesn't rescan every previous object
+    struct IncrementalScoreV1State {
+        i32 processed_count{0};
+        i32 combo{0};
+        f64 nested_score{0.};
+        u32 max_combo_score{0};
+        u64 combo_sum{0};  // sum of max(0, combo - 1) over the processed objects
     };
 
     // This struct is the core data computed by difficulty calculation and used in performance calculation
@@ -190,7 +243,7 @@ class DifficultyCalculator {
     // Its purpose is to remove dependency of diffcalc on the specific beatmap class/object
     struct BeatmapDiffcalcData {
         // Hitobjects
-        std::vector<DifficultyHitObject> &sortedHitObjects;
+        std::pmr::vector<DifficultyHitObject> &sortedHitObjects;
 
         // Basic attributes, they're NOT adjusted by rate
         f32 CS{5.f}, HP{5.f}, AR{5.f}, OD{5.f};
@@ -229,7 +282,6 @@ class DifficultyCalculator {
 
         // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Difficulty/Skills/Speed.cs
         // needed because raw speed strain and rhythm strain are combined in different ways
-        f64 raw_speed_strain{0.};
         f64 rhythm{0.};
 
         vec2 norm_start;  // start position normalized on radius
@@ -241,14 +293,10 @@ class DifficultyCalculator {
         f64 minJumpTime{0.};      // precalc
         f64 travelDistance{0.};   // precalc
 
-        f64 delta_time{0.};           // strain temp
-        f64 adjusted_delta_time{0.};  // strain temp
-
         vec2 lazyEndPos;         // precalc temp
         f64 lazyTravelDist{0.};  // precalc temp
         f64 lazyTravelTime{0.};  // precalc temp
         f64 travelTime{0.};      // precalc temp
-        f64 smallCircleBonus{1.};
 
         i32 prevObjectIndex;  // WARNING: this will be -1 for the first object (as the name implies), see note above
 
@@ -280,16 +328,62 @@ class DifficultyCalculator {
         inline static f64 applyDiminishingExp(f64 val) { return std::pow(val, 0.99); }
         inline static f64 strainDecay(Skills::Skill type, f64 ms) { return std::pow(decay_base[type], ms / 1000.0); }
 
-        void calculate_strains(const DiffObject &prev, const DiffObject *next, f64 hitWindow300, bool autopilotNerf);
-        void calculate_strain(const DiffObject &prev, const DiffObject *next, f64 hitWindow300, bool autopilotNerf,
-                              const Skills::Skill dtype);
         static f64 calculate_difficulty(const Skills::Skill type, const DiffObject *dobjects, uSz dobjectCount,
                                         IncrementalState *incremental, std::vector<f64> *outStrains = nullptr,
                                         DifficultyAttributes *outAttributes = nullptr);
+        static f64 calculate_difficulty_incremental(const Skills::Skill type, const DiffObject *dobjects,
+                                                    uSz dobjectCount, IncrementalState &incremental,
+                                                    std::vector<f64> *outStrains, DifficultyAttributes *outAttributes);
+    };
+
+    // everything the aim/speed strain evaluators read per object, one contiguous column per field (structure of
+    // arrays). only depends on the (stacked) hitobjects, CS and speed, see calculateStrains
+    struct StrainInputs {
+        std::vector<i32> time;
+        std::vector<DifficultyHitObject::TYPE> type;
+        std::vector<vec2> pos;  // stacked
+        std::vector<f64> jumpDistance;
+        std::vector<f64> minJumpDistance;
+        std::vector<f64> minJumpTime;
+        std::vector<f64> travelDistance;
+        std::vector<f64> travelTime;
+        std::vector<f64> angle;
+        f64 smallCircleBonus{1.};
+
+        [[nodiscard]] inline uSz size() const { return time.size(); }
+        void resize(uSz count);
+
+        // from DiffObjects whose distances and angles have been calculated
+        void gather(const DiffObject *dobjects, uSz count, f64 smallCircleBonus);
+    };
+
+    // per-object strains for every skill, same values as DiffObject::strains/rhythm
+    struct StrainOutputs {
+        std::array<std::vector<f64>, Skills::NUM_SKILLS> strains;
+        std::vector<f64> rhythm;
+
+        // per-object evaluator results before decay is applied, and the time deltas they share
+        std::array<std::vector<f64>, Skills::NUM_SKILLS> objectStrains;
+        std::vector<f64> deltaTime;
+        std::vector<f64> adjustedDeltaTime;
+    };
 
-        f64 spacing_weight2(const Skills::Skill diff_type, const DiffObject &prev, const DiffObject *next,
-                            f64 hitWindow300, bool autopilotNerf);
-        f64 get_doubletapness(const DiffObject *next, f64 hitWindow300) const;
+    // evaluate every skill over the whole column set, one pass per evaluator
+    static void calculateStrains(const StrainInputs &inputs, f64 hitWindow300, bool autopilotNerf,
+                                 StrainOutputs &out);
+
+    // everything the star/pp calculation reads from the hitobjects of a beatmap, which only depends on the (stacked)
+    // hitobjects, CS and speed. keeping it around (see DiffAttrCache) allows redoing the rest of the calculation for any
+    // AR/OD/HP and HD/RX/AP/TD without loading the hitobjects again, see calculateStarDiffForStrainData
+    struct StrainData {
+        StrainInputs inputs;
+
+        u32 breakDuration{0};
+        u32 playableLength{0};
+
+        // scorev1 totals, see IncrementalScoreV1State
+        f64 nestedScore{0.};
+        u64 comboSum{0};
     };
 
    public:
@@ -322,6 +416,18 @@ class DifficultyCalculator {
         // ignore "upToObjectIndex" to expect future calls with a larger object index
         // by pre-calculating and filling cachedDiffObjects, if it's empty
         bool forceFillDiffobjCache{false};
+
+        // optional, used together with incremental
+        IncrementalScoreV1State *incrementalScoreV1{nullptr};
+
+        // skip everything that only feeds the performance calculation (difficult strain counts, speed note count,
+        // difficult slider count, scorev1 attributes). the star rating, SliderFactor, Aim/SpeedDifficulty and
+        // outRawDifficulty are unaffected. not supported together with incremental.
+        bool starRatingOnly{false};
+
+        // if non-null, filled with the StrainData of the beatmap. only for full calculations (no incremental,
+        // upToObjectIndex or starRatingOnly), left untouched otherwise
+        StrainData *outStrainData{nullptr};
     };
 
     // stars, fully static
@@ -331,6 +437,35 @@ class DifficultyCalculator {
     // different mod flags (e.g. hidden). skips all strain/difficulty calculation.
     static f64 recomputeStarRating(const RawDifficultyValues &raw, const BeatmapDiffcalcData &beatmapData);
 
+    struct PrecalcVariantParams {
+        // the variant's DifficultyHitObjects, built at speed 1.0 with its AR/CS, and its CS/HP/AR/OD.
+        // the timing fields of the hitobjects are rescaled in place for every speed
+        BeatmapDiffcalcData &beatmapData;
+        const StarPrecalc::ArCsVariant &variant;
+        StarPrecalc::SRArray &outRatings;
+
+        // scratch buffers, reused between calls
+        std::unique_ptr<std::vector<DiffObject>> &cachedDiffObjects;
+        std::vector<f32> &baseSpanDurations;
+        std::vector<f32> &baseScoringTimes;
+
+        // cancellation
+        Sync::stop_token cancelCheck{};
+
+        // only disabled to benchmark against full calculations (see diffcalc --bench-precalc)
+        bool starRatingOnly{true};
+    };
+
+    // star ratings of one StarPrecalc AR/CS variant for every speed, both with and without hidden (the hidden rating
+    // reuses the raw difficulty values of the non-hidden pass, see recomputeStarRating)
+    static void calculatePrecalcVariant(PrecalcVariantParams &params);
+
+    // same result and attributes as calculateStarDiffForHitObjects, from the StrainData of an earlier full calculation
+    // with the same CS and speed (and AR, if stacking is enabled). only the strains, weighing and rating are redone.
+    // beatmapData.sortedHitObjects, breakDuration and playableLength are not used, they come from data instead
+    static f64 calculateStarDiffForStrainData(const StrainData &data, const BeatmapDiffcalcData &beatmapData,
+                                              DifficultyAttributes &outAttributes);
+
     struct PPv2CalcParams {
         DifficultyAttributes attributes;
 
@@ -366,7 +501,17 @@ class DifficultyCalculator {
     // helper functions
     [[nodiscard]] static f64 calculateTotalStarsFromSkills(f64 aim, f64 speed);
     static void calculateScoreV1Attributes(DifficultyAttributes &attributes, const BeatmapDiffcalcData &beatmapData,
-                                           i32 upToObjectIndex);
+                                           i32 upToObjectIndex, IncrementalScoreV1State *incremental = nullptr);
+    [[nodiscard]] static i32 calculateLegacyScoreBaseMultiplier(f32 CS, f32 HP, f32 OD, uSz numObjects,
+                                                                u32 breakDuration, u32 playableLength);
+
+    // weighs the strains of every skill (weighSkill(skill, outStrains, outAttributes) returns the difficulty value)
+    // and applies the final rating transform. shared by calculateStarDiffForHitObjects and
+    // calculateStarDiffForStrainData, defined in DifficultyCalculator.cpp
+    template <typename WeighSkill>
+    static f64 rateSkills(WeighSkill &&weighSkill, uSz numObjects, const BeatmapDiffcalcData &beatmapData,
+                          DifficultyAttributes &attributes, bool starRatingOnly, std::vector<f64> *outAimStrains,
+                          std::vector<f64> *outSpeedStrains, RawDifficultyValues *outRawDifficulty);
     [[nodiscard]] static f64 calculateScoreV1SpinnerScore(f64 spinnerDuration);
 
    private:
@@ -394,7 +539,12 @@ class DifficultyCalculator {
             return std::abs(delta - other.delta) < deltaDifferenceEpsilon && deltaCount == other.deltaCount;
         }
     };
-    static thread_local std::vector<std::pair<RhythmIsland, int>> islandCounts;
+
+    // strain evaluators for object i of the columns (i > 0), see calculateStrains
+    static f64 evaluateSpeed(const StrainInputs &in, const StrainOutputs &out, uSz i, f64 hitWindow300,
+                             bool autopilotNerf, f64 &rhythm);
+    static f64 evaluateAim(const StrainInputs &in, const StrainOutputs &out, uSz i, bool withSliders);
+    static f64 doubletapness(const StrainInputs &in, const StrainOutputs &out, uSz i, uSz next, f64 hitWindow300);
 
    private:
     // Skill values calculation
@@ -61,6 +61,14 @@ struct LivePPCalc::LivePPCalcImpl {
         DatabaseBeatmap::LOAD_DIFFOBJ_RESULT diffres{};
         std::unique_ptr<std::vector<DifficultyCalculator::DiffObject>> diffobj_cache{
             std::make_unique<std::vector<DifficultyCalculator::DiffObject>>()};
+
+        // per-skill running state, so each update only folds in the objects hit since the last one
+        // (calculate_difficulty resets it by itself when seeking backwards)
+        struct IncrementalStates {
+            std::array<DifficultyCalculator::IncrementalState, DifficultyCalculator::Skills::NUM_SKILLS> skills{};
+            DifficultyCalculator::IncrementalScoreV1State scorev1{};
+        };
+        std::unique_ptr<IncrementalStates> incremental{std::make_unique<IncrementalStates>()};
     } m_param_cache;
 
     struct LazyCalcParams {
@@ -85,6 +93,7 @@ struct LivePPCalc::LivePPCalcImpl {
                 c.speed_multiplier = this->speed_multiplier;
                 // get new diffres
                 c.diffobj_cache->clear();
+                *c.incremental = {};
                 c.diffres = DatabaseBeatmap::loadDifficultyHitObjects(this->osufile_path, this->AR, this->CS,
                                                                       this->speed_multiplier);
             }
@@ -171,16 +180,23 @@ struct LivePPCalc::LivePPCalcImpl {
 
             DifficultyCalculator::DifficultyAttributes diffattrsOut{};
 
+            // before the first object (index -1) this is a whole-map calculation, which the incremental state can't
+            // continue from
+            const bool incremental = p.current_hitobject >= 0;
+
+            // live strains aren't displayed anywhere (the strain graph uses the whole-map calculation),
+            // so don't copy them out on every update
             DifficultyCalculator::StarCalcParams params{
                 .cachedDiffObjects = std::move(diffobjCache),
                 .outAttributes = diffattrsOut,
                 .beatmapData = diffcalcData,
-                .outAimStrains = &retInfo.aimStrains,
-                .outSpeedStrains = &retInfo.speedStrains,
-                .incremental = nullptr,  // TODO: use incremental instead of this bs
+                .outAimStrains = nullptr,
+                .outSpeedStrains = nullptr,
+                .incremental = incremental ? cache.incremental->skills.data() : nullptr,
                 .upToObjectIndex = p.current_hitobject,
                 .cancelCheck = {},
-                .forceFillDiffobjCache = true};
+                .forceFillDiffobjCache = true,
+                .incrementalScoreV1 = incremental ? &cache.incremental->scorev1 : nullptr};
 
             retInfo.total_stars = DifficultyCalculator::calculateStarDiffForHitObjects(params);
 
@@ -28,6 +28,24 @@ inline constexpr uSz NUM_MOD_COMBOS = 6;
 inline constexpr std::array MOD_NAMES{"NM", "HR", "HD", "EZ", "HDHR", "HDEZ"};
 static_assert(MOD_NAMES.size() == NUM_MOD_COMBOS);
 
+// AR/CS/OD/HP variant: {multiplier for AR/OD/HP, multiplier for CS}
+// BASE=nomod, HR=1.4x (CS=1.3x), EZ=0.5x
+// every variant needs its own DifficultyHitObjects (stacking and radius depend on AR/CS) and one strain pass per
+// speed. the hidden combo of a variant only differs in the final rating transform, so it reuses the raw difficulty
+// values of its non-hidden pass (see DifficultyCalculator::recomputeStarRating).
+struct ArCsVariant {
+    f32 ar_od_hp_mul;
+    f32 cs_mul;
+    // mod combo indices: [hidden=false, hidden=true]
+    u8 combo_idx[2];
+};
+inline constexpr std::array VARIANTS{
+    ArCsVariant{1.0f, 1.0f, {0, 2}},  // BASE: None(0), HD(2)
+    ArCsVariant{1.4f, 1.3f, {1, 4}},  // HR: HR(1), HD|HR(4)
+    ArCsVariant{0.5f, 0.5f, {3, 5}},  // EZ: EZ(3), HD|EZ(5)
+};
+static_assert(VARIANTS.size() * 2 == NUM_MOD_COMBOS);
+
 inline constexpr uSz NUM_PRECALC_RATINGS = SPEEDS_NUM * NUM_MOD_COMBOS;  // 54
 inline constexpr uSz NOMOD_1X_INDEX = _1_0 * NUM_MOD_COMBOS;             // speed_idx=3 (1.0) * 6 + combo=0 (None) = 18
 
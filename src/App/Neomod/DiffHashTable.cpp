@@ -0,0 +1,101 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "DiffHashTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+// MD5 digests are already uniformly distributed, so the bucket index and tag are just taken straight from the bytes
+forceinline u64 bucket_hash(const MD5Hash &hash) {
+    u64 h;
+    std::memcpy(&h, hash.data(), sizeof(h));
+    return h;
+}
+
+forceinline u32 bucket_tag(const MD5Hash &hash) {
+    u32 t;
+    std::memcpy(&t, hash.data() + sizeof(u64), sizeof(t));
+    return t;
+}
+
+}  // namespace
+
+u32 DiffHashTable::find_index(const MD5Hash &hash) const {
+    if(this->buckets.empty()) return 0;
+
+    const uSz mask = this->buckets.size() - 1;
+    const u32 tag = bucket_tag(hash);
+    for(uSz b = bucket_hash(hash) & mask;; b = (b + 1) & mask) {
+        const Bucket &bucket = this->buckets[b];
+        if(bucket.slot == 0) return 0;
+        if(bucket.tag == tag && this->slot_at(bucket.slot - 1).hash == hash) return bucket.slot;
+    }
+}
+
+DiffHashTable::Slot *DiffHashTable::find(const MD5Hash &hash) {
+    const u32 idx = this->find_index(hash);
+    return idx != 0 ? &this->slot_at(idx - 1) : nullptr;
+}
+
+const DiffHashTable::Slot *DiffHashTable::find(const MD5Hash &hash) const {
+    const u32 idx = this->find_index(hash);
+    return idx != 0 ? &this->slot_at(idx - 1) : nullptr;
+}
+
+DiffHashTable::Slot &DiffHashTable::operator[](const MD5Hash &hash) {
+    // keep the load factor at or below 3/4
+    if((this->num_slots + 1) * 4 > this->buckets.size() * 3) {
+        this->rehash(std::max<uSz>(this->buckets.size() * 2, 1024));
+    }
+
+    const uSz mask = this->buckets.size() - 1;
+    const u32 tag = bucket_tag(hash);
+    uSz b = bucket_hash(hash) & mask;
+    for(;; b = (b + 1) & mask) {
+        const Bucket &bucket = this->buckets[b];
+        if(bucket.slot == 0) break;
+        if(bucket.tag == tag && this->slot_at(bucket.slot - 1).hash == hash) return this->slot_at(bucket.slot - 1);
+    }
+
+    const u32 idx = this->num_slots++;
+    if((idx >> CHUNK_SHIFT) >= this->chunks.size()) {
+        this->chunks.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+    }
+    this->buckets[b] = {.tag = tag, .slot = idx + 1};
+
+    Slot &slot = this->slot_at(idx);
+    slot.hash = hash;
+    return slot;
+}
+
+void DiffHashTable::reserve(uSz count) {
+    const uSz needed = std::bit_ceil((count * 4 + 2) / 3);
+    if(needed > this->buckets.size()) {
+        this->rehash(needed);
+    }
+}
+
+void DiffHashTable::clear() {
+    this->buckets.clear();
+    this->chunks.clear();
+    this->num_slots = 0;
+}
+
+void DiffHashTable::rehash(uSz num_buckets) {
+    std::vector<Bucket> new_buckets(num_buckets, Bucket{.tag = 0, .slot = 0});
+    const uSz mask = num_buckets - 1;
+
+    // slots don't move, only their bucket positions are recomputed
+    for(u32 idx = 0; idx < this->num_slots; idx++) {
+        const MD5Hash &hash = this->slot_at(idx).hash;
+        uSz b = bucket_hash(hash) & mask;
+        while(new_buckets[b].slot != 0) {
+            b = (b + 1) & mask;
+        }
+        new_buckets[b] = {.tag = bucket_tag(hash), .slot = idx + 1};
+    }
+
+    this->buckets = std::move(new_buckets);
+}
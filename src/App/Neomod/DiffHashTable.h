@@ -0,0 +1,109 @@
+#pragma once
+// Copyright (c) 2026, WH, All rights reserved.
+// single MD5 -> per-difficulty data table used by Database
+
+#include "noinclude.h"
+#include "types.h"
+#include "LegacyReplay.h"
+#include "MD5Hash.h"
+#include "Overrides.h"
+#include "score.h"
+#include "DiffCalc/StarPrecalc.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class DatabaseBeatmap;
+
+// Everything the database keeps about one beatmap MD5. This used to be spread across five separate MD5-keyed maps
+// (beatmap_difficulties, scores, online_scores, star_ratings, peppy_overrides), each storing its own copy of the key
+// and each needing its own lookup. Optional parts are heap-allocated so an empty slot stays one cache line.
+struct DiffHashExtraData {
+    MD5Hash hash;                                                        // the only copy of the key in the table
+    DatabaseBeatmap *diff{nullptr};                                      // loaded difficulty with this hash, if any
+    std::unique_ptr<std::vector<FinishedScore>> local_scores{nullptr};   // all local scores stored for this diff
+    std::unique_ptr<std::vector<FinishedScore>> online_scores{nullptr};  // last fetched online leaderboard
+    std::unique_ptr<StarPrecalc::SRArray> star_ratings{nullptr};         // stored star ratings
+    std::unique_ptr<MapOverrides> overrides{nullptr};  // stored peppy_overrides (only relevant for PEPPY_DIFFICULTYs)
+};
+
+// Open-addressed (linear probing) table from MD5Hash to DiffHashExtraData.
+// Buckets only hold a 32-bit tag and a slot index, so a lookup is usually one bucket probe plus one slot access.
+// Slots are allocated in fixed-size chunks and never move or get erased, so pointers to them (and into them)
+// stay valid until clear(). Not thread-safe; Database guards it with diff_hash_mtx.
+class DiffHashTable final {
+    NOCOPY_NOMOVE(DiffHashTable)
+   public:
+    using Slot = DiffHashExtraData;
+
+    DiffHashTable() = default;
+    ~DiffHashTable() = default;
+
+    [[nodiscard]] Slot *find(const MD5Hash &hash);
+    [[nodiscard]] const Slot *find(const MD5Hash &hash) const;
+
+    // returns the slot for hash, creating an empty one if it doesn't exist yet
+    Slot &operator[](const MD5Hash &hash);
+
+    void reserve(uSz count);
+    void clear();
+
+    [[nodiscard]] inline uSz size() const { return this->num_slots; }
+
+    // iterates slots in insertion order
+    template <typename SlotT, typename TableT>
+    class basic_iterator {
+       public:
+        using value_type = std::remove_const_t<SlotT>;
+        using difference_type = std::ptrdiff_t;
+
+        basic_iterator() = default;
+        basic_iterator(TableT *table, u32 idx) : table(table), idx(idx) {}
+        SlotT &operator*() const { return this->table->slot_at(this->idx); }
+        SlotT *operator->() const { return &this->table->slot_at(this->idx); }
+        basic_iterator &operator++() {
+            this->idx++;
+            return *this;
+        }
+        basic_iterator operator++(int) {
+            basic_iterator prev = *this;
+            this->idx++;
+            return prev;
+        }
+        bool operator==(const basic_iterator &other) const { return this->idx == other.idx; }
+
+       private:
+        TableT *table{nullptr};
+        u32 idx{0};
+    };
+    using iterator = basic_iterator<Slot, DiffHashTable>;
+    using const_iterator = basic_iterator<const Slot, const DiffHashTable>;
+
+    inline iterator begin() { return {this, 0}; }
+    inline iterator end() { return {this, this->num_slots}; }
+    inline const_iterator begin() const { return {this, 0}; }
+    inline const_iterator end() const { return {this, this->num_slots}; }
+
+   private:
+    static constexpr u32 CHUNK_SHIFT = 10;
+    static constexpr u32 CHUNK_SIZE = 1u << CHUNK_SHIFT;
+
+    struct Bucket {
+        u32 tag;   // bits of the hash not used for the bucket index, to skip most full key compares
+        u32 slot;  // slot index + 1, 0 if empty
+    };
+
+    [[nodiscard]] forceinline Slot &slot_at(u32 idx) { return this->chunks[idx >> CHUNK_SHIFT][idx & (CHUNK_SIZE - 1)]; }
+    [[nodiscard]] forceinline const Slot &slot_at(u32 idx) const {
+        return this->chunks[idx >> CHUNK_SHIFT][idx & (CHUNK_SIZE - 1)];
+    }
+
+    [[nodiscard]] u32 find_index(const MD5Hash &hash) const;  // slot index + 1, 0 if not found
+    void rehash(uSz num_buckets);
+
+    std::vector<Bucket> buckets;  // power of two sized
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    u32 num_slots{0};
+};
@@ -1324,23 +1324,16 @@ const std::vector<SCORE_ENTRY> &HUD::getCurrentScores() {
             const bool is_online = (BanchoState::is_online() || BanchoState::is_logging_in()) &&
                                    cv::songbrowser_scores_filteringtype.getString() != "Local";
 
+            Sync::shared_lock lock(db->diff_hash_mtx);
+
             const std::vector<FinishedScore> *scoreVec = nullptr;
             if(is_online) {
-                const auto &scoreIt = db->getOnlineScores().find(this->beatmap_md5);
-                if(scoreIt != db->getOnlineScores().end()) {
-                    scoreVec = &scoreIt->second;
-                }
+                scoreVec = db->getOnlineScores(this->beatmap_md5);
             }
 
             // use local if we had no online scores or are not online
-            bool locked_scores_mtx = false;
             if(!scoreVec) {
-                db->scores_mtx.lock_shared();
-                locked_scores_mtx = true;
-                const auto &scoreIt = db->getScores().find(this->beatmap_md5);
-                if(scoreIt != db->getScores().end()) {
-                    scoreVec = &scoreIt->second;
-                }
+                scoreVec = db->getScores(this->beatmap_md5);
             }
 
             if(scoreVec) {
@@ -1362,10 +1355,6 @@ const std::vector<SCORE_ENTRY> &HUD::getCurrentScores() {
                     nb_slots++;
                 }
             }
-
-            if(locked_scores_mtx) {
-                db->scores_mtx.unlock_shared();
-            }
         }
 
         SCORE_ENTRY playerScoreEntry;
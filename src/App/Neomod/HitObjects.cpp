@@ -1,6 +1,7 @@
 #include "HitObjects.h"
 
 #include <cmath>
+#include <cstring>
 #include <utility>
 
 #include "AnimationHandler.h"
@@ -22,12 +23,40 @@
 #include "SliderCurves.h"
 #include "SliderRenderer.h"
 #include "SoundEngine.h"
+#include "Stacking.h"
 #include "Logging.h"
 #include "UI.h"
 #include "crypto.h"
 
 using namespace flags::operators;
 
+void HitObject::calculateStacks(std::span<const std::unique_ptr<HitObject>> hitobjects, int beatmapVersion,
+                                f32 stackTime, f32 stackOffset) {
+    std::vector<Stacking::Object> objects;
+    objects.reserve(hitobjects.size());
+    for(const auto &hitobject : hitobjects) {
+        using enum Stacking::Object::Type;
+        const HitObjectType type = hitobject->getType();
+        const vec2 pos = hitobject->getOriginalRawPosAt(hitobject->getClickTime());
+        objects.push_back({
+            .pos = pos,
+            .endPos = type == HitObjectType::SLIDER ? hitobject->getOriginalRawPosAt(hitobject->getEndTime()) : pos,
+            .time = hitobject->getClickTime(),
+            .endTime = hitobject->getEndTime(),
+            .duration = hitobject->getDuration(),
+            .type = type == HitObjectType::SLIDER ? SLIDER : (type == HitObjectType::SPINNER ? SPINNER : CIRCLE),
+        });
+    }
+
+    std::vector<i32> stacks(objects.size());
+    Stacking::calculate(objects, stacks, beatmapVersion, stackTime);
+
+    for(uSz i = 0; i < hitobjects.size(); i++) {
+        hitobjects[i]->setStack(stacks[i]);
+        if(stacks[i] != 0) hitobjects[i]->updateStackPosition(stackOffset);
+    }
+}
+
 void HitObject::drawHitResult(BeatmapInterface *pf, vec2 rawPos, LiveScore::HIT result, float animPercentInv,
                               float hitDeltaRangePercent) {
     drawHitResult(pf->getSkin(), pf->fHitcircleDiameter, pf->fRawHitcircleDiameter, rawPos, result, animPercentInv,
@@ -479,6 +508,30 @@ void HitObject::onReset(i32 /*curPos*/) {
     m_hitresultanim2.timeSecs = -9999.0f;
 }
 
+namespace {
+// (de)serialization helpers for saveState()/restoreState(), the fields have to be listed in the same order in both
+template <typename... T>
+void saveFields(std::vector<u8> &out, const T &...fields) {
+    static_assert((std::is_trivially_copyable_v<T> && ...));
+    ((out.insert(out.end(), reinterpret_cast<const u8 *>(&fields), reinterpret_cast<const u8 *>(&fields) + sizeof(T))),
+     ...);
+}
+
+template <typename... T>
+void restoreFields(std::span<const u8> &in, T &...fields) {
+    static_assert((std::is_trivially_copyable_v<T> && ...));
+    ((std::memcpy(&fields, in.data(), sizeof(T)), in = in.subspan(sizeof(T))), ...);
+}
+}  // namespace
+
+void HitObject::saveState(std::vector<u8> &out) const {
+    saveFields(out, m_deltaMS, m_autopilotDeltaMS, m_blocked, m_misAim, m_finished);
+}
+
+void HitObject::restoreState(std::span<const u8> &in) {
+    restoreFields(in, m_deltaMS, m_autopilotDeltaMS, m_blocked, m_misAim, m_finished);
+}
+
 float HitObject::lerp3f(float a, float b, float c, float percent) {
     if(percent <= 0.5f)
         return std::lerp(a, b, percent * 2.0f);
@@ -1003,6 +1056,16 @@ void Circle::onReset(i32 curPosMS) {
     }
 }
 
+void Circle::saveState(std::vector<u8> &out) const {
+    HitObject::saveState(out);
+    saveFields(out, m_waiting);
+}
+
+void Circle::restoreState(std::span<const u8> &in) {
+    HitObject::restoreState(in);
+    restoreFields(in, m_waiting);
+}
+
 vec2 Circle::getAutoCursorPos(i32 /*curPos*/) const { return m_pi->osuCoords2Pixels(m_rawPos); }
 
 Slider::Slider(SLIDERCURVETYPE stype, int repeat, float pixelLength, std::vector<vec2> points,
@@ -2296,6 +2359,34 @@ void Slider::onReset(i32 curPosMS) {
     }
 }
 
+void Slider::saveState(std::vector<u8> &out) const {
+    HitObject::saveState(out);
+    saveFields(out, m_curPoint, m_curPointRaw, m_strictTrackingModLastClickHeldTime, m_ignoredKeys, m_curRepeat,
+               m_curRepeatCounterForHitSounds, m_startResult, m_endResult, m_startFinished, m_endFinished,
+               m_cursorLeft, m_cursorInside, m_heldTillEnd, m_heldTillEndForLenienceHack,
+               m_heldTillEndForLenienceHackCheck, m_inReverse, m_hideNumberAfterFirstRepeatHit);
+    for(const auto &click : m_clicks) {
+        saveFields(out, click.finished, click.successful);
+    }
+    for(const auto &tick : m_ticks) {
+        saveFields(out, tick.finished);
+    }
+}
+
+void Slider::restoreState(std::span<const u8> &in) {
+    HitObject::restoreState(in);
+    restoreFields(in, m_curPoint, m_curPointRaw, m_strictTrackingModLastClickHeldTime, m_ignoredKeys, m_curRepeat,
+                  m_curRepeatCounterForHitSounds, m_startResult, m_endResult, m_startFinished, m_endFinished,
+                  m_cursorLeft, m_cursorInside, m_heldTillEnd, m_heldTillEndForLenienceHack,
+                  m_heldTillEndForLenienceHackCheck, m_inReverse, m_hideNumberAfterFirstRepeatHit);
+    for(auto &click : m_clicks) {
+        restoreFields(in, click.finished, click.successful);
+    }
+    for(auto &tick : m_ticks) {
+        restoreFields(in, tick.finished);
+    }
+}
+
 Slider::HitAnim &Slider::addHitAnim(u8 typeFlags, float duration) {
     // percent = 0.001f: quickfix for 1 frame missing images
     // sanity check, avoid bogus maps with insanely fast buzzsliders overloading animationhandler
@@ -2707,6 +2798,22 @@ void Spinner::onReset(i32 curPosMS) {
         m_finished = false;
 }
 
+void Spinner::saveState(std::vector<u8> &out) const {
+    HitObject::saveState(out);
+    saveFields(out, m_percent, m_drawRot, m_rotations, m_rotationsNeeded, m_deltaOverflowMS, m_sumDeltaAngle,
+               m_deltaAngleIndex, m_deltaAngleOverflow, m_RPM, m_lastMouseAngle, m_ratio);
+    const auto *angles = reinterpret_cast<const u8 *>(m_storedDeltaAngles.get());
+    out.insert(out.end(), angles, angles + m_maxStoredDeltaAngles * sizeof(float));
+}
+
+void Spinner::restoreState(std::span<const u8> &in) {
+    HitObject::restoreState(in);
+    restoreFields(in, m_percent, m_drawRot, m_rotations, m_rotationsNeeded, m_deltaOverflowMS, m_sumDeltaAngle,
+                  m_deltaAngleIndex, m_deltaAngleOverflow, m_RPM, m_lastMouseAngle, m_ratio);
+    std::memcpy(m_storedDeltaAngles.get(), in.data(), m_maxStoredDeltaAngles * sizeof(float));
+    in = in.subspan(m_maxStoredDeltaAngles * sizeof(float));
+}
+
 void Spinner::onHit() {
     // calculate hit result
     LiveScore::HIT result = LiveScore::HIT::HIT_NULL;
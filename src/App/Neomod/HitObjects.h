@@ -1,6 +1,8 @@
 #pragma once
 #include "AnimationHandler.h"
 #include "BeatmapInterface.h"
+#include <memory>
+#include <span>
 #include <vector>
 
 class ConVar;
@@ -40,6 +42,11 @@ class HitObject {
     static void drawHitResult(const Skin *skin, float hitcircleDiameter, float rawHitcircleDiameter, vec2 rawPos,
                               LiveScore::HIT result, float animPercentInv, float hitDeltaRangePercent);
 
+    // sets the stack of every hitobject (sorted by click time) and moves the stacked ones, see Stacking.h.
+    // stackTime is (approach time * stack leniency)
+    static void calculateStacks(std::span<const std::unique_ptr<HitObject>> hitobjects, int beatmapVersion,
+                                f32 stackTime, f32 stackOffset);
+
    protected:  // only constructable through subclasses
     HitObject(i32 timeMS, HitSamples samples, int comboNumber, bool isEndOfCombo, int colorCounter, int colorOffset,
               AbstractBeatmapInterface *beatmap);
@@ -106,6 +113,11 @@ class HitObject {
     virtual void onClickEvent(std::vector<Click> & /*clicks*/) { ; }
     virtual void onReset(i32 curPosMS);
 
+    // gameplay state which update()/onClickEvent() carry over between frames (everything else is derived from the
+    // current time), for seeking in simulated replays. restoreState() consumes what saveState() appended
+    virtual void saveState(std::vector<u8> &out) const;
+    virtual void restoreState(std::span<const u8> &in);
+
    private:
     static float lerp3f(float a, float b, float c, float percent);
 
@@ -226,6 +238,9 @@ class Circle final : public HitObject {
     void onClickEvent(std::vector<Click> &clicks) override;
     void onReset(i32 curPosMS) override;
 
+    void saveState(std::vector<u8> &out) const override;
+    void restoreState(std::span<const u8> &in) override;
+
    private:
     // necessary due to the static draw functions
     static int rainbowNumber;
@@ -286,6 +301,9 @@ class Slider final : public HitObject {
     void onClickEvent(std::vector<Click> &clicks) override;
     void onReset(i32 curPosMS) override;
 
+    void saveState(std::vector<u8> &out) const override;
+    void restoreState(std::span<const u8> &in) override;
+
     void rebuildVertexBuffer(bool useRawCoords = false);
 
     [[nodiscard]] inline bool isStartCircleFinished() const { return m_startFinished; }
@@ -403,6 +421,9 @@ class Spinner final : public HitObject {
 
     void onReset(i32 curPosMS) override;
 
+    void saveState(std::vector<u8> &out) const override;
+    void restoreState(std::span<const u8> &in) override;
+
    private:
     void onHit();
     void rotate(float rad);
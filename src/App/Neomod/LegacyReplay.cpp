@@ -21,8 +21,12 @@
 #include "Logging.h"
 #include "UI.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <string_view>
 
 namespace LegacyReplay {
 
@@ -53,7 +57,26 @@ BEATMAP_VALUES getBeatmapValuesForModsLegacy(LegacyFlags modsLegacy, float legac
     return v;
 }
 
-std::vector<Frame> get_frames(u8* replay_data, uSz replay_size) {
+namespace {
+// one "w|x|y|z" frame (without the trailing comma), missing fields are 0
+Frame parse_frame(std::string_view text) {
+    const auto next_field = [&text]() -> std::string_view {
+        const uSz end = text.find('|');
+        const std::string_view field = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view{} : text.substr(end + 1);
+        return field;
+    };
+
+    Frame frame{};
+    frame.milliseconds_since_last_frame = Parsing::strto<i32>(next_field());
+    frame.x = Parsing::strto<f32>(next_field());
+    frame.y = Parsing::strto<f32>(next_field());
+    frame.key_flags = Parsing::strto<u8>(next_field());
+    return frame;
+}
+}  // namespace
+
+std::vector<Frame> get_frames(const u8* replay_data, uSz replay_size) {
     std::vector<Frame> replay_frames;
     if(replay_size <= 0) return replay_frames;
 
@@ -64,41 +87,47 @@ std::vector<Frame> get_frames(u8* replay_data, uSz replay_size) {
         return replay_frames;
     }
 
+    // the .lzma header has the decompressed size (if known), and a frame is ~20-25 characters of text.
+    // the header can claim anything though, so don't believe more than what replay_size could decompress to
+    // (replay text doesn't get anywhere near this ratio, unless it's mostly idle frames)
+    static constexpr u64 MAX_COMPRESSION_RATIO = 16;
+    if(replay_size >= 13) {
+        u64 text_size = 0;
+        std::memcpy(&text_size, replay_data + 5, sizeof(text_size));
+        if(text_size != UINT64_MAX) {
+            replay_frames.reserve(std::min<u64>(text_size, replay_size * MAX_COMPRESSION_RATIO) / 20);
+        }
+    }
+
+    // the text is decompressed in fixed-size chunks and parsed as it comes out, so the whole thing never has to be in
+    // memory. a frame which got cut off at the end of a chunk is moved to the front and completed by the next one
+    std::array<char, 16 * 1024> text;
+    uSz carry = 0;
     i32 cur_music_pos = 0;
-    std::array<u8, BUFSIZ> outbuf;
-    Packet output;
+
     strm.next_in = replay_data;
     strm.avail_in = replay_size;
-    do {
-        strm.next_out = outbuf.data();
-        strm.avail_out = outbuf.size();
+    for(;;) {
+        strm.next_out = reinterpret_cast<u8*>(text.data() + carry);
+        strm.avail_out = text.size() - carry;
 
         ret = lzma_code(&strm, LZMA_FINISH);
         if(ret != LZMA_OK && ret != LZMA_STREAM_END) {
             debugLog("Decompression error ({:d})", static_cast<unsigned int>(ret));
-            goto end;
+            break;
         }
+        const bool end_of_text = ret == LZMA_STREAM_END || strm.avail_out != 0;
+
+        std::string_view chunk{text.data(), text.size() - strm.avail_out};
+        while(!chunk.empty()) {
+            uSz frame_end = chunk.find(',');
+            if(frame_end == std::string_view::npos) {
+                if(!end_of_text) break;
+                frame_end = chunk.size();  // last frame without a trailing comma
+            }
 
-        output.write_bytes(outbuf.data(), outbuf.size() - strm.avail_out);
-    } while(strm.avail_out == 0);
-    output.write<u8>('\0');
-
-    {
-        char* line = (char*)output.memory;
-        while(*line) {
-            Frame frame;
-
-            char* ms = Parsing::strtok_x('|', &line);
-            frame.milliseconds_since_last_frame = Parsing::strto<i32>(ms);
-
-            char* x = Parsing::strtok_x('|', &line);
-            frame.x = Parsing::strto<f32>(x);
-
-            char* y = Parsing::strtok_x('|', &line);
-            frame.y = Parsing::strto<f32>(y);
-
-            char* flags = Parsing::strtok_x(',', &line);
-            frame.key_flags = Parsing::strto<u8>(flags);
+            Frame frame = parse_frame(chunk.substr(0, frame_end));
+            chunk.remove_prefix(std::min(frame_end + 1, chunk.size()));
 
             if(frame.milliseconds_since_last_frame != -12345) {
                 cur_music_pos += frame.milliseconds_since_last_frame;
@@ -106,10 +135,17 @@ std::vector<Frame> get_frames(u8* replay_data, uSz replay_size) {
                 replay_frames.push_back(frame);
             }
         }
+
+        if(end_of_text) break;
+        if(chunk.size() == text.size()) {
+            debugLog("Replay frame longer than {:d} characters, giving up", text.size());
+            break;
+        }
+
+        carry = chunk.size();
+        std::memmove(text.data(), chunk.data(), carry);
     }
 
-end:
-    free(output.memory);
     lzma_end(&strm);
     return replay_frames;
 }
@@ -159,7 +195,7 @@ std::vector<u8> compress_frames(const std::vector<Frame>& frames) {
     return compressed;
 }
 
-Info from_bytes(u8* data, uSz s_data) {
+Info from_bytes(u8* data, uSz s_data, bool load_frames) {
     Info info;
 
     Packet replay;
@@ -191,10 +227,11 @@ Info from_bytes(u8* data, uSz s_data) {
 
     i32 replay_size = replay.read<i32>();
     if(replay_size <= 0) return info;
-    auto replay_data = new u8[replay_size];
-    replay.read_bytes(replay_data, replay_size);
-    info.frames = get_frames(replay_data, replay_size);
-    delete[] replay_data;
+    if(load_frames && replay.pos < replay.size) {
+        // decoded in place, a truncated replay just decodes into fewer frames
+        info.frames = get_frames(replay.memory + replay.pos, std::min<uSz>(replay_size, replay.size - replay.pos));
+    }
+    replay.pos += replay_size;
 
     // https://github.com/ppy/osu/blob/a0e300c3/osu.Game/Scoring/Legacy/LegacyScoreDecoder.cs
     if(info.osu_version >= 20140721) {
@@ -240,9 +277,9 @@ bool load_from_disk(FinishedScore& score, bool update_db) {
         success = true;  // FIXME/TODO (?): we're just assuming from_bytes/get_frames will have worked?
 
         if(update_db) {
-            Sync::unique_lock lk(db->scores_mtx);
-            if(const auto& it = db->getScoresMutable().find(score.beatmap_hash); it != db->getScoresMutable().end()) {
-                if(auto scorevecIt = std::ranges::find(it->second, score); scorevecIt != it->second.end()) {
+            Sync::unique_lock lk(db->diff_hash_mtx);
+            if(auto* scores = db->getScoresMutable(score.beatmap_hash)) {
+                if(auto scorevecIt = std::ranges::find(*scores, score); scorevecIt != scores->end()) {
                     scorevecIt->replay = score.replay;
                 }
             }
@@ -59,8 +59,11 @@ struct Info {
 BEATMAP_VALUES getBeatmapValuesForModsLegacy(LegacyFlags modsLegacy, float legacyAR, float legacyCS, float legacyOD,
                                              float legacyHP);
 
-Info from_bytes(u8* data, uSz s_data);
-std::vector<Frame> get_frames(u8* replay_data, uSz replay_size);
+// parses an .osr file. without load_frames, only the header/score values are read (frames stays empty)
+Info from_bytes(u8* data, uSz s_data, bool load_frames = true);
+
+// decompresses and parses replay frames incrementally, without holding all of the decompressed text in memory
+std::vector<Frame> get_frames(const u8* replay_data, uSz replay_size);
 std::vector<u8> compress_frames(const std::vector<Frame>& frames);
 bool load_from_disk(FinishedScore& score, bool update_db);
 void load_and_watch(FinishedScore score);
@@ -873,7 +873,8 @@ CONVAR(rich_presence_map_backgrounds, true, CLIENT | SKINS | SERVER);
 CONVAR(scoreboard_animations, true, CLIENT | SKINS | SERVER, "animate in-game scoreboard");
 CONVAR(scores_bonus_pp, true, CLIENT | SKINS | SERVER, "whether to add bonus pp to total (real) pp or not");
 CONVAR(scores_enabled, true, CLIENT | SKINS | SERVER);
-CONVAR(scores_save_immediately, true, CLIENT | SKINS | SERVER, "write scores.db as soon as a new score is added");
+CONVAR(scores_save_immediately, true, CLIENT | SKINS | SERVER,
+       "journal new scores to disk as soon as they are added (otherwise they are only written on save/exit)");
 CONVAR(scores_sort_by_pp, true, CLIENT | SKINS | SERVER, "fall back to pp in score browser instead of score");
 CONVAR(scores_always_display_pp, false, CLIENT | SKINS | SERVER,
        "ignore score sorting type and always show pp instead of score");
@@ -881,6 +882,8 @@ CONVAR(scrubbing_smooth, true, CLIENT | SKINS | SERVER);
 CONVAR(seek_delta, 5, CLIENT | SKINS | SERVER, "how many seconds to skip backward/forward when quick seeking");
 CONVAR(show_approach_circle_on_first_hidden_object, true, CLIENT | SKINS | SERVER);
 CONVAR(simulate_replays, false, CLIENT | SKINS | SERVER, "experimental \"improved\" replay playback");
+CONVAR(simulate_replays_checkpoint_interval, 10, CLIENT | SKINS | SERVER,
+       "seconds of replay time between saved simulation states, which seeking continues from");
 CONVAR(skin, "default"sv, CLIENT | SKINS | SERVER);
 CONVAR(skin_fallback, ""sv, CLIENT | SKINS | SERVER, "fallback skin for missing elements");
 CONVAR(skin_animation_force, false, CLIENT | SKINS | SERVER);
@@ -152,7 +152,7 @@ void updateBanchoMods() {
 
     // Servers like akatsuki send different leaderboards based on what mods
     // you have selected. Reset leaderboard when switching mods.
-    db->getOnlineScores().clear();
+    db->clearOnlineScores();
     ui->getSongBrowser()->onGotNewLeaderboard(map_md5);
 }
 
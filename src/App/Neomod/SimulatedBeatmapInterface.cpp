@@ -33,6 +33,8 @@ SimulatedBeatmapInterface::~SimulatedBeatmapInterface() { this->hitobjects.clear
 void SimulatedBeatmapInterface::simulate_to(i32 music_pos) {
     if(this->spectated_replay.size() < 2) return;
 
+    const i32 checkpoint_interval_ms = cv::simulate_replays_checkpoint_interval.getInt() * 1000;
+
     LegacyReplay::Frame current_frame = this->spectated_replay[this->current_frame_idx];
     LegacyReplay::Frame next_frame = this->spectated_replay[this->current_frame_idx + 1];
 
@@ -72,9 +74,108 @@ void SimulatedBeatmapInterface::simulate_to(i32 music_pos) {
         this->iCurMusicPos = current_frame.cur_music_pos;
 
         this->update(frame_time);
+
+        if(checkpoint_interval_ms > 0 && !this->checkpoints.empty() &&
+           this->iCurMusicPos >= this->checkpoints.back().music_pos + checkpoint_interval_ms) {
+            this->saveCheckpoint();
+        }
     }
 }
 
+void SimulatedBeatmapInterface::seek(i32 music_pos) {
+    if(this->checkpoints.empty()) return;
+
+    // last checkpoint at or before music_pos, or the initial state if there is none
+    auto it = std::ranges::upper_bound(this->checkpoints, music_pos, {}, &Checkpoint::music_pos);
+    if(it != this->checkpoints.begin()) --it;
+
+    // seeking forward: only skip ahead if there is a checkpoint between here and there
+    if(music_pos >= this->iCurMusicPos && it->music_pos <= this->iCurMusicPos) return;
+
+    this->restoreCheckpoint(*it);
+}
+
+void SimulatedBeatmapInterface::disable_checkpoints() {
+    this->checkpoints_enabled = false;
+    this->checkpoints = {};
+}
+
+void SimulatedBeatmapInterface::saveCheckpoint() {
+    Checkpoint &checkpoint = this->checkpoints.emplace_back();
+    checkpoint.live_score = this->live_score;
+    checkpoint.clicks = this->clicks;
+
+    // the first checkpoint has the initial state of every hitobject, the others only the ones which the update loop
+    // doesn't skip (see the PVS optimization in update())
+    checkpoint.first_active = 0;
+    checkpoint.end_active = this->hitobjects.size();
+    if(this->checkpoints.size() > 1) {
+        const i32 pvs = this->getPVS();
+        const auto is_past = [&](const std::unique_ptr<HitObject> &hitobject) {
+            return hitobject->isFinished() &&
+                   this->iCurMusicPos - pvs > hitobject->getClickTime() + hitobject->getDuration();
+        };
+        const auto is_future = [&](const std::unique_ptr<HitObject> &hitobject) {
+            return hitobject->getClickTime() > this->iCurMusicPos + pvs;
+        };
+
+        checkpoint.end_active = std::ranges::find_if(this->hitobjects, is_future) - this->hitobjects.begin();
+        while(checkpoint.first_active < checkpoint.end_active &&
+              is_past(this->hitobjects[checkpoint.first_active])) {
+            checkpoint.first_active++;
+        }
+    }
+    for(u32 i = checkpoint.first_active; i < checkpoint.end_active; i++) {
+        this->hitobjects[i]->saveState(checkpoint.hitobject_states);
+    }
+
+    checkpoint.music_pos = this->iCurMusicPos;
+    checkpoint.frame_idx = this->current_frame_idx;
+    checkpoint.allow_any_next_key_until_idx = this->iAllowAnyNextKeyUntilHitObjectIndex;
+    checkpoint.health = this->fHealth;
+    checkpoint.mouse_pos = this->interpolatedMousePos;
+    checkpoint.auto_cursor_pos = this->vAutoCursorPos;
+    checkpoint.keys = this->current_keys;
+    checkpoint.last_keys = this->last_keys;
+    checkpoint.last_pressed_key = this->lastPressedKey;
+    checkpoint.holding_slider = this->holding_slider;
+    checkpoint.failed = this->bFailed;
+    checkpoint.in_break = this->bInBreak;
+    checkpoint.spinner_active = this->bIsSpinnerActive;
+}
+
+void SimulatedBeatmapInterface::restoreCheckpoint(const Checkpoint &checkpoint) {
+    std::span<const u8> initial_states{this->checkpoints[0].hitobject_states};
+    std::span<const u8> saved_states{checkpoint.hitobject_states};
+    for(u32 i = 0; i < this->hitobjects.size(); i++) {
+        const auto &hitobject = this->hitobjects[i];
+        hitobject->restoreState(initial_states);
+        if(i >= checkpoint.first_active && i < checkpoint.end_active) {
+            hitobject->restoreState(saved_states);
+        } else {
+            // finished if it's before the active ones, untouched if it's after them
+            hitobject->onReset(checkpoint.music_pos);
+        }
+    }
+
+    this->live_score = checkpoint.live_score;
+    this->clicks = checkpoint.clicks;
+
+    this->iCurMusicPos = checkpoint.music_pos;
+    this->current_frame_idx = checkpoint.frame_idx;
+    this->iAllowAnyNextKeyUntilHitObjectIndex = checkpoint.allow_any_next_key_until_idx;
+    this->fHealth = checkpoint.health;
+    this->interpolatedMousePos = checkpoint.mouse_pos;
+    this->vAutoCursorPos = checkpoint.auto_cursor_pos;
+    this->current_keys = checkpoint.keys;
+    this->last_keys = checkpoint.last_keys;
+    this->lastPressedKey = checkpoint.last_pressed_key;
+    this->holding_slider = checkpoint.holding_slider;
+    this->bFailed = checkpoint.failed;
+    this->bInBreak = checkpoint.in_break;
+    this->bIsSpinnerActive = checkpoint.spinner_active;
+}
+
 bool SimulatedBeatmapInterface::start() {
     // reset everything, including deleting any previously loaded hitobjects from another diff which we might just have
     // played
@@ -93,6 +194,9 @@ bool SimulatedBeatmapInterface::start() {
     this->hitobjects = std::move(result.hitobjects);
     this->breaks = std::move(result.breaks);
 
+    // loadGameplay() also (re)counts the objects, which the constructor can't rely on for maps that aren't in the db
+    this->nb_hitobjects = this->beatmap->getNumObjects();
+
     // sort hitobjects by endtime
     this->hitobjectsSortedByEndTime.clear();
     this->hitobjectsSortedByEndTime.reserve(this->hitobjects.size());
@@ -108,6 +212,9 @@ bool SimulatedBeatmapInterface::start() {
 
     this->bInBreak = false;
 
+    this->checkpoints.clear();
+    if(this->checkpoints_enabled) this->saveCheckpoint();
+
     // NOTE: loading failures are handled dynamically in update(), so temporarily assume everything has worked in here
     return true;
 }
@@ -832,12 +939,6 @@ void SimulatedBeatmapInterface::calculateStacks() {
 
     debugLog("Beatmap: Calculating stacks ...");
 
-    // reset
-    for(auto &hitobject : this->hitobjects) {
-        hitobject->setStack(0);
-    }
-
-    const f32 STACK_LENIENCE = 3.0f;
     const f32 STACK_OFFSET = 0.05f;
 
     const f32 approachTime =
@@ -845,118 +946,8 @@ void SimulatedBeatmapInterface::calculateStacks() {
                                       GameRules::getMaxApproachTime());
     const f32 stackLeniency = this->beatmap->getStackLeniency();
 
-    if(this->beatmap->getVersion() > 5) {
-        // peppy's algorithm
-        // https://gist.github.com/peppy/1167470
-
-        for(int i = this->hitobjects.size() - 1; i >= 0; i--) {
-            int n = i;
-
-            HitObject *objectI = this->hitobjects[i].get();
-
-            bool isSpinner = dynamic_cast<Spinner *>(objectI) != nullptr;
-
-            if(objectI->getStack() != 0 || isSpinner) continue;
-
-            bool isHitCircle = dynamic_cast<Circle *>(objectI) != nullptr;
-            bool isSlider = dynamic_cast<Slider *>(objectI) != nullptr;
-
-            if(isHitCircle) {
-                while(--n >= 0) {
-                    HitObject *objectN = this->hitobjects[n].get();
-
-                    bool isSpinnerN = dynamic_cast<Spinner *>(objectN);
-
-                    if(isSpinnerN) continue;
-
-                    if(objectI->getClickTime() - (approachTime * stackLeniency) > (objectN->getEndTime())) break;
-
-                    vec2 objectNEndPosition = objectN->getOriginalRawPosAt(objectN->getEndTime());
-                    if(objectN->getDuration() != 0 &&
-                       vec::length(objectNEndPosition - objectI->getOriginalRawPosAt(objectI->getClickTime())) <
-                           STACK_LENIENCE) {
-                        int offset = objectI->getStack() - objectN->getStack() + 1;
-                        for(int j = n + 1; j <= i; j++) {
-                            if(vec::length(objectNEndPosition - this->hitobjects[j]->getOriginalRawPosAt(
-                                                                    this->hitobjects[j]->getClickTime())) <
-                               STACK_LENIENCE)
-                                this->hitobjects[j]->setStack(this->hitobjects[j]->getStack() - offset);
-                        }
-
-                        break;
-                    }
-
-                    if(vec::length(objectN->getOriginalRawPosAt(objectN->getClickTime()) -
-                                   objectI->getOriginalRawPosAt(objectI->getClickTime())) < STACK_LENIENCE) {
-                        objectN->setStack(objectI->getStack() + 1);
-                        objectI = objectN;
-                    }
-                }
-            } else if(isSlider) {
-                while(--n >= 0) {
-                    HitObject *objectN = this->hitobjects[n].get();
-
-                    bool isSpinner = dynamic_cast<Spinner *>(objectN) != nullptr;
-
-                    if(isSpinner) continue;
-
-                    if(objectI->getClickTime() - (approachTime * stackLeniency) > objectN->getClickTime()) break;
-
-                    if(vec::length((objectN->getDuration() != 0
-                                        ? objectN->getOriginalRawPosAt(objectN->getEndTime())
-                                        : objectN->getOriginalRawPosAt(objectN->getClickTime())) -
-                                   objectI->getOriginalRawPosAt(objectI->getClickTime())) < STACK_LENIENCE) {
-                        objectN->setStack(objectI->getStack() + 1);
-                        objectI = objectN;
-                    }
-                }
-            }
-        }
-    } else  // getSelectedDifficulty()->version < 6
-    {
-        // old stacking algorithm for old beatmaps
-        // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Beatmaps/BeatmapProcessor.cs
-
-        for(int i = 0; i < this->hitobjects.size(); i++) {
-            HitObject *currHitObject = this->hitobjects[i].get();
-            auto *sliderPointer = dynamic_cast<Slider *>(currHitObject);
-
-            const bool isSlider = (sliderPointer != nullptr);
-
-            if(currHitObject->getStack() != 0 && !isSlider) continue;
-
-            i32 startTime = currHitObject->getEndTime();
-            int sliderStack = 0;
-
-            for(int j = i + 1; j < this->hitobjects.size(); j++) {
-                HitObject *objectJ = this->hitobjects[j].get();
-
-                if(objectJ->getClickTime() - (approachTime * stackLeniency) > startTime) break;
-
-                // "The start position of the hitobject, or the position at the end of the path if the hitobject is a
-                // slider"
-                vec2 position2 = isSlider ? sliderPointer->getOriginalRawPosAt(sliderPointer->getEndTime())
-                                          : currHitObject->getOriginalRawPosAt(currHitObject->getClickTime());
-
-                if(vec::length(objectJ->getOriginalRawPosAt(objectJ->getClickTime()) -
-                               currHitObject->getOriginalRawPosAt(currHitObject->getClickTime())) < 3) {
-                    currHitObject->setStack(currHitObject->getStack() + 1);
-                    startTime = objectJ->getEndTime();
-                } else if(vec::length(objectJ->getOriginalRawPosAt(objectJ->getClickTime()) - position2) < 3) {
-                    // "Case for sliders - bump notes down and right, rather than up and left."
-                    sliderStack++;
-                    objectJ->setStack(objectJ->getStack() - sliderStack);
-                    startTime = objectJ->getEndTime();
-                }
-            }
-        }
-    }
-
-    // update hitobject positions
-    f32 stackOffset = this->fRawHitcircleDiameter * STACK_OFFSET;
-    for(auto &hitobject : this->hitobjects) {
-        if(hitobject->getStack() != 0) hitobject->updateStackPosition(stackOffset);
-    }
+    HitObject::calculateStacks(this->hitobjects, this->beatmap->getVersion(), approachTime * stackLeniency,
+                               this->fRawHitcircleDiameter * STACK_OFFSET);
 }
 
 void SimulatedBeatmapInterface::computeDrainRate() {
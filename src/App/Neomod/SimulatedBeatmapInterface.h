@@ -15,6 +15,14 @@ class SimulatedBeatmapInterface final : public AbstractBeatmapInterface {
 
     void simulate_to(i32 music_pos);
 
+    // continue from the last checkpoint at or before music_pos (the next simulate_to() walks forward from there).
+    // checkpoints are saved while simulating, so only the parts of the replay which have been simulated before are
+    // skipped. seeking forward past them just simulates forward as usual
+    void seek(i32 music_pos);
+
+    // drop the saved checkpoints and stop saving new ones, for callers which never seek (seek() then does nothing)
+    void disable_checkpoints();
+
     bool start();
     void update(f64 frame_time);
 
@@ -147,6 +155,38 @@ class SimulatedBeatmapInterface final : public AbstractBeatmapInterface {
     void calculateStacks();
     void computeDrainRate();
 
+    // everything simulate_to() carries over between frames, saved every cv::simulate_replays_checkpoint_interval
+    // seconds of replay time
+    struct Checkpoint {
+        LiveScore live_score;
+        std::vector<Click> clicks;
+
+        // HitObject::saveState() of hitobjects[first_active, end_active), the ones the update loop doesn't skip.
+        // the ones before are finished and the ones after are untouched, see restoreCheckpoint()
+        std::vector<u8> hitobject_states;
+        u32 first_active;
+        u32 end_active;
+
+        i32 music_pos;
+        i32 frame_idx;
+        i32 allow_any_next_key_until_idx;
+        f64 health;
+        vec2 mouse_pos;
+        vec2 auto_cursor_pos;
+        u8 keys;
+        u8 last_keys;
+        u8 last_pressed_key;
+        bool holding_slider;
+        bool failed;
+        bool in_break;
+        bool spinner_active;
+    };
+    void saveCheckpoint();
+    void restoreCheckpoint(const Checkpoint &checkpoint);
+
+    std::vector<Checkpoint> checkpoints;  // sorted by music_pos, the first one is the initial state
+    bool checkpoints_enabled{true};
+
     // beatmap
     bool bIsSpinnerActive;
 
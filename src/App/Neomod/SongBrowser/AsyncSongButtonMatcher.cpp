@@ -2,58 +2,19 @@
 #include "AsyncSongButtonMatcher.h"
 
 #include "AsyncPool.h"
+#include "Hashing.h"
 #include "SString.h"
+#include "SyncMutex.h"
 
 #include "SongButton.h"
 #include "DatabaseBeatmap.h"
-namespace AsyncSongButtonMatcher {
-
-namespace {
-static bool search_matcher(const DatabaseBeatmap *databaseBeatmap, const std::vector<std::string> &searchStringTokens,
-                           float speed);
-}
-
-Async::CancellableHandle<void> submitSearchMatch(std::vector<SongButton *> songButtons, const std::string &searchString,
-                                                 const std::string &hardcodedSearchString, float speedMultiplier) {
-    // prepare combined lowercase search string
-    UString uSearch;
-    const UString uHardcodedSearch{hardcodedSearchString};
-
-    if(!uHardcodedSearch.isEmpty()) {
-        uSearch.append(hardcodedSearchString);
-        uSearch.append(u' ');
-    }
 
-    uSearch.append(searchString);
-    // do case-insensitive searches
-    uSearch.lowerCase();
-
-    std::string combinedSearch{uSearch.utf8View()};
-
-    return Async::submit_cancellable(
-        [buttons = std::move(songButtons), search = std::move(combinedSearch),
-         speed = speedMultiplier](const Sync::stop_token &tok) {
-            // flag matches across entire database
-            const std::vector<std::string> searchStringTokens = SString::split<std::string>(search, ' ');
-            for(auto *songButton : buttons) {
-                // FIXME: this is unsafe, children could be getting sorted while we do this
-                std::vector<SongButton *> children = songButton->getChildren();
-                if(children.size() > 0) {
-                    for(auto c : children) {
-                        const bool match = search_matcher(c->getDatabaseBeatmap(), searchStringTokens, speed);
-                        c->setIsSearchMatch(match);
-                    }
-                } else {
-                    const bool match = search_matcher(songButton->getDatabaseBeatmap(), searchStringTokens, speed);
-                    songButton->setIsSearchMatch(match);
-                }
+#include <array>
+#include <charconv>
+#include <iterator>
+#include <optional>
 
-                // cancellation point
-                if(tok.stop_requested()) break;
-            }
-        },
-        Lane::Background);
-}
+namespace AsyncSongButtonMatcher {
 
 namespace {
 enum operatorId : uint8_t { EQ, LT, GT, LE, GE, NE };
@@ -113,6 +74,300 @@ inline constexpr std::initializer_list<Keyword> keywords = {{.str = "ar", .id =
                                                             {.str = "star", .id = STARS},
                                                             {.str = "creator", .id = CREATOR}};
 
+// a single "keyword<op>value" token, parsed once per search instead of once per difficulty
+struct Expression {
+    keywordId keyword;
+    operatorId op;
+    bool rvalue_is_percent;
+    float rvalue;
+    std::string rstring;  // lowercase, only used for string keywords (creator)
+};
+
+struct CompiledQuery {
+    std::vector<Expression> expressions;
+    std::vector<std::string> literals;  // lowercase, trimmed and deduplicated
+
+    // sets which contain every trigram of every literal; only valid if filter_by_candidates is set
+    // (there was at least one literal of 3+ characters and the metadata index is built)
+    bool filter_by_candidates{false};
+    Hash::flat::set<const DatabaseBeatmap *> candidate_sets;
+};
+
+CompiledQuery compile_query(std::string_view search);
+void find_candidate_sets(CompiledQuery &query);
+bool search_matcher(const DatabaseBeatmap *databaseBeatmap, const CompiledQuery &query, float speed);
+
+}  // namespace
+
+Async::CancellableHandle<void> submitSearchMatch(std::vector<SongButton *> songButtons, const std::string &searchString,
+                                                 const std::string &hardcodedSearchString, float speedMultiplier) {
+    // prepare combined lowercase search string
+    UString uSearch;
+    const UString uHardcodedSearch{hardcodedSearchString};
+
+    if(!uHardcodedSearch.isEmpty()) {
+        uSearch.append(hardcodedSearchString);
+        uSearch.append(u' ');
+    }
+
+    uSearch.append(searchString);
+    // do case-insensitive searches
+    uSearch.lowerCase();
+
+    std::string combinedSearch{uSearch.utf8View()};
+
+    return Async::submit_cancellable(
+        [buttons = std::move(songButtons), search = std::move(combinedSearch),
+         speed = speedMultiplier](const Sync::stop_token &tok) {
+            CompiledQuery query = compile_query(search);
+            find_candidate_sets(query);
+
+            // flag matches across entire database
+            for(auto *songButton : buttons) {
+                // FIXME: this is unsafe, children could be getting sorted while we do this
+                std::vector<SongButton *> children = songButton->getChildren();
+                if(children.size() > 0) {
+                    for(auto c : children) {
+                        const bool match = search_matcher(c->getDatabaseBeatmap(), query, speed);
+                        c->setIsSearchMatch(match);
+                    }
+                } else {
+                    const bool match = search_matcher(songButton->getDatabaseBeatmap(), query, speed);
+                    songButton->setIsSearchMatch(match);
+                }
+
+                // cancellation point
+                if(tok.stop_requested()) break;
+            }
+        },
+        Lane::Background);
+}
+
+namespace {
+
+// trigram -> ids of the sets whose metadata contains it
+// the trigrams of case-insensitive fields are taken from the lowercased text, same as the substring checks below
+struct IndexData {
+    std::vector<const DatabaseBeatmap *> sets;          // set id -> set
+    Hash::flat::map<u32, std::vector<u32>> postings;  // sorted set ids
+};
+
+// the index is only ever changed by one background task at a time (the worker): it builds a new index without holding
+// mtx and swaps it in, then folds in the sets queued by addToIndex. the main thread never takes mtx except in
+// clearIndex, after the worker has stopped
+struct MetadataIndex {
+    Sync::shared_mutex mtx;  // guards built and data
+    bool built{false};
+    IndexData data;
+
+    Sync::mutex pending_mtx;  // guards pending and worker_running
+    std::vector<const DatabaseBeatmap *> pending;
+    bool worker_running{false};  // a worker is queued or running, and will index everything in pending before exiting
+
+    // only touched from the main thread
+    Async::CancellableHandle<void> worker;
+    bool tracking{false};  // rebuildIndex was called, so additions have to be indexed
+};
+MetadataIndex metadata_index;
+
+forceinline u8 fold_case(char ch) { return static_cast<u8>(std::tolower(static_cast<unsigned char>(ch))); }
+
+void collect_trigrams(std::string_view field, bool lowercase, std::vector<u32> &out) {
+    if(field.size() < 3) return;
+
+    u32 gram = 0;
+    for(uSz i = 0; i < field.size(); i++) {
+        const u8 ch = lowercase ? fold_case(field[i]) : static_cast<u8>(field[i]);
+        gram = ((gram << 8) | ch) & 0xFFFFFFu;
+        if(i >= 2) out.push_back(gram);
+    }
+}
+
+forceinline std::string_view format_id(int id, std::array<char, 16> &buf) {
+    const auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), id);
+    return {buf.data(), ec == std::errc() ? end : buf.data()};
+}
+
+void collect_set_trigrams(const DatabaseBeatmap *set, std::vector<u32> &out) {
+    const auto add_diff = [&out](const DatabaseBeatmap *diff) {
+        collect_trigrams(diff->getTitleLatin(), true, out);
+        collect_trigrams(diff->getArtistLatin(), true, out);
+        collect_trigrams(diff->getTitleUnicode(), false, out);
+        collect_trigrams(diff->getArtistUnicode(), false, out);
+        collect_trigrams(diff->getCreator(), true, out);
+        collect_trigrams(diff->getDifficultyName(), true, out);
+        collect_trigrams(diff->getSource(), true, out);
+        collect_trigrams(diff->getTags(), true, out);
+
+        std::array<char, 16> buf;
+        if(diff->getID() > 0) collect_trigrams(format_id(diff->getID(), buf), false, out);
+        if(diff->getSetID() > 0) collect_trigrams(format_id(diff->getSetID(), buf), false, out);
+    };
+
+    if(set->getDifficulties().empty()) {
+        add_diff(set);
+    } else {
+        for(const auto &diff : set->getDifficulties()) {
+            add_diff(diff.get());
+        }
+    }
+
+    std::ranges::sort(out);
+    const auto [first, last] = std::ranges::unique(out);
+    out.erase(first, last);
+}
+
+void index_set(IndexData &index, const DatabaseBeatmap *set, std::vector<u32> &scratch) {
+    const u32 set_id = static_cast<u32>(index.sets.size());
+    index.sets.push_back(set);
+
+    scratch.clear();
+    collect_set_trigrams(set, scratch);
+    for(const u32 gram : scratch) {
+        index.postings[gram].push_back(set_id);
+    }
+}
+
+// builds the index from sets first if given, then indexes queued additions until there are none left
+void run_index_worker(std::optional<std::vector<const BeatmapSet *>> sets, const Sync::stop_token &tok) {
+    std::vector<u32> scratch;
+
+    if(sets.has_value()) {
+        IndexData fresh;
+        for(const auto *set : *sets) {
+            if(tok.stop_requested()) return;
+            index_set(fresh, set, scratch);
+        }
+
+        Sync::unique_lock lock(metadata_index.mtx);
+        metadata_index.data = std::move(fresh);
+        metadata_index.built = true;
+    }
+
+    std::vector<const DatabaseBeatmap *> added;
+    while(!tok.stop_requested()) {
+        added.clear();
+        {
+            Sync::scoped_lock lock(metadata_index.pending_mtx);
+            if(metadata_index.pending.empty()) {
+                metadata_index.worker_running = false;
+                return;
+            }
+            added.swap(metadata_index.pending);
+        }
+
+        Sync::unique_lock lock(metadata_index.mtx);
+        for(const auto *set : added) {
+            index_set(metadata_index.data, set, scratch);
+        }
+    }
+}
+
+CompiledQuery compile_query(std::string_view search) {
+    // intelligent search parser
+    // all tokens which are not expressions are literals, which all have to be found in the metadata of a diff.
+    // NOTE: the order of the operators array does matter, because find() is used to detect their presence
+    // (and '=' would then break '<=' etc.)
+    CompiledQuery query;
+    for(const std::string_view token : SString::split(search, ' ')) {
+        //  determine token type, interpret expression
+        bool expression = false;
+        for(const auto &[op_str, op_id] : operators) {
+            if(token.find(op_str) == std::string_view::npos) continue;
+
+            // split expression into left and right parts (only accept singular expressions, things like
+            // "0<bpm<1" will not work with this)
+            const std::vector<std::string_view> values{SString::split(token, op_str)};
+            if(values.size() == 2 && values[0].length() > 0 && values[1].length() > 0) {
+                const std::string_view lvalue = values[0];
+                const std::string_view rstring = values[1];
+
+                const auto rvaluePercentIndex = rstring.find('%');
+                const std::string_view rstring_num =
+                    rvaluePercentIndex == std::string_view::npos ? rstring : rstring.substr(0, rvaluePercentIndex);
+
+                // this must always be a number (at least, assume it is)
+                float rvalue{0.f};
+                if(std::from_chars(rstring_num.data(), rstring_num.data() + rstring_num.size(), rvalue).ec !=
+                   std::errc()) {
+                    rvalue = 0.f;
+                }
+
+                // find lvalue keyword in array (only continue if keyword exists)
+                for(const auto &[kw_str, kw_id] : keywords) {
+                    if(kw_str == lvalue) {
+                        expression = true;
+                        query.expressions.push_back(Expression{.keyword = kw_id,
+                                                               .op = op_id,
+                                                               .rvalue_is_percent = rvaluePercentIndex != std::string_view::npos,
+                                                               .rvalue = rvalue,
+                                                               .rstring = SString::to_lower(rstring)});
+                        break;
+                    }
+                }
+            }
+
+            break;
+        }
+
+        // if this is not an expression, it's a literal
+        if(!expression) {
+            std::string literal{token};
+            SString::trim_inplace(literal);
+            if(!SString::is_wspace_only(literal) && std::ranges::find(query.literals, literal) == query.literals.end()) {
+                query.literals.push_back(std::move(literal));
+            }
+        }
+    }
+
+    return query;
+}
+
+void find_candidate_sets(CompiledQuery &query) {
+    if(query.literals.empty()) return;
+
+    // searches don't wait for the index to be built, they just check every set until then
+    Sync::shared_lock lock(metadata_index.mtx);
+    if(!metadata_index.built) return;
+
+    // every literal has to be a substring of some field, so a matching set has to contain all of their trigrams
+    std::vector<const std::vector<u32> *> lists;
+    std::vector<u32> grams;
+    for(const auto &literal : query.literals) {
+        grams.clear();
+        collect_trigrams(literal, false, grams);
+        for(const u32 gram : grams) {
+            const auto it = metadata_index.data.postings.find(gram);
+            if(it == metadata_index.data.postings.end()) {
+                // nothing can match
+                query.filter_by_candidates = true;
+                return;
+            }
+            lists.push_back(&it->second);
+        }
+    }
+    if(lists.empty()) return;  // only short literals, can't narrow anything down
+
+    // intersect, smallest list first
+    std::ranges::sort(lists, [](const auto *a, const auto *b) { return a->size() < b->size(); });
+    const auto [first, last] = std::ranges::unique(lists);
+    lists.erase(first, last);
+
+    std::vector<u32> result{*lists[0]};
+    std::vector<u32> tmp;
+    for(uSz i = 1; i < lists.size() && !result.empty(); i++) {
+        tmp.clear();
+        std::ranges::set_intersection(result, *lists[i], std::back_inserter(tmp));
+        result.swap(tmp);
+    }
+
+    query.filter_by_candidates = true;
+    query.candidate_sets.reserve(result.size());
+    for(const u32 set_id : result) {
+        query.candidate_sets.insert(metadata_index.data.sets[set_id]);
+    }
+}
+
 // similar to SString::contains_ncase but doesn't lowercase the needle (it's already lowercase)
 static forceinline bool find_needle_in_lowercase_haystack(std::string_view haystack, std::string_view needle) {
     return !haystack.empty() && !std::ranges::search(haystack, needle, [](unsigned char ch1, unsigned char ch2) {
@@ -120,7 +375,13 @@ static forceinline bool find_needle_in_lowercase_haystack(std::string_view hayst
                                  }).empty();
 }
 
+static forceinline bool equals_lowercase(std::string_view str, std::string_view lower) {
+    return std::ranges::equal(str, lower,
+                              [](unsigned char ch1, unsigned char ch2) { return std::tolower(ch1) == ch2; });
+}
+
 static inline bool find_substr_in_metadata(const DatabaseBeatmap *diff, std::string_view lower_substr) {
+    std::array<char, 16> buf;
     return (find_needle_in_lowercase_haystack(diff->getTitleLatin(), lower_substr)) ||
            (find_needle_in_lowercase_haystack(diff->getArtistLatin(), lower_substr)) ||
            (!diff->getTitleUnicode().empty() && diff->getTitleUnicode().contains(lower_substr)) ||
@@ -129,258 +390,178 @@ static inline bool find_substr_in_metadata(const DatabaseBeatmap *diff, std::str
            (find_needle_in_lowercase_haystack(diff->getDifficultyName(), lower_substr)) ||
            (find_needle_in_lowercase_haystack(diff->getSource(), lower_substr)) ||
            (find_needle_in_lowercase_haystack(diff->getTags(), lower_substr)) ||
-           (diff->getID() > 0 && find_needle_in_lowercase_haystack(std::to_string(diff->getID()), lower_substr)) ||
-           (diff->getSetID() > 0 && find_needle_in_lowercase_haystack(std::to_string(diff->getSetID()), lower_substr));
+           (diff->getID() > 0 && find_needle_in_lowercase_haystack(format_id(diff->getID(), buf), lower_substr)) ||
+           (diff->getSetID() > 0 && find_needle_in_lowercase_haystack(format_id(diff->getSetID(), buf), lower_substr));
 }
 
-static bool search_matcher(const DatabaseBeatmap *databaseBeatmap, const std::vector<std::string> &searchStringTokens,
-                           float speed) {
-    if(databaseBeatmap == nullptr) return false;
+bool expression_matches(const DatabaseBeatmap *diff, const Expression &expr, float speed) {
+    // solve keyword
+    float compareValue = 5.0f;
+    bool is_string_compare = false;
+    switch(expr.keyword) {
+        case AR:
+            compareValue = diff->getAR();
+            break;
+        case CS:
+            compareValue = diff->getCS();
+            break;
+        case OD:
+            compareValue = diff->getOD();
+            break;
+        case HP:
+            compareValue = diff->getHP();
+            break;
+        case BPM:
+            compareValue = diff->getMostCommonBPM();
+            break;
+        case OPM:
+            compareValue = (diff->getLengthMS() > 0
+                                ? ((float)diff->getNumObjects() / (float)(diff->getLengthMS() / 1000.0f / 60.0f))
+                                : 0.0f) *
+                           speed;
+            break;
+        case CPM:
+            compareValue = (diff->getLengthMS() > 0
+                                ? ((float)diff->getNumCircles() / (float)(diff->getLengthMS() / 1000.0f / 60.0f))
+                                : 0.0f) *
+                           speed;
+            break;
+        case SPM:
+            compareValue = (diff->getLengthMS() > 0
+                                ? ((float)diff->getNumSliders() / (float)(diff->getLengthMS() / 1000.0f / 60.0f))
+                                : 0.0f) *
+                           speed;
+            break;
+        case OBJECTS:
+            compareValue = diff->getNumObjects();
+            break;
+        case CIRCLES:
+            compareValue = (expr.rvalue_is_percent
+                                ? ((float)diff->getNumCircles() / (float)diff->getNumObjects()) * 100.0f
+                                : diff->getNumCircles());
+            break;
+        case SLIDERS:
+            compareValue = (expr.rvalue_is_percent
+                                ? ((float)diff->getNumSliders() / (float)diff->getNumObjects()) * 100.0f
+                                : diff->getNumSliders());
+            break;
+        case SPINNERS:
+            compareValue = (expr.rvalue_is_percent
+                                ? ((float)diff->getNumSpinners() / (float)diff->getNumObjects()) * 100.0f
+                                : diff->getNumSpinners());
+            break;
+        case LENGTH:
+            compareValue = diff->getLengthMS() / 1000.0f;
+            break;
+        case STARS:
+            compareValue = std::round(diff->getStarRating(StarPrecalc::active_idx) * 100.0f) /
+                           100.0f;  // round to 2 decimal places
+            break;
+        case CREATOR:
+            is_string_compare = !diff->getCreator().empty();
+            break;
+    }
 
-    const auto diffs = [&bdiffs = databaseBeatmap->getDifficulties(),
-                        databaseBeatmap]() -> std::vector<const DatabaseBeatmap *> {
-        std::vector<const DatabaseBeatmap *> ret;
-        if(bdiffs.empty()) {
-            // standalone set
-            ret.push_back(databaseBeatmap);
-        } else {
-            for(const auto &diff : bdiffs) {
-                ret.push_back(diff.get());
-            }
-        }
-        return ret;
-    }();
+    // solve operator
+    switch(expr.op) {
+        case LE:
+            return compareValue <= expr.rvalue;
+        case GE:
+            return compareValue >= expr.rvalue;
+        case LT:
+            return compareValue < expr.rvalue;
+        case GT:
+            return compareValue > expr.rvalue;
+        case NE:
+            return compareValue != expr.rvalue;
+        case EQ:
+            return compareValue == expr.rvalue || (is_string_compare && equals_lowercase(diff->getCreator(), expr.rstring));
+    }
+    return false;
+}
 
-    // TODO: optimize this dumpster fire. can at least cache the parsed tokens and literal strings array instead of
-    // parsing every single damn time
+bool search_matcher(const DatabaseBeatmap *databaseBeatmap, const CompiledQuery &query, float speed) {
+    if(databaseBeatmap == nullptr) return false;
 
-    // intelligent search parser
-    // all strings which are not expressions get appended with spaces between, then checked with one call to
-    // findSubstringInDiff() the rest is interpreted NOTE: this code is quite shitty. the order of the operators
-    // array does matter, because find() is used to detect their presence (and '=' would then break '<=' etc.)
-
-    // split search string into tokens
-    // parse over all difficulties
-    bool expressionMatches = false;  // if any diff matched all expressions
-    std::vector<std::string> literalSearchStrings;
-    for(const auto *diff : diffs) {
-        bool expressionsMatch = true;  // if the current search string (meaning only the expressions in this case)
-                                       // matches the current difficulty
-
-        for(const auto &searchStringToken : searchStringTokens) {
-            // debugLog("token[{:d}] = {:s}", i, tokens[i].toUtf8());
-            //  determine token type, interpret expression
-            bool expression = false;
-            for(const auto &[op_str, op_id] : operators) {
-                if(searchStringToken.find(op_str) != std::string::npos) {
-                    // split expression into left and right parts (only accept singular expressions, things like
-                    // "0<bpm<1" will not work with this)
-                    // debugLog("splitting by string {:s}", operators[o].first.toUtf8());
-                    std::vector<std::string_view> values{SString::split(searchStringToken, op_str)};
-                    if(values.size() == 2 && values[0].length() > 0 && values[1].length() > 0) {
-                        const std::string_view lvalue = values[0];
-                        const std::string_view rstring = values[1];
-
-                        const auto rvaluePercentIndex = rstring.find('%');
-                        const bool rvalueIsPercent = (rvaluePercentIndex != std::string::npos);
-                        const float rvalue = [&rstring, rvaluePercentIndex]() -> float {
-                            float rvalue_tmp{0.f};
-                            const std::string_view rstring_sub = rvaluePercentIndex == std::string::npos
-                                                                     ? rstring
-                                                                     : rstring.substr(0, rvaluePercentIndex);
-
-                            auto [ptr, ec] = std::from_chars(rstring_sub.data(),
-                                                             rstring_sub.data() + rstring_sub.size(), rvalue_tmp);
-                            if(ec != std::errc()) return 0.f;
-                            return rvalue_tmp;
-                        }();  // this must always be a number (at least, assume it is)
-
-                        // find lvalue keyword in array (only continue if keyword exists)
-                        for(const auto &[kw_str, kw_id] : keywords) {
-                            if(kw_str == lvalue) {
-                                expression = true;
-
-                                // we now have a valid expression: the keyword, the operator and the value
-
-                                // solve keyword
-                                float compareValue = 5.0f;
-                                std::string compareString{};
-                                switch(kw_id) {
-                                    case AR:
-                                        compareValue = diff->getAR();
-                                        break;
-                                    case CS:
-                                        compareValue = diff->getCS();
-                                        break;
-                                    case OD:
-                                        compareValue = diff->getOD();
-                                        break;
-                                    case HP:
-                                        compareValue = diff->getHP();
-                                        break;
-                                    case BPM:
-                                        compareValue = diff->getMostCommonBPM();
-                                        break;
-                                    case OPM:
-                                        compareValue =
-                                            (diff->getLengthMS() > 0 ? ((float)diff->getNumObjects() /
-                                                                        (float)(diff->getLengthMS() / 1000.0f / 60.0f))
-                                                                     : 0.0f) *
-                                            speed;
-                                        break;
-                                    case CPM:
-                                        compareValue =
-                                            (diff->getLengthMS() > 0 ? ((float)diff->getNumCircles() /
-                                                                        (float)(diff->getLengthMS() / 1000.0f / 60.0f))
-                                                                     : 0.0f) *
-                                            speed;
-                                        break;
-                                    case SPM:
-                                        compareValue =
-                                            (diff->getLengthMS() > 0 ? ((float)diff->getNumSliders() /
-                                                                        (float)(diff->getLengthMS() / 1000.0f / 60.0f))
-                                                                     : 0.0f) *
-                                            speed;
-                                        break;
-                                    case OBJECTS:
-                                        compareValue = diff->getNumObjects();
-                                        break;
-                                    case CIRCLES:
-                                        compareValue =
-                                            (rvalueIsPercent
-                                                 ? ((float)diff->getNumCircles() / (float)diff->getNumObjects()) *
-                                                       100.0f
-                                                 : diff->getNumCircles());
-                                        break;
-                                    case SLIDERS:
-                                        compareValue =
-                                            (rvalueIsPercent
-                                                 ? ((float)diff->getNumSliders() / (float)diff->getNumObjects()) *
-                                                       100.0f
-                                                 : diff->getNumSliders());
-                                        break;
-                                    case SPINNERS:
-                                        compareValue =
-                                            (rvalueIsPercent
-                                                 ? ((float)diff->getNumSpinners() / (float)diff->getNumObjects()) *
-                                                       100.0f
-                                                 : diff->getNumSpinners());
-                                        break;
-                                    case LENGTH:
-                                        compareValue = diff->getLengthMS() / 1000.0f;
-                                        break;
-                                    case STARS:
-                                        compareValue =
-                                            std::round(diff->getStarRating(StarPrecalc::active_idx) * 100.0f) /
-                                            100.0f;  // round to 2 decimal places
-                                        break;
-                                    case CREATOR:
-                                        compareString = SString::to_lower(diff->getCreator());
-                                        break;
-                                }
-
-                                // solve operator
-                                bool matches = false;
-                                switch(op_id) {
-                                    case LE:
-                                        if(compareValue <= rvalue) matches = true;
-                                        break;
-                                    case GE:
-                                        if(compareValue >= rvalue) matches = true;
-                                        break;
-                                    case LT:
-                                        if(compareValue < rvalue) matches = true;
-                                        break;
-                                    case GT:
-                                        if(compareValue > rvalue) matches = true;
-                                        break;
-                                    case NE:
-                                        if(compareValue != rvalue) matches = true;
-                                        break;
-                                    case EQ:
-                                        if(compareValue == rvalue ||
-                                           (!compareString.empty() && compareString == SString::to_lower(rstring)))
-                                            matches = true;
-                                        break;
-                                }
-
-                                // debugLog("comparing {:f} {:s} {:f} (operatorId = {:d}) = {:d}", compareValue,
-                                // operators[o].first.toUtf8(), rvalue, (int)operators[o].second, (int)matches);
-
-                                if(!matches)  // if a single expression doesn't match, then the whole diff doesn't match
-                                    expressionsMatch = false;
-
-                                break;
-                            }
-                        }
-                    }
+    const auto &bdiffs = databaseBeatmap->getDifficulties();
+    const bool standalone = bdiffs.empty();
 
-                    break;
-                }
-            }
+    // cheap rejection through the metadata index first
+    if(query.filter_by_candidates) {
+        const DatabaseBeatmap *set = standalone ? databaseBeatmap->getParentSet() : databaseBeatmap;
+        if(set != nullptr && !query.candidate_sets.contains(set)) return false;
+    }
 
-            // if this is not an expression, add the token to the literalSearchStrings array
-            if(!expression) {
-                // only add it if it doesn't exist yet
-                // this check is only necessary due to multiple redundant parser executions (one per diff!)
-                bool exists = false;
-                for(const auto &literalSearchString : literalSearchStrings) {
-                    if(literalSearchString == searchStringToken) {
-                        exists = true;
-                        break;
-                    }
-                }
+    const auto for_any_diff = [&](auto &&pred) -> bool {
+        if(standalone) return pred(databaseBeatmap);
+        return std::ranges::any_of(bdiffs, [&pred](const auto &diff) -> bool { return pred(diff.get()); });
+    };
 
-                if(!exists) {
-                    std::string litAdd{searchStringToken};
-                    SString::trim_inplace(litAdd);
-                    if(!SString::is_wspace_only(litAdd)) {
-                        literalSearchStrings.push_back(litAdd);
-                    }
-                }
-            }
-        }
+    // one difficulty has to match all expressions, and one (not necessarily the same) has to contain all literals
+    if(!query.expressions.empty() && !for_any_diff([&](const DatabaseBeatmap *diff) -> bool {
+           return std::ranges::all_of(query.expressions,
+                                      [&](const Expression &expr) { return expression_matches(diff, expr, speed); });
+       })) {
+        return false;
+    }
 
-        if(expressionsMatch)  // as soon as one difficulty matches all expressions, we are done here
-        {
-            expressionMatches = true;
-            break;
-        }
+    if(!query.literals.empty() && !for_any_diff([&](const DatabaseBeatmap *diff) -> bool {
+           return std::ranges::all_of(query.literals,
+                                      [&](const std::string &literal) { return find_substr_in_metadata(diff, literal); });
+       })) {
+        return false;
     }
 
-    // if no diff matched any expression, then we can already stop here
-    if(!expressionMatches) return false;
+    return true;
+}
 
-    bool hasAnyValidLiteralSearchString = false;
-    for(const auto &literalSearchString : literalSearchStrings) {
-        if(literalSearchString.length() > 0) {
-            hasAnyValidLiteralSearchString = true;
-            break;
-        }
+}  // namespace
+
+void rebuildIndex(std::vector<const BeatmapSet *> sets) {
+    clearIndex();
+
+    metadata_index.tracking = true;
+    {
+        Sync::scoped_lock lock(metadata_index.pending_mtx);
+        metadata_index.worker_running = true;
     }
+    metadata_index.worker = Async::submit_cancellable(
+        [sets = std::move(sets)](const Sync::stop_token &tok) mutable { run_index_worker(std::move(sets), tok); },
+        Lane::Background);
+}
 
-    // early return here for literal match/contains
-    if(hasAnyValidLiteralSearchString) {
-        for(const auto *diff : diffs) {
-            bool atLeastOneFullMatch = true;
+void addToIndex(const BeatmapSet *set) {
+    if(!metadata_index.tracking) return;  // nothing to keep up to date
 
-            for(const auto &literalSearchString : literalSearchStrings) {
-                if(!find_substr_in_metadata(diff, literalSearchString)) {
-                    atLeastOneFullMatch = false;
-                    break;
-                }
-            }
+    // handed to the worker, so this never waits for the index to be built or searched
+    bool start_worker = false;
+    {
+        Sync::scoped_lock lock(metadata_index.pending_mtx);
+        metadata_index.pending.push_back(set);
+        start_worker = !metadata_index.worker_running;
+        metadata_index.worker_running = true;
+    }
+    if(start_worker) {
+        metadata_index.worker = Async::submit_cancellable(
+            [](const Sync::stop_token &tok) { run_index_worker(std::nullopt, tok); }, Lane::Background);
+    }
+}
 
-            // as soon as one diff matches all strings, we are done
-            if(atLeastOneFullMatch) return true;
-        }
+void clearIndex() {
+    metadata_index.worker.cancel();
+    if(metadata_index.worker.valid()) metadata_index.worker.wait();
+    metadata_index.worker = {};
+    metadata_index.tracking = false;
 
-        // expression may have matched, but literal didn't match, so the entire beatmap doesn't match
-        return false;
+    {
+        Sync::scoped_lock lock(metadata_index.pending_mtx);
+        metadata_index.pending.clear();
+        metadata_index.worker_running = false;
     }
 
-    return expressionMatches;
+    Sync::unique_lock lock(metadata_index.mtx);
+    metadata_index.built = false;
+    metadata_index.data = {};
 }
 
-}  // namespace
 }  // namespace AsyncSongButtonMatcher
@@ -6,7 +6,16 @@
 #include <vector>
 
 class SongButton;
+class DatabaseBeatmap;
+using BeatmapSet = DatabaseBeatmap;
+
 namespace AsyncSongButtonMatcher {
 Async::CancellableHandle<void> submitSearchMatch(std::vector<SongButton *> songButtons, const std::string &searchString,
                                                  const std::string &hardcodedSearchString, float speedMultiplier);
-}
+
+// trigram index over beatmap metadata (title, artist, creator, tags, ...), used to skip sets which can't contain
+// a literal search term without looking at their strings at all
+void rebuildIndex(std::vector<const BeatmapSet *> sets);  // builds on the background lane, searches don't use it until then
+void addToIndex(const BeatmapSet *set);                   // for sets imported after the initial load, indexed in the background
+void clearIndex();                                        // must be called before the indexed sets are destroyed
+}  // namespace AsyncSongButtonMatcher
@@ -395,19 +395,18 @@ void ScoreButton::update(CBaseUIEventCtx &c) {
             // NOTE: Allows dropped sliderends. Should fix with @PPV3
             const bool fullCombo = (sc.maxPossibleCombo > 0 && sc.numMisses == 0 && sc.numSliderBreaks == 0);
 
-            if(!sc.is_online_score) {
-                db->scores_mtx.lock();
-            }
-            auto &hashToScore = sc.is_online_score ? db->getOnlineScores() : db->getScoresMutable();
-            if(const auto &it = hashToScore.find(sc.beatmap_hash); it != hashToScore.end()) {
-                if(auto scorevecIt = std::ranges::find(it->second, sc); scorevecIt != it->second.end()) {
-                    g_songbrowser->score_resort_scheduled = true;
-                    *scorevecIt = sc;
+            {
+                Sync::unique_lock lock(db->diff_hash_mtx);
+                auto *scores = sc.is_online_score ? db->getOnlineScores(sc.beatmap_hash)
+                                                  : db->getScoresMutable(sc.beatmap_hash);
+                if(scores) {
+                    if(auto scorevecIt = std::ranges::find(*scores, sc); scorevecIt != scores->end()) {
+                        g_songbrowser->score_resort_scheduled = true;
+                        *scorevecIt = sc;
+                        if(!sc.is_online_score) db->reindexPlayerScores(sc.beatmap_hash);
+                    }
                 }
             }
-            if(!sc.is_online_score) {
-                db->scores_mtx.unlock();
-            }
 
             this->sFmtedScorePPWithCombo =
                 fmt::format("PP: {}pp ({}x{:s})", (int)std::round(sc.get_pp()), SString::thousands(sc.comboMax),
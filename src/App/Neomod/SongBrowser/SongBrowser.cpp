@@ -65,6 +65,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <charconv>
 #include <cwctype>
 #include <unordered_set>
@@ -197,7 +198,7 @@ class NoRecordsSetElement final : public CBaseUILabel {
 };
 }  // namespace
 
-// used also by SongButton
+// also the tiebreaker of most of the other comparators
 bool SongBrowser::sort_by_difficulty(SongButton const *a, SongButton const *b) {
     const auto *aPtr = a->getDatabaseBeatmap(), *bPtr = b->getDatabaseBeatmap();
     if((aPtr == nullptr) || (bPtr == nullptr)) return (aPtr == nullptr) < (bPtr == nullptr);
@@ -287,6 +288,110 @@ bool SongBrowser::sort_by_title(SongButton const *a, SongButton const *b) {
     return cmp < 0;
 }
 
+namespace {
+// everything the numeric sorting methods compare, in the order they compare it
+struct ButtonSortKey {
+    i64 grade;          // only for "By Rank Achieved"
+    bool no_beatmap;    // buttons without a beatmap go last
+    i64 primary;        // bpm, length or negated date added, 0 for "By Difficulty"
+    f32 stars;          // then falls back to sort_by_difficulty
+    f32 attr_product;
+    SongButton *button;
+
+    bool operator<(const ButtonSortKey &other) const {
+        if(this->grade != other.grade) return this->grade < other.grade;
+        if(this->no_beatmap != other.no_beatmap) return this->no_beatmap < other.no_beatmap;
+        if(this->primary != other.primary) return this->primary < other.primary;
+        if(this->stars != other.stars) return this->stars < other.stars;
+        return this->attr_product < other.attr_product;
+    }
+};
+
+forceinline f32 attr_product(f32 ar, f32 cs, f32 hp, f32 od, i32 bpm) {
+    return (ar + 1) * (cs + 1) * (hp + 1) * (od + 1) * (std::max(bpm, 1));
+}
+}  // namespace
+
+void SongBrowser::sortButtons(std::vector<SongButton *> &buttons, SortType method) {
+    switch(method) {
+        case SortType::ARTIST:
+        case SortType::CREATOR:
+        case SortType::TITLE:
+        case SortType::MAX:
+            // string comparisons, nothing to gain from the columns
+            srt::pdqsort(buttons, SORTING_METHODS[method].comparator);
+            return;
+        default:
+            break;
+    }
+
+    auto &columns = db->getBeatmapColumns();
+    const auto &stars = columns.getStars(StarPrecalc::active_idx);
+    const auto &ar = columns.getAR();
+    const auto &cs = columns.getCS();
+    const auto &hp = columns.getHP();
+    const auto &od = columns.getOD();
+    const auto &bpm = columns.getMostCommonBPM();
+    const auto &length = columns.getLengthMS();
+    const auto &date_added = columns.getDateAdded();
+
+    std::vector<ButtonSortKey> keys;
+    keys.reserve(buttons.size());
+    for(SongButton *button : buttons) {
+        ButtonSortKey &key = keys.emplace_back(ButtonSortKey{.grade = 0,
+                                                             .no_beatmap = false,
+                                                             .primary = 0,
+                                                             .stars = 0.f,
+                                                             .attr_product = 0.f,
+                                                             .button = button});
+        if(method == SortType::RANKACHIEVED) key.grade = static_cast<i64>(button->grade);
+
+        const DatabaseBeatmap *map = button->getDatabaseBeatmap();
+        if(map == nullptr) {
+            key.no_beatmap = true;
+            continue;
+        }
+
+        i32 map_bpm;
+        i64 map_date_added;
+        u32 map_length;
+        if(const u32 row = map->getColumnRow(); columns.contains(row)) {
+            map_bpm = bpm[row];
+            map_date_added = date_added[row];
+            map_length = length[row];
+            key.stars = stars[row];
+            key.attr_product = attr_product(ar[row], cs[row], hp[row], od[row], map_bpm);
+        } else {
+            // not registered with the database (shouldn't really happen)
+            map_bpm = map->getMostCommonBPM();
+            map_date_added = map->last_modification_time;
+            map_length = map->getLengthMS();
+            key.stars = map->getStarRating(StarPrecalc::active_idx);
+            key.attr_product = attr_product(map->getAR(), map->getCS(), map->getHP(), map->getOD(), map_bpm);
+        }
+
+        switch(method) {
+            case SortType::BPM:
+                key.primary = map_bpm;
+                break;
+            case SortType::DATEADDED:
+                key.primary = -map_date_added;  // newest first
+                break;
+            case SortType::LENGTH:
+                key.primary = map_length;
+                break;
+            default:
+                break;
+        }
+    }
+
+    srt::pdqsort(keys, std::less<>{});
+
+    for(uSz i = 0; i < keys.size(); i++) {
+        buttons[i] = keys[i].button;
+    }
+}
+
 namespace neomod::sbr {
 SongBrowser *g_songbrowser{nullptr};
 BeatmapCarousel *g_carousel{nullptr};
@@ -461,6 +566,7 @@ SongBrowser::~SongBrowser() {
     this->exportHandle.cancel();
     if(this->exportHandle.valid()) this->exportHandle.wait();
     this->checkHandleKillBackgroundSearchMatcher();
+    AsyncSongButtonMatcher::clearIndex();
 
     this->hashToDiffButton->clear();
     for(auto &songButton : this->parentButtons) {
@@ -1188,6 +1294,7 @@ void SongBrowser::onPlayEnd(bool quit) {
             struct stat64 attr;
             if(File::stat_c(bm->sFilePath.get(), &attr) == 0) {
                 bm->last_modification_time = attr.st_mtime;
+                db->getBeatmapColumns().update(bm);
             }
         }
         this->songInfo->setFromBeatmap(bm);
@@ -1393,6 +1500,7 @@ void SongBrowser::refreshBeatmaps(UIScreen *next_screen) {
 
     // reset
     this->checkHandleKillBackgroundSearchMatcher();
+    AsyncSongButtonMatcher::clearIndex();
 
     // clear beatmap interface to lose any potential stale references
     osu->reloadMapInterface();
@@ -1495,6 +1603,7 @@ void SongBrowser::addBeatmapSet(BeatmapSet *mapset, bool initialSongBrowserLoad)
         assert(this->lengthCollectionButtons.size() == 7);
     } else {
         this->bSongButtonsNeedSorting = true;
+        AsyncSongButtonMatcher::addToIndex(mapset);
     }
 
     const bool doDiffCollBtns = initialSongBrowserLoad || likely(this->difficultyCollectionButtons.size() == 12);
@@ -2193,25 +2302,34 @@ void SongBrowser::rebuildScoreButtons() {
 
     std::vector<FinishedScore> scores;
     if(validBeatmap) {
-        Sync::shared_lock lock(db->scores_mtx);
-
-        const FinishedScore *local_best = nullptr;
-        const auto &local_scores = db->getScores().find(mapHash);
+        // copy everything out first, the buttons below shouldn't be created while holding diff_hash_mtx
+        std::optional<FinishedScore> local_best;
+        bool have_online_scores = false;
+        {
+            Sync::shared_lock lock(db->diff_hash_mtx);
+
+            const auto *local_scores = db->getScores(mapHash);
+            if(is_online) {
+                if(local_scores) {
+                    if(const auto &elem = std::ranges::max_element(
+                           *local_scores,
+                           [](const FinishedScore &a, const FinishedScore &b) { return a.score < b.score; });
+                       elem != local_scores->end()) {
+                        local_best = *elem;
+                    }
+                }
 
-        if(is_online) {
-            if(local_scores != db->getScores().end()) {
-                if(const auto &elem = std::ranges::max_element(
-                       local_scores->second,
-                       [](const FinishedScore &a, const FinishedScore &b) { return a.score < b.score; });
-                   elem != local_scores->second.end()) {
-                    local_best = &(*elem);
+                if(const auto *online_scores = db->getOnlineScores(mapHash)) {
+                    scores = *online_scores;
+                    have_online_scores = true;
                 }
+            } else if(local_scores) {
+                scores = *local_scores;
             }
+        }
 
-            const auto &search = db->getOnlineScores().find(mapHash);
-            if(search != db->getOnlineScores().end()) {
-                scores = search->second;
-
+        if(is_online) {
+            if(have_online_scores) {
                 if(!local_best) {
                     if(!scores.empty()) {
                         // We only want to display "No scores" if there are online scores present
@@ -2254,10 +2372,6 @@ void SongBrowser::rebuildScoreButtons() {
                     this->localBestContainer->setVisible(true);
                 }
             }
-        } else {
-            if(local_scores != db->getScores().end()) {
-                scores = local_scores->second;
-            }
         }
     }
 
@@ -2434,6 +2548,14 @@ void SongBrowser::onDatabaseLoadingFinished() {
             this->addBeatmapSet(mapset.get(), true /* initial songbrowser load flag (skip some checks) */);
         }
         this->parentButtons.shrink_to_fit();
+
+        // build the search index in the background, the first search will wait for it if it's not done yet
+        std::vector<const BeatmapSet *> indexSets;
+        indexSets.reserve(numSets);
+        for(const auto &mapset : db->getBeatmapSets()) {
+            indexSets.push_back(mapset.get());
+        }
+        AsyncSongButtonMatcher::rebuildIndex(std::move(indexSets));
     }
 
     // build collections
@@ -2728,7 +2850,7 @@ void SongBrowser::onFilterScoresChange(const UString &text, int id) {
     type_cv->setValue(text_to_set);  // NOTE: remember
 
     this->filterScoresDropdown->setText(text_to_set);
-    db->getOnlineScores().clear();
+    db->clearOnlineScores();
     this->rebuildScoreButtons();
     this->scoreBrowser->scrollToTop();
 }
@@ -2869,11 +2991,16 @@ void SongBrowser::rebucketDifficultyCollections() {
 
     for(auto &btn : this->difficultyCollectionButtons) btn->setChildren({});
 
+    auto &columns = db->getBeatmapColumns();
+    const auto &column_stars = columns.getStars(StarPrecalc::active_idx);
+
     for(auto *parentBtn : this->parentButtons) {
         for(auto *child : parentBtn->getChildren()) {
             auto *diff = child->getDatabaseBeatmap();
             if(!diff) continue;
-            const float stars = diff->getStarRating(StarPrecalc::active_idx);
+            const u32 row = diff->getColumnRow();
+            const float stars =
+                columns.contains(row) ? column_stars[row] : diff->getStarRating(StarPrecalc::active_idx);
             const int idx =
                 std::clamp<int>((std::isfinite(stars) && stars >= static_cast<float>(std::numeric_limits<int>::min()) &&
                                  stars <= static_cast<float>(std::numeric_limits<int>::max()))
@@ -2913,7 +3040,7 @@ void SongBrowser::rebuildAfterGroupOrSortChange(GroupType group, const std::opti
             }
         }
         // the master button list should be sorted for all groupings
-        srt::pdqsort(this->parentButtons, SORTING_METHODS[this->curSortMethod].comparator);
+        sortButtons(this->parentButtons, this->curSortMethod);
         this->bSongButtonsNeedSorting = false;
     }
 
@@ -2959,7 +3086,7 @@ void SongBrowser::rebuildAfterGroupOrSortChange(GroupType group, const std::opti
                 for(const auto &button : *collBtns) {
                     auto &children = button->getChildren();
                     if(!children.empty()) {
-                        srt::pdqsort(children, SORTING_METHODS[this->curSortMethod].comparator);
+                        sortButtons(children, this->curSortMethod);
                         button->setChildren(children);
                     }
                 }
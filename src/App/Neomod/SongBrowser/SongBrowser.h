@@ -114,9 +114,13 @@ class SongBrowser final : public ScreenBackable {
     using SortType = SortTypes::type;
     using GroupType = GroupTypes::type;
 
-    // used also by SongButton
+    // also the tiebreaker of most of the other comparators
     static bool sort_by_difficulty(SongButton const *a, SongButton const *b);
 
+    // sorts with SORTING_METHODS[method]; the numeric methods compare keys gathered from the database's
+    // BeatmapColumns up front instead of dereferencing every button's beatmap in each comparison
+    static void sortButtons(std::vector<SongButton *> &buttons, SortType method);
+
     static f32 getUIScale();
     static i32 getUIScale(f32 m) { return (i32)(m * getUIScale()); }
     static f32 getSkinScale(const SkinImage &img);
@@ -234,7 +234,7 @@ void SongButton::drawSubTitle(float deselectedAlpha, bool forceSelectedStyle) {
 bool SongButton::sortChildren() {
     if(this->childrenNeedSorting()) {
         this->lastChildSortStarPrecalcIdx = StarPrecalc::active_idx;
-        std::ranges::sort(this->children, SongBrowser::sort_by_difficulty);
+        SongBrowser::sortButtons(this->children, SongBrowser::SortType::DIFFICULTY);
         return true;
     } else {
         return false;
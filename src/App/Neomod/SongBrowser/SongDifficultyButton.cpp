@@ -232,13 +232,13 @@ void SongDifficultyButton::updateGrade() {
     }
     this->bUpdateGradeScheduled = false;
 
-    Sync::shared_lock lock(db->scores_mtx);
-    const auto& dbScoreIt = db->getScores().find(this->databaseBeatmap->getMD5());
-    if(dbScoreIt == db->getScores().end()) {
+    Sync::shared_lock lock(db->diff_hash_mtx);
+    const auto* scores = db->getScores(this->databaseBeatmap->getMD5());
+    if(!scores) {
         return;
     }
 
-    for(const auto& score : dbScoreIt->second) {
+    for(const auto& score : *scores) {
         if(score.grade < this->grade) {
             this->grade = score.grade;
 
@@ -0,0 +1,379 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "Stacking.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Stacking {
+namespace {
+
+constexpr const f32 STACK_LENIENCE = 3.0f;
+
+// a bit wider than STACK_LENIENCE, so that rounding in the cell coordinate division can't put two positions which
+// are close enough to stack more than one cell apart
+constexpr const f32 CELL_SIZE = 4.0f;
+
+// maps with objects far outside of the playfield get coarser cells instead of a huge grid
+constexpr const f32 MAX_CELLS_PER_AXIS = 1024.0f;
+
+forceinline bool close_enough(vec2 a, vec2 b) { return vec::length(a - b) < STACK_LENIENCE; }
+
+// object indices bucketed by the grid cell of one of their positions, ascending within each cell.
+// every position within stacking distance of a point is in the 3x3 cells around it
+class Grid {
+   public:
+    void add(vec2 pos, i32 index) { this->entries.emplace_back(pos, index); }
+
+    void build() {
+        vec2 minPos{std::numeric_limits<f32>::max()};
+        vec2 maxPos{std::numeric_limits<f32>::lowest()};
+        for(const auto &[pos, index] : this->entries) {
+            if(!std::isfinite(pos.x) || !std::isfinite(pos.y)) continue;  // never close enough to anything anyways
+            minPos = vec::min(minPos, pos);
+            maxPos = vec::max(maxPos, pos);
+        }
+        if(minPos.x > maxPos.x) minPos = maxPos = vec2{0.f};
+
+        const vec2 extent = vec::min(maxPos - minPos, vec2{std::numeric_limits<f32>::max()});
+        this->origin = minPos;
+        this->cellSize = std::max(CELL_SIZE, std::max(extent.x, extent.y) / MAX_CELLS_PER_AXIS);
+        this->width = (i32)(extent.x / this->cellSize) + 1;
+        this->height = (i32)(extent.y / this->cellSize) + 1;
+
+        // counting sort into the cells, entries were added in ascending index order
+        this->offsets.assign((uSz)this->width * this->height + 1, 0);
+        for(const auto &[pos, index] : this->entries) {
+            this->offsets[this->cell_of(pos.x, pos.y) + 1]++;
+        }
+        for(uSz c = 1; c < this->offsets.size(); c++) {
+            this->offsets[c] += this->offsets[c - 1];
+        }
+
+        this->indices.resize(this->entries.size());
+        std::vector<u32> fill(this->offsets.begin(), this->offsets.end() - 1);
+        for(const auto &[pos, index] : this->entries) {
+            this->indices[fill[this->cell_of(pos.x, pos.y)]++] = index;
+        }
+
+        this->entries = {};
+    }
+
+    // largest index in (lo, hi) near pos which satisfies pred, -1 if there is none
+    template <typename Pred>
+    [[nodiscard]] i32 find_last(vec2 pos, i32 lo, i32 hi, Pred &&pred) const {
+        i32 found = -1;
+        this->for_each_cell(pos, [&](std::span<const i32> cell) {
+            for(auto it = std::ranges::lower_bound(cell, hi); it != cell.begin();) {
+                const i32 index = *--it;
+                if(index <= std::max(lo, found)) break;
+                if(pred(index)) {
+                    found = index;
+                    break;
+                }
+            }
+        });
+        return found;
+    }
+
+    // the cells around one position, for repeated forward searches from it (see find_first)
+    class Neighbourhood {
+       public:
+        // smallest index in (lo, hi) which satisfies pred, hi if there is none.
+        // lo must not decrease between calls, everything up to it is dropped for good
+        template <typename Pred>
+        [[nodiscard]] i32 find_first(i32 lo, i32 hi, Pred &&pred) {
+            i32 found = hi;
+            for(auto &cell : std::span{this->cells}.first(this->nbCells)) {
+                while(!cell.empty() && cell.front() <= lo) cell = cell.subspan(1);
+                for(const i32 index : cell) {
+                    if(index >= found) break;
+                    if(pred(index)) {
+                        found = index;
+                        break;
+                    }
+                }
+            }
+            return found;
+        }
+
+       private:
+        friend class Grid;
+        std::array<std::span<const i32>, 9> cells;
+        uSz nbCells{0};
+    };
+
+    [[nodiscard]] Neighbourhood around(vec2 pos) const {
+        Neighbourhood result;
+        this->for_each_cell(pos, [&](std::span<const i32> cell) { result.cells[result.nbCells++] = cell; });
+        return result;
+    }
+
+    // every index in (lo, hi) near pos, in no particular order
+    template <typename Fn>
+    void for_each(vec2 pos, i32 lo, i32 hi, Fn &&fn) const {
+        this->for_each_cell(pos, [&](std::span<const i32> cell) {
+            for(auto it = std::ranges::upper_bound(cell, lo); it != cell.end() && *it < hi; ++it) {
+                fn(*it);
+            }
+        });
+    }
+
+   private:
+    // positions outside of the grid (only possible for lookups) are clamped onto its border, which still covers
+    // everything in the grid that could be close enough to them
+    [[nodiscard]] forceinline i32 cell_coord(f32 v, f32 origin, i32 cells) const {
+        if(std::isnan(v)) return 0;
+        return (i32)std::clamp((v - origin) / this->cellSize, 0.f, (f32)(cells - 1));
+    }
+    [[nodiscard]] forceinline uSz cell_of(f32 x, f32 y) const {
+        return (uSz)this->cell_coord(x, this->origin.x, this->width) * this->height +
+               this->cell_coord(y, this->origin.y, this->height);
+    }
+
+    template <typename Fn>
+    void for_each_cell(vec2 pos, Fn &&fn) const {
+        const i32 x = this->cell_coord(pos.x, this->origin.x, this->width);
+        const i32 y = this->cell_coord(pos.y, this->origin.y, this->height);
+        for(i32 cx = std::max(x - 1, 0); cx <= std::min(x + 1, this->width - 1); cx++) {
+            for(i32 cy = std::max(y - 1, 0); cy <= std::min(y + 1, this->height - 1); cy++) {
+                const uSz c = (uSz)cx * this->height + cy;
+                if(this->offsets[c] == this->offsets[c + 1]) continue;
+                fn(std::span<const i32>{&this->indices[this->offsets[c]], this->offsets[c + 1] - this->offsets[c]});
+            }
+        }
+    }
+
+    std::vector<std::pair<vec2, i32>> entries;  // only until build()
+    std::vector<u32> offsets;                   // into indices, one more than there are cells
+    std::vector<i32> indices;
+    vec2 origin{0.f};
+    f32 cellSize{CELL_SIZE};
+    i32 width{1};
+    i32 height{1};
+};
+
+// min segment tree over one value per object, for finding where a backwards scan over the objects would have stopped
+class LastBelow {
+   public:
+    explicit LastBelow(std::span<const f32> values) {
+        this->leaves = std::bit_ceil(std::max<uSz>(values.size(), 1));
+        this->tree.assign(2 * this->leaves, std::numeric_limits<f32>::infinity());
+        std::ranges::copy(values, this->tree.begin() + (std::ptrdiff_t)this->leaves);
+        for(uSz v = this->leaves - 1; v > 0; v--) {
+            this->tree[v] = std::min(this->tree[2 * v], this->tree[2 * v + 1]);
+        }
+    }
+
+    [[nodiscard]] forceinline f32 value(i32 index) const { return this->tree[this->leaves + index]; }
+
+    // largest index below end whose value is < threshold, -1 if there is none
+    [[nodiscard]] i32 find(i32 end, f32 threshold) const {
+        if(end <= 0) return -1;
+
+        uSz v = this->leaves + end - 1;
+        while(!(this->tree[v] < threshold)) {
+            // move on to the subtree covering the range right before this one
+            while((v & 1) == 0) v >>= 1;
+            if(v == 1) return -1;
+            v--;
+        }
+        while(v < this->leaves) {
+            v = 2 * v + 1;
+            if(!(this->tree[v] < threshold)) v--;
+        }
+        return (i32)(v - this->leaves);
+    }
+
+   private:
+    std::vector<f32> tree;
+    uSz leaves;
+};
+
+// most stacks are on one of the objects right next to each other, so this many are checked directly like the original
+// loops did, before the grid lookups take over
+constexpr const i32 LINEAR_SCAN = 8;
+
+}  // namespace
+
+void calculate(std::span<const Object> objects, std::span<i32> stacks, int beatmapVersion, f32 stackTime) {
+    using enum Object::Type;
+
+    std::ranges::fill(stacks, 0);
+
+    const i32 count = (i32)objects.size();
+    if(count < 2) return;
+
+    Grid starts;
+    for(i32 i = 0; i < count; i++) {
+        starts.add(objects[i].pos, i);
+    }
+    starts.build();
+
+    if(beatmapVersion > 5) {
+        // peppy's algorithm
+        // https://gist.github.com/peppy/1167470
+        //
+        // the original walks backwards from every unstacked object, and only the objects it doesn't skip over (the
+        // ones that stack) matter. scan_back finds those directly, the trees tell where the walk would have stopped
+        Grid ends;  // only objects which have an end position to stack on
+        std::vector<f32> endTimes(count);
+        std::vector<f32> times(count);
+        for(i32 i = 0; i < count; i++) {
+            const Object &o = objects[i];
+            const bool isSpinner = o.type == SPINNER;
+            if(!isSpinner && o.duration != 0) ends.add(o.endPos, i);
+
+            // spinners are skipped over, they never stop the walk
+            endTimes[i] = isSpinner ? std::numeric_limits<f32>::infinity() : (f32)o.endTime;
+            times[i] = isSpinner ? std::numeric_limits<f32>::infinity() : (f32)o.time;
+        }
+        ends.build();
+
+        const LastBelow lastEndingBefore(endTimes);
+        const LastBelow lastStartingBefore(times);
+
+        // the first non-spinner below cur that matches, or -1 if the walk leaves the window (ends/starts before
+        // window's threshold) before reaching one. gridSearch(stop, hi) finds the last match in (stop, hi)
+        const auto scan_back = [&](i32 cur, const LastBelow &window, auto &&matches, auto &&gridSearch) -> i32 {
+            const f32 threshold = (f32)objects[cur].time - stackTime;
+
+            i32 n = cur;
+            for(i32 k = 0; k < LINEAR_SCAN; k++) {
+                if(--n < 0) return -1;
+                if(objects[n].type == SPINNER) continue;
+                if(window.value(n) < threshold) return -1;
+                if(matches(n)) return n;
+            }
+            return gridSearch(window.find(n, threshold), n);
+        };
+
+        for(i32 i = count - 1; i >= 0; i--) {
+            if(stacks[i] != 0 || objects[i].type == SPINNER) continue;
+
+            if(objects[i].type == CIRCLE) {
+                for(i32 cur = i;;) {
+                    const vec2 pos = objects[cur].pos;
+                    const auto endsOnCur = [&](i32 n) {
+                        return objects[n].duration != 0 && close_enough(objects[n].endPos, pos);
+                    };
+                    const auto startsOnCur = [&](i32 n) { return close_enough(objects[n].pos, pos); };
+
+                    const i32 n = scan_back(
+                        cur, lastEndingBefore, [&](i32 n) { return endsOnCur(n) || startsOnCur(n); },
+                        [&](i32 stop, i32 hi) {
+                            return std::max(ends.find_last(pos, stop, hi, endsOnCur),
+                                            starts.find_last(pos, stop, hi, [&](i32 n) {
+                                                return objects[n].type != SPINNER && startsOnCur(n);
+                                            }));
+                        });
+                    if(n < 0) break;
+
+                    if(endsOnCur(n)) {
+                        const vec2 objectNEndPosition = objects[n].endPos;
+                        const i32 offset = stacks[cur] - stacks[n] + 1;
+                        starts.for_each(objectNEndPosition, n, i + 1, [&](i32 j) {
+                            if(close_enough(objectNEndPosition, objects[j].pos)) stacks[j] -= offset;
+                        });
+                        break;
+                    }
+
+                    stacks[n] = stacks[cur] + 1;
+                    cur = n;
+                }
+            } else {
+                for(i32 cur = i;;) {
+                    const vec2 pos = objects[cur].pos;
+                    const auto endsOnCur = [&](i32 n) { return close_enough(objects[n].endPos, pos); };
+                    const auto startsOnCur = [&](i32 n) {
+                        return objects[n].duration == 0 && close_enough(objects[n].pos, pos);
+                    };
+
+                    const i32 n = scan_back(
+                        cur, lastStartingBefore,
+                        [&](i32 n) { return objects[n].duration != 0 ? endsOnCur(n) : startsOnCur(n); },
+                        [&](i32 stop, i32 hi) {
+                            return std::max(ends.find_last(pos, stop, hi, endsOnCur),
+                                            starts.find_last(pos, stop, hi, [&](i32 n) {
+                                                return objects[n].type != SPINNER && startsOnCur(n);
+                                            }));
+                        });
+                    if(n < 0) break;
+
+                    stacks[n] = stacks[cur] + 1;
+                    cur = n;
+                }
+            }
+        }
+    } else {
+        // old stacking algorithm for old beatmaps
+        // https://github.com/ppy/osu/blob/master/osu.Game.Rulesets.Osu/Beatmaps/OsuBeatmapProcessor.cs
+        for(i32 i = 0; i < count; i++) {
+            const Object &objectI = objects[i];
+            const bool isSlider = objectI.type == SLIDER;
+
+            if(stacks[i] != 0 && !isSlider) continue;
+
+            // "The start position of the hitobject, or the position at the end of the path if the hitobject is a
+            // slider"
+            const vec2 position2 = isSlider ? objectI.endPos : objectI.pos;
+
+            i32 startTime = objectI.time + objectI.duration;
+            i32 sliderStack = 0;
+
+            const auto startsOnI = [&](i32 j) { return close_enough(objects[j].pos, objectI.pos); };
+            const auto startsOnPosition2 = [&](i32 j) { return close_enough(objects[j].pos, position2); };
+
+            // only needed once the linear scans come up empty, position2 is the same as objectI.pos for non-sliders
+            std::optional<Grid::Neighbourhood> aroundI;
+            std::optional<Grid::Neighbourhood> aroundPosition2;
+
+            for(i32 j = i;;) {
+                const f32 threshold = (f32)startTime;
+                const auto outsideWindow = [&](const Object &o) { return (f32)o.time - stackTime > threshold; };
+
+                // the next object after j which starts on either position, same idea as scan_back above
+                i32 next = j + 1;
+                const i32 linearEnd = std::min(count, next + LINEAR_SCAN);
+                while(next < linearEnd && !outsideWindow(objects[next]) && !startsOnI(next) &&
+                      !startsOnPosition2(next)) {
+                    next++;
+                }
+                if(next == count || outsideWindow(objects[next])) break;
+                if(next == linearEnd) {
+                    // objects are sorted by time, so the window ends at the first one starting too late
+                    const auto rest = objects.subspan(next);
+                    const i32 end =
+                        next + (i32)(std::ranges::partition_point(rest, std::not_fn(outsideWindow)) - rest.begin());
+
+                    if(!aroundI) aroundI = starts.around(objectI.pos);
+                    i32 found = aroundI->find_first(next - 1, end, startsOnI);
+                    if(isSlider) {
+                        if(!aroundPosition2) aroundPosition2 = starts.around(position2);
+                        found = std::min(found, aroundPosition2->find_first(next - 1, end, startsOnPosition2));
+                    }
+                    if(found == end) break;
+                    next = found;
+                }
+
+                j = next;
+                if(startsOnI(j)) {
+                    stacks[i]++;
+                } else {
+                    // "Case for sliders - bump notes down and right, rather than up and left."
+                    sliderStack++;
+                    stacks[j] -= sliderStack;
+                }
+                startTime = objects[j].time + objects[j].duration;
+            }
+        }
+    }
+}
+
+}  // namespace Stacking
@@ -0,0 +1,32 @@
+#pragma once
+// Copyright (c) 2026, WH, All rights reserved.
+
+#include "noinclude.h"
+#include "types.h"
+#include "Vectors.h"
+
+#include <span>
+
+// osu!stable hitobject stacking, shared between gameplay (BeatmapInterface, SimulatedBeatmapInterface) and star
+// calculation (DatabaseBeatmap::loadDifficultyHitObjects), which used to carry their own copies of it.
+// works on plain position/time data instead of hitobjects, so the (virtual) position lookups happen once per object
+// up front, and neighbours are found through a uniform grid over the unstacked positions instead of by scanning every
+// object in the stacking time window.
+namespace Stacking {
+
+struct Object {
+    enum class Type : u8 { CIRCLE, SLIDER, SPINNER };
+
+    vec2 pos;     // unstacked position at time
+    vec2 endPos;  // unstacked position at time + duration (same as pos for non-sliders)
+    i32 time;
+    i32 endTime;   // as used for the time window of peppy's algorithm
+    i32 duration;  // as used for the end position and the time window of the old algorithm
+    Type type;
+};
+
+// objects must be sorted by time. stackTime is (approach time * stack leniency).
+// overwrites stacks (one per object) with the stack index of every object, exactly like the original nested loops did
+void calculate(std::span<const Object> objects, std::span<i32> stacks, int beatmapVersion, f32 stackTime);
+
+}  // namespace Stacking
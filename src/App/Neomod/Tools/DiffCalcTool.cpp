@@ -12,12 +12,77 @@
 #include "ModFlags.h"
 #include "SString.h"
 #include "Parsing.h"
+#include "StarPrecalc.h"
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef BUILD_TOOLS_ONLY
+#include <cstdlib>
+#include <new>
+
+// count heap allocations for --regress (only in the standalone build, the game keeps its own allocator).
+// every replaceable form is replaced, so that new[] and over-aligned allocations are counted too, and so that
+// nothing ends up freeing memory from a different allocator
+static std::atomic<uint64_t> s_numAllocations{0};
+
+namespace {
+void *countedAlloc(std::size_t size, std::size_t alignment) noexcept {
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if(size == 0) size = 1;
+    if(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return std::malloc(size);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void *countedAllocOrThrow(std::size_t size, std::size_t alignment) {
+    if(void *ptr = countedAlloc(size, alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void countedFree(void *ptr) noexcept { std::free(ptr); }
+}  // namespace
+
+void *operator new(std::size_t size) { return countedAllocOrThrow(size, 0); }
+void *operator new[](std::size_t size) { return countedAllocOrThrow(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al) { return countedAllocOrThrow(size, (std::size_t)al); }
+void *operator new[](std::size_t size, std::align_val_t al) { return countedAllocOrThrow(size, (std::size_t)al); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size, 0); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+    return countedAlloc(size, (std::size_t)al);
+}
+void *operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t &) noexcept {
+    return countedAlloc(size, (std::size_t)al);
+}
+
+void operator delete(void *ptr) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(ptr); }
+#endif
 
 namespace {  // static
 
@@ -153,82 +218,108 @@ std::string modsStringFromMods(ModFlags mods, float speed) {
     return modsString;
 }
 
-}  // namespace
+// one beatmap + mods/speed/hit counts to calculate (a single invocation, or one line of a bulk run)
+struct CalcJob {
+    std::string path{};
+    float speed = 1.0f;
+    ModFlags mods = {};
+    // -1 = full combo / SS
+    int combo = -1;
+    int misses = 0;
+    int c300 = -1;
+    int c100 = 0;
+    int c50 = 0;
+};
 
-#ifdef BUILD_TOOLS_ONLY
-#define entrypoint main
-#else
-#define entrypoint NEOMOD_run_diffcalc
-#endif
+struct CalcResult {
+    BeatmapSettings settings;
+    double totalStars = 0.0;
+    double aim = 0.0;
+    double speed = 0.0;
+    double pp = 0.0;
+    size_t numCircles = 0;
+    size_t numSliders = 0;
+    size_t numSpinners = 0;
+    size_t maxCombo = 0;
+    std::string error;  // empty on success
+};
 
-int entrypoint(int argc_, char *argv_[]) {
-    auto argv = std::vector<std::string>(argv_, argv_ + argc_);
+// accumulated wall time per calculation phase, in seconds
+struct PhaseTimes {
+    double parse = 0.0;    // reading the file + loadPrimitiveObjectsFromData
+    double curve = 0.0;    // loadDifficultyHitObjects (slider timing, curves, stacking)
+    double strains = 0.0;  // calculateStarDiffForHitObjects
+    double pp = 0.0;       // calculatePPv2
 
-#ifdef BUILD_TOOLS_ONLY
-    // lazy
-    argv.insert(argv.begin() + 1, "-");
-    constexpr std::string_view usage = "<osu_file> [speed] [mod flags bitmask (0xHEX)]";
-#else
-    constexpr std::string_view usage = "-diffcalc <osu_file> [speed] [mod flags bitmask (0xHEX)]";
-#endif
+    PhaseTimes &operator+=(const PhaseTimes &other) {
+        parse += other.parse;
+        curve += other.curve;
+        strains += other.strains;
+        pp += other.pp;
+        return *this;
+    }
+};
 
-    size_t argc = argv.size();
+using Clock = std::chrono::steady_clock;
 
-    if(argc < 3) {
-        std::cerr << "usage: " << argv[0] << usage << '\n';
-        return 1;
-    }
+double secondsSince(Clock::time_point &last) {
+    const auto now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - last).count();
+    last = now;
+    return elapsed;
+}
 
-    std::string osuFilePath = argv[2];
+bool parseSpeed(std::string_view cur, float &out) {
+    float speedTemp = 1.f;
+    auto [ptr, ec] = std::from_chars(cur.data(), cur.data() + cur.size(), speedTemp);
+    if(ec != std::errc() || speedTemp < 0.01f || speedTemp > 3.f) return false;
+    out = speedTemp;
+    return true;
+}
 
-    LiteFile file(osuFilePath);
-    if(!file.canRead() || (file.getFileSize() == 0)) {
-        std::cerr << "error: could not read file" << osuFilePath << '\n';
-        return 1;
+bool parseModFlags(std::string_view cur, ModFlags &out) {
+    int base = 10;
+    uint64_t flagsValue = 0;
+    if(cur.starts_with("0x") || cur.starts_with("0X")) {
+        base = 16;
+        cur = cur.substr(2);
     }
+    auto [ptr, ec] = std::from_chars(cur.data(), cur.data() + cur.size(), flagsValue, base);
+    if(ec != std::errc()) return false;
+    out = static_cast<ModFlags>(flagsValue);
+    return true;
+}
 
-    // parse difficulty settings from file
-    BeatmapSettings settings = parseDifficultySettings(file);
+bool parseInt(std::string_view cur, int &out) {
+    auto [ptr, ec] = std::from_chars(cur.data(), cur.data() + cur.size(), out);
+    return ec == std::errc();
+}
 
-    std::vector<uint8_t> fileBuffer;
-    file.readToVector(fileBuffer);
+// every stage after reading the file, res.settings must already be set.
+// the parse phase is timed from last, so that runJob can include reading the file in it
+bool runJobOnData(const CalcJob &job, const std::vector<uint8_t> &fileBuffer, CalcResult &res, PhaseTimes &times,
+                  Clock::time_point last) {
+    const BeatmapSettings &settings = res.settings;
 
     // load primitive hitobjects
     DatabaseBeatmap::PRIMITIVE_CONTAINER primitives =
-        DatabaseBeatmap::loadPrimitiveObjectsFromData(fileBuffer, osuFilePath);
+        DatabaseBeatmap::loadPrimitiveObjectsFromData(fileBuffer, job.path);
+    times.parse += secondsSince(last);
     if(primitives.error.errc) {
-        std::cerr << "error loading beatmap primitives: " << primitives.error.error_string() << '\n';
-        return 1;
-    }
-
-    float speedMultiplier = 1.0f;
-    if(argc > 3) {
-        std::string_view cur{argv[3]};
-        float speedTemp = 1.f;
-        auto [ptr, ec] = std::from_chars(cur.data(), cur.data() + cur.size(), speedTemp);
-        if(ec == std::errc() && speedTemp >= 0.01f && speedTemp <= 3.f) speedMultiplier = speedTemp;
-    }
-
-    ModFlags modFlags = {};
-    if(argc > 4) {
-        int base = 10;
-        uint64_t flagsValue = 0;
-        std::string_view cur{argv[4]};
-        if(cur.starts_with("0x") || cur.starts_with("0X")) {
-            base = 16;
-            cur = cur.substr(2);
-        }
-        auto [ptr, ec] = std::from_chars(cur.data(), cur.data() + cur.size(), flagsValue, base);
-        if(ec == std::errc()) modFlags = static_cast<ModFlags>(flagsValue);
+        res.error = "error loading beatmap primitives: ";
+        res.error.append(primitives.error.error_string());
+        return false;
     }
 
     // load difficulty hitobjects for star calculation
     DatabaseBeatmap::LOAD_DIFFOBJ_RESULT diffResult =
-        DatabaseBeatmap::loadDifficultyHitObjects(primitives, settings.AR, settings.CS, speedMultiplier, false);
+        DatabaseBeatmap::loadDifficultyHitObjects(primitives, settings.AR, settings.CS, job.speed, false);
+    times.curve += secondsSince(last);
 
     if(diffResult.error.errc) {
-        std::cerr << "error loading difficulty objects: " << diffResult.error.error_string() << '\n';
-        return 1;
+        res.error = "error loading difficulty objects: ";
+        res.error.append(diffResult.error.error_string());
+        return false;
     }
 
     // calculate star rating
@@ -237,11 +328,11 @@ int entrypoint(int argc_, char *argv_[]) {
                                                            .HP = settings.HP,
                                                            .AR = settings.AR,
                                                            .OD = settings.OD,
-                                                           .hidden = flags::has<ModFlags::Hidden>(modFlags),
-                                                           .relax = flags::has<ModFlags::Relax>(modFlags),
-                                                           .autopilot = flags::has<ModFlags::Autopilot>(modFlags),
-                                                           .touchDevice = flags::has<ModFlags::TouchDevice>(modFlags),
-                                                           .speedMultiplier = speedMultiplier,
+                                                           .hidden = flags::has<ModFlags::Hidden>(job.mods),
+                                                           .relax = flags::has<ModFlags::Relax>(job.mods),
+                                                           .autopilot = flags::has<ModFlags::Autopilot>(job.mods),
+                                                           .touchDevice = flags::has<ModFlags::TouchDevice>(job.mods),
+                                                           .speedMultiplier = job.speed,
                                                            .breakDuration = diffResult.totalBreakDuration,
                                                            .playableLength = diffResult.playableLength};
 
@@ -258,48 +349,1228 @@ int entrypoint(int argc_, char *argv_[]) {
         .cancelCheck = {},
     };
 
-    const double totalStars = DifficultyCalculator::calculateStarDiffForHitObjects(starParams);
+    res.totalStars = DifficultyCalculator::calculateStarDiffForHitObjects(starParams);
+    times.strains += secondsSince(last);
 
-    const double aim = outAttrs.AimDifficulty;
-    const double speed = outAttrs.SpeedDifficulty;
+    res.aim = outAttrs.AimDifficulty;
+    res.speed = outAttrs.SpeedDifficulty;
+    res.numCircles = primitives.hitcircles.size();
+    res.numSliders = primitives.sliders.size();
+    res.numSpinners = primitives.spinners.size();
+    res.maxCombo = diffResult.getTotalMaxCombo();
 
-    // calculate PP for SS play
+    // calculate PP (for an SS play, unless hit counts were given)
     DifficultyCalculator::PPv2CalcParams ppParams{.attributes = outAttrs,
-                                                  .modFlags = modFlags,
-                                                  .timescale = speedMultiplier,
+                                                  .modFlags = job.mods,
+                                                  .timescale = job.speed,
                                                   .ar = settings.AR,
                                                   .od = settings.OD,
                                                   .numHitObjects = static_cast<int>(primitives.getNumObjects()),
-                                                  .numCircles = static_cast<int>(primitives.hitcircles.size()),
-                                                  .numSliders = static_cast<int>(primitives.sliders.size()),
-                                                  .numSpinners = static_cast<int>(primitives.spinners.size()),
-                                                  .maxPossibleCombo = static_cast<int>(diffResult.getTotalMaxCombo()),
-                                                  .combo = -1,
-                                                  .misses = 0,
-                                                  .c300 = -1,
-                                                  .c100 = 0,
-                                                  .c50 = 0,
+                                                  .numCircles = static_cast<int>(res.numCircles),
+                                                  .numSliders = static_cast<int>(res.numSliders),
+                                                  .numSpinners = static_cast<int>(res.numSpinners),
+                                                  .maxPossibleCombo = static_cast<int>(res.maxCombo),
+                                                  .combo = job.combo,
+                                                  .misses = job.misses,
+                                                  .c300 = job.c300,
+                                                  .c100 = job.c100,
+                                                  .c50 = job.c50,
                                                   .legacyTotalScore = 0,
                                                   .isMcOsuImported = false};
 
-    const double pp = DifficultyCalculator::calculatePPv2(ppParams);
+    res.pp = DifficultyCalculator::calculatePPv2(ppParams);
+    times.pp += secondsSince(last);
+
+    return true;
+}
+
+bool runJob(const CalcJob &job, CalcResult &res, PhaseTimes &times) {
+    const auto start = Clock::now();
+
+    LiteFile file(job.path);
+    if(!file.canRead() || (file.getFileSize() == 0)) {
+        res.error = "could not read file";
+        return false;
+    }
+
+    // parse difficulty settings from file
+    res.settings = parseDifficultySettings(file);
+
+    std::vector<uint8_t> fileBuffer;
+    file.readToVector(fileBuffer);
+
+    return runJobOnData(job, fileBuffer, res, times, start);
+}
+
+/*
+ * bulk mode
+ */
+
+enum class OutputFormat : uint8_t { NDJSON, CSV };
+
+void appendNumber(std::string &out, double value) {
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+void appendNumber(std::string &out, size_t value) {
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+void appendModsHex(std::string &out, ModFlags mods) {
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), static_cast<uint64_t>(mods), 16);
+    out.append("0x");
+    out.append(buf, ec == std::errc() ? ptr : buf);
+}
+
+void appendJsonString(std::string &out, std::string_view str) {
+    out.push_back('"');
+    for(const char c : str) {
+        switch(c) {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    constexpr std::string_view hex = "0123456789abcdef";
+                    out.append("\\u00");
+                    out.push_back(hex[(c >> 4) & 0xF]);
+                    out.push_back(hex[c & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendCsvString(std::string &out, std::string_view str) {
+    out.push_back('"');
+    for(const char c : str) {
+        if(c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+constexpr std::string_view CSV_HEADER =
+    "index,path,speed,mods,stars,aim,speed_stars,pp,ar,cs,od,hp,circles,sliders,spinners,max_combo,error\n";
+
+void formatResult(std::string &out, OutputFormat format, size_t index, const CalcJob &job, const CalcResult &res) {
+    const bool ok = res.error.empty();
+    if(format == OutputFormat::NDJSON) {
+        out.append("{\"index\":");
+        appendNumber(out, index);
+        out.append(",\"path\":");
+        appendJsonString(out, job.path);
+        out.append(",\"speed\":");
+        appendNumber(out, static_cast<double>(job.speed));
+        out.append(",\"mods\":\"");
+        appendModsHex(out, job.mods);
+        out.push_back('"');
+        if(!ok) {
+            out.append(",\"error\":");
+            appendJsonString(out, res.error);
+            out.append("}\n");
+            return;
+        }
+        out.append(",\"stars\":");
+        appendNumber(out, res.totalStars);
+        out.append(",\"aim\":");
+        appendNumber(out, res.aim);
+        out.append(",\"speed_stars\":");
+        appendNumber(out, res.speed);
+        out.append(",\"pp\":");
+        appendNumber(out, res.pp);
+        out.append(",\"ar\":");
+        appendNumber(out, static_cast<double>(res.settings.AR));
+        out.append(",\"cs\":");
+        appendNumber(out, static_cast<double>(res.settings.CS));
+        out.append(",\"od\":");
+        appendNumber(out, static_cast<double>(res.settings.OD));
+        out.append(",\"hp\":");
+        appendNumber(out, static_cast<double>(res.settings.HP));
+        out.append(",\"circles\":");
+        appendNumber(out, res.numCircles);
+        out.append(",\"sliders\":");
+        appendNumber(out, res.numSliders);
+        out.append(",\"spinners\":");
+        appendNumber(out, res.numSpinners);
+        out.append(",\"max_combo\":");
+        appendNumber(out, res.maxCombo);
+        out.append("}\n");
+    } else {
+        appendNumber(out, index);
+        out.push_back(',');
+        appendCsvString(out, job.path);
+        out.push_back(',');
+        appendNumber(out, static_cast<double>(job.speed));
+        out.push_back(',');
+        appendModsHex(out, job.mods);
+        if(!ok) {
+            out.append(",,,,,,,,,,,,,");
+            appendCsvString(out, res.error);
+            out.push_back('\n');
+            return;
+        }
+        for(const double v : {res.totalStars, res.aim, res.speed, res.pp, static_cast<double>(res.settings.AR),
+                              static_cast<double>(res.settings.CS), static_cast<double>(res.settings.OD),
+                              static_cast<double>(res.settings.HP)}) {
+            out.push_back(',');
+            appendNumber(out, v);
+        }
+        for(const size_t v : {res.numCircles, res.numSliders, res.numSpinners, res.maxCombo}) {
+            out.push_back(',');
+            appendNumber(out, v);
+        }
+        out.append(",\n");
+    }
+}
+
+bool isOsuFile(const std::filesystem::path &path) {
+    std::string ext = path.extension().string();
+    std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".osu";
+}
+
+// every .osu file below a directory, at nomod 1.0x
+bool collectDirectoryJobs(const std::filesystem::path &dir, std::vector<CalcJob> &jobs) {
+    std::error_code ec;
+    auto it = std::filesystem::recursive_directory_iterator(
+        dir, std::filesystem::directory_options::skip_permission_denied, ec);
+    if(ec) {
+        std::cerr << "error: could not open directory " << dir.string() << ": " << ec.message() << '\n';
+        return false;
+    }
+
+    for(const auto end = std::filesystem::recursive_directory_iterator(); it != end; it.increment(ec)) {
+        if(ec) break;
+        if(it->is_regular_file(ec) && isOsuFile(it->path())) {
+            jobs.push_back(CalcJob{.path = it->path().string()});
+        }
+    }
+
+    // directory iteration order is unspecified, keep output stable between runs
+    std::ranges::sort(jobs, std::ranges::less{}, &CalcJob::path);
+    return true;
+}
+
+// manifest: one job per line, "path[,speed[,mods[,combo,misses,n300,n100,n50]]]"
+// empty lines and lines starting with '#' are skipped, relative paths are relative to the manifest
+bool collectManifestJobs(const std::filesystem::path &manifestPath, std::vector<CalcJob> &jobs) {
+    LiteFile manifest(manifestPath.string());
+    if(!manifest.canRead()) {
+        std::cerr << "error: could not read manifest " << manifestPath.string() << '\n';
+        return false;
+    }
+
+    const std::filesystem::path baseDir = manifestPath.parent_path();
+
+    size_t lineNumber = 0;
+    for(auto line = manifest.readLine(); !line.empty() || manifest.canRead(); line = manifest.readLine()) {
+        lineNumber++;
+        if(line.empty() || line.starts_with('#')) continue;
+
+        std::vector<std::string_view> fields;
+        std::string_view rest{line};
+        for(size_t comma = rest.find(','); comma != std::string_view::npos; comma = rest.find(',')) {
+            fields.push_back(rest.substr(0, comma));
+            rest = rest.substr(comma + 1);
+        }
+        fields.push_back(rest);
+
+        CalcJob job;
+        std::filesystem::path path{std::string(fields[0])};
+        job.path = (path.is_relative() ? baseDir / path : path).string();
+
+        bool valid = true;
+        if(fields.size() > 1 && !fields[1].empty()) valid &= parseSpeed(fields[1], job.speed);
+        if(fields.size() > 2 && !fields[2].empty()) valid &= parseModFlags(fields[2], job.mods);
+        if(fields.size() > 3) {
+            if(fields.size() != 8) {
+                valid = false;
+            } else {
+                valid &= parseInt(fields[3], job.combo);
+                valid &= parseInt(fields[4], job.misses);
+                valid &= parseInt(fields[5], job.c300);
+                valid &= parseInt(fields[6], job.c100);
+                valid &= parseInt(fields[7], job.c50);
+            }
+        }
+
+        if(!valid) {
+            std::cerr << "warning: skipping invalid manifest line " << lineNumber << '\n';
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+void printPhase(std::string_view name, double seconds, size_t count) {
+    std::cerr << "  " << name << ": " << seconds << " s total, "
+              << (count > 0 ? seconds * 1000.0 / static_cast<double>(count) : 0.0) << " ms/map\n";
+}
+
+int runBulk(const std::vector<std::string> &args, std::string_view usage) {
+    std::string inputPath;
+    OutputFormat format = OutputFormat::NDJSON;
+    unsigned int numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    bool bench = false;
+
+    for(size_t i = 0; i < args.size(); i++) {
+        const std::string_view arg{args[i]};
+        if(arg == "--format" && i + 1 < args.size()) {
+            const std::string_view value{args[++i]};
+            if(value == "ndjson" || value == "json") {
+                format = OutputFormat::NDJSON;
+            } else if(value == "csv") {
+                format = OutputFormat::CSV;
+            } else {
+                std::cerr << "error: unknown output format " << value << '\n';
+                return 1;
+            }
+        } else if(arg == "--threads" && i + 1 < args.size()) {
+            int value = 0;
+            if(!parseInt(args[++i], value) || value < 1) {
+                std::cerr << "error: invalid thread count " << args[i] << '\n';
+                return 1;
+            }
+            numThreads = static_cast<unsigned int>(value);
+        } else if(arg == "--bench") {
+            bench = true;
+        } else if(inputPath.empty() && !arg.starts_with("--")) {
+            inputPath = arg;
+        } else {
+            std::cerr << "usage: " << usage << '\n';
+            return 1;
+        }
+    }
+
+    if(inputPath.empty()) {
+        std::cerr << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    std::vector<CalcJob> jobs;
+    std::error_code ec;
+    if(std::filesystem::is_directory(inputPath, ec)) {
+        if(!collectDirectoryJobs(inputPath, jobs)) return 1;
+    } else if(!collectManifestJobs(inputPath, jobs)) {
+        return 1;
+    }
+
+    numThreads = static_cast<unsigned int>(std::clamp<size_t>(jobs.size(), 1, numThreads));
+
+    std::ios::sync_with_stdio(false);
+    if(format == OutputFormat::CSV) {
+        std::cout << CSV_HEADER;
+    }
+
+    std::atomic<size_t> nextJob{0};
+    std::atomic<size_t> numFailed{0};
+    std::mutex outputMutex;
+    PhaseTimes totalTimes;
+
+    const auto startTime = Clock::now();
+
+    auto worker = [&]() {
+        PhaseTimes times;
+        CalcResult res;
+        std::string out;
+        for(size_t i = nextJob.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+            i = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+            res = CalcResult{};
+            if(!runJob(jobs[i], res, times)) {
+                numFailed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // results are streamed in completion order; "index" refers to the input order
+            out.clear();
+            formatResult(out, format, i, jobs[i], res);
+
+            std::scoped_lock lock(outputMutex);
+            std::cout << out;
+        }
+
+        std::scoped_lock lock(outputMutex);
+        totalTimes += times;
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(numThreads);
+        for(unsigned int i = 0; i < numThreads; i++) {
+            threads.emplace_back(worker);
+        }
+    }
+    std::cout.flush();
+
+    const double wallTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+    const size_t failed = numFailed.load(std::memory_order_relaxed);
+
+    if(bench) {
+        std::cerr << jobs.size() << " maps (" << failed << " failed) on " << numThreads << " threads in " << wallTime
+                  << " s, " << (wallTime > 0.0 ? static_cast<double>(jobs.size()) / wallTime : 0.0) << " maps/s\n";
+        std::cerr << "per-phase times (summed over all threads):\n";
+        printPhase("parse", totalTimes.parse, jobs.size());
+        printPhase("curve", totalTimes.curve, jobs.size());
+        printPhase("strains", totalTimes.strains, jobs.size());
+        printPhase("pp", totalTimes.pp, jobs.size());
+    } else if(failed > 0) {
+        std::cerr << failed << '/' << jobs.size() << " maps failed\n";
+    }
+
+    return failed == jobs.size() && !jobs.empty() ? 1 : 0;
+}
+
+/*
+ * star rating precalc benchmark
+ */
+
+// StarPrecalc::SRArray for every combo, the way BatchDiffCalc does it (DifficultyCalculator::calculatePrecalcVariant)
+struct PrecalcScratch {
+    std::unique_ptr<std::vector<DifficultyCalculator::DiffObject>> diffObjCache;
+    std::vector<float> baseSpanDurations;
+    std::vector<float> baseScoringTimes;
+};
+
+void precalcRatings(DatabaseBeatmap::PRIMITIVE_CONTAINER &primitives, const BeatmapSettings &settings,
+                    bool starRatingOnly, PrecalcScratch &scratch, StarPrecalc::SRArray &out) {
+    DatabaseBeatmap::calculateSliderCurves(primitives);
+
+    for(const auto &var : StarPrecalc::VARIANTS) {
+        const float ar = std::clamp(settings.AR * var.ar_od_hp_mul, 0.f, 10.f);
+        const float cs = std::clamp(settings.CS * var.cs_mul, 0.f, 10.f);
+        const float od = std::clamp(settings.OD * var.ar_od_hp_mul, 0.f, 10.f);
+        const float hp = std::clamp(settings.HP * var.ar_od_hp_mul, 0.f, 10.f);
+
+        auto diffResult = DatabaseBeatmap::loadDifficultyHitObjects(primitives, ar, cs, 1.0f, false);
+        if(diffResult.error.errc) {
+            for(size_t speedIdx = 0; speedIdx < StarPrecalc::SPEEDS_NUM; speedIdx++) {
+                out[speedIdx * StarPrecalc::NUM_MOD_COMBOS + var.combo_idx[0]] = 0.f;
+                out[speedIdx * StarPrecalc::NUM_MOD_COMBOS + var.combo_idx[1]] = 0.f;
+            }
+            continue;
+        }
+
+        DifficultyCalculator::BeatmapDiffcalcData diffcalcData{.sortedHitObjects = diffResult.diffobjects,
+                                                               .CS = cs,
+                                                               .HP = hp,
+                                                               .AR = ar,
+                                                               .OD = od,
+                                                               .breakDuration = primitives.totalBreakDuration,
+                                                               .playableLength = diffResult.playableLength};
+        DifficultyCalculator::PrecalcVariantParams params{.beatmapData = diffcalcData,
+                                                          .variant = var,
+                                                          .outRatings = out,
+                                                          .cachedDiffObjects = scratch.diffObjCache,
+                                                          .baseSpanDurations = scratch.baseSpanDurations,
+                                                          .baseScoringTimes = scratch.baseScoringTimes,
+                                                          .starRatingOnly = starRatingOnly};
+        DifficultyCalculator::calculatePrecalcVariant(params);
+    }
+}
+
+// times the precalc with and without StarCalcParams::starRatingOnly over the same parsed maps and checks that the
+// ratings agree
+int runPrecalcBench(const std::vector<std::string> &args, std::string_view usage) {
+    if(args.size() != 1) {
+        std::cerr << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    const std::filesystem::path inputPath{args[0]};
+    std::vector<CalcJob> jobs;
+    std::error_code ec;
+    if(std::filesystem::is_directory(inputPath, ec)) {
+        if(!collectDirectoryJobs(inputPath, jobs)) return 1;
+    } else if(isOsuFile(inputPath)) {
+        jobs.push_back(CalcJob{.path = inputPath.string()});
+    } else if(!collectManifestJobs(inputPath, jobs)) {
+        return 1;
+    }
+
+    double fullTime = 0.0;
+    double starsOnlyTime = 0.0;
+    double maxDelta = 0.0;
+    size_t numMaps = 0;
+    size_t numObjects = 0;
+
+    std::vector<uint8_t> fileBuffer;
+    PrecalcScratch scratch;
+    StarPrecalc::SRArray full{};
+    StarPrecalc::SRArray starsOnly{};
+
+    for(const CalcJob &job : jobs) {
+        LiteFile file(job.path);
+        if(!file.canRead() || (file.getFileSize() == 0)) {
+            std::cerr << "warning: could not read " << job.path << '\n';
+            continue;
+        }
+
+        const BeatmapSettings settings = parseDifficultySettings(file);
+        file.readToVector(fileBuffer);
+
+        DatabaseBeatmap::PRIMITIVE_CONTAINER primitives =
+            DatabaseBeatmap::loadPrimitiveObjectsFromData(fileBuffer, job.path);
+        if(primitives.error.errc) {
+            std::cerr << "warning: error loading beatmap primitives: " << primitives.error.error_string() << ' '
+                      << job.path << '\n';
+            continue;
+        }
+
+        // slider curves are shared by both runs, build them outside the timed sections
+        DatabaseBeatmap::calculateSliderCurves(primitives);
+
+        // best of a few interleaved runs, the difference is small enough to drown in noise otherwise
+        double bestFull = std::numeric_limits<double>::max();
+        double bestStarsOnly = std::numeric_limits<double>::max();
+        for(int run = 0; run < 5; run++) {
+            auto last = Clock::now();
+            precalcRatings(primitives, settings, false, scratch, full);
+            bestFull = std::min(bestFull, secondsSince(last));
+            precalcRatings(primitives, settings, true, scratch, starsOnly);
+            bestStarsOnly = std::min(bestStarsOnly, secondsSince(last));
+        }
+        fullTime += bestFull;
+        starsOnlyTime += bestStarsOnly;
+
+        for(size_t i = 0; i < StarPrecalc::NUM_PRECALC_RATINGS; i++) {
+            maxDelta = std::max(maxDelta, (double)std::abs(full[i] - starsOnly[i]));
+        }
+        numMaps++;
+        numObjects += primitives.getNumObjects();
+    }
+
+    constexpr size_t variants = StarPrecalc::VARIANTS.size();
+    constexpr size_t ratings = StarPrecalc::NUM_PRECALC_RATINGS;
+
+    std::cerr << numMaps << " maps (" << numObjects << " objects), " << ratings << " ratings per map, " << variants
+              << " object builds + " << variants * StarPrecalc::SPEEDS_NUM << " strain passes per map\n";
+    std::cerr << "  full attributes: " << fullTime << " s\n";
+    std::cerr << "  star rating only: " << starsOnlyTime << " s\n";
+    std::cerr << "  speedup: " << (starsOnlyTime > 0.0 ? fullTime / starsOnlyTime : 0.0)
+              << "x, max star rating difference: " << maxDelta << '\n';
+
+    return numMaps > 0 ? 0 : 1;
+}
+
+/*
+ * regression/throughput suite
+ */
+
+#ifdef BUILD_TOOLS_ONLY
+constexpr bool COUNTS_ALLOCATIONS = true;
+uint64_t allocationCount() { return s_numAllocations.load(std::memory_order_relaxed); }
+#else
+constexpr bool COUNTS_ALLOCATIONS = false;
+uint64_t allocationCount() { return 0; }
+#endif
+
+// generated in memory, so that the suite always covers every object type and the code paths a real corpus might not
+// (lazy slider curves, deep stacks, slider velocity changes), even without any beatmaps on disk
+struct SyntheticMap {
+    std::string_view name;
+    BeatmapSettings settings;
+    void (*writeTimingPoints)(std::string &out);
+    void (*writeHitObjects)(std::string &out);
+};
+
+void appendCsvLine(std::string &out, std::initializer_list<long> values, std::string_view tail = {}) {
+    bool first = true;
+    for(const long v : values) {
+        if(!first) out.push_back(',');
+        out.append(std::to_string(v));
+        first = false;
+    }
+    out.append(tail);
+    out.push_back('\n');
+}
+
+// 200 bpm, with 2x/0.5x slider velocity sections every 32 beats
+void writeTimingPoints(std::string &out) {
+    out.append("0,300,4,2,0,100,1,0\n");
+    for(long time = 9600; time < 3600000; time += 9600) {
+        const long svPercent = (time / 9600) % 3 == 0 ? -100 : (time / 9600) % 3 == 1 ? -50 : -200;
+        appendCsvLine(out, {time, svPercent, 4, 2, 0, 100, 0, 0});
+    }
+}
+
+void writeStream(std::string &out) {
+    for(long i = 0; i < 2000; i++) {
+        appendCsvLine(out, {156 + (i % 8) * 25, 192 + ((i / 8) % 2 ? 30 : -30), 1000 + i * 75, 1, 0});
+    }
+}
+
+void writeJumps(std::string &out) {
+    for(long i = 0; i < 1000; i++) {
+        const long x = i % 2 ? 64 + (i * 37) % 128 : 448 - (i * 53) % 128;
+        appendCsvLine(out, {x, 64 + (i * 97) % 256, 1000 + i * 150, 1, 0});
+    }
+}
+
+// every curve type, with repeats
+void writeSliders(std::string &out) {
+    constexpr char curveTypes[] = {'L', 'P', 'B', 'C'};
+    for(long i = 0; i < 800; i++) {
+        const long x = 64 + (i * 41) % 320;
+        const long y = 64 + (i * 67) % 224;
+        const long type = i % 4;
+
+        std::string curve(1, curveTypes[type]);
+        for(long p = 1; p <= type + 1; p++) {
+            curve.push_back('|');
+            curve.append(std::to_string(x + p * 40));
+            curve.push_back(':');
+            curve.append(std::to_string(y + (p % 2 ? 30 : -20)));
+        }
+
+        std::string tail(",");
+        tail.append(curve);
+        tail.push_back(',');
+        tail.append(std::to_string(1 + i % 3));
+        tail.push_back(',');
+        tail.append(std::to_string(100 + (i * 13) % 100));
+        appendCsvLine(out, {x, y, 1000 + i * 600, 2, 0}, tail);
+    }
+}
+
+// groups of stacked circles ending in a slider from the same position, and a spinner every 20 groups
+void writeStacks(std::string &out) {
+    long time = 1000;
+    for(long group = 0; group < 400; group++) {
+        const long x = 100 + (group * 29) % 312;
+        const long y = 80 + (group * 47) % 224;
+        for(long i = 0; i < 5; i++, time += 75) {
+            appendCsvLine(out, {x, y, time, 1, 0});
+        }
+        std::string tail(",L|");
+        tail.append(std::to_string(x + 80));
+        tail.push_back(':');
+        tail.append(std::to_string(y));
+        tail.append(",1,80");
+        appendCsvLine(out, {x, y, time, 2, 0}, tail);
+        time += 300;
+
+        if(group % 20 == 19) {
+            appendCsvLine(out, {256, 192, time, 8, 0, time + 2000});
+            time += 2300;
+        }
+    }
+}
+
+// enough sliders for DifficultyHitObject to build curves lazily instead of up front
+void writeMarathon(std::string &out) {
+    const long numSliders = static_cast<long>(DifficultyHitObject::max_precalculated_curves) + 500;
+    for(long i = 0; i < numSliders; i++) {
+        const long x = 64 + (i * 31) % 320;
+        const long y = 64 + (i * 43) % 256;
+        std::string tail(",L|");
+        tail.append(std::to_string(x + 60));
+        tail.push_back(':');
+        tail.append(std::to_string(y + 20));
+        tail.append(",1,60");
+        appendCsvLine(out, {x, y, 1000 + i * 150, 2, 0}, tail);
+    }
+}
+
+constexpr SyntheticMap SYNTHETIC_MAPS[] = {
+    {"stream", {.AR = 9.f, .CS = 4.f, .OD = 8.f, .HP = 5.f}, writeTimingPoints, writeStream},
+    {"jumps", {.AR = 9.3f, .CS = 4.2f, .OD = 9.f, .HP = 6.f}, writeTimingPoints, writeJumps},
+    {"sliders", {.AR = 8.f, .CS = 3.5f, .OD = 7.f, .HP = 4.f}, writeTimingPoints, writeSliders},
+    {"stacks", {.AR = 7.f, .CS = 5.f, .OD = 6.f, .HP = 5.f}, writeTimingPoints, writeStacks},
+    {"marathon", {.AR = 9.f, .CS = 4.f, .OD = 8.f, .HP = 5.f}, writeTimingPoints, writeMarathon},
+};
+
+// speed/mod combinations every synthetic map is calculated with
+constexpr std::pair<float, ModFlags> SYNTHETIC_COMBOS[] = {
+    {1.0f, ModFlags{}},
+    {1.5f, ModFlags::Hidden},
+    {0.75f, ModFlags::Relax},
+    {1.0f, ModFlags::Autopilot},
+};
+
+std::vector<uint8_t> buildSyntheticMap(const SyntheticMap &map) {
+    std::string out;
+    out.append("osu file format v14\n\n[General]\nMode: 0\n\n[Difficulty]\n");
+    for(const auto &[key, value] : {std::pair{"HPDrainRate", map.settings.HP}, {"CircleSize", map.settings.CS},
+                                    {"OverallDifficulty", map.settings.OD}, {"ApproachRate", map.settings.AR}}) {
+        out.append(key);
+        out.push_back(':');
+        appendNumber(out, static_cast<double>(value));
+        out.push_back('\n');
+    }
+    out.append("SliderMultiplier:1.4\nSliderTickRate:1\n\n[TimingPoints]\n");
+    map.writeTimingPoints(out);
+    out.append("\n[HitObjects]\n");
+    map.writeHitObjects(out);
+    return {out.begin(), out.end()};
+}
+
+// one calculation of the suite, either a synthetic map or a corpus file
+struct RegressionCase {
+    std::string key;  // "synthetic/<name>" or the path relative to the corpus
+    CalcJob job;
+    const SyntheticMap *synthetic = nullptr;
+};
+
+struct GoldenValues {
+    double stars = 0.0;
+    double pp = 0.0;
+};
+
+// golden lines are "key<TAB>speed<TAB>mods<TAB>stars<TAB>pp", the map key is the first three fields
+std::string goldenKey(const RegressionCase &c) {
+    std::string key = c.key;
+    key.push_back('\t');
+    appendNumber(key, static_cast<double>(c.job.speed));
+    key.push_back('\t');
+    appendModsHex(key, c.job.mods);
+    return key;
+}
+
+bool readGoldenFile(const std::string &path, std::map<std::string, GoldenValues> &out) {
+    LiteFile file(path);
+    if(!file.canRead()) return false;
+
+    for(auto line = file.readLine(); !line.empty() || file.canRead(); line = file.readLine()) {
+        if(line.empty() || line.starts_with('#')) continue;
+
+        const size_t modsEnd = line.find('\t', line.find('\t', line.find('\t') + 1) + 1);
+        const size_t starsEnd = modsEnd == std::string::npos ? std::string::npos : line.find('\t', modsEnd + 1);
+        if(starsEnd == std::string::npos) {
+            std::cerr << "warning: skipping invalid golden line: " << line << '\n';
+            continue;
+        }
+
+        GoldenValues values;
+        const char *end = line.data() + line.size();
+        const bool valid =
+            std::from_chars(line.data() + modsEnd + 1, line.data() + starsEnd, values.stars).ec == std::errc() &&
+            std::from_chars(line.data() + starsEnd + 1, end, values.pp).ec == std::errc();
+        if(!valid) {
+            std::cerr << "warning: skipping invalid golden line: " << line << '\n';
+            continue;
+        }
+        out.insert_or_assign(line.substr(0, modsEnd), values);
+    }
+    return true;
+}
+
+bool withinTolerance(double value, double golden, double tolerance) {
+    return std::abs(value - golden) <= tolerance * std::max(1.0, std::abs(golden));
+}
+
+bool sameAttributes(const DifficultyCalculator::DifficultyAttributes &a,
+                    const DifficultyCalculator::DifficultyAttributes &b) {
+    return a.AimDifficulty == b.AimDifficulty && a.AimDifficultSliderCount == b.AimDifficultSliderCount &&
+           a.SpeedDifficulty == b.SpeedDifficulty && a.SpeedNoteCount == b.SpeedNoteCount &&
+           a.SliderFactor == b.SliderFactor && a.AimTopWeightedSliderFactor == b.AimTopWeightedSliderFactor &&
+           a.SpeedTopWeightedSliderFactor == b.SpeedTopWeightedSliderFactor &&
+           a.AimDifficultStrainCount == b.AimDifficultStrainCount &&
+           a.SpeedDifficultStrainCount == b.SpeedDifficultStrainCount &&
+           a.NestedScorePerObject == b.NestedScorePerObject &&
+           a.LegacyScoreBaseMultiplier == b.LegacyScoreBaseMultiplier &&
+           a.MaximumLegacyComboScore == b.MaximumLegacyComboScore;
+}
+
+// calculates OD/HP/mod variants from the StrainData of a single full calculation (like DiffAttrCache hits do) and
+// checks that they exactly match a full calculation of each variant. returns the first mismatch, empty if all match
+std::string checkStrainData(const CalcJob &job, const std::vector<uint8_t> &fileBuffer,
+                            const BeatmapSettings &settings) {
+    DatabaseBeatmap::PRIMITIVE_CONTAINER primitives =
+        DatabaseBeatmap::loadPrimitiveObjectsFromData(fileBuffer, job.path);
+    if(primitives.error.errc) return {};  // already reported by the regular calculation
+    DatabaseBeatmap::LOAD_DIFFOBJ_RESULT diffResult =
+        DatabaseBeatmap::loadDifficultyHitObjects(primitives, settings.AR, settings.CS, job.speed, false);
+    if(diffResult.error.errc) return {};
+
+    DifficultyCalculator::BeatmapDiffcalcData diffcalcData{.sortedHitObjects = diffResult.diffobjects,
+                                                           .CS = settings.CS,
+                                                           .HP = settings.HP,
+                                                           .AR = settings.AR,
+                                                           .OD = settings.OD,
+                                                           .speedMultiplier = job.speed,
+                                                           .breakDuration = diffResult.totalBreakDuration,
+                                                           .playableLength = diffResult.playableLength};
+
+    auto fullCalculation = [&](DifficultyCalculator::DifficultyAttributes &attributes,
+                               DifficultyCalculator::StrainData *outStrainData) {
+        DifficultyCalculator::StarCalcParams starParams{.cachedDiffObjects = {},
+                                                        .outAttributes = attributes,
+                                                        .beatmapData = diffcalcData,
+                                                        .outAimStrains = nullptr,
+                                                        .outSpeedStrains = nullptr,
+                                                        .incremental = nullptr,
+                                                        .upToObjectIndex = -1,
+                                                        .cancelCheck = {},
+                                                        .outStrainData = outStrainData};
+        return DifficultyCalculator::calculateStarDiffForHitObjects(starParams);
+    };
+
+    DifficultyCalculator::StrainData strainData;
+    DifficultyCalculator::DifficultyAttributes baseAttributes{};
+    fullCalculation(baseAttributes, &strainData);
+
+    using namespace flags::operators;
+
+    // AR only affects the StrainData through stacking, so it stays fixed
+    for(const float od : {settings.OD, 0.0f, 4.5f, 10.0f}) {
+        for(const ModFlags mods : {ModFlags{}, ModFlags::Hidden, ModFlags::Relax, ModFlags::Autopilot,
+                                   ModFlags::TouchDevice | ModFlags::Hidden}) {
+            diffcalcData.OD = od;
+            diffcalcData.HP = od == settings.OD ? settings.HP : 10.0f - od;
+            diffcalcData.hidden = flags::has<ModFlags::Hidden>(mods);
+            diffcalcData.relax = flags::has<ModFlags::Relax>(mods);
+            diffcalcData.autopilot = flags::has<ModFlags::Autopilot>(mods);
+            diffcalcData.touchDevice = flags::has<ModFlags::TouchDevice>(mods);
+
+            DifficultyCalculator::DifficultyAttributes expected{};
+            const double expectedStars = fullCalculation(expected, nullptr);
+
+            DifficultyCalculator::DifficultyAttributes actual{};
+            const double actualStars =
+                DifficultyCalculator::calculateStarDiffForStrainData(strainData, diffcalcData, actual);
+
+            if(actualStars != expectedStars || !sameAttributes(actual, expected)) {
+                std::string mismatch{"OD "};
+                appendNumber(mismatch, static_cast<double>(od));
+                mismatch.append(" mods ");
+                appendModsHex(mismatch, mods);
+                mismatch.append(": ");
+                appendNumber(mismatch, actualStars);
+                mismatch.append(" stars from StrainData, ");
+                appendNumber(mismatch, expectedStars);
+                mismatch.append(" from a full calculation");
+                return mismatch;
+            }
+        }
+    }
+    return {};
+}
+
+double relativeError(double value, double expected) {
+    return std::abs(value - expected) / std::max(1.0, std::abs(expected));
+}
+
+// feeds the beatmap object by object through the incremental (live pp) calculation and compares every step with a
+// full calculation up to the same object. the star rating, difficulty values and note counts must match exactly,
+// the difficult strain counts only within DifficultyCalculator::incremental_count_tolerance (see IncrementalState).
+// returns the first mismatch, empty if all steps match
+std::string checkIncremental(const CalcJob &job, const std::vector<uint8_t> &fileBuffer,
+                             const BeatmapSettings &settings) {
+    DatabaseBeatmap::PRIMITIVE_CONTAINER primitives =
+        DatabaseBeatmap::loadPrimitiveObjectsFromData(fileBuffer, job.path);
+    if(primitives.error.errc) return {};  // already reported by the regular calculation
+    DatabaseBeatmap::LOAD_DIFFOBJ_RESULT diffResult =
+        DatabaseBeatmap::loadDifficultyHitObjects(primitives, settings.AR, settings.CS, job.speed, false);
+    if(diffResult.error.errc) return {};
+
+    const DifficultyCalculator::BeatmapDiffcalcData diffcalcData{
+        .sortedHitObjects = diffResult.diffobjects,
+        .CS = settings.CS,
+        .HP = settings.HP,
+        .AR = settings.AR,
+        .OD = settings.OD,
+        .hidden = flags::has<ModFlags::Hidden>(job.mods),
+        .relax = flags::has<ModFlags::Relax>(job.mods),
+        .autopilot = flags::has<ModFlags::Autopilot>(job.mods),
+        .touchDevice = flags::has<ModFlags::TouchDevice>(job.mods),
+        .speedMultiplier = job.speed,
+        .breakDuration = diffResult.totalBreakDuration,
+        .playableLength = diffResult.playableLength};
+
+    // same setup as LivePPCalc
+    std::unique_ptr<std::vector<DifficultyCalculator::DiffObject>> incrementalObjects, fullObjects;
+    std::array<DifficultyCalculator::IncrementalState, DifficultyCalculator::Skills::NUM_SKILLS> states{};
+    DifficultyCalculator::IncrementalScoreV1State scoreV1State{};
+
+    auto calculate = [&](i32 upToObjectIndex, bool incremental, DifficultyCalculator::DifficultyAttributes &attributes) {
+        auto &objects = incremental ? incrementalObjects : fullObjects;
+        DifficultyCalculator::StarCalcParams starParams{.cachedDiffObjects = std::move(objects),
+                                                        .outAttributes = attributes,
+                                                        .beatmapData = diffcalcData,
+                                                        .outAimStrains = nullptr,
+                                                        .outSpeedStrains = nullptr,
+                                                        .incremental = incremental ? states.data() : nullptr,
+                                                        .upToObjectIndex = upToObjectIndex,
+                                                        .cancelCheck = {},
+                                                        .forceFillDiffobjCache = true,
+                                                        .incrementalScoreV1 = incremental ? &scoreV1State : nullptr};
+        const double stars = DifficultyCalculator::calculateStarDiffForHitObjects(starParams);
+        objects = std::move(starParams.cachedDiffObjects);
+        return stars;
+    };
+
+    // with a miss, so the miss penalties (which depend on the difficult strain counts) are included
+    auto calculatePP = [&](const DifficultyCalculator::DifficultyAttributes &attributes) {
+        DifficultyCalculator::PPv2CalcParams ppParams{.attributes = attributes,
+                                                      .modFlags = job.mods,
+                                                      .timescale = job.speed,
+                                                      .ar = settings.AR,
+                                                      .od = settings.OD,
+                                                      .numHitObjects = static_cast<int>(primitives.getNumObjects()),
+                                                      .numCircles = static_cast<int>(primitives.hitcircles.size()),
+                                                      .numSliders = static_cast<int>(primitives.sliders.size()),
+                                                      .numSpinners = static_cast<int>(primitives.spinners.size()),
+                                                      .maxPossibleCombo = static_cast<int>(diffResult.getTotalMaxCombo()),
+                                                      .combo = -1,
+                                                      .misses = 1,
+                                                      .c300 = -1,
+                                                      .c100 = 0,
+                                                      .c50 = 0,
+                                                      .legacyTotalScore = 0,
+                                                      .isMcOsuImported = false};
+        return DifficultyCalculator::calculatePPv2(ppParams);
+    };
+
+    const double tolerance = DifficultyCalculator::incremental_count_tolerance;
+    for(i32 i = 0; i < static_cast<i32>(diffResult.diffobjects.size()); i++) {
+        DifficultyCalculator::DifficultyAttributes actual{}, expected{};
+        const double actualStars = calculate(i, true, actual);
+        const double expectedStars = calculate(i, false, expected);
+
+        const bool exact = actualStars == expectedStars && actual.AimDifficulty == expected.AimDifficulty &&
+                           actual.SpeedDifficulty == expected.SpeedDifficulty &&
+                           actual.SliderFactor == expected.SliderFactor &&
+                           actual.SpeedNoteCount == expected.SpeedNoteCount &&
+                           actual.AimDifficultSliderCount == expected.AimDifficultSliderCount &&
+                           actual.NestedScorePerObject == expected.NestedScorePerObject &&
+                           actual.MaximumLegacyComboScore == expected.MaximumLegacyComboScore;
+        double countError = std::max(
+            {relativeError(actual.AimDifficultStrainCount, expected.AimDifficultStrainCount),
+             relativeError(actual.SpeedDifficultStrainCount, expected.SpeedDifficultStrainCount),
+             relativeError(actual.AimTopWeightedSliderFactor, expected.AimTopWeightedSliderFactor),
+             relativeError(actual.SpeedTopWeightedSliderFactor, expected.SpeedTopWeightedSliderFactor)});
+
+        countError = std::max(countError, relativeError(calculatePP(actual), calculatePP(expected)));
+
+        if(!exact || !(countError <= tolerance)) {
+            std::string mismatch{"object "};
+            appendNumber(mismatch, static_cast<size_t>(i));
+            mismatch.append(exact ? ": difficult strain counts or pp off by " : ": incremental ");
+            appendNumber(mismatch, exact ? countError : actualStars);
+            if(!exact) {
+                mismatch.append(" stars, full calculation ");
+                appendNumber(mismatch, expectedStars);
+            }
+            return mismatch;
+        }
+    }
+    return {};
+}
+
+int runRegression(const std::vector<std::string> &args, std::string_view usage) {
+    std::string goldenPath;
+    std::string corpusPath;
+    bool update = false;
+    int iterations = 3;
+    double tolerance = 1e-5;
+
+    for(size_t i = 0; i < args.size(); i++) {
+        const std::string_view arg{args[i]};
+        if(arg == "--update") {
+            update = true;
+        } else if(arg == "--iterations" && i + 1 < args.size()) {
+            if(!parseInt(args[++i], iterations) || iterations < 1) {
+                std::cerr << "error: invalid iteration count " << args[i] << '\n';
+                return 1;
+            }
+        } else if(arg == "--tolerance" && i + 1 < args.size()) {
+            const std::string_view value{args[++i]};
+            if(std::from_chars(value.data(), value.data() + value.size(), tolerance).ec != std::errc() ||
+               tolerance < 0.0) {
+                std::cerr << "error: invalid tolerance " << value << '\n';
+                return 1;
+            }
+        } else if(goldenPath.empty() && !arg.starts_with("--")) {
+            goldenPath = arg;
+        } else if(corpusPath.empty() && !arg.starts_with("--")) {
+            corpusPath = arg;
+        } else {
+            std::cerr << "usage: " << usage << '\n';
+            return 1;
+        }
+    }
+
+    if(goldenPath.empty()) {
+        std::cerr << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    std::vector<RegressionCase> cases;
+    for(const SyntheticMap &map : SYNTHETIC_MAPS) {
+        for(const auto &[speed, mods] : SYNTHETIC_COMBOS) {
+            std::string key{"synthetic/"};
+            key.append(map.name);
+            cases.push_back(
+                RegressionCase{.key = std::move(key), .job = {.speed = speed, .mods = mods}, .synthetic = &map});
+        }
+    }
+
+    if(!corpusPath.empty()) {
+        std::vector<CalcJob> jobs;
+        std::filesystem::path base{corpusPath};
+        std::error_code ec;
+        if(std::filesystem::is_directory(base, ec)) {
+            if(!collectDirectoryJobs(base, jobs)) return 1;
+        } else {
+            if(isOsuFile(base)) {
+                jobs.push_back(CalcJob{.path = corpusPath});
+            } else if(!collectManifestJobs(base, jobs)) {
+                return 1;
+            }
+            base = base.parent_path();
+        }
+
+        for(CalcJob &job : jobs) {
+            std::string key = std::filesystem::path(job.path).lexically_relative(base).generic_string();
+            cases.push_back(RegressionCase{.key = key.empty() ? job.path : std::move(key), .job = std::move(job)});
+        }
+    }
+
+    std::map<std::string, GoldenValues> golden;
+    if(!update && !readGoldenFile(goldenPath, golden)) {
+        std::cerr << "error: could not read golden file " << goldenPath << " (create it with --update)\n";
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    PhaseTimes totalTimes;
+    uint64_t totalAllocations = 0;
+    size_t totalObjects = 0;
+    size_t numFailed = 0;
+    std::vector<CalcResult> results(cases.size());
+
+    std::vector<uint8_t> fileBuffer;
+    for(size_t i = 0; i < cases.size(); i++) {
+        const RegressionCase &c = cases[i];
+        if(c.synthetic != nullptr) fileBuffer = buildSyntheticMap(*c.synthetic);
+
+        CalcResult &res = results[i];
+        PhaseTimes times;
+        const uint64_t allocationsBefore = allocationCount();
+        bool deterministic = true;
+
+        for(int iteration = 0; iteration < iterations; iteration++) {
+            CalcResult cur;
+            bool ok;
+            if(c.synthetic != nullptr) {
+                cur.settings = c.synthetic->settings;
+                ok = runJobOnData(c.job, fileBuffer, cur, times, Clock::now());
+            } else {
+                ok = runJob(c.job, cur, times);
+            }
+            if(!ok && cur.error.empty()) cur.error = "calculation failed";
+
+            if(iteration == 0) {
+                res = std::move(cur);
+            } else if(cur.error != res.error || cur.totalStars != res.totalStars || cur.pp != res.pp) {
+                deterministic = false;
+            }
+        }
+
+        const uint64_t allocations = (allocationCount() - allocationsBefore) / iterations;
+
+        std::string strainDataMismatch, incrementalMismatch;
+        if(res.error.empty()) {
+            if(c.synthetic == nullptr) {
+                LiteFile file(c.job.path);
+                file.readToVector(fileBuffer);
+            }
+            strainDataMismatch = checkStrainData(c.job, fileBuffer, res.settings);
+            incrementalMismatch = checkIncremental(c.job, fileBuffer, res.settings);
+        }
+        const size_t numObjects = res.numCircles + res.numSliders + res.numSpinners;
+        const double caseSeconds = times.parse + times.curve + times.strains + times.pp;
+        totalTimes += times;
+        totalAllocations += allocations;
+        totalObjects += numObjects;
+
+        const std::string mods = modsStringFromMods(c.job.mods, c.job.speed);
+        std::cout << c.key << ' ' << c.job.speed << 'x' << (mods.empty() ? "" : " ") << mods << ": ";
+        if(!res.error.empty()) {
+            std::cout << "FAILED (" << res.error << ")\n";
+            numFailed++;
+            continue;
+        }
+
+        std::cout << res.totalStars << " stars, " << res.pp << " pp, "
+                  << (numObjects > 0 ? caseSeconds * 1e9 / static_cast<double>(numObjects * iterations) : 0.0)
+                  << " ns/object";
+        if constexpr(COUNTS_ALLOCATIONS) std::cout << ", " << allocations << " allocations";
+
+        if(!deterministic) {
+            std::cout << " NONDETERMINISTIC\n";
+            numFailed++;
+        } else if(!strainDataMismatch.empty()) {
+            std::cout << " STRAINDATA MISMATCH (" << strainDataMismatch << ")\n";
+            numFailed++;
+        } else if(!incrementalMismatch.empty()) {
+            std::cout << " INCREMENTAL MISMATCH (" << incrementalMismatch << ")\n";
+            numFailed++;
+        } else if(update) {
+            std::cout << '\n';
+        } else if(const auto it = golden.find(goldenKey(c)); it == golden.end()) {
+            std::cout << " MISSING (not in golden file)\n";
+            numFailed++;
+        } else if(!withinTolerance(res.totalStars, it->second.stars, tolerance) ||
+                  !withinTolerance(res.pp, it->second.pp, tolerance)) {
+            std::cout << " DRIFT (golden: " << it->second.stars << " stars, " << it->second.pp << " pp)\n";
+            numFailed++;
+        } else {
+            std::cout << " ok\n";
+        }
+    }
+    std::cout.flush();
+
+    const double objectRuns = static_cast<double>(totalObjects) * iterations;
+    auto printStage = [&](std::string_view name, double seconds) {
+        std::cerr << "  " << name << ": " << (objectRuns > 0.0 ? seconds * 1e9 / objectRuns : 0.0) << " ns/object\n";
+    };
+
+    std::cerr << cases.size() << " cases (" << totalObjects << " objects), " << iterations << " iterations each\n";
+    printStage("parse", totalTimes.parse);
+    printStage("curve", totalTimes.curve);
+    printStage("strains", totalTimes.strains);
+    printStage("pp", totalTimes.pp);
+    if(COUNTS_ALLOCATIONS && !cases.empty()) {
+        std::cerr << "  allocations: " << totalAllocations / cases.size() << " per map\n";
+    }
+
+    if(update) {
+        std::string out{
+            "# diffcalc regression golden values, regenerate with --update after intentional star/pp changes\n"
+            "# key\tspeed\tmods\tstars\tpp\n"};
+        for(size_t i = 0; i < cases.size(); i++) {
+            if(!results[i].error.empty()) continue;
+            out.append(goldenKey(cases[i]));
+            out.push_back('\t');
+            appendNumber(out, results[i].totalStars);
+            out.push_back('\t');
+            appendNumber(out, results[i].pp);
+            out.push_back('\n');
+        }
+
+        std::ofstream file(goldenPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!file.write(out.data(), static_cast<std::streamsize>(out.size())).good()) {
+            std::cerr << "error: could not write golden file " << goldenPath << '\n';
+            return 1;
+        }
+        std::cerr << "wrote " << cases.size() - numFailed << " golden values to " << goldenPath << '\n';
+    } else {
+        std::cerr << (numFailed > 0 ? "FAILED: " : "passed: ") << cases.size() - numFailed << '/' << cases.size()
+                  << " cases match the golden values\n";
+    }
+
+    return numFailed > 0 ? 1 : 0;
+}
+
+}  // namespace
+
+#ifdef BUILD_TOOLS_ONLY
+#define entrypoint main
+#else
+#define entrypoint NEOMOD_run_diffcalc
+#endif
+
+int entrypoint(int argc_, char *argv_[]) {
+    auto argv = std::vector<std::string>(argv_, argv_ + argc_);
+
+#ifdef BUILD_TOOLS_ONLY
+    // lazy
+    argv.insert(argv.begin() + 1, "-");
+    constexpr std::string_view usage = "<osu_file> [speed] [mod flags bitmask (0xHEX)]";
+    constexpr std::string_view bulkUsage =
+        "--bulk <directory|manifest> [--format ndjson|csv] [--threads N] [--bench]";
+    constexpr std::string_view precalcUsage = "--bench-precalc <osu_file|directory|manifest>";
+    constexpr std::string_view regressUsage =
+        "--regress <golden_file> [osu_file|directory|manifest] [--update] [--iterations N] [--tolerance X]";
+#else
+    constexpr std::string_view usage = "-diffcalc <osu_file> [speed] [mod flags bitmask (0xHEX)]";
+    constexpr std::string_view bulkUsage =
+        "-diffcalc --bulk <directory|manifest> [--format ndjson|csv] [--threads N] [--bench]";
+    constexpr std::string_view precalcUsage = "-diffcalc --bench-precalc <osu_file|directory|manifest>";
+    constexpr std::string_view regressUsage =
+        "-diffcalc --regress <golden_file> [osu_file|directory|manifest] [--update] [--iterations N] "
+        "[--tolerance X]";
+#endif
+
+    size_t argc = argv.size();
+
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0] << usage << '\n';
+        std::cerr << "       " << argv[0] << bulkUsage << '\n';
+        std::cerr << "       " << argv[0] << precalcUsage << '\n';
+        std::cerr << "       " << argv[0] << regressUsage << '\n';
+        return 1;
+    }
+
+    if(argv[2] == "--bulk") {
+        return runBulk(std::vector<std::string>(argv.begin() + 3, argv.end()), bulkUsage);
+    }
+
+    if(argv[2] == "--bench-precalc") {
+        return runPrecalcBench(std::vector<std::string>(argv.begin() + 3, argv.end()), precalcUsage);
+    }
+
+    if(argv[2] == "--regress") {
+        return runRegression(std::vector<std::string>(argv.begin() + 3, argv.end()), regressUsage);
+    }
+
+    CalcJob job{.path = argv[2]};
+
+    if(argc > 3) {
+        parseSpeed(argv[3], job.speed);
+    }
+
+    if(argc > 4) {
+        parseModFlags(argv[4], job.mods);
+    }
+
+    CalcResult res;
+    PhaseTimes times;
+    if(!runJob(job, res, times)) {
+        std::cerr << "error: " << res.error << ' ' << job.path << '\n';
+        return 1;
+    }
+
+    const BeatmapSettings &settings = res.settings;
 
     // output results
-    std::cout << "star rating: " << totalStars << '\n';
-    std::cout << "  aim: " << aim << '\n';
-    std::cout << "  speed: " << speed << '\n';
-    std::cout << "pp (SS): " << pp << '\n';
+    std::cout << "star rating: " << res.totalStars << '\n';
+    std::cout << "  aim: " << res.aim << '\n';
+    std::cout << "  speed: " << res.speed << '\n';
+    std::cout << "pp (SS): " << res.pp << '\n';
     std::cout << '\n';
     std::cout << "map info:\n";
-    std::cout << "  mods: " << modsStringFromMods(modFlags, speedMultiplier) << '\n';
-    std::cout << "  timescale: " << speedMultiplier << '\n';
+    std::cout << "  mods: " << modsStringFromMods(job.mods, job.speed) << '\n';
+    std::cout << "  timescale: " << job.speed << '\n';
     std::cout << "  AR: " << settings.AR << '\n';
     std::cout << "  CS: " << settings.CS << '\n';
     std::cout << "  OD: " << settings.OD << '\n';
     std::cout << "  HP: " << settings.HP << '\n';
-    std::cout << "  objects: " << primitives.getNumObjects() << " (" << primitives.hitcircles.size() << "c + "
-              << primitives.sliders.size() << "s + " << primitives.spinners.size() << "sp)\n";
-    std::cout << "  max combo: " << diffResult.getTotalMaxCombo() << '\n';
+    std::cout << "  objects: " << (res.numCircles + res.numSliders + res.numSpinners) << " (" << res.numCircles
+              << "c + " << res.numSliders << "s + " << res.numSpinners << "sp)\n";
+    std::cout << "  max combo: " << res.maxCombo << '\n';
 
     return 0;
 }
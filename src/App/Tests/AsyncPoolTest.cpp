@@ -6,9 +6,11 @@
 #include "Engine.h"
 #include "Timing.h"
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace Mc::Tests {
 
@@ -216,6 +218,27 @@ void AsyncPoolTest::runSyncTests() {
         TEST_ASSERT_EQ(count.load(std::memory_order_relaxed), N, "all background tasks completed (work stealing)");
     }
 
+    TEST_SECTION("parallel_for");
+    {
+        constexpr int N = 1000;
+        std::vector<int> hits(N, 0);
+        std::atomic<int> count{0};
+        Async::parallel_for(N, [&](size_t i) {
+            hits[i]++;
+            count.fetch_add(1, std::memory_order_relaxed);
+        });
+        TEST_ASSERT_EQ(count.load(std::memory_order_relaxed), N, "parallel_for visits every index");
+        TEST_ASSERT(std::ranges::all_of(hits, [](int h) { return h == 1; }), "parallel_for visits each index once");
+
+        // nested inside a pool task, which must not deadlock waiting for the pool
+        auto nested = Async::submit([] {
+            std::atomic<int> inner{0};
+            Async::parallel_for(64, [&inner](size_t) { inner.fetch_add(1, std::memory_order_relaxed); });
+            return inner.load(std::memory_order_relaxed);
+        });
+        TEST_ASSERT_EQ(nested.get(), 64, "parallel_for works from a pool thread");
+    }
+
     TEST_SECTION("thread_count >= 2");
     {
         TEST_ASSERT(Async::pool().thread_count() >= 2, "pool has at least 2 threads");
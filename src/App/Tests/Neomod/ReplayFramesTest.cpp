@@ -0,0 +1,179 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "ReplayFramesTest.h"
+
+#ifndef LZMA_API_STATIC
+#define LZMA_API_STATIC
+#endif
+#include <lzma.h>
+
+#include "TestMacros.h"
+#include "Engine.h"
+#include "LegacyReplay.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Mc::Tests {
+
+namespace {
+
+using LegacyReplay::Frame;
+
+// size of the chunks get_frames decompresses the replay text in, see LegacyReplay.cpp
+constexpr uSz DECODE_CHUNK_SIZE = 16 * 1024;
+
+// same text as compress_frames writes for a frame
+std::string frame_text(const Frame &frame) {
+    return fmt::format("{}|{:.4f}|{:.4f}|{},", frame.milliseconds_since_last_frame, frame.x, frame.y,
+                       frame.key_flags);
+}
+
+// for replay text compress_frames wouldn't write
+std::vector<u8> compress_text(std::string_view text) {
+    lzma_stream stream = LZMA_STREAM_INIT;
+    lzma_options_lzma options;
+    lzma_lzma_preset(&options, LZMA_PRESET_DEFAULT);
+    if(lzma_alone_encoder(&stream, &options) != LZMA_OK) return {};
+
+    std::vector<u8> compressed(text.size() + 1024);
+    stream.next_in = reinterpret_cast<const u8 *>(text.data());
+    stream.avail_in = text.size();
+    stream.next_out = compressed.data();
+    stream.avail_out = compressed.size();
+    const lzma_ret ret = lzma_code(&stream, LZMA_FINISH);
+    compressed.resize(ret == LZMA_STREAM_END ? stream.total_out : 0);
+    lzma_end(&stream);
+    return compressed;
+}
+
+// random cursor movement, on quarter pixels so that x/y survive the 4 decimals of the text exactly
+std::vector<Frame> random_frames(std::mt19937 &rng, uSz count) {
+    std::vector<Frame> frames(count);
+    for(auto &frame : frames) {
+        frame.milliseconds_since_last_frame =
+            rng() % 50 == 0 ? static_cast<i32>(rng() % 100000) - 1000 : static_cast<i32>(rng() % 60);
+        frame.x = static_cast<f32>(static_cast<i32>(rng() % 2600) - 200) / 4.f;
+        frame.y = static_cast<f32>(static_cast<i32>(rng() % 2000) - 200) / 4.f;
+        frame.key_flags = static_cast<u8>(rng() % 32);
+    }
+    return frames;
+}
+
+constexpr uSz ALL_MATCH = static_cast<uSz>(-1);
+
+// index of the first frame which didn't decode to what it was encoded from, or ALL_MATCH
+uSz first_mismatch(const std::vector<Frame> &decoded, const std::vector<Frame> &frames) {
+    i32 cur_music_pos = 0;
+    for(uSz i = 0; i < frames.size(); i++) {
+        if(i >= decoded.size()) return i;
+
+        cur_music_pos += frames[i].milliseconds_since_last_frame;
+        if(decoded[i].milliseconds_since_last_frame != frames[i].milliseconds_since_last_frame ||
+           decoded[i].x != frames[i].x || decoded[i].y != frames[i].y || decoded[i].key_flags != frames[i].key_flags ||
+           decoded[i].cur_music_pos != cur_music_pos) {
+            return i;
+        }
+    }
+    return decoded.size() == frames.size() ? ALL_MATCH : frames.size();
+}
+
+}  // namespace
+
+ReplayFramesTest::ReplayFramesTest() { logRaw("ReplayFramesTest created"); }
+
+void ReplayFramesTest::update() {
+    if(!m_ran) {
+        m_ran = true;
+        runTests();
+
+        TEST_PRINT_RESULTS("ReplayFramesTest");
+
+        engine->shutdown();
+    }
+}
+
+void ReplayFramesTest::runTests() {
+    TEST_SECTION("compress_frames round trip");
+    {
+        static constexpr int NUM_REPLAYS = 40;
+        std::mt19937 rng(1234);
+
+        int mismatches = 0;
+        bool straddled_chunk = false;  // a frame started in the first chunk and ended in the second
+        bool ended_on_chunk = false;   // a frame's comma was the last character of the first chunk
+        for(int replay = 0; replay < NUM_REPLAYS; replay++) {
+            const std::vector<Frame> frames = random_frames(rng, 1500 + rng() % 1500);
+
+            uSz text_pos = 0;
+            for(const auto &frame : frames) {
+                const uSz frame_end = text_pos + frame_text(frame).size();
+                if(text_pos < DECODE_CHUNK_SIZE && frame_end > DECODE_CHUNK_SIZE) straddled_chunk = true;
+                if(frame_end == DECODE_CHUNK_SIZE) ended_on_chunk = true;
+                text_pos = frame_end;
+            }
+
+            const std::vector<u8> compressed = LegacyReplay::compress_frames(frames);
+            const std::vector<Frame> decoded = LegacyReplay::get_frames(compressed.data(), compressed.size());
+
+            if(const uSz i = first_mismatch(decoded, frames); i != ALL_MATCH) {
+                if(mismatches++ < 5) {
+                    logRaw("  replay {}: frame {} of {} didn't survive ({} decoded)", replay, i, frames.size(),
+                           decoded.size());
+                }
+            }
+        }
+
+        TEST_ASSERT_EQ(mismatches, 0, "replays which didn't decode to the frames they were compressed from");
+        TEST_ASSERT(straddled_chunk, "covered a frame cut off at the end of a chunk");
+        TEST_ASSERT(ended_on_chunk, "covered a frame ending exactly at the end of a chunk");
+    }
+
+    TEST_SECTION("last frame without a trailing comma");
+    {
+        const std::vector<u8> compressed = compress_text("16|100.5000|200.0000|1,-12345|0|0|0,-3|50|60");
+        const std::vector<Frame> decoded = LegacyReplay::get_frames(compressed.data(), compressed.size());
+
+        TEST_ASSERT_EQ(decoded.size(), 2, "frame count");
+        if(decoded.size() == 2) {
+            TEST_ASSERT_EQ(decoded[0].cur_music_pos, 16, "first frame time");
+            TEST_ASSERT_EQ(decoded[0].x, 100.5f, "first frame x");
+            TEST_ASSERT_EQ(decoded[0].key_flags, 1, "first frame keys");
+            TEST_ASSERT_EQ(decoded[1].milliseconds_since_last_frame, -3, "last frame delta");
+            TEST_ASSERT_EQ(decoded[1].cur_music_pos, 13, "last frame time");
+            TEST_ASSERT_EQ(decoded[1].y, 60.f, "last frame y");
+            TEST_ASSERT_EQ(decoded[1].key_flags, 0, "last frame keys (missing field)");
+        }
+    }
+    {
+        // the last frame also has to be put together from two chunks
+        std::mt19937 rng(42);
+        const std::vector<Frame> frames = random_frames(rng, 3000);
+        std::string text;
+        for(const auto &frame : frames) text += frame_text(frame);
+        text.pop_back();
+
+        const std::vector<u8> compressed = compress_text(text);
+        const std::vector<Frame> decoded = LegacyReplay::get_frames(compressed.data(), compressed.size());
+        TEST_ASSERT(text.size() > DECODE_CHUNK_SIZE, "text spans several chunks");
+        TEST_ASSERT(first_mismatch(decoded, frames) == ALL_MATCH, "frames over several chunks");
+    }
+
+    TEST_SECTION("untrusted uncompressed size");
+    {
+        std::mt19937 rng(7);
+        const std::vector<Frame> frames = random_frames(rng, 100);
+        std::vector<u8> compressed = LegacyReplay::compress_frames(frames);
+
+        // claims way more text than the stream could ever hold
+        const u64 claimed_size = 1ULL << 37;
+        std::memcpy(compressed.data() + 5, &claimed_size, sizeof(claimed_size));
+
+        const std::vector<Frame> decoded = LegacyReplay::get_frames(compressed.data(), compressed.size());
+        TEST_ASSERT(decoded.capacity() <= compressed.size(), "reserved frames bounded by the compressed size");
+    }
+}
+
+}  // namespace Mc::Tests
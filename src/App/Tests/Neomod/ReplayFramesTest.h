@@ -0,0 +1,25 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#pragma once
+#include "App.h"
+
+namespace Mc::Tests {
+
+// round trips replay frames through LegacyReplay::compress_frames and get_frames, including frames which get cut off
+// at the end of get_frames' decompression chunks, replay text without a trailing comma and lying .lzma headers
+class ReplayFramesTest : public App {
+    NOCOPY_NOMOVE(ReplayFramesTest)
+   public:
+    ReplayFramesTest();
+    ~ReplayFramesTest() override = default;
+
+    void update() override;
+
+   private:
+    void runTests();
+
+    int m_passes = 0;
+    int m_failures = 0;
+    bool m_ran = false;
+};
+
+}  // namespace Mc::Tests
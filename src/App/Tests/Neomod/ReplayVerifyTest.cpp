@@ -0,0 +1,236 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "ReplayVerifyTest.h"
+
+#include "TestMacros.h"
+#include "AsyncPool.h"
+#include "DatabaseBeatmap.h"
+#include "Engine.h"
+#include "File.h"
+#include "Hashing.h"
+#include "LegacyReplay.h"
+#include "MD5Hash.h"
+#include "SimulatedBeatmapInterface.h"
+#include "Timing.h"
+#include "crypto.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <limits>
+
+namespace Mc::Tests {
+
+namespace {
+
+struct VerifyResult {
+    enum class Status : u8 { LOAD_ERROR, UNSUPPORTED, NO_BEATMAP, MATCH, MISMATCH };
+    Status status{Status::LOAD_ERROR};
+    std::string mismatches;  // "name: stored != simulated, ..."
+    uSz numFrames{0};
+};
+
+template <typename T>
+void compareField(std::string &out, std::string_view name, T stored, T simulated) {
+    if(stored == simulated) return;
+    if(!out.empty()) out.append(", ");
+    out.append(fmt::format("{}: {} != {}", name, stored, simulated));
+}
+
+// runs on a pool thread, everything it touches is its own
+VerifyResult verifyReplay(const std::string &replayPath, const Hash::flat::map<MD5Hash, std::string> &beatmaps) {
+    using enum VerifyResult::Status;
+    VerifyResult result;
+
+    LegacyReplay::Info info;
+    Hash::flat::map<MD5Hash, std::string>::const_iterator it;
+    {
+        File file(replayPath);
+        const uSz fileSize = file.canRead() ? file.getFileSize() : 0;
+        if(!fileSize) return result;
+
+        const std::unique_ptr<u8[]> buffer = file.takeFileBuffer();
+        if(!buffer) return result;
+
+        // header first, replays which are going to be skipped anyway don't need their frames decompressed
+        info = LegacyReplay::from_bytes(buffer.get(), fileSize, false);
+        if(info.gamemode != 0 || info.map_md5.lengthUtf8() != 32) {
+            result.status = UNSUPPORTED;
+            return result;
+        }
+
+        it = beatmaps.find(MD5Hash{info.map_md5.toUtf8()});
+        if(it == beatmaps.end()) {
+            result.status = NO_BEATMAP;
+            return result;
+        }
+
+        info = LegacyReplay::from_bytes(buffer.get(), fileSize);
+        if(info.frames.size() < 2) {
+            result.status = UNSUPPORTED;
+            return result;
+        }
+    }
+
+    const std::string &beatmapPath = it->second;
+    BeatmapDifficulty beatmap(beatmapPath, beatmapPath.substr(0, beatmapPath.find_last_of("/\\") + 1),
+                              DatabaseBeatmap::BeatmapType::PEPPY_DIFFICULTY);
+
+    // the difficulty settings have to be known before the hitobjects get loaded (the database would have them)
+    if(beatmap.loadMetadata(false).error.errc) return result;
+
+    result.numFrames = info.frames.size();
+
+    SimulatedBeatmapInterface sim(&beatmap, Replay::Mods::from_legacy(info.mod_flags));
+    sim.disable_checkpoints();  // only ever simulated forward once
+    sim.spectated_replay = std::move(info.frames);
+    sim.simulate_to(std::numeric_limits<i32>::max());
+
+    // same mapping as BeatmapInterface uses when saving a FinishedScore
+    const LiveScore &score = sim.live_score;
+    compareField(result.mismatches, "300s", info.num300s, score.getNum300s());
+    compareField(result.mismatches, "100s", info.num100s, score.getNum100s());
+    compareField(result.mismatches, "50s", info.num50s, score.getNum50s());
+    compareField(result.mismatches, "misses", info.numMisses, score.getNumMisses());
+    compareField(result.mismatches, "gekis", info.numGekis, score.getNum300gs());
+    compareField(result.mismatches, "katus", info.numKatus, score.getNum100ks());
+    compareField(result.mismatches, "combo", info.comboMax, score.getComboMax());
+    compareField(result.mismatches, "score", (u64)info.score, score.getScore());
+
+    result.status = result.mismatches.empty() ? MATCH : MISMATCH;
+    return result;
+}
+
+}  // namespace
+
+ReplayVerifyTest::ReplayVerifyTest() { logRaw("ReplayVerifyTest created"); }
+
+void ReplayVerifyTest::update() {
+    if(!m_ran) {
+        m_ran = true;
+        runTests();
+
+        TEST_PRINT_RESULTS("ReplayVerifyTest");
+
+        engine->shutdown();
+    }
+}
+
+void ReplayVerifyTest::runTests() {
+    auto replaysPath = getTestArg("replays");
+    auto songsPath = getTestArg("songs");
+    if(const auto osuFolder = getTestArg("osu_folder")) {
+        if(!replaysPath) replaysPath = *osuFolder + "/Data/r";
+        if(!songsPath) songsPath = *osuFolder + "/Songs";
+    }
+
+    if(!replaysPath || !songsPath) {
+        logRaw("  FAIL: missing -testarg:osu_folder, or -testarg:replays and -testarg:songs");
+        m_failures++;
+        return;
+    }
+
+    Timer timer;
+
+    // map MD5 -> .osu path, which is all the replays know about their beatmap
+    TEST_SECTION("indexing beatmaps");
+    Hash::flat::map<MD5Hash, std::string> beatmaps;
+    {
+        timer.start();
+
+        std::vector<std::string> beatmapFiles = collectFiles(*songsPath, ".osu");
+        std::vector<MD5Hash> hashes(beatmapFiles.size());
+        Async::parallel_for(beatmapFiles.size(),
+                            [&](uSz i) { crypto::hash::md5_f(beatmapFiles[i], hashes[i].data()); });
+
+        beatmaps.reserve(beatmapFiles.size());
+        for(uSz i = 0; i < beatmapFiles.size(); i++) {
+            if(!hashes[i].empty()) beatmaps.emplace(hashes[i], std::move(beatmapFiles[i]));
+        }
+
+        logRaw("  {} beatmaps in {:.2f}s", beatmaps.size(), timer.getLiveElapsedTime());
+    }
+
+    TEST_SECTION("simulating replays");
+    {
+        const std::vector<std::string> replayFiles = collectFiles(*replaysPath, ".osr");
+        std::vector<VerifyResult> results(replayFiles.size());
+
+        timer.start();
+        Async::parallel_for(replayFiles.size(), [&](uSz i) { results[i] = verifyReplay(replayFiles[i], beatmaps); });
+        const f64 elapsed = std::max(timer.getLiveElapsedTime(), 1e-9);
+
+        uSz numSimulated = 0;
+        uSz numFrames = 0;
+        uSz numUnsupported = 0;
+        uSz numNoBeatmap = 0;
+        for(uSz i = 0; i < results.size(); i++) {
+            using enum VerifyResult::Status;
+            const VerifyResult &result = results[i];
+            switch(result.status) {
+                case LOAD_ERROR:
+                    logRaw("  FAIL: couldn't load {}", replayFiles[i]);
+                    m_failures++;
+                    break;
+                case UNSUPPORTED:
+                    numUnsupported++;
+                    break;
+                case NO_BEATMAP:
+                    numNoBeatmap++;
+                    break;
+                case MATCH:
+                    m_passes++;
+                    break;
+                case MISMATCH:
+                    logRaw("  FAIL: {} -- {}", replayFiles[i], result.mismatches);
+                    m_failures++;
+                    break;
+            }
+
+            if(result.status == MATCH || result.status == MISMATCH) {
+                numSimulated++;
+                numFrames += result.numFrames;
+            }
+        }
+
+        logRaw("  simulated {} replays ({} frames) in {:.2f}s: {:.1f} replays/s, {:.0f} frames/s", numSimulated,
+               numFrames, elapsed, (f64)numSimulated / elapsed, (f64)numFrames / elapsed);
+        logRaw("  skipped {} replays with a missing beatmap, {} empty or non-osu!standard replays", numNoBeatmap,
+               numUnsupported);
+    }
+}
+
+// a single file (if it has the extension), or every matching file below a directory, sorted
+std::vector<std::string> ReplayVerifyTest::collectFiles(const std::string &path, std::string_view extension) {
+    const auto hasExtension = [extension](const std::filesystem::path &file) {
+        std::string ext = file.extension().string();
+        std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == extension;
+    };
+
+    std::vector<std::string> files;
+    std::error_code ec;
+    if(std::filesystem::is_regular_file(path, ec)) {
+        if(hasExtension(path)) files.push_back(path);
+        return files;
+    }
+
+    auto it = std::filesystem::recursive_directory_iterator(
+        path, std::filesystem::directory_options::skip_permission_denied, ec);
+    if(ec) {
+        logRaw("  couldn't open {}: {}", path, ec.message());
+        return files;
+    }
+
+    for(const auto end = std::filesystem::recursive_directory_iterator(); it != end; it.increment(ec)) {
+        if(ec) break;
+        if(it->is_regular_file(ec) && hasExtension(it->path())) {
+            files.push_back(it->path().string());
+        }
+    }
+
+    // directory iteration order is unspecified, keep output stable between runs
+    std::ranges::sort(files);
+    return files;
+}
+
+}  // namespace Mc::Tests
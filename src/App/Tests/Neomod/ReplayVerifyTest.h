@@ -0,0 +1,35 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#pragma once
+#include "App.h"
+
+#include <string>
+#include <vector>
+
+namespace Mc::Tests {
+
+// headless batch replay verification: plays every given .osr against its beatmap through SimulatedBeatmapInterface
+// (on all pool threads) and compares the simulated hit counts/combo/score to the ones stored in the replay.
+// for validating gameplay changes against a large set of real replays.
+//
+// -testarg:replays <.osr file or directory>  (searched recursively)
+// -testarg:songs <directory with the beatmaps>  (searched recursively, matched by MD5)
+// -testarg:osu_folder <osu!stable folder>  (defaults to <osu_folder>/Data/r and <osu_folder>/Songs for the above)
+class ReplayVerifyTest : public App {
+    NOCOPY_NOMOVE(ReplayVerifyTest)
+   public:
+    ReplayVerifyTest();
+    ~ReplayVerifyTest() override = default;
+
+    void update() override;
+
+   private:
+    void runTests();
+
+    static std::vector<std::string> collectFiles(const std::string &path, std::string_view extension);
+
+    int m_passes = 0;
+    int m_failures = 0;
+    bool m_ran = false;
+};
+
+}  // namespace Mc::Tests
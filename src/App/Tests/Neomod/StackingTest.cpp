@@ -0,0 +1,243 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#include "StackingTest.h"
+
+#include "TestMacros.h"
+#include "Engine.h"
+#include "Stacking.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Mc::Tests {
+
+namespace {
+
+using Stacking::Object;
+using enum Stacking::Object::Type;
+
+// the stacking loops as they were before Stacking.cpp (DatabaseBeatmap::loadDifficultyHitObjects' copy), on the
+// same object data
+std::vector<i32> referenceStacks(const std::vector<Object> &objs, int version, f32 stackTime) {
+    static constexpr f32 STACK_LENIENCE = 3.0f;
+
+    std::vector<i32> stack(objs.size(), 0);
+    const int count = static_cast<int>(objs.size());
+
+    if(version > 5) {
+        // peppy's algorithm
+        for(int i = count - 1; i >= 0; i--) {
+            int n = i;
+            int objectI = i;
+
+            if(stack[objectI] != 0 || objs[objectI].type == SPINNER) continue;
+
+            if(objs[objectI].type == CIRCLE) {
+                while(--n >= 0) {
+                    if(objs[n].type == SPINNER) continue;
+                    if(objs[objectI].time - stackTime > objs[n].endTime) break;
+
+                    const vec2 objectNEndPosition = objs[n].endPos;
+                    if(objs[n].duration != 0 &&
+                       vec::length(objectNEndPosition - objs[objectI].pos) < STACK_LENIENCE) {
+                        const int offset = stack[objectI] - stack[n] + 1;
+                        for(int j = n + 1; j <= i; j++) {
+                            if(vec::length(objectNEndPosition - objs[j].pos) < STACK_LENIENCE) stack[j] -= offset;
+                        }
+                        break;
+                    }
+
+                    if(vec::length(objs[n].pos - objs[objectI].pos) < STACK_LENIENCE) {
+                        stack[n] = stack[objectI] + 1;
+                        objectI = n;
+                    }
+                }
+            } else {
+                while(--n >= 0) {
+                    if(objs[n].type == SPINNER) continue;
+                    if(objs[objectI].time - stackTime > objs[n].time) break;
+
+                    const vec2 objectNPos = objs[n].duration != 0 ? objs[n].endPos : objs[n].pos;
+                    if(vec::length(objectNPos - objs[objectI].pos) < STACK_LENIENCE) {
+                        stack[n] = stack[objectI] + 1;
+                        objectI = n;
+                    }
+                }
+            }
+        }
+    } else {
+        // old stacking algorithm for old beatmaps
+        for(int i = 0; i < count; i++) {
+            const bool isSlider = objs[i].type == SLIDER;
+            if(stack[i] != 0 && !isSlider) continue;
+
+            i32 startTime = objs[i].time + objs[i].duration;
+            int sliderStack = 0;
+
+            for(int j = i + 1; j < count; j++) {
+                if(objs[j].time - stackTime > startTime) break;
+
+                const vec2 position2 = isSlider ? objs[i].endPos : objs[i].pos;
+                if(vec::length(objs[j].pos - objs[i].pos) < 3) {
+                    stack[i]++;
+                    startTime = objs[j].time + objs[j].duration;
+                } else if(vec::length(objs[j].pos - position2) < 3) {
+                    sliderStack++;
+                    stack[j] -= sliderStack;
+                    startTime = objs[j].time + objs[j].duration;
+                }
+            }
+        }
+    }
+
+    return stack;
+}
+
+std::vector<i32> engineStacks(const std::vector<Object> &objs, int version, f32 stackTime) {
+    std::vector<i32> stack(objs.size());
+    Stacking::calculate(objs, stack, version, stackTime);
+    return stack;
+}
+
+// few distinct positions close together (so that most objects are within stacking distance of something), random
+// types/durations, the odd far away or non-finite-ish position, and a random stacking time window
+std::vector<Object> randomMap(std::mt19937 &rng, f32 &stackTime) {
+    const int numObjects = static_cast<int>(rng() % 200) + 1;
+    const int spread = (rng() % 4 == 0) ? 3 : (rng() % 2 ? 8 : 40);
+    const int numPositions = static_cast<int>(rng() % 6) + 1;
+
+    std::vector<vec2> positions;
+    for(int k = 0; k < numPositions; k++) {
+        positions.emplace_back(static_cast<f32>(rng() % spread) * 0.7f + 100.f,
+                               static_cast<f32>(rng() % spread) * 0.9f + 100.f);
+    }
+
+    std::vector<Object> objs;
+    i32 time = 0;
+    for(int k = 0; k < numObjects; k++) {
+        time += static_cast<i32>(rng() % 150);
+
+        Object o{};
+        const u32 type = rng() % 10;
+        o.type = type < 5 ? CIRCLE : (type < 9 ? SLIDER : SPINNER);
+        o.pos = positions[rng() % numPositions] + vec2(static_cast<f32>(rng() % 3) * 0.5f, 0.f);
+        if(rng() % 40 == 0) o.pos.x = (rng() % 2) ? 1e30f : -1e6f;
+        o.time = time;
+
+        if(o.type == CIRCLE) {
+            o.endTime = time;
+            o.duration = 0;
+            o.endPos = o.pos;
+        } else if(o.type == SLIDER) {
+            // zero and negative lengths happen with broken maps
+            const i32 length = (rng() % 8 == 0) ? 0 : static_cast<i32>(rng() % 600) - 50;
+            o.endTime = time + length;
+            o.duration = std::max(0, length);
+            o.endPos = o.duration != 0 ? positions[rng() % numPositions] : o.pos;
+        } else {
+            const i32 length = static_cast<i32>(rng() % 2000);
+            o.endTime = time + length;
+            o.duration = length;
+            o.endPos = o.pos;
+        }
+        objs.push_back(o);
+    }
+
+    stackTime = static_cast<f32>(rng() % 1800) * 0.7f;
+    return objs;
+}
+
+Object circle(vec2 pos, i32 time) {
+    return {.pos = pos, .endPos = pos, .time = time, .endTime = time, .duration = 0, .type = CIRCLE};
+}
+
+Object slider(vec2 pos, vec2 endPos, i32 time, i32 duration) {
+    return {.pos = pos,
+            .endPos = endPos,
+            .time = time,
+            .endTime = time + duration,
+            .duration = duration,
+            .type = SLIDER};
+}
+
+}  // namespace
+
+StackingTest::StackingTest() { logRaw("StackingTest created"); }
+
+void StackingTest::update() {
+    if(!m_ran) {
+        m_ran = true;
+        runTests();
+
+        TEST_PRINT_RESULTS("StackingTest");
+
+        engine->shutdown();
+    }
+}
+
+void StackingTest::runTests() {
+    static constexpr f32 STACK_TIME = 1800.f * 0.7f;  // AR 0 approach time * default stack leniency
+
+    TEST_SECTION("handcrafted stacks");
+    {
+        // five circles on the same spot, the earliest one is stacked the highest
+        std::vector<Object> objs;
+        for(i32 k = 0; k < 5; k++) {
+            objs.push_back(circle(vec2(256.f, 192.f), k * 100));
+        }
+        TEST_ASSERT(engineStacks(objs, 14, STACK_TIME) == std::vector<i32>({4, 3, 2, 1, 0}), "v14 circle stack");
+        TEST_ASSERT(engineStacks(objs, 4, STACK_TIME) == referenceStacks(objs, 4, STACK_TIME), "v4 circle stack");
+    }
+    {
+        // circles on a slider's end are pushed the other way, the later ones further
+        std::vector<Object> objs{slider(vec2(100.f, 100.f), vec2(300.f, 100.f), 0, 200),
+                                 circle(vec2(300.f, 100.f), 400), circle(vec2(300.f, 100.f), 500)};
+        TEST_ASSERT(engineStacks(objs, 14, STACK_TIME) == std::vector<i32>({0, -1, -2}), "v14 stack on slider end");
+        TEST_ASSERT(engineStacks(objs, 14, STACK_TIME) == referenceStacks(objs, 14, STACK_TIME),
+                    "v14 stack on slider end matches");
+        TEST_ASSERT(engineStacks(objs, 4, STACK_TIME) == referenceStacks(objs, 4, STACK_TIME),
+                    "v4 stack on slider end matches");
+    }
+    {
+        // outside of the stacking time window nothing stacks
+        std::vector<Object> objs{circle(vec2(256.f, 192.f), 0), circle(vec2(256.f, 192.f), 5000)};
+        for(const int version : {4, 14}) {
+            TEST_ASSERT(engineStacks(objs, version, STACK_TIME) == std::vector<i32>({0, 0}), "no stack past window");
+        }
+    }
+    {
+        // long stream on the same spot, where the old loops rescan the whole window for every object
+        std::vector<Object> objs;
+        for(i32 k = 0; k < 5000; k++) {
+            objs.push_back(circle(vec2(256.f + (k % 7 == 0 ? 0.f : static_cast<f32>(k % 50)), 192.f), k * 20));
+        }
+        for(const int version : {4, 14}) {
+            TEST_ASSERT(engineStacks(objs, version, STACK_TIME) == referenceStacks(objs, version, STACK_TIME),
+                        fmt::format("v{} dense stream matches", version));
+        }
+    }
+
+    TEST_SECTION("randomized maps against the original loops");
+    {
+        static constexpr int NUM_MAPS = 20000;
+        std::mt19937 rng(1234);
+
+        int mismatches[2]{};
+        for(int map = 0; map < NUM_MAPS; map++) {
+            f32 stackTime = 0.f;
+            const std::vector<Object> objs = randomMap(rng, stackTime);
+
+            for(const int version : {4, 14}) {
+                if(engineStacks(objs, version, stackTime) == referenceStacks(objs, version, stackTime)) continue;
+                if(mismatches[version > 5]++ < 5) {
+                    logRaw("  mismatch: map {} (v{}, {} objects, stack time {})", map, version, objs.size(),
+                           stackTime);
+                }
+            }
+        }
+        TEST_ASSERT_EQ(mismatches[0], 0, "v5 and older maps with different stacks");
+        TEST_ASSERT_EQ(mismatches[1], 0, "v6 and newer maps with different stacks");
+    }
+}
+
+}  // namespace Mc::Tests
@@ -0,0 +1,25 @@
+// Copyright (c) 2026, WH, All rights reserved.
+#pragma once
+#include "App.h"
+
+namespace Mc::Tests {
+
+// compares Stacking::calculate against the original O(n^2) stacking loops (both algorithm versions) on randomized
+// maps with heavy overlap, plus a few handcrafted stacks
+class StackingTest : public App {
+    NOCOPY_NOMOVE(StackingTest)
+   public:
+    StackingTest();
+    ~StackingTest() override = default;
+
+    void update() override;
+
+   private:
+    void runTests();
+
+    int m_passes = 0;
+    int m_failures = 0;
+    bool m_ran = false;
+};
+
+}  // namespace Mc::Tests
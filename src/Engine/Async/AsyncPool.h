@@ -11,6 +11,7 @@
 #include "SyncCV.h"
 #include "SyncJthread.h"
 
+#include <algorithm>
 #include <queue>
 #include <functional>
 #include <memory>
@@ -175,6 +176,54 @@ auto submit_cancellable(F&& f, Lane lane = Lane::Foreground)
 inline void queue_main(std::function<void()> fn) { pool().queue_main(std::move(fn)); }
 inline void update() { pool().update(); }
 
+// ---------------------------------------------------------------------------
+// parallel_for: run fn(i) for every i in [0, count), spread over the pool
+// ---------------------------------------------------------------------------
+
+// the calling thread claims indices too and only waits for the ones other threads already started, so this is safe to
+// call from a pool thread even while the rest of the pool is busy (it just degrades to a serial loop).
+// indices are claimed one at a time, so fn should do a reasonably sized chunk of work per index.
+template <typename F>
+void parallel_for(size_t count, F&& fn, Lane lane = Lane::Background) {
+    if(count == 0) return;
+    if(count == 1) {
+        fn(size_t{0});
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        size_t count;
+        std::function<void(size_t)> fn;
+        void run() {
+            size_t i;
+            while((i = this->next.fetch_add(1, std::memory_order_relaxed)) < this->count) {
+                this->fn(i);
+                if(this->done.fetch_add(1, std::memory_order_acq_rel) + 1 == this->count) {
+                    this->done.notify_all();
+                }
+            }
+        }
+    };
+
+    // helpers that only get to run after everything was claimed exit without touching fn
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->fn = [&fn](size_t i) { fn(i); };
+
+    const size_t nb_helpers = std::min(count - 1, pool().thread_count());
+    for(size_t h = 0; h < nb_helpers; h++) {
+        dispatch([state]() { state->run(); }, lane);
+    }
+
+    state->run();
+    for(size_t done = state->done.load(std::memory_order_acquire); done < count;
+        done = state->done.load(std::memory_order_acquire)) {
+        state->done.wait(done, std::memory_order_acquire);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // make_ready_future: create a future that is immediately ready
 // ---------------------------------------------------------------------------
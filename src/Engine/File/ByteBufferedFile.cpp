@@ -10,6 +10,16 @@
 #include <cassert>
 #include <vector>
 
+#if defined(MCENGINE_PLATFORM_WINDOWS)
+#include "WinDebloatDefs.h"
+#include <windows.h>
+#elif !defined(MCENGINE_PLATFORM_WASM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace {
 constexpr size_t NUM_FILE_LOCKS = 16;
 
@@ -236,6 +246,189 @@ void ByteBufferedFile::Reader::skip_string() {
     this->skip_bytes(len);
 }
 
+ByteBufferedFile::MappedReader::MappedReader(std::string_view readPath_param) : read_path(readPath_param) {
+    file_locks[path_to_lock_index(this->read_path)].lock_shared();
+
+    if(this->map_file()) {
+        return;
+    }
+
+    // not mappable here, just read the whole thing
+    std::ifstream file(File::getFsPath(this->read_path), std::ios::binary | std::ios::ate);
+    if(!file.is_open()) {
+        this->set_error("Failed to open file for reading: " + std::generic_category().message(errno));
+        debugLog("Failed to open '{:s}': {:s}", this->read_path, std::generic_category().message(errno).c_str());
+        return;
+    }
+
+    const auto size = static_cast<std::streamsize>(file.tellg());
+    if(size <= 0) {
+        return;  // empty, not an error
+    }
+
+    this->read_buffer = std::make_unique_for_overwrite<u8[]>(static_cast<uSz>(size));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char *>(this->read_buffer.get()), size);
+    if(file.gcount() != size) {
+        this->set_error("Failed to read " + std::to_string(size) + " bytes");
+        this->read_buffer.reset();
+        return;
+    }
+
+    this->view = this->read_buffer.get();
+    this->total_size = static_cast<uSz>(size);
+}
+
+ByteBufferedFile::MappedReader::~MappedReader() {
+    if(this->mapping != nullptr) {
+#if defined(MCENGINE_PLATFORM_WINDOWS)
+        UnmapViewOfFile(this->mapping);
+#elif !defined(MCENGINE_PLATFORM_WASM)
+        munmap(this->mapping, this->total_size);
+#endif
+    }
+    file_locks[path_to_lock_index(this->read_path)].unlock_shared();
+}
+
+bool ByteBufferedFile::MappedReader::map_file() {
+    void *base = nullptr;
+#if defined(MCENGINE_PLATFORM_WINDOWS)
+    HANDLE file = CreateFileW(File::getFsPath(this->read_path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size{};
+    if(!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE file_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(file_mapping == nullptr) return false;
+
+    // the view keeps the mapping object alive
+    base = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(file_mapping);
+
+    if(base != nullptr) this->total_size = static_cast<uSz>(size.QuadPart);
+#elif !defined(MCENGINE_PLATFORM_WASM)
+    const int fd = open(this->read_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1) return false;
+
+    struct stat st{};
+    if(fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    // the mapping stays valid after closing the descriptor
+    base = mmap(nullptr, static_cast<uSz>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return false;
+
+    // databases are read front to back exactly once
+    posix_madvise(base, static_cast<uSz>(st.st_size), POSIX_MADV_SEQUENTIAL);
+
+    this->total_size = static_cast<uSz>(st.st_size);
+#endif
+    if(base == nullptr) return false;
+
+    this->mapping = base;
+    this->view = static_cast<const u8 *>(base);
+    return true;
+}
+
+void ByteBufferedFile::MappedReader::set_error(const std::string &error_msg) {
+    if(!this->error_flag) {  // only set first error
+        this->error_flag = true;
+        this->last_error = error_msg;
+    }
+}
+
+bool ByteBufferedFile::SpanReader::read_hash_chars(MD5String &inout) {
+    if(this->error_flag) {
+        return false;
+    }
+
+    u8 empty_check = this->read<u8>();
+    if(empty_check == 0) {
+        return false;
+    }
+
+    u32 len = this->read_uleb128();
+    if(len != 32) {
+        // just continue, read what's there
+        debugLog("WARNING: Expected 32 bytes for hash string, got {}!", len);
+        const u32 to_read = std::min(len, 32U);
+        if(this->read_bytes(reinterpret_cast<u8 *>(inout.data()), to_read) == to_read) {
+            this->skip_bytes(len - to_read);
+        }
+        return false;
+    }
+
+    return this->read_bytes(reinterpret_cast<u8 *>(inout.data()), 32) == 32;
+}
+
+bool ByteBufferedFile::SpanReader::read_hash_chars(MD5Hash &inout) {
+    MD5String temp;
+    bool ret = read_hash_chars(temp);
+    inout = temp;
+    return ret;
+}
+
+bool ByteBufferedFile::SpanReader::read_string(std::string &inout) {
+    if(this->error_flag) {
+        return false;
+    }
+
+    u8 empty_check = this->read<u8>();
+    if(empty_check == 0) return false;
+
+    u32 len = this->read_uleb128();
+    if(this->error_flag || len > this->total_size - this->total_pos) {
+        this->error_flag = true;
+        inout.clear();
+        return false;
+    }
+
+    inout.assign(reinterpret_cast<const char *>(&this->bytes[this->total_pos]), len);
+    this->total_pos += len;
+    return true;
+}
+
+std::string ByteBufferedFile::SpanReader::read_string() {
+    std::string str;
+    this->read_string(str);
+    return str;
+}
+
+u32 ByteBufferedFile::SpanReader::read_uleb128() {
+    u32 result = 0;
+    u32 shift = 0;
+    u8 byte = 0;
+
+    do {
+        byte = this->read<u8>();
+        result |= (byte & 0x7f) << shift;
+        shift += 7;
+    } while((byte & 0x80) && shift < 35);
+
+    return result;
+}
+
+void ByteBufferedFile::SpanReader::skip_string() {
+    if(this->error_flag) {
+        return;
+    }
+
+    u8 empty_check = this->read<u8>();
+    if(empty_check == 0) return;
+
+    u32 len = this->read_uleb128();
+    this->skip_bytes(len);
+}
+
 ByteBufferedFile::Writer::Writer(std::string_view writePath_param)
     : buffer(std::make_unique_for_overwrite<u8[]>(WRITE_BUFFER_SIZE)), write_path(writePath_param) {
     file_locks[path_to_lock_index(this->write_path)].lock();
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <span>
 
 #include "noinclude.h"
 #include "types.h"
@@ -218,6 +220,110 @@ class ByteBufferedFile {
         std::string last_error;
     };
 
+    // Read-only view of a whole file for formats that are indexed in place rather than streamed.
+    // Memory-mapped where possible, otherwise (WASM, or if mapping fails) the file is read into memory once.
+    // Holds the same per-path lock as Reader for as long as it's alive, so keep it short-lived.
+    class MappedReader {
+        NOCOPY_NOMOVE(MappedReader)
+       public:
+        MappedReader() = delete;
+        MappedReader(std::string_view readPath);
+        ~MappedReader();
+
+        [[nodiscard]] constexpr bool good() const { return !this->error_flag; }
+        [[nodiscard]] constexpr std::string_view error() const { return this->last_error; }
+        [[nodiscard]] constexpr bool is_mapped() const { return this->mapping != nullptr; }
+
+        [[nodiscard]] constexpr std::span<const u8> data() const { return {this->view, this->total_size}; }
+
+        uSz total_size{0};
+
+       private:
+        void set_error(const std::string &error_msg);
+        bool map_file();
+
+        std::string read_path;
+
+        const u8 *view{nullptr};
+        void *mapping{nullptr};             // base of the platform mapping, if there is one
+        std::unique_ptr<u8[]> read_buffer;  // fallback when not mapped
+
+        bool error_flag{false};
+        std::string last_error;
+    };
+
+    // Same reading interface as Reader, over bytes that are already in memory (usually a MappedReader's data()).
+    // Doesn't own or lock anything, so several copies can decode different parts of one file in parallel,
+    // each one seek()ed to an offset found by an earlier sequential pass.
+    class SpanReader {
+       public:
+        SpanReader() = default;
+        explicit SpanReader(std::span<const u8> bytes) : total_size(bytes.size()), bytes(bytes) {}
+
+        [[nodiscard]] default_inline_attr uSz read_bytes(u8 *out, uSz len) {
+            if(this->error_flag || len > this->total_size - this->total_pos) {
+                this->error_flag = true;
+                if(out != nullptr) {
+                    memset(out, 0, len);
+                }
+                return 0;
+            }
+
+            if(out != nullptr) {
+                memcpy(out, &this->bytes[this->total_pos], len);
+            }
+            this->total_pos += len;
+            return len;
+        }
+
+        template <typename T>
+        [[nodiscard]] default_inline_attr T read() {
+            T result;
+            if((this->read_bytes(reinterpret_cast<u8 *>(&result), sizeof(T))) != sizeof(T)) {
+                memset(&result, 0, sizeof(T));
+            }
+            return result;
+        }
+
+        default_inline_attr void skip_bytes(uSz n) {
+            if(this->error_flag || n > this->total_size - this->total_pos) {
+                this->error_flag = true;
+                return;
+            }
+            this->total_pos += n;
+        }
+
+        template <typename T>
+        default_inline_attr void skip() {
+            this->skip_bytes(sizeof(T));
+        }
+
+        // clears the error flag, offsets past the end are clamped (and the next read fails)
+        inline void seek(uSz pos) {
+            this->total_pos = std::min(pos, this->total_size);
+            this->error_flag = false;
+        }
+
+        [[nodiscard]] constexpr bool good() const { return !this->error_flag; }
+
+        [[nodiscard]] bool read_hash_chars(MD5String &hash_str_inout);
+        [[nodiscard]] bool read_hash_chars(MD5Hash &hash_digest_inout);
+
+        bool read_string(std::string &inout);
+        [[nodiscard]] std::string read_string();
+
+        [[nodiscard]] u32 read_uleb128();
+
+        void skip_string();
+
+        uSz total_size{0};
+        uSz total_pos{0};
+
+       private:
+        std::span<const u8> bytes;
+        bool error_flag{false};
+    };
+
     class Writer {
         NOCOPY_NOMOVE(Writer)
        public:
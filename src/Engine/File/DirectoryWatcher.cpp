@@ -10,6 +10,7 @@
 #include "UString.h"
 
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 #include <atomic>
@@ -17,11 +18,18 @@
 #ifdef MCENGINE_PLATFORM_WINDOWS
 #include "WinDebloatDefs.h"
 #include <windows.h>
+#elif defined(MCENGINE_PLATFORM_LINUX)
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 #endif
 
 namespace fs = std::filesystem;
 
-// The Windows implementation does not poll, only wakes up when files in folders on disk have changed
+// The Windows and Linux implementations do not poll, only wake up when files in folders on disk have changed
 struct DirWatcherImpl {
    private:
     NOCOPY_NOMOVE(DirWatcherImpl)
@@ -30,11 +38,19 @@ struct DirWatcherImpl {
         this->init_wakeup_notification();
         this->thr = Sync::jthread([this](const Sync::stop_token& stoken) { return this->worker_loop(stoken); });
     }
-    ~DirWatcherImpl() { this->destroy_wakeup_notification(); }
+    ~DirWatcherImpl() {
+        // the worker may still be waiting on the wakeup notification
+        if(this->thr.joinable()) {
+            this->thr.request_stop();
+            this->thr.join();
+        }
+        this->destroy_wakeup_notification();
+    }
 
-    void watch_directory(std::string path, FileChangeCallback cb) {
+    void watch_directory(std::string path, FileChangeCallback cb, bool recursive) {
         Sync::scoped_lock lock(this->directories_mtx);
-        this->directories_to_add.emplace_back(std::move(path), std::move(cb));
+        this->directories_to_add.push_back(
+            DirectoryToAdd{.path = std::move(path), .cb = std::move(cb), .recursive = recursive});
         this->notify_thread();
     }
 
@@ -63,8 +79,14 @@ struct DirWatcherImpl {
         u8 stable_checks{0};  // consecutive checks where timestamp was stable
     };
 
+    struct DirectoryToAdd {
+        std::string path;
+        FileChangeCallback cb;
+        bool recursive;
+    };
+
     Sync::mutex directories_mtx;
-    std::vector<std::pair<std::string, FileChangeCallback>> directories_to_add;
+    std::vector<DirectoryToAdd> directories_to_add;
     std::vector<std::string> directories_to_remove;
 
     Sync::mutex finished_events_mtx;
@@ -85,9 +107,10 @@ struct DirWatcherImpl {
     void notify_thread() { SetEvent(this->wakeup_event); }
 
     struct DirectoryState {
-        DirectoryState(FileChangeCallback cb) : cb(std::move(cb)) {}
+        DirectoryState(FileChangeCallback cb, bool recursive) : cb(std::move(cb)), recursive(recursive) {}
 
         FileChangeCallback cb;
+        bool recursive;
 
         Hash::stable_stringmap<UnconfirmedEvent> unconfirmed_events{};
 
@@ -155,11 +178,11 @@ struct DirWatcherImpl {
             // Add/remove directories
             {
                 Sync::scoped_lock lock(this->directories_mtx);
-                for(auto& [path, cb] : this->directories_to_add) {
+                for(auto& [path, cb, recursive] : this->directories_to_add) {
                     if(std::ranges::contains(this->directories_to_remove, path)) continue;
                     if(!path.ends_with('/')) path.push_back('/');  // make sure it ends with a /
 
-                    auto [it, added] = active_directories.emplace(path, DirectoryState(cb));
+                    auto [it, added] = active_directories.emplace(path, DirectoryState(cb, recursive));
                     if(added) {
                         // This should always be true
                         directories_to_init.push_back(it);
@@ -206,10 +229,13 @@ struct DirWatcherImpl {
                 if(state.read_pending) continue;
 
                 ResetEvent(state.w.overlapped.hEvent);
-                BOOL result = ReadDirectoryChangesW(
-                    state.w.dir_handle, state.buffer.data(), static_cast<DWORD>(state.buffer.size()), FALSE,
-                    FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, nullptr,
-                    &state.w.overlapped, nullptr);
+                // non-recursive watches also report new subdirectories
+                const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                     FILE_NOTIFY_CHANGE_SIZE | (state.recursive ? 0 : FILE_NOTIFY_CHANGE_DIR_NAME);
+                BOOL result = ReadDirectoryChangesW(state.w.dir_handle, state.buffer.data(),
+                                                    static_cast<DWORD>(state.buffer.size()),
+                                                    state.recursive ? TRUE : FALSE, filter, nullptr,
+                                                    &state.w.overlapped, nullptr);
 
                 if(result || GetLastError() == ERROR_IO_PENDING) {
                     state.read_pending = true;
@@ -283,14 +309,30 @@ struct DirWatcherImpl {
                                          static_cast<int>(notify->FileNameLength / sizeof(WCHAR))};
 
                     // The directory is guaranteed to end with a '/', since we made sure when we added it.
-                    UString uni_filepath{fmt::format("{}{}", path, uni_filename)};
-                    std::string std_filepath{uni_filepath.utf8View()};
+                    // (files in subdirectories of recursive watches come as relative paths with backslashes)
+                    std::string std_filepath{fmt::format("{}{}", path, uni_filename)};
+                    std::ranges::replace(std_filepath, '\\', '/');
+                    UString uni_filepath{std_filepath};
 
                     std::error_code ec;
                     auto file_status = fs::status(uni_filepath.wstringView(), ec);
 
-                    // Handle deletions immediately
-                    if(ec || file_status.type() != fs::file_type::regular) {
+                    const bool dir_added =
+                        notify->Action == FILE_ACTION_ADDED || notify->Action == FILE_ACTION_RENAMED_NEW_NAME;
+                    if(!ec && file_status.type() == fs::file_type::directory) {
+                        // directories are created in one go, no need to wait for them to settle
+                        if(!state.recursive && dir_added) {
+                            auto dir_time = fs::last_write_time(uni_filepath.wstringView(), ec);
+                            if(!ec) {
+                                Sync::scoped_lock lock(this->finished_events_mtx);
+                                this->finished_events.emplace_back(state.cb,
+                                                                   FileChangeEvent{.path = std_filepath + '/',
+                                                                                   .type = FileChangeType::CREATED,
+                                                                                   .tms = dir_time});
+                            }
+                        }
+                    } else if(ec || file_status.type() != fs::file_type::regular) {
+                        // Handle deletions immediately
                         if(notify->Action == FILE_ACTION_REMOVED || notify->Action == FILE_ACTION_RENAMED_OLD_NAME) {
                             Sync::scoped_lock lock(this->finished_events_mtx);
                             this->finished_events.emplace_back(state.cb,
@@ -373,6 +415,361 @@ struct DirWatcherImpl {
 
         CloseHandle(stop_event);
     }
+#elif defined(MCENGINE_PLATFORM_LINUX)
+   private:
+    // inotify also tells us when a writer closes a file, so unlike on Windows most creations/modifications can be
+    // confirmed right away instead of waiting for their timestamp to settle.
+    // NOTE: fanotify could mark a whole filesystem instead of every single subdirectory, but that needs
+    // CAP_SYS_ADMIN, and an unprivileged fanotify group can't do anything inotify can't.
+
+    int wakeup_fd{-1};
+
+    void init_wakeup_notification() {
+        this->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        assert(this->wakeup_fd != -1);
+    }
+    void destroy_wakeup_notification() {
+        if(this->wakeup_fd != -1) close(this->wakeup_fd);
+        this->wakeup_fd = -1;
+    }
+    void notify_thread() {
+        const u64 one = 1;
+        [[maybe_unused]] const ssize_t written = write(this->wakeup_fd, &one, sizeof(one));
+    }
+
+    static constexpr u32 WATCH_MASK = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                                      IN_DELETE | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+    // confirmed events are held back until no new ones came in for this long, so that e.g. extracting an archive
+    // into a watched folder is delivered in one update() instead of trickling in
+    static constexpr u64 COALESCE_MS = 50;
+    static constexpr u64 MAX_COALESCE_MS = 500;
+    static constexpr u64 STABILITY_CHECK_MS = 100;
+
+    struct DirectoryState {
+        DirectoryState(FileChangeCallback cb, bool recursive) : cb(std::move(cb)), recursive(recursive) {}
+        FileChangeCallback cb;
+        bool recursive;
+
+        // created/modified files which haven't been closed yet
+        Hash::stable_stringmap<UnconfirmedEvent> unconfirmed_events{};
+        Hash::stable_stringmap<FileChangeEvent> confirmed_events{};
+        std::vector<int> watch_descriptors;
+    };
+
+    struct Watch {
+        std::string dir;   // always ends with a '/'
+        std::string root;  // key of the DirectoryState this belongs to
+    };
+
+    using DirectoryMap = Hash::stable_stringmap<DirectoryState>;
+    using WatchMap = Hash::flat::map<int, Watch>;
+
+    static void confirm_event(DirectoryState& state, FileChangeEvent event) {
+        state.unconfirmed_events.erase(event.path);
+
+        auto [it, inserted] = state.confirmed_events.try_emplace(event.path, event);
+        if(inserted) return;
+
+        // coalesce with what we already have for this file
+        auto& existing = it->second;
+        if(event.type != FileChangeType::DELETED && existing.type == FileChangeType::CREATED) {
+            existing.tms = event.tms;
+        } else {
+            existing = std::move(event);
+        }
+    }
+
+    static void add_unconfirmed_event(DirectoryState& state, const std::string& file, FileChangeType type) {
+        std::error_code ec;
+        const auto file_time = fs::last_write_time(file, ec);
+        if(ec) return;
+
+        auto it = state.unconfirmed_events.find(file);
+        if(it != state.unconfirmed_events.end()) {
+            // preserve CREATED type if that's what we saw first
+            auto& existing = it->second;
+            if(existing.event.type != FileChangeType::CREATED) {
+                existing.event.type = type;
+            }
+            existing.event.tms = file_time;
+            existing.stable_checks = 0;
+        } else {
+            state.unconfirmed_events[file] = UnconfirmedEvent({file, type, file_time});
+        }
+    }
+
+    // watches dir (and its subdirectories if the state is recursive)
+    // files that already exist are reported as created if report_existing, for directories that appeared after we
+    // started watching (their contents could have been written before we got to adding a watch)
+    static void add_watches(int inotify_fd, WatchMap& watches, const std::string& root, DirectoryState& state,
+                            const std::string& dir, bool report_existing) {
+        const int wd = inotify_add_watch(inotify_fd, dir.c_str(), WATCH_MASK);
+        if(wd < 0) {
+            if(errno == ENOSPC) {
+                debugLog("DirectoryWatcher: out of inotify watches adding {} (see fs.inotify.max_user_watches)", dir);
+            } else {
+                debugLog("DirectoryWatcher: failed to watch directory {}: {}", dir, std::strerror(errno));
+            }
+            return;
+        }
+        watches[wd] = Watch{.dir = dir, .root = root};
+        if(!std::ranges::contains(state.watch_descriptors, wd)) state.watch_descriptors.push_back(wd);
+
+        if(!state.recursive && !report_existing) return;
+
+        std::error_code ec;
+        for(const auto& entry : fs::directory_iterator(dir, fs::directory_options::skip_permission_denied, ec)) {
+            const auto type = entry.symlink_status(ec).type();
+            if(ec) continue;
+
+            std::string path = dir + entry.path().filename().string();
+            if(type == fs::file_type::directory) {
+                if(!state.recursive) continue;
+                path.push_back('/');
+                add_watches(inotify_fd, watches, root, state, path, report_existing);
+            } else if(report_existing && type == fs::file_type::regular) {
+                add_unconfirmed_event(state, path, FileChangeType::CREATED);
+            }
+        }
+    }
+
+    static void remove_watches(int inotify_fd, WatchMap& watches, DirectoryState& state) {
+        for(const int wd : state.watch_descriptors) {
+            inotify_rm_watch(inotify_fd, wd);
+            watches.erase(wd);
+        }
+        state.watch_descriptors.clear();
+    }
+
+    static void handle_event(int inotify_fd, const inotify_event& ev, DirectoryMap& active_directories,
+                             WatchMap& watches) {
+        if(ev.mask & IN_Q_OVERFLOW) {
+            debugLog("DirectoryWatcher: inotify event queue overflowed, some changes were missed");
+            return;
+        }
+
+        const auto watch_it = watches.find(ev.wd);
+        if(watch_it == watches.end()) return;
+        const auto dir_it = active_directories.find(watch_it->second.root);
+        if(dir_it == active_directories.end()) return;
+        auto& [root, state] = *dir_it;
+
+        if(ev.mask & IN_IGNORED) {
+            // watched directory was deleted/moved away or we removed the watch
+            std::erase(state.watch_descriptors, ev.wd);
+            watches.erase(watch_it);
+            return;
+        }
+        if(ev.len == 0) return;
+
+        // copy, adding watches below can rehash the map
+        std::string path = watch_it->second.dir + ev.name;
+
+        if(ev.mask & IN_ISDIR) {
+            path.push_back('/');
+            if(!state.recursive) {
+                // reported, but not watched (one watch per subdirectory adds up fast, see fs.inotify.max_user_watches)
+                if(ev.mask & (IN_CREATE | IN_MOVED_TO)) {
+                    std::error_code ec;
+                    const auto dir_time = fs::last_write_time(path, ec);
+                    if(ec) return;
+                    confirm_event(state,
+                                  FileChangeEvent{.path = path, .type = FileChangeType::CREATED, .tms = dir_time});
+                }
+                return;
+            }
+
+            if(ev.mask & (IN_CREATE | IN_MOVED_TO)) {
+                add_watches(inotify_fd, watches, root, state, path, true);
+            } else if(ev.mask & IN_MOVED_FROM) {
+                // its watches would keep reporting the old paths
+                std::vector<int> moved;
+                for(const auto& [wd, watch] : watches) {
+                    if(watch.root == root && watch.dir.starts_with(path)) moved.push_back(wd);
+                }
+                for(const int wd : moved) {
+                    inotify_rm_watch(inotify_fd, wd);
+                    watches.erase(wd);
+                    std::erase(state.watch_descriptors, wd);
+                }
+            }
+            return;
+        }
+
+        if(ev.mask & (IN_DELETE | IN_MOVED_FROM)) {
+            confirm_event(state, FileChangeEvent{.path = path, .type = FileChangeType::DELETED, .tms = {}});
+        } else if(ev.mask & (IN_MOVED_TO | IN_CLOSE_WRITE)) {
+            // renames are atomic, and a closed file is done being written to
+            std::error_code ec;
+            const auto file_time = fs::last_write_time(path, ec);
+            if(ec) return;
+
+            FileChangeType type = FileChangeType::CREATED;
+            if(ev.mask & IN_CLOSE_WRITE) {
+                const auto it = state.unconfirmed_events.find(path);
+                type = it != state.unconfirmed_events.end() ? it->second.event.type : FileChangeType::MODIFIED;
+            }
+            confirm_event(state, FileChangeEvent{.path = path, .type = type, .tms = file_time});
+        } else if(ev.mask & IN_CREATE) {
+            add_unconfirmed_event(state, path, FileChangeType::CREATED);
+        } else if(ev.mask & IN_MODIFY) {
+            add_unconfirmed_event(state, path, FileChangeType::MODIFIED);
+        }
+    }
+
+    void worker_loop(const Sync::stop_token& stoken) {
+        McThread::set_current_thread_name(US_("dir_watcher"));
+        McThread::set_current_thread_prio(McThread::Priority::LOW);
+
+        const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(inotify_fd < 0) {
+            debugLog("DirectoryWatcher: inotify_init1 failed: {}", std::strerror(errno));
+            return;
+        }
+
+        // wake up the poll() below when stop is requested
+        Sync::stop_callback stop_cb(stoken, [this]() { this->notify_thread(); });
+
+        DirectoryMap active_directories;
+        WatchMap watches;
+
+        std::vector<char> buffer(64 * 1024);
+        u64 first_pending_confirm_ms = 0;  // 0 if nothing is waiting to be published
+        u64 last_stability_check_ms = 0;
+
+        while(!stoken.stop_requested()) {
+            // Add/remove directories
+            {
+                Sync::scoped_lock lock(this->directories_mtx);
+                for(auto& path : this->directories_to_remove) {
+                    if(!path.ends_with('/')) path.push_back('/');
+
+                    if(auto it = active_directories.find(path); it != active_directories.end()) {
+                        remove_watches(inotify_fd, watches, it->second);
+                        active_directories.erase(it);
+                    }
+                }
+
+                for(auto& [path, cb, recursive] : this->directories_to_add) {
+                    // Don't add if it's going to be removed
+                    if(std::ranges::contains(this->directories_to_remove, path)) continue;
+                    if(!path.ends_with('/')) path.push_back('/');
+
+                    auto [it, added] = active_directories.emplace(path, DirectoryState(cb, recursive));
+                    if(added) {
+                        add_watches(inotify_fd, watches, it->first, it->second, it->first, false);
+                    }
+                }
+                this->directories_to_add.clear();
+                this->directories_to_remove.clear();
+            }
+
+            bool has_unconfirmed = false;
+            for(const auto& [path, state] : active_directories) {
+                if(!state.unconfirmed_events.empty()) {
+                    has_unconfirmed = true;
+                    break;
+                }
+            }
+
+            // only time out when something is waiting to be published or for its timestamp to settle
+            int timeout = -1;
+            if(first_pending_confirm_ms != 0) {
+                timeout = static_cast<int>(COALESCE_MS);
+            } else if(has_unconfirmed) {
+                timeout = static_cast<int>(STABILITY_CHECK_MS);
+            }
+
+            std::array<pollfd, 2> fds{{{.fd = inotify_fd, .events = POLLIN, .revents = 0},
+                                       {.fd = this->wakeup_fd, .events = POLLIN, .revents = 0}}};
+            const int ready = poll(fds.data(), fds.size(), timeout);
+            if(ready < 0 && errno != EINTR) {
+                debugLog("DirectoryWatcher: poll failed: {}", std::strerror(errno));
+                break;
+            }
+            if(stoken.stop_requested()) break;
+
+            if(fds[1].revents & POLLIN) {
+                u64 count;
+                [[maybe_unused]] const ssize_t got = read(this->wakeup_fd, &count, sizeof(count));
+            }
+
+            // drain everything inotify has for us
+            bool got_events = false;
+            if(fds[0].revents & POLLIN) {
+                ssize_t len;
+                while((len = read(inotify_fd, buffer.data(), buffer.size())) > 0) {
+                    got_events = true;
+                    for(ssize_t offset = 0; offset < len;) {
+                        const auto* ev = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                        handle_event(inotify_fd, *ev, active_directories, watches);
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                    }
+                }
+            }
+
+            const u64 now = Timing::getTicksMS();
+
+            // Check unconfirmed events for stability (fallback for files that were never closed, e.g. written
+            // through mmap), require at least 2 consecutive stable checks before confirming
+            if(has_unconfirmed && now - last_stability_check_ms >= STABILITY_CHECK_MS) {
+                last_stability_check_ms = now;
+                for(auto& [path, state] : active_directories) {
+                    std::vector<std::string> to_confirm;
+                    for(auto& [file, unconfirmed] : state.unconfirmed_events) {
+                        std::error_code ec;
+                        const auto current_time = fs::last_write_time(file, ec);
+                        if(ec) {
+                            // deleted in the meantime (we'll have gotten an event for that)
+                            to_confirm.push_back(file);
+                        } else if(current_time != unconfirmed.event.tms) {
+                            unconfirmed.event.tms = current_time;
+                            unconfirmed.stable_checks = 0;
+                        } else if(++unconfirmed.stable_checks >= 2) {
+                            to_confirm.push_back(file);
+                        }
+                    }
+                    for(const auto& file : to_confirm) {
+                        const auto it = state.unconfirmed_events.find(file);
+                        UnconfirmedEvent unconfirmed = std::move(it->second);
+                        state.unconfirmed_events.erase(it);
+                        if(unconfirmed.stable_checks >= 2) confirm_event(state, std::move(unconfirmed.event));
+                    }
+                }
+            }
+
+            bool has_confirmed = false;
+            for(const auto& [path, state] : active_directories) {
+                if(!state.confirmed_events.empty()) {
+                    has_confirmed = true;
+                    break;
+                }
+            }
+            if(!has_confirmed) {
+                first_pending_confirm_ms = 0;
+                continue;
+            }
+            if(first_pending_confirm_ms == 0) first_pending_confirm_ms = now;
+
+            // publish once things have calmed down (or if they don't, at least every MAX_COALESCE_MS)
+            if(got_events && now - first_pending_confirm_ms < MAX_COALESCE_MS) continue;
+
+            {
+                Sync::scoped_lock lock(this->finished_events_mtx);
+                for(auto& [path, state] : active_directories) {
+                    for(auto& [file, event] : state.confirmed_events) {
+                        this->finished_events.emplace_back(state.cb, std::move(event));
+                    }
+                    state.confirmed_events.clear();
+                }
+                this->finished_events_count.store(this->finished_events.size(), std::memory_order_release);
+            }
+            first_pending_confirm_ms = 0;
+        }
+
+        close(inotify_fd);
+    }
 #else
    private:
     // Generic implementation (polling)
@@ -383,8 +780,9 @@ struct DirWatcherImpl {
     void notify_thread() {}
 
     struct DirectoryState {
-        DirectoryState(FileChangeCallback cb) : cb(std::move(cb)) {}
+        DirectoryState(FileChangeCallback cb, bool recursive) : cb(std::move(cb)), recursive(recursive) {}
         FileChangeCallback cb;
+        bool recursive;
 
         Hash::stable_stringmap<UnconfirmedEvent> unconfirmed_events{};
         Hash::stable_stringmap<fs::file_time_type> files{};
@@ -401,22 +799,34 @@ struct DirWatcherImpl {
         // To keep things "simple" for now, we'll just do the simplest method
         // that works on all platforms: manually checking for changes.
 
-        // The downside is that this doesn't work recursively, so we can't
-        // just monitor the entire Skins/ and Songs/ directories.
+        // The downside is that recursive watches have to walk the entire tree
+        // every time, so we can't cheaply monitor the entire Skins/ and Songs/ directories.
 
-        static auto getFileTimes = [](const std::string& dir_path) -> Hash::stable_stringmap<fs::file_time_type> {
+        static auto getFileTimes = [](const std::string& dir_path,
+                                      bool recursive) -> Hash::stable_stringmap<fs::file_time_type> {
             Hash::stable_stringmap<fs::file_time_type> files;
 
-            std::error_code ec;
-            for(const auto& entry : fs::directory_iterator(dir_path, ec)) {
-                if(ec) continue;
+            const auto add_entry = [&files](const fs::directory_entry& entry) {
+                std::error_code ec;
                 auto fileType = entry.status(ec).type();
                 // we only care about files, not directories right now
-                if(fileType != fs::file_type::regular) continue;
+                if(fileType != fs::file_type::regular) return;
 
                 auto time = fs::last_write_time(entry, ec);
-                if(ec) continue;
+                if(ec) return;
                 files[entry.path().string()] = time;
+            };
+
+            std::error_code ec;
+            if(recursive) {
+                for(const auto& entry :
+                    fs::recursive_directory_iterator(dir_path, fs::directory_options::skip_permission_denied, ec)) {
+                    add_entry(entry);
+                }
+            } else {
+                for(const auto& entry : fs::directory_iterator(dir_path, ec)) {
+                    add_entry(entry);
+                }
             }
 
             return files;
@@ -429,12 +839,12 @@ struct DirWatcherImpl {
             // Add/remove directories
             {
                 Sync::scoped_lock lock(this->directories_mtx);
-                for(auto& [path, cb] : this->directories_to_add) {
+                for(auto& [path, cb, recursive] : this->directories_to_add) {
                     // Don't add if it's going to be removed
                     if(std::ranges::contains(this->directories_to_remove, path)) continue;
                     if(!path.ends_with('/')) path.push_back('/');
 
-                    auto [it, added] = active_directories.emplace(path, DirectoryState(cb));
+                    auto [it, added] = active_directories.emplace(path, DirectoryState(cb, recursive));
                     if(added) {
                         // This should always be true
                         directories_to_init.push_back(it);
@@ -454,14 +864,14 @@ struct DirWatcherImpl {
                 for(const auto& it : directories_to_init) {
                     auto& path = it->first;
                     auto& state = it->second;
-                    state.files = getFileTimes(path);
+                    state.files = getFileTimes(path, state.recursive);
                 }
                 directories_to_init.clear();
             }
 
             // Check for changes
             for(auto& [path, state] : active_directories) {
-                auto latest_files = getFileTimes(path);
+                auto latest_files = getFileTimes(path, state.recursive);
 
                 // Deletions
                 for(auto& [file, tms] : state.files) {
@@ -531,10 +941,18 @@ DirectoryWatcher::DirectoryWatcher() : pImpl() {}
 
 DirectoryWatcher::~DirectoryWatcher() = default;
 
-void DirectoryWatcher::watch_directory(std::string path, FileChangeCallback cb) {
-    return pImpl->watch_directory(std::move(path), std::move(cb));
+void DirectoryWatcher::watch_directory(std::string path, FileChangeCallback cb, bool recursive) {
+    return pImpl->watch_directory(std::move(path), std::move(cb), recursive);
 }
 
 void DirectoryWatcher::stop_watching(std::string path) { return pImpl->stop_watching(std::move(path)); }
 
 void DirectoryWatcher::update() { return pImpl->update(); }
+
+bool DirectoryWatcher::is_event_driven() {
+#if defined(MCENGINE_PLATFORM_WINDOWS) || defined(MCENGINE_PLATFORM_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -33,9 +33,16 @@ class DirectoryWatcher {
     DirectoryWatcher();
     ~DirectoryWatcher();
 
-    void watch_directory(std::string path, FileChangeCallback cb);
+    // recursive also reports files in (current and future) subdirectories of path
+    // otherwise, subdirectories created in (or moved into) path are reported as CREATED with a trailing '/', so that
+    // the caller can decide which of them to watch (event-driven platforms only)
+    void watch_directory(std::string path, FileChangeCallback cb, bool recursive = false);
     void stop_watching(std::string path);
 
+    // false if the current platform's implementation has to poll for changes,
+    // i.e. watching large (recursive) directories is expensive
+    [[nodiscard]] static bool is_event_driven();
+
    private:
     friend class Engine;
 
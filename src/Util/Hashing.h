@@ -24,6 +24,7 @@ struct UnstableStringHash {
 // unstable because unordered_dense doesn't guarantee iterator/reference stability
 template <typename T>
 using unstable_stringmap = flat::map<std::string, T, UnstableStringHash, std::equal_to<>>;
+using unstable_stringset = flat::set<std::string, UnstableStringHash, std::equal_to<>>;
 
 struct StableStringHash {
     using is_transparent = void;
@@ -228,6 +228,16 @@ bool parse(S str, T arg, Extra... extra)
     return !!detail::parse_impl(begin, end, arg, extra...);
 }
 
+// Same as parse(), but returns the unparsed remainder of str on success, so that optional trailing
+// fields can be parsed from where the required ones left off instead of re-parsing the whole string.
+template <typename T, typename... Extra>
+std::optional<std::string_view> parse_prefix(std::string_view str, T arg, Extra... extra) {
+    const char *end = str.data() + str.size();
+    const char *pos = detail::parse_impl(str.data(), end, arg, extra...);
+    if(pos == nullptr) return std::nullopt;
+    return std::string_view{pos, static_cast<uSz>(end - pos)};
+}
+
 // NOLINTEND(cppcoreguidelines-init-variables)
 
 // Since strtok_r SUCKS I'll just make my own
@@ -8,10 +8,21 @@
 #include "BaseEnvironment.h"
 
 #include <vector>
+#include <array>
+#include <cassert>
 #include <cstring>
 #include <cerrno>
 #include <random>
 #include <algorithm>
+#include <utility>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #ifdef USE_OPENSSL
 #include <openssl/rand.h>
@@ -131,6 +142,238 @@ void md5(const void* data, size_t size, u8* hash) {
     std::memcpy(hash, hasher.getDigest(), 16);
 }
 
+namespace {
+// multi-buffer MD5: every SIMD lane hashes a different input, so independent buffers are hashed N at a time instead
+// of one (MD5 itself is a serial dependency chain, there is nothing to vectorize within a single buffer)
+#if defined(__AVX512F__)
+struct Md5Lanes {
+    static constexpr uSz N = 16;
+    __m512i v;
+    static forceinline Md5Lanes load(const u32* p) { return {_mm512_load_si512(p)}; }
+    static forceinline Md5Lanes set1(u32 x) { return {_mm512_set1_epi32((int)x)}; }
+    forceinline void store(u32* p) const { _mm512_store_si512(p, this->v); }
+    friend forceinline Md5Lanes operator+(Md5Lanes a, Md5Lanes b) { return {_mm512_add_epi32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator&(Md5Lanes a, Md5Lanes b) { return {_mm512_and_si512(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator|(Md5Lanes a, Md5Lanes b) { return {_mm512_or_si512(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator^(Md5Lanes a, Md5Lanes b) { return {_mm512_xor_si512(a.v, b.v)}; }
+    template <int S>
+    forceinline Md5Lanes rotl() const {
+        return {_mm512_rol_epi32(this->v, S)};
+    }
+};
+#elif defined(__AVX2__)
+struct Md5Lanes {
+    static constexpr uSz N = 8;
+    __m256i v;
+    static forceinline Md5Lanes load(const u32* p) { return {_mm256_load_si256(reinterpret_cast<const __m256i*>(p))}; }
+    static forceinline Md5Lanes set1(u32 x) { return {_mm256_set1_epi32((int)x)}; }
+    forceinline void store(u32* p) const { _mm256_store_si256(reinterpret_cast<__m256i*>(p), this->v); }
+    friend forceinline Md5Lanes operator+(Md5Lanes a, Md5Lanes b) { return {_mm256_add_epi32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator&(Md5Lanes a, Md5Lanes b) { return {_mm256_and_si256(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator|(Md5Lanes a, Md5Lanes b) { return {_mm256_or_si256(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator^(Md5Lanes a, Md5Lanes b) { return {_mm256_xor_si256(a.v, b.v)}; }
+    template <int S>
+    forceinline Md5Lanes rotl() const {
+        return {_mm256_or_si256(_mm256_slli_epi32(this->v, S), _mm256_srli_epi32(this->v, 32 - S))};
+    }
+};
+#elif defined(__SSE2__)
+struct Md5Lanes {
+    static constexpr uSz N = 4;
+    __m128i v;
+    static forceinline Md5Lanes load(const u32* p) { return {_mm_load_si128(reinterpret_cast<const __m128i*>(p))}; }
+    static forceinline Md5Lanes set1(u32 x) { return {_mm_set1_epi32((int)x)}; }
+    forceinline void store(u32* p) const { _mm_store_si128(reinterpret_cast<__m128i*>(p), this->v); }
+    friend forceinline Md5Lanes operator+(Md5Lanes a, Md5Lanes b) { return {_mm_add_epi32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator&(Md5Lanes a, Md5Lanes b) { return {_mm_and_si128(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator|(Md5Lanes a, Md5Lanes b) { return {_mm_or_si128(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator^(Md5Lanes a, Md5Lanes b) { return {_mm_xor_si128(a.v, b.v)}; }
+    template <int S>
+    forceinline Md5Lanes rotl() const {
+        return {_mm_or_si128(_mm_slli_epi32(this->v, S), _mm_srli_epi32(this->v, 32 - S))};
+    }
+};
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+struct Md5Lanes {
+    static constexpr uSz N = 4;
+    uint32x4_t v;
+    static forceinline Md5Lanes load(const u32* p) { return {vld1q_u32(p)}; }
+    static forceinline Md5Lanes set1(u32 x) { return {vdupq_n_u32(x)}; }
+    forceinline void store(u32* p) const { vst1q_u32(p, this->v); }
+    friend forceinline Md5Lanes operator+(Md5Lanes a, Md5Lanes b) { return {vaddq_u32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator&(Md5Lanes a, Md5Lanes b) { return {vandq_u32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator|(Md5Lanes a, Md5Lanes b) { return {vorrq_u32(a.v, b.v)}; }
+    friend forceinline Md5Lanes operator^(Md5Lanes a, Md5Lanes b) { return {veorq_u32(a.v, b.v)}; }
+    template <int S>
+    forceinline Md5Lanes rotl() const {
+        return {vsriq_n_u32(vshlq_n_u32(this->v, S), this->v, 32 - S)};
+    }
+};
+#endif
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || (defined(__aarch64__) && defined(__ARM_NEON))
+#define MD5_MULTI_BUFFER 1
+
+// RFC 1321 per-step constants: sine table, rotation amounts, message word index
+constexpr std::array<u32, 64> MD5_K{
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+constexpr std::array<int, 16> MD5_S{7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+consteval uSz md5_word(uSz i) {
+    switch(i / 16) {
+        case 0:
+            return i;
+        case 1:
+            return (5 * i + 1) % 16;
+        case 2:
+            return (3 * i + 5) % 16;
+        default:
+            return (7 * i) % 16;
+    }
+}
+
+using Md5Words = u32[16][Md5Lanes::N];
+
+// one of the 64 steps. the state rotates by one register per step, so step I works on st[(4 - I) % 4] etc.
+template <uSz I>
+forceinline void md5_step(std::array<Md5Lanes, 4>& st, const Md5Words& w) {
+    Md5Lanes& a = st[(4 - I % 4) % 4];
+    const Md5Lanes b = st[(5 - I % 4) % 4];
+    const Md5Lanes c = st[(6 - I % 4) % 4];
+    const Md5Lanes d = st[(7 - I % 4) % 4];
+
+    Md5Lanes f;
+    if constexpr(I < 16) {
+        f = d ^ (b & (c ^ d));
+    } else if constexpr(I < 32) {
+        f = c ^ (d & (b ^ c));
+    } else if constexpr(I < 48) {
+        f = b ^ c ^ d;
+    } else {
+        f = c ^ (b | (d ^ Md5Lanes::set1(0xffffffff)));
+    }
+
+    a = b + (a + f + Md5Lanes::set1(MD5_K[I]) + Md5Lanes::load(w[md5_word(I)])).template rotl<MD5_S[(I / 16) * 4 + I % 4]>();
+}
+
+template <uSz... I>
+forceinline void md5_steps(std::array<Md5Lanes, 4>& st, const Md5Words& w, std::index_sequence<I...>) {
+    (md5_step<I>(st, w), ...);
+}
+
+// per-lane cursor over one input: full blocks straight from the input, then 1-2 blocks of padding/length
+struct Md5LaneJob {
+    const u8* data{nullptr};
+    uSz full_blocks{0};
+    uSz total_blocks{0};
+    uSz next_block{0};
+    uSz input_idx{0};
+    bool active{false};
+    alignas(16) u8 tail[128]{};
+
+    void start(std::span<const u8> input, uSz idx) {
+        this->data = input.data();
+        this->full_blocks = input.size() / 64;
+        this->next_block = 0;
+        this->input_idx = idx;
+        this->active = true;
+
+        const uSz rem = input.size() % 64;
+        std::memset(this->tail, 0, sizeof(this->tail));
+        if(rem > 0) std::memcpy(this->tail, input.data() + this->full_blocks * 64, rem);
+        this->tail[rem] = 0x80;
+
+        const uSz tail_blocks = rem + 9 <= 64 ? 1 : 2;
+        const u64 bit_length = static_cast<u64>(input.size()) * 8;
+        for(uSz i = 0; i < 8; i++) this->tail[tail_blocks * 64 - 8 + i] = static_cast<u8>(bit_length >> (8 * i));
+
+        this->total_blocks = this->full_blocks + tail_blocks;
+    }
+
+    [[nodiscard]] const u8* block() const {
+        return this->next_block < this->full_blocks ? this->data + this->next_block * 64
+                                                    : this->tail + (this->next_block - this->full_blocks) * 64;
+    }
+};
+
+void md5_multi_buffer(std::span<const std::span<const u8>> inputs, std::span<MD5Hash> hashes_out) {
+    constexpr uSz N = Md5Lanes::N;
+    static constexpr u8 idle_block[64]{};
+
+    std::array<Md5LaneJob, N> jobs;
+    alignas(64) u32 state[4][N];
+    alignas(64) Md5Words words;
+
+    uSz next_input = 0;
+    for(;;) {
+        // refill idle lanes, so long inputs don't hold up the short ones
+        bool any_active = false;
+        for(uSz lane = 0; lane < N; lane++) {
+            auto& job = jobs[lane];
+            if(!job.active && next_input < inputs.size()) {
+                job.start(inputs[next_input], next_input);
+                next_input++;
+                state[0][lane] = 0x67452301;
+                state[1][lane] = 0xefcdab89;
+                state[2][lane] = 0x98badcfe;
+                state[3][lane] = 0x10325476;
+            }
+            any_active |= job.active;
+        }
+        if(!any_active) break;
+
+        // transpose: words[j][lane] is message word j of that lane's current block
+        for(uSz lane = 0; lane < N; lane++) {
+            const u8* block = jobs[lane].active ? jobs[lane].block() : idle_block;
+            for(uSz j = 0; j < 16; j++) {
+                const u8* p = block + j * 4;
+                words[j][lane] = (u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
+            }
+        }
+
+        std::array<Md5Lanes, 4> st{Md5Lanes::load(state[0]), Md5Lanes::load(state[1]), Md5Lanes::load(state[2]),
+                                   Md5Lanes::load(state[3])};
+        md5_steps(st, words, std::make_index_sequence<64>{});
+        for(uSz i = 0; i < 4; i++) (st[i] + Md5Lanes::load(state[i])).store(state[i]);
+
+        for(uSz lane = 0; lane < N; lane++) {
+            auto& job = jobs[lane];
+            if(!job.active || ++job.next_block < job.total_blocks) continue;
+
+            u8* out = hashes_out[job.input_idx].data();
+            for(uSz i = 0; i < 4; i++) {
+                for(uSz b = 0; b < 4; b++) out[i * 4 + b] = static_cast<u8>(state[i][lane] >> (8 * b));
+            }
+            job.active = false;
+        }
+    }
+}
+#else
+#define MD5_MULTI_BUFFER 0
+#endif
+}  // namespace
+
+void md5_batch(std::span<const std::span<const u8>> inputs, std::span<MD5Hash> hashes_out) {
+    assert(hashes_out.size() >= inputs.size());
+#if MD5_MULTI_BUFFER
+    if(inputs.size() > 1) {
+        md5_multi_buffer(inputs, hashes_out);
+        return;
+    }
+#endif
+    for(uSz i = 0; i < inputs.size(); i++) {
+        md5(inputs[i].data(), inputs[i].size(), hashes_out[i].data());
+    }
+}
+
 void sha256_f(std::string_view file_path, u8* hash) {
     constexpr size_t CHUNK_SIZE{32768};
     std::array<u8, CHUNK_SIZE> buffer{};
@@ -2,11 +2,13 @@
 #pragma once
 
 #include "types.h"
+#include <span>
 #include <string>
 #include <vector>
 
 class UString;
 struct MD5String;
+struct MD5Hash;
 
 namespace crypto {
 
@@ -67,6 +69,10 @@ void md5_f(std::string_view file_path, u8* hash);
 // computes digest and returns a 32-wide array of chars of the hex
 MD5String md5_hex(const u8* msg, size_t msg_len);
 
+// hashes independent buffers several at a time (one per SIMD lane: 16 with AVX-512, 8 with AVX2, 4 with SSE2/NEON),
+// or one by one through md5() without SIMD. hashes_out[i] receives the digest of inputs[i].
+void md5_batch(std::span<const std::span<const u8>> inputs, std::span<MD5Hash> hashes_out);
+
 }  // namespace hash
 
 namespace conv {